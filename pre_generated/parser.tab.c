@@ -73,23 +73,53 @@
 #include <stdlib.h>
 #include <string.h>
 #include "compiler.h"
+#include "phase.h"
+#include "memstats.h"
 
 void yyerror(const char* s);
 int yylex(void);
 
+// The lexer is timed as a phase of its own, so the parser calls it through
+// phase_yylex(), defined at the end of this file.
+static int phase_yylex(void);
+#define yylex phase_yylex
+
+// Appends item, which may itself be a chain (an IF and its ELSE, the
+// statements of a block), walking only the appended part.
+static NodeList list_append(NodeList list, ASTNode* item) {
+    if (item == NULL) return list;
+    if (list.head == NULL) {
+        list.head = item;
+    } else {
+        list.tail->next = item;
+    }
+    while (item->next != NULL) item = item->next;
+    list.tail = item;
+    return list;
+}
+
+static NodeList empty_list(void) {
+    NodeList list = { NULL, NULL };
+    return list;
+}
+
 char* my_strdup(const char* s) {
-    char* result = malloc(strlen(s) + 1);
+    phase_begin(PHASE_AST);
+    size_t size = strlen(s) + 1;
+    char* result = malloc(size);
     if (result == NULL) {
         fprintf(stderr, "Memory allocation failed\n");
         exit(1);
     }
     strcpy(result, s);
+    mem_alloc(MEM_PARSER_STRING, size);
+    phase_end(PHASE_AST);
     return result;
 }
 
 ASTNode* root = NULL;
 
-#line 93 "pre_generated/parser.tab.c"
+#line 123 "pre_generated/parser.tab.c"
 
 # ifndef YY_CAST
 #  ifdef __cplusplus
@@ -160,27 +190,28 @@ enum yysymbol_kind_t
   YYSYMBOL_YYACCEPT = 40,                  /* $accept  */
   YYSYMBOL_program = 41,                   /* program  */
   YYSYMBOL_function_def = 42,              /* function_def  */
-  YYSYMBOL_param_list = 43,                /* param_list  */
-  YYSYMBOL_params = 44,                    /* params  */
-  YYSYMBOL_type = 45,                      /* type  */
-  YYSYMBOL_statements = 46,                /* statements  */
-  YYSYMBOL_statement = 47,                 /* statement  */
-  YYSYMBOL_declaration = 48,               /* declaration  */
-  YYSYMBOL_if_statement = 49,              /* if_statement  */
-  YYSYMBOL_while_statement = 50,           /* while_statement  */
-  YYSYMBOL_for_statement = 51,             /* for_statement  */
-  YYSYMBOL_return_statement = 52,          /* return_statement  */
-  YYSYMBOL_expression = 53,                /* expression  */
-  YYSYMBOL_assignment_expr = 54,           /* assignment_expr  */
-  YYSYMBOL_logical_expr = 55,              /* logical_expr  */
-  YYSYMBOL_relational_expr = 56,           /* relational_expr  */
-  YYSYMBOL_additive_expr = 57,             /* additive_expr  */
-  YYSYMBOL_term = 58,                      /* term  */
-  YYSYMBOL_factor = 59,                    /* factor  */
-  YYSYMBOL_function_call = 60,             /* function_call  */
-  YYSYMBOL_array_access = 61,              /* array_access  */
-  YYSYMBOL_arg_list = 62,                  /* arg_list  */
-  YYSYMBOL_args = 63                       /* args  */
+  YYSYMBOL_43_1 = 43,                      /* @1  */
+  YYSYMBOL_param_list = 44,                /* param_list  */
+  YYSYMBOL_params = 45,                    /* params  */
+  YYSYMBOL_type = 46,                      /* type  */
+  YYSYMBOL_statements = 47,                /* statements  */
+  YYSYMBOL_statement = 48,                 /* statement  */
+  YYSYMBOL_declaration = 49,               /* declaration  */
+  YYSYMBOL_if_statement = 50,              /* if_statement  */
+  YYSYMBOL_while_statement = 51,           /* while_statement  */
+  YYSYMBOL_for_statement = 52,             /* for_statement  */
+  YYSYMBOL_return_statement = 53,          /* return_statement  */
+  YYSYMBOL_expression = 54,                /* expression  */
+  YYSYMBOL_assignment_expr = 55,           /* assignment_expr  */
+  YYSYMBOL_logical_expr = 56,              /* logical_expr  */
+  YYSYMBOL_relational_expr = 57,           /* relational_expr  */
+  YYSYMBOL_additive_expr = 58,             /* additive_expr  */
+  YYSYMBOL_term = 59,                      /* term  */
+  YYSYMBOL_factor = 60,                    /* factor  */
+  YYSYMBOL_function_call = 61,             /* function_call  */
+  YYSYMBOL_array_access = 62,              /* array_access  */
+  YYSYMBOL_arg_list = 63,                  /* arg_list  */
+  YYSYMBOL_args = 64                       /* args  */
 };
 typedef enum yysymbol_kind_t yysymbol_kind_t;
 
@@ -513,11 +544,11 @@ union yyalloc
 /* YYNTOKENS -- Number of terminals.  */
 #define YYNTOKENS  40
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  24
+#define YYNNTS  25
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  68
+#define YYNRULES  69
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  132
+#define YYNSTATES  133
 
 /* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   294
@@ -570,13 +601,13 @@ static const yytype_int8 yytranslate[] =
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
-       0,    52,    52,    57,    69,    78,    83,    89,    93,   106,
-     110,   114,   121,   125,   139,   145,   149,   153,   157,   161,
-     165,   169,   176,   180,   185,   194,   200,   212,   221,   232,
-     237,   244,   251,   255,   260,   268,   276,   285,   289,   295,
-     304,   308,   314,   320,   326,   332,   338,   347,   351,   357,
-     366,   370,   376,   382,   391,   395,   401,   405,   409,   413,
-     418,   423,   427,   434,   442,   450,   455,   461,   465
+       0,    84,    84,    89,    96,    96,   107,   112,   118,   122,
+     129,   133,   137,   144,   148,   153,   159,   163,   167,   171,
+     175,   179,   183,   190,   194,   199,   208,   215,   228,   238,
+     250,   255,   262,   269,   273,   278,   286,   294,   303,   307,
+     313,   322,   326,   332,   338,   344,   350,   356,   365,   369,
+     375,   384,   388,   394,   400,   409,   413,   419,   423,   427,
+     431,   436,   441,   445,   452,   460,   468,   473,   479,   483
 };
 #endif
 
@@ -598,7 +629,7 @@ static const char *const yytname[] =
   "ASSIGN", "PLUS_ASSIGN", "MINUS_ASSIGN", "EQ", "NEQ", "LT", "GT", "LE",
   "GE", "AND", "OR", "NOT", "LPAREN", "RPAREN", "LBRACE", "RBRACE",
   "LBRACKET", "RBRACKET", "SEMICOLON", "COMMA", "$accept", "program",
-  "function_def", "param_list", "params", "type", "statements",
+  "function_def", "@1", "param_list", "params", "type", "statements",
   "statement", "declaration", "if_statement", "while_statement",
   "for_statement", "return_statement", "expression", "assignment_expr",
   "logical_expr", "relational_expr", "additive_expr", "term", "factor",
@@ -612,7 +643,7 @@ yysymbol_name (yysymbol_kind_t yysymbol)
 }
 #endif
 
-#define YYPACT_NINF (-34)
+#define YYPACT_NINF (-33)
 
 #define yypact_value_is_default(Yyn) \
   ((Yyn) == YYPACT_NINF)
@@ -626,20 +657,20 @@ yysymbol_name (yysymbol_kind_t yysymbol)
    STATE-NUM.  */
 static const yytype_int16 yypact[] =
 {
-      12,   -34,   -34,   -34,    16,   -34,    63,   -34,   -34,    37,
-      12,   -27,    33,    69,    40,    12,   -34,   146,    73,   -34,
-      43,   -34,   -34,    46,    48,    50,     6,   160,   160,   165,
-     146,    79,    99,   -34,    49,   -34,   -34,   -34,   -34,    51,
-     -34,     2,   112,    -1,    22,   -34,   -34,    64,   -34,   165,
-     165,   165,   165,   165,   165,   165,   165,   -34,    52,   -19,
-     -34,   -34,   -34,    58,   113,   -18,   -34,   -34,   -34,   -34,
-     160,   160,   160,   160,   160,   160,   160,   160,   160,   160,
-     160,   160,   160,   165,   -34,   -34,   -34,   -34,    60,    55,
-      59,    65,    67,    72,   -34,   -34,   -34,   165,    94,   112,
-     112,    -1,    -1,    -1,    -1,    -1,    -1,    22,    22,   -34,
-     -34,   -34,   -34,   -34,   165,   -34,   146,   146,   165,   -34,
-      77,   -34,   117,   -34,    86,   -34,   146,   165,   -34,   108,
-     146,   -34
+      32,   -33,   -33,   -33,    16,   -33,    10,   -33,   -33,   -33,
+       0,    32,    36,    31,    72,    44,    32,   -33,   146,    73,
+     -33,    43,   -33,   -33,    48,    49,    50,     6,   160,   160,
+     165,   146,    79,    99,   -33,    46,   -33,   -33,   -33,   -33,
+      51,   -33,   -10,   112,    27,    55,   -33,   -33,    67,   -33,
+     165,   165,   165,   165,   165,   165,   165,   165,   -33,    52,
+     -15,   -33,   -33,   -33,    58,   113,    -5,   -33,   -33,   -33,
+     -33,   160,   160,   160,   160,   160,   160,   160,   160,   160,
+     160,   160,   160,   160,   165,   -33,   -33,   -33,   -33,    60,
+      57,    61,    64,    77,    56,   -33,   -33,   -33,   165,    97,
+     112,   112,    27,    27,    27,    27,    27,    27,    55,    55,
+     -33,   -33,   -33,   -33,   -33,   165,   -33,   146,   146,   165,
+     -33,    87,   -33,   103,   -33,    90,   -33,   146,   165,   -33,
+     108,   146,   -33
 };
 
 /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
@@ -647,36 +678,36 @@ static const yytype_int16 yypact[] =
    means the default is an error.  */
 static const yytype_int8 yydefact[] =
 {
-       0,     9,    10,    11,     0,     2,     0,     1,     3,     0,
-       6,     0,     5,     0,     0,     0,     7,    14,     0,    55,
-      54,    56,    57,     0,     0,     0,     0,     0,     0,     0,
-      14,     0,     0,    12,     0,    17,    18,    19,    20,     0,
-      31,    32,    37,    40,    47,    50,    61,    62,     8,     0,
-       0,     0,    66,     0,     0,     0,     0,    30,     0,    54,
-      60,    62,    59,     0,     0,    22,     4,    13,    16,    15,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,    33,    34,    35,    67,     0,    65,
-       0,     0,     0,     0,    29,    58,    21,     0,     0,    38,
-      39,    41,    42,    43,    44,    45,    46,    48,    49,    51,
-      52,    53,    36,    63,     0,    64,     0,     0,     0,    23,
-       0,    68,    25,    27,     0,    24,     0,     0,    26,     0,
-       0,    28
+       0,    10,    11,    12,     0,     2,     0,     1,     3,     4,
+       0,     7,     0,     6,     0,     0,     0,     8,    15,     0,
+      56,    55,    57,    58,     0,     0,     0,     0,     0,     0,
+       0,    15,     0,     0,    13,     0,    18,    19,    20,    21,
+       0,    32,    33,    38,    41,    48,    51,    62,    63,     9,
+       0,     0,     0,    67,     0,     0,     0,     0,    31,     0,
+      55,    61,    63,    60,     0,     0,    23,     5,    14,    17,
+      16,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,    34,    35,    36,    68,     0,
+      66,     0,     0,     0,     0,    30,    59,    22,     0,     0,
+      39,    40,    42,    43,    44,    45,    46,    47,    49,    50,
+      52,    53,    54,    37,    64,     0,    65,     0,     0,     0,
+      24,     0,    69,    26,    28,     0,    25,     0,     0,    27,
+       0,     0,    29
 };
 
 /* YYPGOTO[NTERM-NUM].  */
 static const yytype_int16 yypgoto[] =
 {
-     -34,   -34,   128,   -34,   -34,    66,   116,   -31,   -34,   -34,
-     -34,   -34,   -34,   -26,   -15,   -34,   -28,   110,   -33,   -20,
-     -34,   -23,   -34,   -34
+     -33,   -33,   128,   -33,   -33,   -33,     2,   111,   -32,   -33,
+     -33,   -33,   -33,   -33,   -27,   -16,   -33,   -26,   109,   -13,
+     -21,   -33,   -24,   -33,   -33
 };
 
 /* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_int8 yydefgoto[] =
 {
-       0,     4,     5,    11,    12,    31,    32,    33,    34,    35,
+       0,     4,     5,    10,    12,    13,    32,    33,    34,    35,
       36,    37,    38,    39,    40,    41,    42,    43,    44,    45,
-      46,    47,    88,    89
+      46,    47,    48,    89,    90
 };
 
 /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
@@ -684,49 +715,49 @@ static const yytype_int8 yydefgoto[] =
    number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_uint8 yytable[] =
 {
-      58,    67,    97,    63,    61,    61,    14,    60,    62,    19,
-      20,    21,    22,    52,    78,    79,     7,    53,    98,     1,
-       2,     3,    27,     1,     2,     3,    87,    90,    91,    92,
-      93,    70,    71,    67,    84,    85,    86,    28,    29,    80,
-      81,    82,    99,   100,    57,   107,   108,    61,    61,    61,
-      61,    61,    61,    61,    61,    61,    61,    61,    61,    61,
-     109,   110,   111,    49,    50,    51,     6,     9,   112,    10,
-       6,   119,    15,    16,    17,    52,    13,    48,    54,    53,
-      55,    18,    56,    65,    83,   122,   123,    68,   121,    69,
-      94,    95,   124,   113,   114,   128,   115,   120,   116,   131,
-     117,   129,    19,    20,    21,    22,     1,     2,     3,    23,
-     118,    24,    25,    26,   125,    27,    19,    20,    21,    22,
-       1,     2,     3,    23,   127,    24,    25,    26,   126,    27,
-      28,    29,     8,    30,    66,    72,    73,    74,    75,    76,
-      77,   130,     0,     0,    28,    29,    64,    30,    96,    19,
-      20,    21,    22,     1,     2,     3,    23,     0,    24,    25,
-      26,     0,    27,    19,    59,    21,    22,     0,    19,    20,
-      21,    22,     0,     0,     0,     0,    27,    28,    29,     0,
-      30,    27,   101,   102,   103,   104,   105,   106,     0,     0,
-       0,    28,    29,     0,     0,     0,    28,    29
+      59,    68,     6,    64,    62,    62,     6,    61,    63,    20,
+      21,    22,    23,    14,     9,    98,     7,    53,    19,    71,
+      72,    54,    28,     1,     2,     3,    88,    91,    92,    93,
+      94,    99,    11,    68,    85,    86,    87,    29,    30,     1,
+       2,     3,    79,    80,    58,   100,   101,    62,    62,    62,
+      62,    62,    62,    62,    62,    62,    62,    62,    62,    62,
+     110,   111,   112,    50,    51,    52,   108,   109,   113,    15,
+      16,   120,    81,    82,    83,    53,    17,    49,    18,    54,
+      55,    56,    57,    66,    69,   123,   124,    84,   122,    70,
+      95,    96,   125,   114,   119,   129,   115,   117,   116,   132,
+     121,   130,    20,    21,    22,    23,     1,     2,     3,    24,
+     118,    25,    26,    27,   127,    28,    20,    21,    22,    23,
+       1,     2,     3,    24,   126,    25,    26,    27,   128,    28,
+      29,    30,     8,    31,    67,    73,    74,    75,    76,    77,
+      78,   131,    65,     0,    29,    30,     0,    31,    97,    20,
+      21,    22,    23,     1,     2,     3,    24,     0,    25,    26,
+      27,     0,    28,    20,    60,    22,    23,     0,    20,    21,
+      22,    23,     0,     0,     0,     0,    28,    29,    30,     0,
+      31,    28,   102,   103,   104,   105,   106,   107,     0,     0,
+       0,    29,    30,     0,     0,     0,    29,    30
 };
 
 static const yytype_int16 yycheck[] =
 {
-      26,    32,    20,    29,    27,    28,    33,    27,    28,     3,
-       4,     5,     6,    32,    15,    16,     0,    36,    36,     7,
-       8,     9,    16,     7,     8,     9,    52,    53,    54,    55,
-      56,    29,    30,    64,    49,    50,    51,    31,    32,    17,
-      18,    19,    70,    71,    38,    78,    79,    70,    71,    72,
-      73,    74,    75,    76,    77,    78,    79,    80,    81,    82,
-      80,    81,    82,    20,    21,    22,     0,     4,    83,    32,
-       4,    97,    39,     4,    34,    32,    10,     4,    32,    36,
-      32,    15,    32,     4,    20,   116,   117,    38,   114,    38,
-      38,    33,   118,    33,    39,   126,    37,     3,    33,   130,
-      33,   127,     3,     4,     5,     6,     7,     8,     9,    10,
-      38,    12,    13,    14,    37,    16,     3,     4,     5,     6,
-       7,     8,     9,    10,    38,    12,    13,    14,    11,    16,
+      27,    33,     0,    30,    28,    29,     4,    28,    29,     3,
+       4,     5,     6,    11,     4,    20,     0,    32,    16,    29,
+      30,    36,    16,     7,     8,     9,    53,    54,    55,    56,
+      57,    36,    32,    65,    50,    51,    52,    31,    32,     7,
+       8,     9,    15,    16,    38,    71,    72,    71,    72,    73,
+      74,    75,    76,    77,    78,    79,    80,    81,    82,    83,
+      81,    82,    83,    20,    21,    22,    79,    80,    84,    33,
+      39,    98,    17,    18,    19,    32,     4,     4,    34,    36,
+      32,    32,    32,     4,    38,   117,   118,    20,   115,    38,
+      38,    33,   119,    33,    38,   127,    39,    33,    37,   131,
+       3,   128,     3,     4,     5,     6,     7,     8,     9,    10,
+      33,    12,    13,    14,    11,    16,     3,     4,     5,     6,
+       7,     8,     9,    10,    37,    12,    13,    14,    38,    16,
       31,    32,     4,    34,    35,    23,    24,    25,    26,    27,
-      28,    33,    -1,    -1,    31,    32,    30,    34,    35,     3,
+      28,    33,    31,    -1,    31,    32,    -1,    34,    35,     3,
        4,     5,     6,     7,     8,     9,    10,    -1,    12,    13,
       14,    -1,    16,     3,     4,     5,     6,    -1,     3,     4,
        5,     6,    -1,    -1,    -1,    -1,    16,    31,    32,    -1,
-      34,    16,    72,    73,    74,    75,    76,    77,    -1,    -1,
+      34,    16,    73,    74,    75,    76,    77,    78,    -1,    -1,
       -1,    31,    32,    -1,    -1,    -1,    31,    32
 };
 
@@ -734,44 +765,44 @@ static const yytype_int16 yycheck[] =
    state STATE-NUM.  */
 static const yytype_int8 yystos[] =
 {
-       0,     7,     8,     9,    41,    42,    45,     0,    42,     4,
-      32,    43,    44,    45,    33,    39,     4,    34,    45,     3,
-       4,     5,     6,    10,    12,    13,    14,    16,    31,    32,
-      34,    45,    46,    47,    48,    49,    50,    51,    52,    53,
-      54,    55,    56,    57,    58,    59,    60,    61,     4,    20,
-      21,    22,    32,    36,    32,    32,    32,    38,    53,     4,
-      59,    61,    59,    53,    46,     4,    35,    47,    38,    38,
-      29,    30,    23,    24,    25,    26,    27,    28,    15,    16,
-      17,    18,    19,    20,    54,    54,    54,    53,    62,    63,
-      53,    53,    53,    53,    38,    33,    35,    20,    36,    56,
-      56,    57,    57,    57,    57,    57,    57,    58,    58,    59,
-      59,    59,    54,    33,    39,    37,    33,    33,    38,    53,
-       3,    53,    47,    47,    53,    37,    11,    38,    47,    53,
-      33,    47
+       0,     7,     8,     9,    41,    42,    46,     0,    42,     4,
+      43,    32,    44,    45,    46,    33,    39,     4,    34,    46,
+       3,     4,     5,     6,    10,    12,    13,    14,    16,    31,
+      32,    34,    46,    47,    48,    49,    50,    51,    52,    53,
+      54,    55,    56,    57,    58,    59,    60,    61,    62,     4,
+      20,    21,    22,    32,    36,    32,    32,    32,    38,    54,
+       4,    60,    62,    60,    54,    47,     4,    35,    48,    38,
+      38,    29,    30,    23,    24,    25,    26,    27,    28,    15,
+      16,    17,    18,    19,    20,    55,    55,    55,    54,    63,
+      64,    54,    54,    54,    54,    38,    33,    35,    20,    36,
+      57,    57,    58,    58,    58,    58,    58,    58,    59,    59,
+      60,    60,    60,    55,    33,    39,    37,    33,    33,    38,
+      54,     3,    54,    48,    48,    54,    37,    11,    38,    48,
+      54,    33,    48
 };
 
 /* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr1[] =
 {
-       0,    40,    41,    41,    42,    43,    43,    44,    44,    45,
-      45,    45,    46,    46,    46,    47,    47,    47,    47,    47,
-      47,    47,    48,    48,    48,    49,    49,    50,    51,    52,
-      52,    53,    54,    54,    54,    54,    54,    55,    55,    55,
-      56,    56,    56,    56,    56,    56,    56,    57,    57,    57,
-      58,    58,    58,    58,    59,    59,    59,    59,    59,    59,
-      59,    59,    59,    60,    61,    62,    62,    63,    63
+       0,    40,    41,    41,    43,    42,    44,    44,    45,    45,
+      46,    46,    46,    47,    47,    47,    48,    48,    48,    48,
+      48,    48,    48,    49,    49,    49,    50,    50,    51,    52,
+      53,    53,    54,    55,    55,    55,    55,    55,    56,    56,
+      56,    57,    57,    57,    57,    57,    57,    57,    58,    58,
+      58,    59,    59,    59,    59,    60,    60,    60,    60,    60,
+      60,    60,    60,    60,    61,    62,    63,    63,    64,    64
 };
 
 /* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr2[] =
 {
-       0,     2,     1,     2,     8,     1,     0,     2,     4,     1,
-       1,     1,     1,     2,     0,     2,     2,     1,     1,     1,
-       1,     3,     2,     4,     5,     5,     7,     5,     9,     3,
-       2,     1,     1,     3,     3,     3,     3,     1,     3,     3,
-       1,     3,     3,     3,     3,     3,     3,     1,     3,     3,
-       1,     3,     3,     3,     1,     1,     1,     1,     3,     2,
-       2,     1,     1,     4,     4,     1,     0,     1,     3
+       0,     2,     1,     2,     0,     9,     1,     0,     2,     4,
+       1,     1,     1,     1,     2,     0,     2,     2,     1,     1,
+       1,     1,     3,     2,     4,     5,     5,     7,     5,     9,
+       3,     2,     1,     1,     3,     3,     3,     3,     1,     3,
+       3,     1,     3,     3,     3,     3,     3,     3,     1,     3,
+       3,     1,     3,     3,     3,     1,     1,     1,     1,     3,
+       2,     2,     1,     1,     4,     4,     1,     0,     1,     3
 };
 
 
@@ -1235,631 +1266,618 @@ yyreduce:
   switch (yyn)
     {
   case 2: /* program: function_def  */
-#line 53 "src/parser.y"
+#line 85 "src/parser.y"
     {
-        (yyval.node) = (yyvsp[0].node);
-        root = (yyval.node);
+        (yyval.list) = list_append(empty_list(), (yyvsp[0].node));
+        root = (yyvsp[0].node);
     }
-#line 1244 "pre_generated/parser.tab.c"
+#line 1275 "pre_generated/parser.tab.c"
     break;
 
   case 3: /* program: program function_def  */
-#line 58 "src/parser.y"
+#line 90 "src/parser.y"
     {
-        ASTNode* temp = (yyvsp[-1].node);
-        while(temp->next != NULL) {
-            temp = temp->next;
-        }
-        temp->next = (yyvsp[0].node);
-        (yyval.node) = (yyvsp[-1].node);
+        (yyval.list) = list_append((yyvsp[-1].list), (yyvsp[0].node));
     }
-#line 1257 "pre_generated/parser.tab.c"
+#line 1283 "pre_generated/parser.tab.c"
     break;
 
-  case 4: /* function_def: type IDENTIFIER LPAREN param_list RPAREN LBRACE statements RBRACE  */
-#line 70 "src/parser.y"
+  case 4: /* @1: %empty  */
+#line 96 "src/parser.y"
+                      { (yyval.num) = yylineno; }
+#line 1289 "pre_generated/parser.tab.c"
+    break;
+
+  case 5: /* function_def: type IDENTIFIER @1 LPAREN param_list RPAREN LBRACE statements RBRACE  */
+#line 97 "src/parser.y"
     {
-        (yyval.node) = create_node(NODE_FUNCTION, (yyvsp[-6].str));
+        // Created after the body; the line is the one of the name.
+        (yyval.node) = create_node(NODE_FUNCTION, (yyvsp[-7].str));
+        (yyval.node)->line = (yyvsp[-6].num);
         (yyval.node)->left = (yyvsp[-4].node);
-        (yyval.node)->right = (yyvsp[-1].node);
+        (yyval.node)->right = (yyvsp[-1].list).head;
     }
-#line 1267 "pre_generated/parser.tab.c"
+#line 1301 "pre_generated/parser.tab.c"
     break;
 
-  case 5: /* param_list: params  */
-#line 79 "src/parser.y"
+  case 6: /* param_list: params  */
+#line 108 "src/parser.y"
     {
-        (yyval.node) = (yyvsp[0].node);
+        (yyval.node) = (yyvsp[0].list).head;
     }
-#line 1275 "pre_generated/parser.tab.c"
+#line 1309 "pre_generated/parser.tab.c"
     break;
 
-  case 6: /* param_list: %empty  */
-#line 83 "src/parser.y"
+  case 7: /* param_list: %empty  */
+#line 112 "src/parser.y"
     {
         (yyval.node) = NULL;
     }
-#line 1283 "pre_generated/parser.tab.c"
+#line 1317 "pre_generated/parser.tab.c"
     break;
 
-  case 7: /* params: type IDENTIFIER  */
-#line 90 "src/parser.y"
+  case 8: /* params: type IDENTIFIER  */
+#line 119 "src/parser.y"
     {
-        (yyval.node) = create_node(NODE_DECLARATION, (yyvsp[0].str));
+        (yyval.list) = list_append(empty_list(), create_node(NODE_DECLARATION, (yyvsp[0].str)));
     }
-#line 1291 "pre_generated/parser.tab.c"
+#line 1325 "pre_generated/parser.tab.c"
     break;
 
-  case 8: /* params: params COMMA type IDENTIFIER  */
-#line 94 "src/parser.y"
+  case 9: /* params: params COMMA type IDENTIFIER  */
+#line 123 "src/parser.y"
     {
-        ASTNode* param = create_node(NODE_DECLARATION, (yyvsp[0].str));
-        ASTNode* temp = (yyvsp[-3].node);
-        while(temp->next != NULL) {
-            temp = temp->next;
-        }
-        temp->next = param;
-        (yyval.node) = (yyvsp[-3].node);
+        (yyval.list) = list_append((yyvsp[-3].list), create_node(NODE_DECLARATION, (yyvsp[0].str)));
     }
-#line 1305 "pre_generated/parser.tab.c"
+#line 1333 "pre_generated/parser.tab.c"
     break;
 
-  case 9: /* type: INT  */
-#line 107 "src/parser.y"
+  case 10: /* type: INT  */
+#line 130 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_TYPE, my_strdup("int"));
     }
-#line 1313 "pre_generated/parser.tab.c"
+#line 1341 "pre_generated/parser.tab.c"
     break;
 
-  case 10: /* type: CHAR  */
-#line 111 "src/parser.y"
+  case 11: /* type: CHAR  */
+#line 134 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_TYPE, my_strdup("char"));
     }
-#line 1321 "pre_generated/parser.tab.c"
+#line 1349 "pre_generated/parser.tab.c"
     break;
 
-  case 11: /* type: VOID  */
-#line 115 "src/parser.y"
+  case 12: /* type: VOID  */
+#line 138 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_TYPE, my_strdup("void"));
     }
-#line 1329 "pre_generated/parser.tab.c"
+#line 1357 "pre_generated/parser.tab.c"
     break;
 
-  case 12: /* statements: statement  */
-#line 122 "src/parser.y"
+  case 13: /* statements: statement  */
+#line 145 "src/parser.y"
     {
-        (yyval.node) = (yyvsp[0].node);
+        (yyval.list) = list_append(empty_list(), (yyvsp[0].node));
     }
-#line 1337 "pre_generated/parser.tab.c"
+#line 1365 "pre_generated/parser.tab.c"
     break;
 
-  case 13: /* statements: statements statement  */
-#line 126 "src/parser.y"
+  case 14: /* statements: statements statement  */
+#line 149 "src/parser.y"
     {
-        if ((yyvsp[-1].node) == NULL) {
-            (yyval.node) = (yyvsp[0].node);
-        } else {
-            ASTNode* temp = (yyvsp[-1].node);
-            while(temp->next != NULL) {
-                temp = temp->next;
-            }
-            temp->next = (yyvsp[0].node);
-            (yyval.node) = (yyvsp[-1].node);
-        }
+        (yyval.list) = list_append((yyvsp[-1].list), (yyvsp[0].node));
     }
-#line 1354 "pre_generated/parser.tab.c"
+#line 1373 "pre_generated/parser.tab.c"
     break;
 
-  case 14: /* statements: %empty  */
-#line 139 "src/parser.y"
+  case 15: /* statements: %empty  */
+#line 153 "src/parser.y"
     {
-        (yyval.node) = NULL;
+        (yyval.list) = empty_list();
     }
-#line 1362 "pre_generated/parser.tab.c"
+#line 1381 "pre_generated/parser.tab.c"
     break;
 
-  case 15: /* statement: expression SEMICOLON  */
-#line 146 "src/parser.y"
+  case 16: /* statement: expression SEMICOLON  */
+#line 160 "src/parser.y"
     {
         (yyval.node) = (yyvsp[-1].node);
     }
-#line 1370 "pre_generated/parser.tab.c"
+#line 1389 "pre_generated/parser.tab.c"
     break;
 
-  case 16: /* statement: declaration SEMICOLON  */
-#line 150 "src/parser.y"
+  case 17: /* statement: declaration SEMICOLON  */
+#line 164 "src/parser.y"
     {
         (yyval.node) = (yyvsp[-1].node);
     }
-#line 1378 "pre_generated/parser.tab.c"
+#line 1397 "pre_generated/parser.tab.c"
     break;
 
-  case 17: /* statement: if_statement  */
-#line 154 "src/parser.y"
+  case 18: /* statement: if_statement  */
+#line 168 "src/parser.y"
     {
         (yyval.node) = (yyvsp[0].node);
     }
-#line 1386 "pre_generated/parser.tab.c"
+#line 1405 "pre_generated/parser.tab.c"
     break;
 
-  case 18: /* statement: while_statement  */
-#line 158 "src/parser.y"
+  case 19: /* statement: while_statement  */
+#line 172 "src/parser.y"
     {
         (yyval.node) = (yyvsp[0].node);
     }
-#line 1394 "pre_generated/parser.tab.c"
+#line 1413 "pre_generated/parser.tab.c"
     break;
 
-  case 19: /* statement: for_statement  */
-#line 162 "src/parser.y"
+  case 20: /* statement: for_statement  */
+#line 176 "src/parser.y"
     {
         (yyval.node) = (yyvsp[0].node);
     }
-#line 1402 "pre_generated/parser.tab.c"
+#line 1421 "pre_generated/parser.tab.c"
     break;
 
-  case 20: /* statement: return_statement  */
-#line 166 "src/parser.y"
+  case 21: /* statement: return_statement  */
+#line 180 "src/parser.y"
     {
         (yyval.node) = (yyvsp[0].node);
     }
-#line 1410 "pre_generated/parser.tab.c"
+#line 1429 "pre_generated/parser.tab.c"
     break;
 
-  case 21: /* statement: LBRACE statements RBRACE  */
-#line 170 "src/parser.y"
+  case 22: /* statement: LBRACE statements RBRACE  */
+#line 184 "src/parser.y"
     {
-        (yyval.node) = (yyvsp[-1].node);
+        (yyval.node) = (yyvsp[-1].list).head;
     }
-#line 1418 "pre_generated/parser.tab.c"
+#line 1437 "pre_generated/parser.tab.c"
     break;
 
-  case 22: /* declaration: type IDENTIFIER  */
-#line 177 "src/parser.y"
+  case 23: /* declaration: type IDENTIFIER  */
+#line 191 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_DECLARATION, (yyvsp[0].str));
     }
-#line 1426 "pre_generated/parser.tab.c"
+#line 1445 "pre_generated/parser.tab.c"
     break;
 
-  case 23: /* declaration: type IDENTIFIER ASSIGN expression  */
-#line 181 "src/parser.y"
+  case 24: /* declaration: type IDENTIFIER ASSIGN expression  */
+#line 195 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_DECLARATION, (yyvsp[-2].str));
         (yyval.node)->right = (yyvsp[0].node);
     }
-#line 1435 "pre_generated/parser.tab.c"
+#line 1454 "pre_generated/parser.tab.c"
     break;
 
-  case 24: /* declaration: type IDENTIFIER LBRACKET NUMBER RBRACKET  */
-#line 186 "src/parser.y"
+  case 25: /* declaration: type IDENTIFIER LBRACKET NUMBER RBRACKET  */
+#line 200 "src/parser.y"
     {
         char* array_info = malloc(strlen((yyvsp[-3].str)) + 20);
         sprintf(array_info, "%s[%d]", (yyvsp[-3].str), (yyvsp[-1].num));
         (yyval.node) = create_node(NODE_DECLARATION, array_info);
     }
-#line 1445 "pre_generated/parser.tab.c"
+#line 1464 "pre_generated/parser.tab.c"
     break;
 
-  case 25: /* if_statement: IF LPAREN expression RPAREN statement  */
-#line 195 "src/parser.y"
+  case 26: /* if_statement: IF LPAREN expression RPAREN statement  */
+#line 209 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_IF, NULL);
+        (yyval.node)->line = (yyvsp[-2].node)->line;
         (yyval.node)->left = (yyvsp[-2].node);
         (yyval.node)->right = (yyvsp[0].node);
     }
-#line 1455 "pre_generated/parser.tab.c"
+#line 1475 "pre_generated/parser.tab.c"
     break;
 
-  case 26: /* if_statement: IF LPAREN expression RPAREN statement ELSE statement  */
-#line 201 "src/parser.y"
+  case 27: /* if_statement: IF LPAREN expression RPAREN statement ELSE statement  */
+#line 216 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_IF, NULL);
+        (yyval.node)->line = (yyvsp[-4].node)->line;
         (yyval.node)->left = (yyvsp[-4].node);
         (yyval.node)->right = (yyvsp[-2].node);
         ASTNode* else_node = create_node(NODE_ELSE, NULL);
         else_node->right = (yyvsp[0].node);
         (yyval.node)->next = else_node;
     }
-#line 1468 "pre_generated/parser.tab.c"
+#line 1489 "pre_generated/parser.tab.c"
     break;
 
-  case 27: /* while_statement: WHILE LPAREN expression RPAREN statement  */
-#line 213 "src/parser.y"
+  case 28: /* while_statement: WHILE LPAREN expression RPAREN statement  */
+#line 229 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_WHILE, NULL);
+        (yyval.node)->line = (yyvsp[-2].node)->line;
         (yyval.node)->left = (yyvsp[-2].node);
         (yyval.node)->right = (yyvsp[0].node);
     }
-#line 1478 "pre_generated/parser.tab.c"
+#line 1500 "pre_generated/parser.tab.c"
     break;
 
-  case 28: /* for_statement: FOR LPAREN expression SEMICOLON expression SEMICOLON expression RPAREN statement  */
-#line 222 "src/parser.y"
+  case 29: /* for_statement: FOR LPAREN expression SEMICOLON expression SEMICOLON expression RPAREN statement  */
+#line 239 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_FOR, NULL);
+        (yyval.node)->line = (yyvsp[-6].node)->line;
         (yyval.node)->left = (yyvsp[-6].node);
         (yyval.node)->right = (yyvsp[-4].node);
         (yyvsp[-4].node)->next = (yyvsp[-2].node);
         (yyvsp[-2].node)->next = (yyvsp[0].node);
     }
-#line 1490 "pre_generated/parser.tab.c"
+#line 1513 "pre_generated/parser.tab.c"
     break;
 
-  case 29: /* return_statement: RETURN expression SEMICOLON  */
-#line 233 "src/parser.y"
+  case 30: /* return_statement: RETURN expression SEMICOLON  */
+#line 251 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_RETURN, NULL);
         (yyval.node)->left = (yyvsp[-1].node);
     }
-#line 1499 "pre_generated/parser.tab.c"
+#line 1522 "pre_generated/parser.tab.c"
     break;
 
-  case 30: /* return_statement: RETURN SEMICOLON  */
-#line 238 "src/parser.y"
+  case 31: /* return_statement: RETURN SEMICOLON  */
+#line 256 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_RETURN, NULL);
     }
-#line 1507 "pre_generated/parser.tab.c"
+#line 1530 "pre_generated/parser.tab.c"
     break;
 
-  case 31: /* expression: assignment_expr  */
-#line 245 "src/parser.y"
+  case 32: /* expression: assignment_expr  */
+#line 263 "src/parser.y"
     {
         (yyval.node) = (yyvsp[0].node);
     }
-#line 1515 "pre_generated/parser.tab.c"
+#line 1538 "pre_generated/parser.tab.c"
     break;
 
-  case 32: /* assignment_expr: logical_expr  */
-#line 252 "src/parser.y"
+  case 33: /* assignment_expr: logical_expr  */
+#line 270 "src/parser.y"
     {
         (yyval.node) = (yyvsp[0].node);
     }
-#line 1523 "pre_generated/parser.tab.c"
+#line 1546 "pre_generated/parser.tab.c"
     break;
 
-  case 33: /* assignment_expr: IDENTIFIER ASSIGN assignment_expr  */
-#line 256 "src/parser.y"
+  case 34: /* assignment_expr: IDENTIFIER ASSIGN assignment_expr  */
+#line 274 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_ASSIGNMENT, (yyvsp[-2].str));
         (yyval.node)->right = (yyvsp[0].node);
     }
-#line 1532 "pre_generated/parser.tab.c"
+#line 1555 "pre_generated/parser.tab.c"
     break;
 
-  case 34: /* assignment_expr: IDENTIFIER PLUS_ASSIGN assignment_expr  */
-#line 261 "src/parser.y"
+  case 35: /* assignment_expr: IDENTIFIER PLUS_ASSIGN assignment_expr  */
+#line 279 "src/parser.y"
     {
         ASTNode* plus = create_node(NODE_EXPRESSION, my_strdup("+"));
-        plus->left = create_node(NODE_EXPRESSION, (yyvsp[-2].str));
+        plus->left = create_node(NODE_EXPRESSION, my_strdup((yyvsp[-2].str)));
         plus->right = (yyvsp[0].node);
         (yyval.node) = create_node(NODE_ASSIGNMENT, (yyvsp[-2].str));
         (yyval.node)->right = plus;
     }
-#line 1544 "pre_generated/parser.tab.c"
+#line 1567 "pre_generated/parser.tab.c"
     break;
 
-  case 35: /* assignment_expr: IDENTIFIER MINUS_ASSIGN assignment_expr  */
-#line 269 "src/parser.y"
+  case 36: /* assignment_expr: IDENTIFIER MINUS_ASSIGN assignment_expr  */
+#line 287 "src/parser.y"
     {
         ASTNode* minus = create_node(NODE_EXPRESSION, my_strdup("-"));
-        minus->left = create_node(NODE_EXPRESSION, (yyvsp[-2].str));
+        minus->left = create_node(NODE_EXPRESSION, my_strdup((yyvsp[-2].str)));
         minus->right = (yyvsp[0].node);
         (yyval.node) = create_node(NODE_ASSIGNMENT, (yyvsp[-2].str));
         (yyval.node)->right = minus;
     }
-#line 1556 "pre_generated/parser.tab.c"
+#line 1579 "pre_generated/parser.tab.c"
     break;
 
-  case 36: /* assignment_expr: array_access ASSIGN assignment_expr  */
-#line 277 "src/parser.y"
+  case 37: /* assignment_expr: array_access ASSIGN assignment_expr  */
+#line 295 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_ASSIGNMENT, NULL);
         (yyval.node)->left = (yyvsp[-2].node);
         (yyval.node)->right = (yyvsp[0].node);
     }
-#line 1566 "pre_generated/parser.tab.c"
+#line 1589 "pre_generated/parser.tab.c"
     break;
 
-  case 37: /* logical_expr: relational_expr  */
-#line 286 "src/parser.y"
+  case 38: /* logical_expr: relational_expr  */
+#line 304 "src/parser.y"
     {
         (yyval.node) = (yyvsp[0].node);
     }
-#line 1574 "pre_generated/parser.tab.c"
+#line 1597 "pre_generated/parser.tab.c"
     break;
 
-  case 38: /* logical_expr: logical_expr AND relational_expr  */
-#line 290 "src/parser.y"
+  case 39: /* logical_expr: logical_expr AND relational_expr  */
+#line 308 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_EXPRESSION, my_strdup("&&"));
         (yyval.node)->left = (yyvsp[-2].node);
         (yyval.node)->right = (yyvsp[0].node);
     }
-#line 1584 "pre_generated/parser.tab.c"
+#line 1607 "pre_generated/parser.tab.c"
     break;
 
-  case 39: /* logical_expr: logical_expr OR relational_expr  */
-#line 296 "src/parser.y"
+  case 40: /* logical_expr: logical_expr OR relational_expr  */
+#line 314 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_EXPRESSION, my_strdup("||"));
         (yyval.node)->left = (yyvsp[-2].node);
         (yyval.node)->right = (yyvsp[0].node);
     }
-#line 1594 "pre_generated/parser.tab.c"
+#line 1617 "pre_generated/parser.tab.c"
     break;
 
-  case 40: /* relational_expr: additive_expr  */
-#line 305 "src/parser.y"
+  case 41: /* relational_expr: additive_expr  */
+#line 323 "src/parser.y"
     {
         (yyval.node) = (yyvsp[0].node);
     }
-#line 1602 "pre_generated/parser.tab.c"
+#line 1625 "pre_generated/parser.tab.c"
     break;
 
-  case 41: /* relational_expr: relational_expr EQ additive_expr  */
-#line 309 "src/parser.y"
+  case 42: /* relational_expr: relational_expr EQ additive_expr  */
+#line 327 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_EXPRESSION, my_strdup("=="));
         (yyval.node)->left = (yyvsp[-2].node);
         (yyval.node)->right = (yyvsp[0].node);
     }
-#line 1612 "pre_generated/parser.tab.c"
+#line 1635 "pre_generated/parser.tab.c"
     break;
 
-  case 42: /* relational_expr: relational_expr NEQ additive_expr  */
-#line 315 "src/parser.y"
+  case 43: /* relational_expr: relational_expr NEQ additive_expr  */
+#line 333 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_EXPRESSION, my_strdup("!="));
         (yyval.node)->left = (yyvsp[-2].node);
         (yyval.node)->right = (yyvsp[0].node);
     }
-#line 1622 "pre_generated/parser.tab.c"
+#line 1645 "pre_generated/parser.tab.c"
     break;
 
-  case 43: /* relational_expr: relational_expr LT additive_expr  */
-#line 321 "src/parser.y"
+  case 44: /* relational_expr: relational_expr LT additive_expr  */
+#line 339 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_EXPRESSION, my_strdup("<"));
         (yyval.node)->left = (yyvsp[-2].node);
         (yyval.node)->right = (yyvsp[0].node);
     }
-#line 1632 "pre_generated/parser.tab.c"
+#line 1655 "pre_generated/parser.tab.c"
     break;
 
-  case 44: /* relational_expr: relational_expr GT additive_expr  */
-#line 327 "src/parser.y"
+  case 45: /* relational_expr: relational_expr GT additive_expr  */
+#line 345 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_EXPRESSION, my_strdup(">"));
         (yyval.node)->left = (yyvsp[-2].node);
         (yyval.node)->right = (yyvsp[0].node);
     }
-#line 1642 "pre_generated/parser.tab.c"
+#line 1665 "pre_generated/parser.tab.c"
     break;
 
-  case 45: /* relational_expr: relational_expr LE additive_expr  */
-#line 333 "src/parser.y"
+  case 46: /* relational_expr: relational_expr LE additive_expr  */
+#line 351 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_EXPRESSION, my_strdup("<="));
         (yyval.node)->left = (yyvsp[-2].node);
         (yyval.node)->right = (yyvsp[0].node);
     }
-#line 1652 "pre_generated/parser.tab.c"
+#line 1675 "pre_generated/parser.tab.c"
     break;
 
-  case 46: /* relational_expr: relational_expr GE additive_expr  */
-#line 339 "src/parser.y"
+  case 47: /* relational_expr: relational_expr GE additive_expr  */
+#line 357 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_EXPRESSION, my_strdup(">="));
         (yyval.node)->left = (yyvsp[-2].node);
         (yyval.node)->right = (yyvsp[0].node);
     }
-#line 1662 "pre_generated/parser.tab.c"
+#line 1685 "pre_generated/parser.tab.c"
     break;
 
-  case 47: /* additive_expr: term  */
-#line 348 "src/parser.y"
+  case 48: /* additive_expr: term  */
+#line 366 "src/parser.y"
     {
         (yyval.node) = (yyvsp[0].node);
     }
-#line 1670 "pre_generated/parser.tab.c"
+#line 1693 "pre_generated/parser.tab.c"
     break;
 
-  case 48: /* additive_expr: additive_expr PLUS term  */
-#line 352 "src/parser.y"
+  case 49: /* additive_expr: additive_expr PLUS term  */
+#line 370 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_EXPRESSION, my_strdup("+"));
         (yyval.node)->left = (yyvsp[-2].node);
         (yyval.node)->right = (yyvsp[0].node);
     }
-#line 1680 "pre_generated/parser.tab.c"
+#line 1703 "pre_generated/parser.tab.c"
     break;
 
-  case 49: /* additive_expr: additive_expr MINUS term  */
-#line 358 "src/parser.y"
+  case 50: /* additive_expr: additive_expr MINUS term  */
+#line 376 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_EXPRESSION, my_strdup("-"));
         (yyval.node)->left = (yyvsp[-2].node);
         (yyval.node)->right = (yyvsp[0].node);
     }
-#line 1690 "pre_generated/parser.tab.c"
+#line 1713 "pre_generated/parser.tab.c"
     break;
 
-  case 50: /* term: factor  */
-#line 367 "src/parser.y"
+  case 51: /* term: factor  */
+#line 385 "src/parser.y"
     {
         (yyval.node) = (yyvsp[0].node);
     }
-#line 1698 "pre_generated/parser.tab.c"
+#line 1721 "pre_generated/parser.tab.c"
     break;
 
-  case 51: /* term: term TIMES factor  */
-#line 371 "src/parser.y"
+  case 52: /* term: term TIMES factor  */
+#line 389 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_EXPRESSION, my_strdup("*"));
         (yyval.node)->left = (yyvsp[-2].node);
         (yyval.node)->right = (yyvsp[0].node);
     }
-#line 1708 "pre_generated/parser.tab.c"
+#line 1731 "pre_generated/parser.tab.c"
     break;
 
-  case 52: /* term: term DIVIDE factor  */
-#line 377 "src/parser.y"
+  case 53: /* term: term DIVIDE factor  */
+#line 395 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_EXPRESSION, my_strdup("/"));
         (yyval.node)->left = (yyvsp[-2].node);
         (yyval.node)->right = (yyvsp[0].node);
     }
-#line 1718 "pre_generated/parser.tab.c"
+#line 1741 "pre_generated/parser.tab.c"
     break;
 
-  case 53: /* term: term MOD factor  */
-#line 383 "src/parser.y"
+  case 54: /* term: term MOD factor  */
+#line 401 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_EXPRESSION, my_strdup("%"));
         (yyval.node)->left = (yyvsp[-2].node);
         (yyval.node)->right = (yyvsp[0].node);
     }
-#line 1728 "pre_generated/parser.tab.c"
+#line 1751 "pre_generated/parser.tab.c"
     break;
 
-  case 54: /* factor: IDENTIFIER  */
-#line 392 "src/parser.y"
+  case 55: /* factor: IDENTIFIER  */
+#line 410 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_EXPRESSION, (yyvsp[0].str));
     }
-#line 1736 "pre_generated/parser.tab.c"
+#line 1759 "pre_generated/parser.tab.c"
     break;
 
-  case 55: /* factor: NUMBER  */
-#line 396 "src/parser.y"
+  case 56: /* factor: NUMBER  */
+#line 414 "src/parser.y"
     {
         char buffer[20];
         sprintf(buffer, "%d", (yyvsp[0].num));
         (yyval.node) = create_node(NODE_EXPRESSION, my_strdup(buffer));
     }
-#line 1746 "pre_generated/parser.tab.c"
+#line 1769 "pre_generated/parser.tab.c"
     break;
 
-  case 56: /* factor: STRING_LITERAL  */
-#line 402 "src/parser.y"
+  case 57: /* factor: STRING_LITERAL  */
+#line 420 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_STRING, (yyvsp[0].str));
     }
-#line 1754 "pre_generated/parser.tab.c"
+#line 1777 "pre_generated/parser.tab.c"
     break;
 
-  case 57: /* factor: CHAR_LITERAL  */
-#line 406 "src/parser.y"
+  case 58: /* factor: CHAR_LITERAL  */
+#line 424 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_CHAR, (yyvsp[0].str));
     }
-#line 1762 "pre_generated/parser.tab.c"
+#line 1785 "pre_generated/parser.tab.c"
     break;
 
-  case 58: /* factor: LPAREN expression RPAREN  */
-#line 410 "src/parser.y"
+  case 59: /* factor: LPAREN expression RPAREN  */
+#line 428 "src/parser.y"
     {
         (yyval.node) = (yyvsp[-1].node);
     }
-#line 1770 "pre_generated/parser.tab.c"
+#line 1793 "pre_generated/parser.tab.c"
     break;
 
-  case 59: /* factor: NOT factor  */
-#line 414 "src/parser.y"
+  case 60: /* factor: NOT factor  */
+#line 432 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_EXPRESSION, my_strdup("!"));
         (yyval.node)->right = (yyvsp[0].node);
     }
-#line 1779 "pre_generated/parser.tab.c"
+#line 1802 "pre_generated/parser.tab.c"
     break;
 
-  case 60: /* factor: MINUS factor  */
-#line 419 "src/parser.y"
+  case 61: /* factor: MINUS factor  */
+#line 437 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_EXPRESSION, my_strdup("-"));
         (yyval.node)->right = (yyvsp[0].node);
     }
-#line 1788 "pre_generated/parser.tab.c"
+#line 1811 "pre_generated/parser.tab.c"
     break;
 
-  case 61: /* factor: function_call  */
-#line 424 "src/parser.y"
+  case 62: /* factor: function_call  */
+#line 442 "src/parser.y"
     {
         (yyval.node) = (yyvsp[0].node);
     }
-#line 1796 "pre_generated/parser.tab.c"
+#line 1819 "pre_generated/parser.tab.c"
     break;
 
-  case 62: /* factor: array_access  */
-#line 428 "src/parser.y"
+  case 63: /* factor: array_access  */
+#line 446 "src/parser.y"
     {
         (yyval.node) = (yyvsp[0].node);
     }
-#line 1804 "pre_generated/parser.tab.c"
+#line 1827 "pre_generated/parser.tab.c"
     break;
 
-  case 63: /* function_call: IDENTIFIER LPAREN arg_list RPAREN  */
-#line 435 "src/parser.y"
+  case 64: /* function_call: IDENTIFIER LPAREN arg_list RPAREN  */
+#line 453 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_FUNCTION_CALL, (yyvsp[-3].str));
         (yyval.node)->left = (yyvsp[-1].node);
     }
-#line 1813 "pre_generated/parser.tab.c"
+#line 1836 "pre_generated/parser.tab.c"
     break;
 
-  case 64: /* array_access: IDENTIFIER LBRACKET expression RBRACKET  */
-#line 443 "src/parser.y"
+  case 65: /* array_access: IDENTIFIER LBRACKET expression RBRACKET  */
+#line 461 "src/parser.y"
     {
         (yyval.node) = create_node(NODE_ARRAY_ACCESS, (yyvsp[-3].str));
         (yyval.node)->left = (yyvsp[-1].node);
     }
-#line 1822 "pre_generated/parser.tab.c"
+#line 1845 "pre_generated/parser.tab.c"
     break;
 
-  case 65: /* arg_list: args  */
-#line 451 "src/parser.y"
+  case 66: /* arg_list: args  */
+#line 469 "src/parser.y"
     {
-        (yyval.node) = (yyvsp[0].node);
+        (yyval.node) = (yyvsp[0].list).head;
     }
-#line 1830 "pre_generated/parser.tab.c"
+#line 1853 "pre_generated/parser.tab.c"
     break;
 
-  case 66: /* arg_list: %empty  */
-#line 455 "src/parser.y"
+  case 67: /* arg_list: %empty  */
+#line 473 "src/parser.y"
     {
         (yyval.node) = NULL;
     }
-#line 1838 "pre_generated/parser.tab.c"
+#line 1861 "pre_generated/parser.tab.c"
     break;
 
-  case 67: /* args: expression  */
-#line 462 "src/parser.y"
+  case 68: /* args: expression  */
+#line 480 "src/parser.y"
     {
-        (yyval.node) = (yyvsp[0].node);
+        (yyval.list) = list_append(empty_list(), (yyvsp[0].node));
     }
-#line 1846 "pre_generated/parser.tab.c"
+#line 1869 "pre_generated/parser.tab.c"
     break;
 
-  case 68: /* args: args COMMA expression  */
-#line 466 "src/parser.y"
+  case 69: /* args: args COMMA expression  */
+#line 484 "src/parser.y"
     {
-        ASTNode* temp = (yyvsp[-2].node);
-        while(temp->next != NULL) {
-            temp = temp->next;
-        }
-        temp->next = (yyvsp[0].node);
-        (yyval.node) = (yyvsp[-2].node);
+        (yyval.list) = list_append((yyvsp[-2].list), (yyvsp[0].node));
     }
-#line 1859 "pre_generated/parser.tab.c"
+#line 1877 "pre_generated/parser.tab.c"
     break;
 
 
-#line 1863 "pre_generated/parser.tab.c"
+#line 1881 "pre_generated/parser.tab.c"
 
       default: break;
     }
@@ -2052,14 +2070,27 @@ yyreturnlab:
   return yyresult;
 }
 
-#line 476 "src/parser.y"
+#line 489 "src/parser.y"
 
 
+#undef yylex
+static int phase_yylex(void) {
+    if (!phase_tracking) return yylex();
+    phase_begin(PHASE_LEX);
+    int token = yylex();
+    if (token == IDENTIFIER || token == STRING_LITERAL || token == CHAR_LITERAL) {
+        mem_alloc(MEM_LEXER_STRING, strlen(yylval.str) + 1);
+    }
+    phase_end(PHASE_LEX);
+    return token;
+}
+
 void yyerror(const char* s) {
     fprintf(stderr, "Syntax error at line %d: %s\n", yylineno, s);
 }
 
 ASTNode* create_node(NodeType type, char* value) {
+    phase_begin(PHASE_AST);
     ASTNode* node = malloc(sizeof(ASTNode));
     if (node == NULL) {
         fprintf(stderr, "Memory allocation failed for AST node\n");
@@ -2070,28 +2101,38 @@ ASTNode* create_node(NodeType type, char* value) {
     node->left = NULL;
     node->right = NULL;
     node->next = NULL;
+    // The lexer is at most a token ahead, so this is the line a leaf or a
+    // one-line statement is on; compound statements take their
+    // condition's line instead.
+    node->line = yylineno;
+    mem_node_alloc(type, value ? strlen(value) + 1 : 0);
+    phase_end(PHASE_AST);
     return node;
 }
 
 void free_ast(ASTNode* node) {
-    if (node == NULL) return;
-    if (node->left) {
+    // Lists are walked iteratively; only nesting uses the stack.
+    while (node != NULL) {
+        ASTNode* next = node->next;
         free_ast(node->left);
-        node->left = NULL;
-    }
-    if (node->right) {
         free_ast(node->right);
-        node->right = NULL;
-    }
-    if (node->next) {
-        free_ast(node->next);
-        node->next = NULL;
-    }
-    if (node->value) {
-        free(node->value);
-        node->value = NULL;
+        if (node->value) {
+            mem_free(strlen(node->value) + 1);
+            free(node->value);
+        }
+        mem_free(sizeof(ASTNode));
+        free(node);
+        node = next;
     }
-    free(node);
+}
+
+const char* node_type_name(NodeType type) {
+    static const char* names[] = {
+        "program", "function", "declaration", "assignment", "expression", "statement",
+        "if", "else", "while", "for", "return", "function_call", "type", "string",
+        "char", "array_access"
+    };
+    return type <= NODE_ARRAY_ACCESS ? names[type] : "?";
 }
 
 void print_ast(ASTNode* node, int level) {
@@ -45,7 +45,7 @@
 extern int yydebug;
 #endif
 /* "%code requires" blocks.  */
-#line 23 "src/parser.y"
+#line 53 "src/parser.y"
 
     #include "compiler.h"
 
@@ -105,13 +105,14 @@ extern int yydebug;
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
 union YYSTYPE
 {
-#line 27 "src/parser.y"
+#line 57 "src/parser.y"
 
     int num;
     char* str;
     ASTNode* node;
+    NodeList list;
 
-#line 115 "pre_generated/parser.tab.h"
+#line 116 "pre_generated/parser.tab.h"
 
 };
 typedef union YYSTYPE YYSTYPE;
@@ -0,0 +1,237 @@
+#define _POSIX_C_SOURCE 200809L
+#include "ast_cache.h"
+#include "memstats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+typedef struct {
+    char* data;
+    size_t size;
+    size_t capacity;
+} ByteBuffer;
+
+typedef struct {
+    uint32_t* slots;          // symbol ID + 1, 0 means empty
+    uint32_t capacity;
+    uint32_t* offsets;        // symbol ID -> string table offset
+    uint32_t count;
+    uint32_t offsets_capacity;
+    ByteBuffer strings;
+} StringInterner;
+
+uint64_t ast_cache_hash(uint64_t hash, const void* data, size_t len) {
+    // FNV-1a, good enough to tell sources apart. Start from
+    // AST_CACHE_HASH_SEED and feed the data in as many pieces as needed.
+    const unsigned char* bytes = data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static void* checked_realloc(void* ptr, size_t size) {
+    void* result = realloc(ptr, size);
+    if (result == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    return result;
+}
+
+static void buffer_append(ByteBuffer* buffer, const void* data, size_t len) {
+    if (buffer->size + len > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity : 256;
+        while (capacity < buffer->size + len) capacity *= 2;
+        buffer->data = checked_realloc(buffer->data, capacity);
+        buffer->capacity = capacity;
+    }
+    memcpy(buffer->data + buffer->size, data, len);
+    buffer->size += len;
+}
+
+static void interner_grow(StringInterner* interner) {
+    uint32_t capacity = interner->capacity ? interner->capacity * 2 : 64;
+    uint32_t* slots = calloc(capacity, sizeof(uint32_t));
+    if (slots == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    for (uint32_t i = 0; i < interner->capacity; i++) {
+        uint32_t id = interner->slots[i];
+        if (!id) continue;
+        const char* s = interner->strings.data + interner->offsets[id - 1];
+        uint32_t pos = (uint32_t)ast_cache_hash(AST_CACHE_HASH_SEED, s, strlen(s)) & (capacity - 1);
+        while (slots[pos]) pos = (pos + 1) & (capacity - 1);
+        slots[pos] = id;
+    }
+    free(interner->slots);
+    interner->slots = slots;
+    interner->capacity = capacity;
+}
+
+static uint32_t interner_intern(StringInterner* interner, const char* s) {
+    if (s == NULL) return AST_CACHE_NONE;
+    if ((interner->count + 1) * 2 > interner->capacity) interner_grow(interner);
+
+    size_t len = strlen(s);
+    uint32_t pos = (uint32_t)ast_cache_hash(AST_CACHE_HASH_SEED, s, len) & (interner->capacity - 1);
+    while (interner->slots[pos]) {
+        uint32_t id = interner->slots[pos] - 1;
+        if (strcmp(interner->strings.data + interner->offsets[id], s) == 0) return id;
+        pos = (pos + 1) & (interner->capacity - 1);
+    }
+
+    if (interner->count == interner->offsets_capacity) {
+        interner->offsets_capacity = interner->offsets_capacity ? interner->offsets_capacity * 2 : 64;
+        interner->offsets = checked_realloc(interner->offsets, interner->offsets_capacity * sizeof(uint32_t));
+    }
+    interner->offsets[interner->count] = (uint32_t)interner->strings.size;
+    buffer_append(&interner->strings, s, len + 1);
+    interner->slots[pos] = ++interner->count;
+    return interner->count - 1;
+}
+
+static uint32_t enqueue(ASTNode*** queue, uint32_t* count, uint32_t* capacity, ASTNode* node) {
+    if (node == NULL) return AST_CACHE_NONE;
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 256;
+        *queue = checked_realloc(*queue, *capacity * sizeof(ASTNode*));
+    }
+    (*queue)[*count] = node;
+    return (*count)++;
+}
+
+int ast_cache_write(ASTNode* root, uint64_t source_hash, const char* path) {
+    // Number the nodes breadth-first; the queue position is the node index.
+    ASTNode** queue = NULL;
+    uint32_t count = 0, capacity = 0;
+    AstCacheNode* records = NULL;
+    StringInterner interner = {0};
+
+    uint32_t root_index = enqueue(&queue, &count, &capacity, root);
+    for (uint32_t i = 0; i < count; i++) {
+        ASTNode* node = queue[i];
+        if (i % 256 == 0) records = checked_realloc(records, (i + 256) * sizeof(AstCacheNode));
+        records[i].type = node->type;
+        records[i].symbol = interner_intern(&interner, node->value);
+        records[i].left = enqueue(&queue, &count, &capacity, node->left);
+        records[i].right = enqueue(&queue, &count, &capacity, node->right);
+        records[i].next = enqueue(&queue, &count, &capacity, node->next);
+        records[i].line = (uint32_t)node->line;
+    }
+
+    AstCacheHeader header = {
+        .magic = AST_CACHE_MAGIC,
+        .version = AST_CACHE_VERSION,
+        .source_hash = source_hash,
+        .node_count = count,
+        .symbol_count = interner.count,
+        .string_bytes = (uint32_t)interner.strings.size,
+        .root = root_index,
+    };
+
+    ByteBuffer image = {0};
+    buffer_append(&image, &header, sizeof(header));
+    buffer_append(&image, records, count * sizeof(AstCacheNode));
+    buffer_append(&image, interner.offsets, interner.count * sizeof(uint32_t));
+    buffer_append(&image, interner.strings.data, interner.strings.size);
+
+    int result = -1;
+    FILE* file = fopen(path, "wb");
+    if (file) {
+        if (fwrite(image.data, 1, image.size, file) == image.size) result = 0;
+        if (fclose(file) != 0) result = -1;
+    }
+
+    free(image.data);
+    free(queue);
+    free(records);
+    free(interner.slots);
+    free(interner.offsets);
+    free(interner.strings.data);
+    return result;
+}
+
+static int valid_link(uint32_t index, uint32_t count) {
+    return index == AST_CACHE_NONE || index < count;
+}
+
+int ast_cache_load(const char* path, uint64_t source_hash, AstCache* cache) {
+    memset(cache, 0, sizeof(*cache));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(AstCacheHeader)) {
+        close(fd);
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+
+    const AstCacheHeader* header = map;
+    const AstCacheNode* records = (const AstCacheNode*)(header + 1);
+    const uint32_t* symbols = (const uint32_t*)(records + header->node_count);
+    const char* strings = (const char*)(symbols + header->symbol_count);
+
+    int valid = header->magic == AST_CACHE_MAGIC
+        && header->version == AST_CACHE_VERSION
+        && header->source_hash == source_hash
+        && sizeof(*header) + (size_t)header->node_count * sizeof(AstCacheNode)
+           + (size_t)header->symbol_count * sizeof(uint32_t) + header->string_bytes == size
+        && (header->string_bytes == 0 || strings[header->string_bytes - 1] == '\0')
+        && valid_link(header->root, header->node_count);
+    for (uint32_t i = 0; valid && i < header->symbol_count; i++) {
+        valid = symbols[i] < header->string_bytes;
+    }
+    for (uint32_t i = 0; valid && i < header->node_count; i++) {
+        const AstCacheNode* record = &records[i];
+        valid = record->type <= NODE_ARRAY_ACCESS
+            && (record->symbol == AST_CACHE_NONE || record->symbol < header->symbol_count)
+            && valid_link(record->left, header->node_count)
+            && valid_link(record->right, header->node_count)
+            && valid_link(record->next, header->node_count);
+    }
+    if (!valid) {
+        munmap(map, size);
+        return -1;
+    }
+
+    ASTNode* nodes = calloc(header->node_count ? header->node_count : 1, sizeof(ASTNode));
+    if (nodes == NULL) {
+        munmap(map, size);
+        return -1;
+    }
+    for (uint32_t i = 0; i < header->node_count; i++) {
+        const AstCacheNode* record = &records[i];
+        nodes[i].type = (NodeType)record->type;
+        nodes[i].value = record->symbol == AST_CACHE_NONE ? NULL : (char*)strings + symbols[record->symbol];
+        nodes[i].left = record->left == AST_CACHE_NONE ? NULL : &nodes[record->left];
+        nodes[i].right = record->right == AST_CACHE_NONE ? NULL : &nodes[record->right];
+        nodes[i].next = record->next == AST_CACHE_NONE ? NULL : &nodes[record->next];
+        nodes[i].line = (int)record->line;
+    }
+
+    mem_alloc(MEM_AST_CACHE, (size_t)header->node_count * sizeof(ASTNode));
+    cache->map = map;
+    cache->map_size = size;
+    cache->nodes = nodes;
+    cache->root = header->root == AST_CACHE_NONE ? NULL : &nodes[header->root];
+    cache->node_count = header->node_count;
+    return 0;
+}
+
+void ast_cache_close(AstCache* cache) {
+    if (cache->map) munmap(cache->map, cache->map_size);
+    if (cache->nodes) mem_free((size_t)cache->node_count * sizeof(ASTNode));
+    free(cache->nodes);
+    memset(cache, 0, sizeof(*cache));
+}
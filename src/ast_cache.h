@@ -0,0 +1,53 @@
+#pragma once
+
+#include "compiler.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// On-disk layout of a cached parse. Everything is addressed by index so the
+// file can be mapped anywhere and used without relocation:
+//
+//   AstCacheHeader | AstCacheNode[node_count] | uint32_t[symbol_count] | strings
+//
+// Node values are symbol IDs; each symbol is an offset into the string table,
+// so an identifier used many times is stored once.
+
+#define AST_CACHE_MAGIC     0x54534153u   // "SAST"
+#define AST_CACHE_VERSION   2u
+#define AST_CACHE_NONE      0xFFFFFFFFu
+#define AST_CACHE_HASH_SEED 0xcbf29ce484222325ull
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t source_hash;
+    uint32_t node_count;
+    uint32_t symbol_count;
+    uint32_t string_bytes;
+    uint32_t root;
+} AstCacheHeader;
+
+typedef struct {
+    uint32_t type;
+    uint32_t symbol;
+    uint32_t left;
+    uint32_t right;
+    uint32_t next;
+    uint32_t line;
+} AstCacheNode;
+
+// A loaded cache. The ASTNode view lives in a single allocation and its
+// values point straight into the read-only mapping, so it must be released
+// with ast_cache_close(), never free_ast().
+typedef struct {
+    void* map;
+    size_t map_size;
+    ASTNode* nodes;
+    ASTNode* root;
+    uint32_t node_count;
+} AstCache;
+
+uint64_t ast_cache_hash(uint64_t hash, const void* data, size_t len);
+int ast_cache_write(ASTNode* root, uint64_t source_hash, const char* path);
+int ast_cache_load(const char* path, uint64_t source_hash, AstCache* cache);
+void ast_cache_close(AstCache* cache);
@@ -0,0 +1,592 @@
+#define _GNU_SOURCE
+#include "batch.h"
+#include "compiler.h"
+#include "driver.h"
+#include "remarks.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+#define URING_SLOTS      32
+#define URING_SLOT_SIZE  (64 * 1024)
+#define QUEUE_CAPACITY   16
+
+typedef struct {
+    const char* input_path;
+    char* output_path;
+    char* source;
+    size_t source_len;
+    char* output;
+    size_t output_len;
+    int failed;
+    // io_uring backend only
+    int fd;
+    int slot;
+    size_t written;
+    int fixed_output;
+} BatchJob;
+
+static const char* mode_names[] = { "auto", "io_uring", "threads", "stdio" };
+
+int parse_batch_io_mode(const char* name, BatchIoMode* mode) {
+    for (int i = 0; i < (int)(sizeof(mode_names) / sizeof(mode_names[0])); i++) {
+        if (strcmp(name, mode_names[i]) == 0) {
+            *mode = (BatchIoMode)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char* batch_io_mode_name(BatchIoMode mode) {
+    return mode_names[mode];
+}
+
+static void compile_job(BatchJob* job) {
+    remarks_set_source(job->input_path);
+    if (compile_buffer(job->source, job->source_len, &job->output, &job->output_len) != 0) {
+        fprintf(stderr, "%s: Compilation failed at line %d\n", job->input_path, yylineno);
+        job->failed = 1;
+    }
+}
+
+/* ---- stdio: the single-file path, repeated ---- */
+
+static void batch_stdio(BatchJob* jobs, int count) {
+    for (int i = 0; i < count; i++) {
+        BatchJob* job = &jobs[i];
+        FILE* input = fopen(job->input_path, "r");
+        if (!input) {
+            fprintf(stderr, "Error: Cannot open file %s\n", job->input_path);
+            job->failed = 1;
+            continue;
+        }
+        char buffer[65536];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), input)) > 0) {
+            job->source = realloc(job->source, job->source_len + n);
+            if (job->source == NULL) {
+                fprintf(stderr, "Memory allocation failed\n");
+                exit(1);
+            }
+            memcpy(job->source + job->source_len, buffer, n);
+            job->source_len += n;
+        }
+        fclose(input);
+
+        compile_job(job);
+        free(job->source);
+        job->source = NULL;
+        if (job->failed) continue;
+
+        FILE* output = fopen(job->output_path, "w");
+        if (!output) {
+            fprintf(stderr, "Error: Cannot create output file %s\n", job->output_path);
+            job->failed = 1;
+        } else {
+            fwrite(job->output, 1, job->output_len, output);
+            fclose(output);
+        }
+        free(job->output);
+        job->output = NULL;
+    }
+}
+
+/* ---- threads: reads and writes overlap compilation ---- */
+
+typedef struct {
+    BatchJob* items[QUEUE_CAPACITY];
+    int head;
+    int count;
+    int closed;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} JobQueue;
+
+typedef struct {
+    BatchJob* jobs;
+    int count;
+    JobQueue* queue;
+} ThreadArgs;
+
+static void queue_init(JobQueue* queue) {
+    memset(queue, 0, sizeof(*queue));
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->changed, NULL);
+}
+
+static void queue_destroy(JobQueue* queue) {
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->changed);
+}
+
+static void queue_push(JobQueue* queue, BatchJob* job) {
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == QUEUE_CAPACITY) pthread_cond_wait(&queue->changed, &queue->lock);
+    queue->items[(queue->head + queue->count) % QUEUE_CAPACITY] = job;
+    queue->count++;
+    pthread_cond_broadcast(&queue->changed);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+static void queue_close(JobQueue* queue) {
+    pthread_mutex_lock(&queue->lock);
+    queue->closed = 1;
+    pthread_cond_broadcast(&queue->changed);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+// Returns NULL once the queue is closed and drained.
+static BatchJob* queue_pop(JobQueue* queue) {
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0 && !queue->closed) pthread_cond_wait(&queue->changed, &queue->lock);
+    BatchJob* job = NULL;
+    if (queue->count > 0) {
+        job = queue->items[queue->head];
+        queue->head = (queue->head + 1) % QUEUE_CAPACITY;
+        queue->count--;
+        pthread_cond_broadcast(&queue->changed);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return job;
+}
+
+static void* reader_thread(void* arg) {
+    ThreadArgs* args = arg;
+    for (int i = 0; i < args->count; i++) {
+        BatchJob* job = &args->jobs[i];
+        if (read_source_file(job->input_path, &job->source, &job->source_len) != 0) {
+            fprintf(stderr, "Error: Cannot open file %s\n", job->input_path);
+            job->failed = 1;
+        }
+        queue_push(args->queue, job);
+    }
+    queue_close(args->queue);
+    return NULL;
+}
+
+static void* writer_thread(void* arg) {
+    ThreadArgs* args = arg;
+    BatchJob* job;
+    while ((job = queue_pop(args->queue)) != NULL) {
+        if (!job->failed && write_output_file(job->output_path, job->output, job->output_len) != 0) {
+            fprintf(stderr, "Error: Cannot create output file %s\n", job->output_path);
+            job->failed = 1;
+        }
+        free(job->output);
+        job->output = NULL;
+    }
+    return NULL;
+}
+
+static void batch_threads(BatchJob* jobs, int count) {
+    JobQueue read_queue, write_queue;
+    queue_init(&read_queue);
+    queue_init(&write_queue);
+    ThreadArgs reader_args = { jobs, count, &read_queue };
+    ThreadArgs writer_args = { jobs, count, &write_queue };
+    pthread_t reader, writer;
+    pthread_create(&reader, NULL, reader_thread, &reader_args);
+    pthread_create(&writer, NULL, writer_thread, &writer_args);
+
+    BatchJob* job;
+    while ((job = queue_pop(&read_queue)) != NULL) {
+        if (!job->failed) compile_job(job);
+        free(job->source);
+        job->source = NULL;
+        queue_push(&write_queue, job);
+    }
+    queue_close(&write_queue);
+
+    pthread_join(reader, NULL);
+    pthread_join(writer, NULL);
+    queue_destroy(&read_queue);
+    queue_destroy(&write_queue);
+}
+
+/* ---- io_uring: batched opens, reads, writes and closes ---- */
+
+enum { OP_OPEN_IN, OP_READ, OP_CLOSE_IN, OP_OPEN_OUT, OP_WRITE, OP_CLOSE_OUT };
+
+typedef struct {
+    int fd;
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    struct io_uring_sqe* sqes;
+    struct io_uring_cqe* cqes;
+    void* sq_map;
+    size_t sq_map_size;
+    void* cq_map;
+    size_t cq_map_size;
+    size_t sqes_size;
+    unsigned to_submit;
+    char* buffers;
+} Uring;
+
+static void uring_teardown(Uring* ring) {
+    if (ring->sqes) munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_map && ring->cq_map != ring->sq_map) munmap(ring->cq_map, ring->cq_map_size);
+    if (ring->sq_map) munmap(ring->sq_map, ring->sq_map_size);
+    if (ring->fd >= 0) close(ring->fd);
+    free(ring->buffers);
+}
+
+static int uring_op_supported(const struct io_uring_probe* probe, int op) {
+    return op < probe->ops_len && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+}
+
+static int uring_setup(Uring* ring, unsigned entries) {
+    memset(ring, 0, sizeof(*ring));
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0) return -1;
+
+    ring->sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_map_size > ring->sq_map_size) ring->sq_map_size = ring->cq_map_size;
+        ring->cq_map_size = ring->sq_map_size;
+    }
+    ring->sq_map = mmap(NULL, ring->sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_map == MAP_FAILED) {
+        ring->sq_map = NULL;
+        uring_teardown(ring);
+        return -1;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_map = ring->sq_map;
+    } else {
+        ring->cq_map = mmap(NULL, ring->cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cq_map == MAP_FAILED) {
+            ring->cq_map = NULL;
+            uring_teardown(ring);
+            return -1;
+        }
+    }
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        ring->sqes = NULL;
+        uring_teardown(ring);
+        return -1;
+    }
+
+    char* sq = ring->sq_map;
+    char* cq = ring->cq_map;
+    ring->sq_head = (unsigned*)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned*)(sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned*)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned*)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned*)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+
+    // Every opcode used below must exist, otherwise the caller falls back.
+    size_t probe_size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe* probe = calloc(1, probe_size);
+    int usable = probe
+        && syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_PROBE, probe, 256) >= 0
+        && uring_op_supported(probe, IORING_OP_OPENAT)
+        && uring_op_supported(probe, IORING_OP_READ_FIXED)
+        && uring_op_supported(probe, IORING_OP_WRITE_FIXED)
+        && uring_op_supported(probe, IORING_OP_WRITE)
+        && uring_op_supported(probe, IORING_OP_CLOSE);
+    free(probe);
+    if (!usable) {
+        uring_teardown(ring);
+        return -1;
+    }
+
+    // One registered buffer per in-flight file: sources are read into it and,
+    // when the assembly fits, written back out of it.
+    ring->buffers = aligned_alloc(4096, (size_t)URING_SLOTS * URING_SLOT_SIZE);
+    struct iovec iov[URING_SLOTS];
+    for (int i = 0; ring->buffers && i < URING_SLOTS; i++) {
+        iov[i].iov_base = ring->buffers + (size_t)i * URING_SLOT_SIZE;
+        iov[i].iov_len = URING_SLOT_SIZE;
+    }
+    if (ring->buffers == NULL
+        || syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_BUFFERS, iov, URING_SLOTS) < 0) {
+        uring_teardown(ring);
+        return -1;
+    }
+    return 0;
+}
+
+// Submits the queued entries and, if wait is set, waits for a completion.
+static int uring_enter(Uring* ring, unsigned wait) {
+    for (;;) {
+        long ret = syscall(__NR_io_uring_enter, ring->fd, ring->to_submit, wait, wait ? IORING_ENTER_GETEVENTS : 0,
+                           NULL, 0);
+        if (ret >= 0) {
+            ring->to_submit -= (unsigned)ret;
+            return 0;
+        }
+        if (errno != EINTR) return -1;
+    }
+}
+
+static struct io_uring_sqe* uring_sqe(Uring* ring, BatchJob* jobs, BatchJob* job, int op, int opcode, int fd) {
+    unsigned tail = *ring->sq_tail;
+    if (tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) > *ring->sq_mask) {
+        // Full: hand what is queued to the kernel, which frees the entries.
+        if (uring_enter(ring, 0) != 0 || tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) > *ring->sq_mask) {
+            fprintf(stderr, "Error: io_uring submission queue is full\n");
+            exit(1);
+        }
+    }
+    unsigned index = tail & *ring->sq_mask;
+    struct io_uring_sqe* sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = (uint8_t)opcode;
+    sqe->fd = fd;
+    sqe->user_data = ((uint64_t)(job - jobs) << 3) | (uint64_t)op;
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring->to_submit++;
+    return sqe;
+}
+
+static char* slot_buffer(Uring* ring, int slot) {
+    return ring->buffers + (size_t)slot * URING_SLOT_SIZE;
+}
+
+static void prep_write(Uring* ring, BatchJob* jobs, BatchJob* job) {
+    size_t remaining = job->output_len - job->written;
+    struct io_uring_sqe* sqe;
+    if (job->fixed_output) {
+        sqe = uring_sqe(ring, jobs, job, OP_WRITE, IORING_OP_WRITE_FIXED, job->fd);
+        sqe->addr = (uint64_t)(uintptr_t)(slot_buffer(ring, job->slot) + job->written);
+        sqe->buf_index = (uint16_t)job->slot;
+    } else {
+        sqe = uring_sqe(ring, jobs, job, OP_WRITE, IORING_OP_WRITE, job->fd);
+        sqe->addr = (uint64_t)(uintptr_t)(job->output + job->written);
+    }
+    sqe->len = (uint32_t)remaining;
+    sqe->off = job->written;
+}
+
+static void prep_open(Uring* ring, BatchJob* jobs, BatchJob* job, int op, const char* path, int flags) {
+    struct io_uring_sqe* sqe = uring_sqe(ring, jobs, job, op, IORING_OP_OPENAT, AT_FDCWD);
+    sqe->addr = (uint64_t)(uintptr_t)path;
+    sqe->open_flags = (uint32_t)flags;
+    sqe->len = 0644;
+}
+
+// Reads whatever did not fit into the registered buffer. Sources larger than
+// a slot are rare, so this stays synchronous.
+static int finish_large_read(Uring* ring, BatchJob* job) {
+    struct stat st;
+    if (fstat(job->fd, &st) != 0) return -1;
+    if ((size_t)st.st_size <= URING_SLOT_SIZE) return 0;
+    char* source = malloc((size_t)st.st_size);
+    if (source == NULL) return -1;
+    memcpy(source, slot_buffer(ring, job->slot), URING_SLOT_SIZE);
+    size_t total = URING_SLOT_SIZE;
+    while (total < (size_t)st.st_size) {
+        ssize_t n = pread(job->fd, source + total, (size_t)st.st_size - total, (off_t)total);
+        if (n <= 0) {
+            free(source);
+            return -1;
+        }
+        total += (size_t)n;
+    }
+    job->source = source;
+    job->source_len = total;
+    return 0;
+}
+
+static int batch_uring(BatchJob* jobs, int count) {
+    Uring ring;
+    if (uring_setup(&ring, URING_SLOTS * 2) != 0) return -1;
+
+    int free_slots[URING_SLOTS];
+    int free_count = URING_SLOTS;
+    for (int i = 0; i < URING_SLOTS; i++) free_slots[i] = URING_SLOTS - 1 - i;
+
+    int next = 0;
+    int inflight = 0;
+    while (next < count || inflight > 0) {
+        while (next < count && free_count > 0) {
+            BatchJob* job = &jobs[next++];
+            job->slot = free_slots[--free_count];
+            prep_open(&ring, jobs, job, OP_OPEN_IN, job->input_path, O_RDONLY);
+            inflight++;
+        }
+        if (uring_enter(&ring, 1) != 0) {
+            fprintf(stderr, "Error: io_uring_enter failed: %s\n", strerror(errno));
+            exit(1);
+        }
+
+        unsigned head = *ring.cq_head;
+        unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            struct io_uring_cqe* cqe = &ring.cqes[head & *ring.cq_mask];
+            BatchJob* job = &jobs[cqe->user_data >> 3];
+            int op = (int)(cqe->user_data & 7);
+            int res = cqe->res;
+            int done = 0;
+            inflight--;
+
+            switch (op) {
+                case OP_OPEN_IN:
+                    if (res < 0) {
+                        fprintf(stderr, "Error: Cannot open file %s\n", job->input_path);
+                        job->failed = 1;
+                        done = 1;
+                        break;
+                    }
+                    job->fd = res;
+                    {
+                        struct io_uring_sqe* sqe = uring_sqe(&ring, jobs, job, OP_READ, IORING_OP_READ_FIXED, job->fd);
+                        sqe->addr = (uint64_t)(uintptr_t)slot_buffer(&ring, job->slot);
+                        sqe->len = URING_SLOT_SIZE;
+                        sqe->buf_index = (uint16_t)job->slot;
+                        inflight++;
+                    }
+                    break;
+                case OP_READ:
+                    job->source = slot_buffer(&ring, job->slot);
+                    job->source_len = res < 0 ? 0 : (size_t)res;
+                    if (res < 0 || (res == URING_SLOT_SIZE && finish_large_read(&ring, job) != 0)) {
+                        fprintf(stderr, "Error: Cannot read file %s\n", job->input_path);
+                        job->failed = 1;
+                    }
+                    uring_sqe(&ring, jobs, job, OP_CLOSE_IN, IORING_OP_CLOSE, job->fd);
+                    inflight++;
+                    if (!job->failed) compile_job(job);
+                    if (job->source != slot_buffer(&ring, job->slot)) free(job->source);
+                    job->source = NULL;
+                    if (job->failed) {
+                        done = 1;
+                        break;
+                    }
+                    if (job->output_len <= URING_SLOT_SIZE) {
+                        memcpy(slot_buffer(&ring, job->slot), job->output, job->output_len);
+                        free(job->output);
+                        job->output = NULL;
+                        job->fixed_output = 1;
+                    }
+                    prep_open(&ring, jobs, job, OP_OPEN_OUT, job->output_path, O_WRONLY | O_CREAT | O_TRUNC);
+                    inflight++;
+                    break;
+                case OP_CLOSE_IN:
+                    break;
+                case OP_OPEN_OUT:
+                    if (res < 0) {
+                        fprintf(stderr, "Error: Cannot create output file %s\n", job->output_path);
+                        job->failed = 1;
+                        done = 1;
+                        break;
+                    }
+                    job->fd = res;
+                    if (job->output_len == 0) {
+                        uring_sqe(&ring, jobs, job, OP_CLOSE_OUT, IORING_OP_CLOSE, job->fd);
+                    } else {
+                        prep_write(&ring, jobs, job);
+                    }
+                    inflight++;
+                    break;
+                case OP_WRITE:
+                    if (res <= 0) {
+                        fprintf(stderr, "Error: Cannot write output file %s\n", job->output_path);
+                        job->failed = 1;
+                    } else {
+                        job->written += (size_t)res;
+                    }
+                    if (!job->failed && job->written < job->output_len) {
+                        prep_write(&ring, jobs, job);
+                    } else {
+                        uring_sqe(&ring, jobs, job, OP_CLOSE_OUT, IORING_OP_CLOSE, job->fd);
+                    }
+                    inflight++;
+                    break;
+                case OP_CLOSE_OUT:
+                    // Delayed write errors surface here.
+                    if (res < 0 && !job->failed) {
+                        fprintf(stderr, "Error: Cannot write output file %s\n", job->output_path);
+                        job->failed = 1;
+                    }
+                    done = 1;
+                    break;
+            }
+
+            if (done) {
+                free(job->output);
+                job->output = NULL;
+                free_slots[free_count++] = job->slot;
+            }
+        }
+        __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    uring_teardown(&ring);
+    return 0;
+}
+
+int batch_compile(char** inputs, int count, BatchIoMode mode) {
+    BatchJob* jobs = calloc(count ? (size_t)count : 1, sizeof(BatchJob));
+    if (jobs == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    for (int i = 0; i < count; i++) {
+        jobs[i].input_path = inputs[i];
+        jobs[i].output_path = assembly_path_for(inputs[i]);
+        jobs[i].fd = -1;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    switch (mode) {
+        case BATCH_IO_AUTO:
+        case BATCH_IO_URING:
+            if (batch_uring(jobs, count) == 0) {
+                mode = BATCH_IO_URING;
+                break;
+            }
+            fprintf(stderr, "Warning: io_uring is unavailable, using threads\n");
+            mode = BATCH_IO_THREADS;
+            /* fall through */
+        case BATCH_IO_THREADS:
+            batch_threads(jobs, count);
+            break;
+        case BATCH_IO_STDIO:
+            batch_stdio(jobs, count);
+            break;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    int failures = 0;
+    for (int i = 0; i < count; i++) {
+        failures += jobs[i].failed;
+        free(jobs[i].output_path);
+    }
+    free(jobs);
+
+    double ms = (double)(end.tv_sec - start.tv_sec) * 1e3 + (double)(end.tv_nsec - start.tv_nsec) / 1e6;
+    printf("Compiled %d of %d files with %s I/O in %.2f ms (%.0f files/s)\n",
+           count - failures, count, batch_io_mode_name(mode), ms, ms > 0 ? count / (ms / 1e3) : 0.0);
+    return failures;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+// Multi-file compilation. Every input "name.c" is compiled to "name.s" next
+// to it. The I/O backend only changes how files are read and written; the
+// generated assembly is identical for all of them.
+typedef enum {
+    BATCH_IO_AUTO,      // io_uring if the kernel supports it, threads otherwise
+    BATCH_IO_URING,     // batched submissions with registered read buffers
+    BATCH_IO_THREADS,   // reader and writer threads around the compiler
+    BATCH_IO_STDIO      // plain fopen/fread/fwrite, one file at a time
+} BatchIoMode;
+
+int parse_batch_io_mode(const char* name, BatchIoMode* mode);
+const char* batch_io_mode_name(BatchIoMode mode);
+
+// Returns the number of inputs that failed to compile.
+int batch_compile(char** inputs, int count, BatchIoMode mode);
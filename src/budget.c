@@ -0,0 +1,81 @@
+#define _POSIX_C_SOURCE 200809L
+#include "budget.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+void opt_budget_init(OptBudget* budget, const OptLimits* limits) {
+    memset(budget, 0, sizeof(*budget));
+    if (limits) budget->limits = *limits;
+    budget->compile_start = now_ms();
+    budget->compile_end = budget->compile_start;
+}
+
+void opt_budget_free(OptBudget* budget) {
+    free(budget->functions);
+    budget->functions = NULL;
+    budget->function_count = 0;
+    budget->function_capacity = 0;
+}
+
+static int compile_out_of_time(const OptBudget* budget, double now) {
+    return budget->limits.compile_ms > 0 && now - budget->compile_start >= budget->limits.compile_ms;
+}
+
+int opt_budget_begin_function(OptBudget* budget, const char* name) {
+    budget->function = name;
+    budget->function_start = now_ms();
+    budget->function_fuel = 0;
+    budget->exhausted = (budget->limits.compile_fuel > 0 && budget->compile_fuel >= budget->limits.compile_fuel)
+        || compile_out_of_time(budget, budget->function_start);
+    return !budget->exhausted;
+}
+
+int opt_budget_consume(OptBudget* budget, long units) {
+    if (budget->exhausted) return 0;
+    budget->function_fuel += units;
+    budget->compile_fuel += units;
+
+    const OptLimits* limits = &budget->limits;
+    double now = (limits->function_ms > 0 || limits->compile_ms > 0) ? now_ms() : 0;
+    if ((limits->function_fuel > 0 && budget->function_fuel > limits->function_fuel)
+        || (limits->compile_fuel > 0 && budget->compile_fuel > limits->compile_fuel)
+        || (limits->function_ms > 0 && now - budget->function_start >= limits->function_ms)
+        || compile_out_of_time(budget, now)) {
+        budget->exhausted = 1;
+    }
+    return !budget->exhausted;
+}
+
+void opt_budget_end_function(OptBudget* budget, int optimized) {
+    if (budget->function_count == budget->function_capacity) {
+        int capacity = budget->function_capacity ? budget->function_capacity * 2 : 16;
+        FunctionFuel* functions = realloc(budget->functions, (size_t)capacity * sizeof(FunctionFuel));
+        if (functions == NULL) return;
+        budget->functions = functions;
+        budget->function_capacity = capacity;
+    }
+    FunctionFuel* entry = &budget->functions[budget->function_count++];
+    entry->name = budget->function;
+    entry->fuel = budget->function_fuel;
+    budget->compile_end = now_ms();
+    entry->ms = budget->compile_end - budget->function_start;
+    entry->optimized = optimized;
+}
+
+void opt_budget_report(const OptBudget* budget, FILE* output) {
+    fprintf(output, "Optimization fuel per function:\n");
+    for (int i = 0; i < budget->function_count; i++) {
+        const FunctionFuel* entry = &budget->functions[i];
+        fprintf(output, "  %-24s %8ld units %10.3f ms  %s\n", entry->name ? entry->name : "?",
+                entry->fuel, entry->ms, entry->optimized ? "optimized" : "fallback");
+    }
+    fprintf(output, "  %-24s %8ld units %10.3f ms\n", "total", budget->compile_fuel,
+            budget->compile_end - budget->compile_start);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdio.h>
+
+// Optimization budgets. Every optimization step costs fuel; passes call
+// opt_budget_consume() and stop as soon as it fails, and the function is then
+// emitted by the direct code generator instead. Limits of 0 mean unlimited.
+typedef struct {
+    long function_fuel;     // fuel per function
+    long compile_fuel;      // fuel for the whole compile
+    double function_ms;     // wall time per function
+    double compile_ms;      // wall time for the whole compile
+} OptLimits;
+
+typedef struct {
+    const char* name;
+    long fuel;
+    double ms;
+    int optimized;
+} FunctionFuel;
+
+typedef struct {
+    OptLimits limits;
+    double compile_start;
+    double compile_end;
+    long compile_fuel;
+    // current function
+    const char* function;
+    double function_start;
+    long function_fuel;
+    int exhausted;
+    // per-function results
+    FunctionFuel* functions;
+    int function_count;
+    int function_capacity;
+} OptBudget;
+
+void opt_budget_init(OptBudget* budget, const OptLimits* limits);
+void opt_budget_free(OptBudget* budget);
+// Returns 0 if the whole compile is already out of budget.
+int opt_budget_begin_function(OptBudget* budget, const char* name);
+// Returns 0 once the function or the compile is out of fuel or time.
+int opt_budget_consume(OptBudget* budget, long units);
+void opt_budget_end_function(OptBudget* budget, int optimized);
+void opt_budget_report(const OptBudget* budget, FILE* output);
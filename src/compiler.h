@@ -45,20 +45,21 @@ typedef struct ASTNode {
     struct ASTNode* left;
     struct ASTNode* right;
     struct ASTNode* next;
+    int line;                   // source line the construct starts on
 } ASTNode;
 
-
-typedef struct Symbol {
-    char* name;
-    TokenType type;
-    int scope;
-    struct Symbol* next;
-} Symbol;
+// A ->next chain under construction in the parser. Keeping the tail makes
+// appending to statement, parameter and argument lists constant time.
+typedef struct {
+    ASTNode* head;
+    ASTNode* tail;
+} NodeList;
 
 
 ASTNode* create_node(NodeType type, char* value);
 void free_ast(ASTNode* node);
 void print_ast(ASTNode* node, int level);
+const char* node_type_name(NodeType type);
 void yyerror(const char* s);
 int yylex(void);
 int yyparse(void);
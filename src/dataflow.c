@@ -0,0 +1,531 @@
+#include "dataflow.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__)
+// Four words at a time; may_alias because rows are also accessed as words.
+typedef BitWord BitVector __attribute__((vector_size(BIT_VECTOR_WORDS * sizeof(BitWord)), may_alias));
+#define HAVE_BIT_VECTORS 1
+#endif
+
+static void* checked(void* data) {
+    if (data == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    return data;
+}
+
+static int* int_array(int count, int fill) {
+    int* array = checked(malloc((size_t)(count > 0 ? count : 1) * sizeof(int)));
+    for (int i = 0; i < count; i++) array[i] = fill;
+    return array;
+}
+
+// calloc rather than an aligned allocation and a memset: large matrices
+// then come straight from zeroed pages, which are only touched as rows are
+// written, and most gen and kill rows stay sparse.
+void bit_matrix_init(BitMatrix* matrix, int rows, int bits) {
+    const size_t alignment = BIT_VECTOR_WORDS * sizeof(BitWord);
+    int words = (bits + BIT_WORD_BITS - 1) / BIT_WORD_BITS;
+    words = (words + BIT_VECTOR_WORDS - 1) / BIT_VECTOR_WORDS * BIT_VECTOR_WORDS;
+    size_t bytes = (size_t)rows * (size_t)words * sizeof(BitWord);
+    matrix->memory = checked(calloc(1, bytes + alignment));
+    matrix->bits = (BitWord*)(((uintptr_t)matrix->memory + alignment - 1) & ~(uintptr_t)(alignment - 1));
+    matrix->rows = rows;
+    matrix->words = words;
+}
+
+void bit_matrix_free(BitMatrix* matrix) {
+    free(matrix->memory);
+    matrix->memory = NULL;
+    matrix->bits = NULL;
+}
+
+int bit_next(const BitWord* row, int words, int from) {
+    int w = from / BIT_WORD_BITS;
+    if (w >= words) return -1;
+    BitWord bits = row[w] & (~(BitWord)0 << (from % BIT_WORD_BITS));
+    while (bits == 0) {
+        if (++w == words) return -1;
+        bits = row[w];
+    }
+    return w * BIT_WORD_BITS + __builtin_ctzll(bits);
+}
+
+static void bits_or(BitWord* dest, const BitWord* source, int words) {
+#ifdef HAVE_BIT_VECTORS
+    for (int w = 0; w < words; w += BIT_VECTOR_WORDS) *(BitVector*)(dest + w) |= *(const BitVector*)(source + w);
+#else
+    for (int w = 0; w < words; w++) dest[w] |= source[w];
+#endif
+}
+
+static void bits_and(BitWord* dest, const BitWord* source, int words) {
+#ifdef HAVE_BIT_VECTORS
+    for (int w = 0; w < words; w += BIT_VECTOR_WORDS) *(BitVector*)(dest + w) &= *(const BitVector*)(source + w);
+#else
+    for (int w = 0; w < words; w++) dest[w] &= source[w];
+#endif
+}
+
+// out = gen | (in & ~kill); returns whether out changed.
+static int bits_transfer(BitWord* out, const BitWord* gen, const BitWord* in, const BitWord* kill, int words) {
+#ifdef HAVE_BIT_VECTORS
+    BitVector changed = { 0 };
+    for (int w = 0; w < words; w += BIT_VECTOR_WORDS) {
+        BitVector* o = (BitVector*)(out + w);
+        BitVector updated = *(const BitVector*)(gen + w) | (*(const BitVector*)(in + w) & ~*(const BitVector*)(kill + w));
+        changed |= updated ^ *o;
+        *o = updated;
+    }
+    return (changed[0] | changed[1] | changed[2] | changed[3]) != 0;
+#else
+    BitWord changed = 0;
+    for (int w = 0; w < words; w++) {
+        BitWord updated = gen[w] | (in[w] & ~kill[w]);
+        changed |= updated ^ out[w];
+        out[w] = updated;
+    }
+    return changed != 0;
+#endif
+}
+
+// Sets bits 0..bits-1; the padding stays clear.
+static void bits_fill(BitWord* row, int bits) {
+    for (int w = 0; w < bits / BIT_WORD_BITS; w++) row[w] = ~(BitWord)0;
+    if (bits % BIT_WORD_BITS) row[bits / BIT_WORD_BITS] = ((BitWord)1 << (bits % BIT_WORD_BITS)) - 1;
+}
+
+int ir_reverse_postorder(const IrFunction* function, int* order) {
+    int count = function->block_count;
+    if (count == 0) return 0;
+    int* stack = int_array(count, 0);
+    int* next_edge = int_array(count, IR_NONE);
+    uint8_t* visited = checked(calloc((size_t)count, 1));
+    int depth = 0;
+    int finished = 0;
+
+    stack[depth++] = 0;
+    visited[0] = 1;
+    next_edge[0] = function->blocks[0].first_succ;
+    while (depth > 0) {
+        int block = stack[depth - 1];
+        int edge = next_edge[block];
+        if (edge != IR_NONE) {
+            next_edge[block] = function->edges[edge].next_succ;
+            int succ = function->edges[edge].to;
+            if (!visited[succ]) {
+                visited[succ] = 1;
+                next_edge[succ] = function->blocks[succ].first_succ;
+                stack[depth++] = succ;
+            }
+        } else {
+            order[finished++] = block;
+            depth--;
+        }
+    }
+    for (int i = 0; i < finished / 2; i++) {
+        int swap = order[i];
+        order[i] = order[finished - 1 - i];
+        order[finished - 1 - i] = swap;
+    }
+    free(stack);
+    free(next_edge);
+    free(visited);
+    return finished;
+}
+
+void dataflow_init(Dataflow* flow, const IrFunction* function, DataflowDirection direction, DataflowMeet meet,
+                   int bits) {
+    int blocks = function->block_count;
+    flow->direction = direction;
+    flow->meet = meet;
+    flow->bits = bits;
+    bit_matrix_init(&flow->gen, blocks, bits);
+    bit_matrix_init(&flow->kill, blocks, bits);
+    bit_matrix_init(&flow->in, blocks, bits);
+    bit_matrix_init(&flow->out, blocks, bits);
+    flow->order = int_array(blocks, 0);
+    flow->order_count = ir_reverse_postorder(function, flow->order);
+    flow->visits = 0;
+}
+
+void dataflow_free(Dataflow* flow) {
+    bit_matrix_free(&flow->gen);
+    bit_matrix_free(&flow->kill);
+    bit_matrix_free(&flow->in);
+    bit_matrix_free(&flow->out);
+    free(flow->order);
+    flow->order = NULL;
+}
+
+// Round-robin worklist: sweeps over the blocks in visiting order evaluate
+// the pending ones, and a block whose result changed makes the blocks that
+// read it pending, later ones within the same sweep.
+void dataflow_solve(Dataflow* flow, const IrFunction* function) {
+    int count = flow->order_count;
+    int words = flow->in.words;
+    int forward = flow->direction == DATAFLOW_FORWARD;
+    // The meet writes `input` from the neighbours' `result`; the transfer writes `result`.
+    BitMatrix* input = forward ? &flow->in : &flow->out;
+    BitMatrix* result = forward ? &flow->out : &flow->in;
+    int* sequence = int_array(count, 0);
+    int* position = int_array(function->block_count, IR_NONE);
+    uint8_t* pending = checked(malloc((size_t)(count > 0 ? count : 1)));
+
+    for (int i = 0; i < count; i++) {
+        sequence[i] = flow->order[forward ? i : count - 1 - i];
+        position[sequence[i]] = i;
+        pending[i] = 1;
+        // Must problems start from the full set and shrink.
+        if (flow->meet == DATAFLOW_INTERSECTION) bits_fill(bit_row(result, sequence[i]), flow->bits);
+    }
+    flow->visits = 0;
+    int remaining = count;
+    while (remaining > 0) {
+        for (int p = 0; p < count; p++) {
+            if (!pending[p]) continue;
+            pending[p] = 0;
+            remaining--;
+            flow->visits++;
+            int block = sequence[p];
+            const IrBlock* info = &function->blocks[block];
+            BitWord* meet = bit_row(input, block);
+            int first = 1;
+            for (int edge = forward ? info->first_pred : info->first_succ; edge != IR_NONE;
+                 edge = forward ? function->edges[edge].next_pred : function->edges[edge].next_succ) {
+                int neighbour = forward ? function->edges[edge].from : function->edges[edge].to;
+                if (position[neighbour] == IR_NONE) continue;
+                const BitWord* source = bit_row(result, neighbour);
+                if (first) {
+                    memcpy(meet, source, (size_t)words * sizeof(BitWord));
+                } else if (flow->meet == DATAFLOW_UNION) {
+                    bits_or(meet, source, words);
+                } else {
+                    bits_and(meet, source, words);
+                }
+                first = 0;
+            }
+            // Nothing flows into the entry (forward) or out of an exit (backward).
+            if (first || (forward && block == 0 && flow->meet == DATAFLOW_INTERSECTION)) {
+                memset(meet, 0, (size_t)words * sizeof(BitWord));
+            }
+            if (!bits_transfer(bit_row(result, block), bit_row(&flow->gen, block), meet, bit_row(&flow->kill, block),
+                               words)) {
+                continue;
+            }
+            for (int edge = forward ? info->first_succ : info->first_pred; edge != IR_NONE;
+                 edge = forward ? function->edges[edge].next_succ : function->edges[edge].next_pred) {
+                int q = position[forward ? function->edges[edge].to : function->edges[edge].from];
+                if (q != IR_NONE && !pending[q]) {
+                    pending[q] = 1;
+                    remaining++;
+                }
+            }
+        }
+    }
+    free(sequence);
+    free(position);
+    free(pending);
+}
+
+// Block in which operand `a` of `insn` (in `block`) is read: a phi reads
+// its operands at the end of the predecessors. `edge` walks the
+// predecessor edges alongside the operands of a phi.
+static int use_block(const IrFunction* function, int insn, int block, int* edge) {
+    if (function->insns[insn].op != IR_PHI) return block;
+    int from = function->edges[*edge].from;
+    *edge = function->edges[*edge].next_pred;
+    return from;
+}
+
+void ir_liveness(IrLiveness* liveness, const IrFunction* function, int (*tracked)(const void* context, int value),
+                 const void* context) {
+    int values = function->insn_count;
+    liveness->bit_of = int_array(values, IR_NONE);
+    liveness->value_of = int_array(values, 0);
+    liveness->count = 0;
+    for (int b = 0; b < function->block_count; b++) {
+        for (int insn = function->blocks[b].first; insn != IR_NONE; insn = function->insns[insn].next) {
+            const int32_t* args = ir_args(function, insn);
+            int edge = function->blocks[b].first_pred;
+            for (int a = 0; a < function->insns[insn].arg_count; a++) {
+                int value = args[a];
+                int user = use_block(function, insn, b, &edge);
+                if (function->insns[value].block == user || liveness->bit_of[value] != IR_NONE) continue;
+                if (tracked && !tracked(context, value)) continue;
+                liveness->value_of[liveness->count] = value;
+                liveness->bit_of[value] = liveness->count++;
+            }
+        }
+    }
+
+    // A tracked value is upward exposed in every block that uses it other
+    // than its own, and only its own block defines it.
+    Dataflow* flow = &liveness->flow;
+    dataflow_init(flow, function, DATAFLOW_BACKWARD, DATAFLOW_UNION, liveness->count);
+    for (int b = 0; b < function->block_count; b++) {
+        for (int insn = function->blocks[b].first; insn != IR_NONE; insn = function->insns[insn].next) {
+            const int32_t* args = ir_args(function, insn);
+            int edge = function->blocks[b].first_pred;
+            for (int a = 0; a < function->insns[insn].arg_count; a++) {
+                int bit = liveness->bit_of[args[a]];
+                int user = use_block(function, insn, b, &edge);
+                if (bit != IR_NONE && function->insns[args[a]].block != user) bit_set(bit_row(&flow->gen, user), bit);
+            }
+        }
+    }
+    for (int bit = 0; bit < liveness->count; bit++) {
+        bit_set(bit_row(&flow->kill, function->insns[liveness->value_of[bit]].block), bit);
+    }
+    dataflow_solve(flow, function);
+}
+
+void ir_liveness_free(IrLiveness* liveness) {
+    dataflow_free(&liveness->flow);
+    free(liveness->bit_of);
+    free(liveness->value_of);
+}
+
+// Frame slot an address points into, or IR_NONE if it is not a frame address.
+static int address_slot(const IrFunction* function, int address) {
+    const IrInsn* insn = &function->insns[address];
+    if (insn->op == IR_SLOT) return insn->imm;
+    if (insn->op == IR_ELEMENT) {
+        const IrInsn* base = &function->insns[ir_args(function, address)[0]];
+        if (base->op == IR_SLOT) return base->imm;
+    }
+    return IR_NONE;
+}
+
+// Frame word an address names when it is known at compile time, numbered
+// across all slots, or IR_NONE.
+static int address_word(const IrFunction* function, const int* slot_word, int address) {
+    const IrInsn* insn = &function->insns[address];
+    if (insn->op == IR_SLOT) return slot_word[insn->imm];
+    if (insn->op != IR_ELEMENT) return IR_NONE;
+    const IrInsn* base = &function->insns[ir_args(function, address)[0]];
+    const IrInsn* index = &function->insns[ir_args(function, address)[1]];
+    if (base->op != IR_SLOT || index->op != IR_CONST) return IR_NONE;
+    if (index->imm < 0 || index->imm >= function->slots[base->imm].words) return IR_NONE;
+    return slot_word[base->imm] + index->imm;
+}
+
+void ir_reaching_definitions(IrReaching* reaching, const IrFunction* function) {
+    int* slot_word = int_array(function->slot_count, 0);
+    int frame_words = 0;
+    for (int s = 0; s < function->slot_count; s++) {
+        slot_word[s] = frame_words;
+        frame_words += function->slots[s].words;
+    }
+    reaching->bit_of = int_array(function->insn_count, IR_NONE);
+    reaching->store_of = int_array(function->insn_count, 0);
+    reaching->count = 0;
+    for (int b = 0; b < function->block_count; b++) {
+        for (int insn = function->blocks[b].first; insn != IR_NONE; insn = function->insns[insn].next) {
+            if (function->insns[insn].op != IR_STORE) continue;
+            reaching->store_of[reaching->count] = insn;
+            reaching->bit_of[insn] = reaching->count++;
+        }
+    }
+
+    // The stores to each known word, grouped by a counting sort.
+    int count = reaching->count;
+    int* word_of = int_array(count, IR_NONE);
+    int* word_first = int_array(frame_words + 1, 0);
+    int* word_stores = int_array(count, 0);
+    for (int d = 0; d < count; d++) {
+        word_of[d] = address_word(function, slot_word, ir_args(function, reaching->store_of[d])[0]);
+        if (word_of[d] != IR_NONE) word_first[word_of[d] + 1]++;
+    }
+    for (int w = 0; w < frame_words; w++) word_first[w + 1] += word_first[w];
+    int* fill = int_array(frame_words, 0);
+    for (int d = 0; d < count; d++) {
+        if (word_of[d] != IR_NONE) word_stores[word_first[word_of[d]] + fill[word_of[d]]++] = d;
+    }
+
+    // Walking each block backwards, a store generates unless a later store
+    // in the block writes the same known word, and kills the word's other stores.
+    Dataflow* flow = &reaching->flow;
+    dataflow_init(flow, function, DATAFLOW_FORWARD, DATAFLOW_UNION, count);
+    int* written = int_array(frame_words, IR_NONE);
+    for (int b = 0; b < function->block_count; b++) {
+        BitWord* gen = bit_row(&flow->gen, b);
+        BitWord* kill = bit_row(&flow->kill, b);
+        for (int insn = function->blocks[b].last; insn != IR_NONE; insn = function->insns[insn].prev) {
+            int d = reaching->bit_of[insn];
+            if (d == IR_NONE) continue;
+            int word = word_of[d];
+            if (word == IR_NONE) {
+                bit_set(gen, d);
+                continue;
+            }
+            if (written[word] == b) continue;
+            written[word] = b;
+            bit_set(gen, d);
+            for (int i = word_first[word]; i < word_first[word + 1]; i++) bit_set(kill, word_stores[i]);
+        }
+    }
+    dataflow_solve(flow, function);
+    free(slot_word);
+    free(word_of);
+    free(word_first);
+    free(word_stores);
+    free(fill);
+    free(written);
+}
+
+void ir_reaching_free(IrReaching* reaching) {
+    dataflow_free(&reaching->flow);
+    free(reaching->bit_of);
+    free(reaching->store_of);
+}
+
+static int is_expression(IrOp op) {
+    return (op >= IR_ADD && op <= IR_ELEMENT) || op == IR_LOAD;
+}
+
+static int commutes(IrOp op) {
+    return op == IR_ADD || op == IR_MUL || op == IR_AND || op == IR_OR || op == IR_XOR || op == IR_EQ ||
+           op == IR_NE;
+}
+
+typedef struct {
+    int64_t left, right;
+    int32_t op;
+    int32_t expression;         // IR_NONE for an empty entry
+} ExpressionKey;
+
+// Operands are compared by what they compute, not by instruction: constants
+// by value, slot addresses by slot and expressions by their number, so that
+// the constants and addresses the lowering rebuilds at every use still match.
+static int64_t operand_key(const IrFunction* function, const int* expression_of, int value) {
+    const IrInsn* insn = &function->insns[value];
+    if (insn->op == IR_CONST) return (int64_t)1 << 40 | (uint32_t)insn->imm;
+    if (insn->op == IR_SLOT) return (int64_t)2 << 40 | (uint32_t)insn->imm;
+    if (expression_of[value] != IR_NONE) return (int64_t)3 << 40 | (uint32_t)expression_of[value];
+    return value;
+}
+
+static ExpressionKey expression_key(const IrFunction* function, const int* expression_of, int insn) {
+    const IrInsn* ir = &function->insns[insn];
+    const int32_t* args = ir_args(function, insn);
+    ExpressionKey key = { operand_key(function, expression_of, args[0]),
+                          ir->arg_count > 1 ? operand_key(function, expression_of, args[1]) : IR_NONE, ir->op,
+                          IR_NONE };
+    if (commutes((IrOp)ir->op) && key.left > key.right) {
+        int64_t swap = key.left;
+        key.left = key.right;
+        key.right = swap;
+    }
+    return key;
+}
+
+void ir_available_expressions(IrAvailable* available, const IrFunction* function) {
+    available->bit_of = int_array(function->insn_count, IR_NONE);
+    available->first_of = int_array(function->insn_count, 0);
+    available->count = 0;
+
+    // Expressions are numbered through an open-addressing table on their
+    // key, in reverse postorder so that operands are numbered before their users.
+    int capacity = 16;
+    while (capacity < 2 * function->insn_count) capacity *= 2;
+    ExpressionKey* table = checked(malloc((size_t)capacity * sizeof(ExpressionKey)));
+    int* first = int_array(function->insn_count, 0);
+    int* uses = int_array(function->insn_count, 0);
+    int* order = int_array(function->block_count, 0);
+    int order_count = ir_reverse_postorder(function, order);
+    int keys = 0;
+    for (int i = 0; i < capacity; i++) table[i].expression = IR_NONE;
+    for (int o = 0; o < order_count; o++) {
+        for (int insn = function->blocks[order[o]].first; insn != IR_NONE; insn = function->insns[insn].next) {
+            if (!is_expression((IrOp)function->insns[insn].op)) continue;
+            ExpressionKey key = expression_key(function, available->bit_of, insn);
+            uint64_t hash = ((uint64_t)key.op * 0x9E3779B97F4A7C15ull) ^ ((uint64_t)key.left * 0xC2B2AE3D27D4EB4Full) ^
+                            ((uint64_t)key.right * 0x165667B19E3779F9ull);
+            int i = (int)((hash >> 32) & (uint64_t)(capacity - 1));
+            while (table[i].expression != IR_NONE &&
+                   (table[i].op != key.op || table[i].left != key.left || table[i].right != key.right)) {
+                i = (i + 1) & (capacity - 1);
+            }
+            if (table[i].expression == IR_NONE) {
+                key.expression = keys++;
+                table[i] = key;
+                first[key.expression] = insn;
+                uses[key.expression] = 0;
+            }
+            uses[table[i].expression]++;
+            available->bit_of[insn] = table[i].expression;
+        }
+    }
+    free(order);
+    free(table);
+    // An expression computed once can never be redundant and gets no bit.
+    for (int k = 0; k < keys; k++) {
+        if (uses[k] < 2) {
+            uses[k] = IR_NONE;
+            continue;
+        }
+        available->first_of[available->count] = first[k];
+        uses[k] = available->count++;
+    }
+    for (int insn = 0; insn < function->insn_count; insn++) {
+        if (available->bit_of[insn] != IR_NONE) available->bit_of[insn] = uses[available->bit_of[insn]];
+    }
+    free(first);
+    free(uses);
+
+    // The loads each slot's stores clobber, as one mask per slot; slot_count
+    // stands for addresses outside the frame, which any store may write and
+    // whose stores may write any slot.
+    int slots = function->slot_count;
+    int count = available->count;
+    BitMatrix clobbered;
+    bit_matrix_init(&clobbered, slots + 1, count);
+    for (int e = 0; e < count; e++) {
+        int insn = available->first_of[e];
+        if (function->insns[insn].op != IR_LOAD) continue;
+        int slot = address_slot(function, ir_args(function, insn)[0]);
+        if (slot == IR_NONE) {
+            for (int s = 0; s <= slots; s++) bit_set(bit_row(&clobbered, s), e);
+        } else {
+            bit_set(bit_row(&clobbered, slot), e);
+            bit_set(bit_row(&clobbered, slots), e);
+        }
+    }
+
+    // Walking each block backwards, an expression is generated unless a
+    // later store in the block clobbers it.
+    Dataflow* flow = &available->flow;
+    dataflow_init(flow, function, DATAFLOW_FORWARD, DATAFLOW_INTERSECTION, count);
+    int* stored = int_array(slots + 1, IR_NONE);
+    for (int b = 0; b < function->block_count; b++) {
+        BitWord* gen = bit_row(&flow->gen, b);
+        BitWord* kill = bit_row(&flow->kill, b);
+        for (int insn = function->blocks[b].last; insn != IR_NONE; insn = function->insns[insn].prev) {
+            int e = available->bit_of[insn];
+            if (e != IR_NONE) {
+                // So far kill holds what the later stores clobber.
+                if (!bit_test(kill, e)) bit_set(gen, e);
+                continue;
+            }
+            if (function->insns[insn].op != IR_STORE) continue;
+            int slot = address_slot(function, ir_args(function, insn)[0]);
+            if (slot == IR_NONE) slot = slots;
+            if (stored[slot] == b) continue;
+            stored[slot] = b;
+            bits_or(kill, bit_row(&clobbered, slot), flow->kill.words);
+        }
+    }
+    bit_matrix_free(&clobbered);
+    free(stored);
+    dataflow_solve(flow, function);
+}
+
+void ir_available_free(IrAvailable* available) {
+    dataflow_free(&available->flow);
+    free(available->bit_of);
+    free(available->first_of);
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "ir.h"
+#include <stdint.h>
+
+// Iterative dataflow analysis over the CFG of an IrFunction.
+//
+// Sets are dense bit vectors, one row per block in a BitMatrix. Rows are
+// padded to whole 256-bit vectors and 32-byte aligned, so the solver's
+// inner loops (meet, transfer, change test) run a vector at a time through
+// GCC vector extensions with no tail handling; the compiler maps them to
+// SSE2, AVX2 or NEON, or to plain 64-bit words elsewhere.
+//
+// A problem is a direction, a meet (union or intersection) and per-block
+// gen and kill sets; the transfer function of a block is
+// out = gen | (in & ~kill), with in and out swapped for backward problems.
+// The solver visits blocks in reverse postorder (postorder for backward
+// problems) and only revisits a block when an input changed, so an acyclic
+// region is finished in one sweep and a loop nest needs about one extra
+// sweep per level. Blocks unreachable from the entry are ignored and keep
+// empty sets.
+
+typedef uint64_t BitWord;
+
+#define BIT_WORD_BITS 64
+#define BIT_VECTOR_WORDS 4
+
+typedef struct {
+    BitWord* bits;              // aligned, inside `memory`
+    void* memory;
+    int rows;
+    int words;                  // per row, a multiple of BIT_VECTOR_WORDS
+} BitMatrix;
+
+void bit_matrix_init(BitMatrix* matrix, int rows, int bits);
+void bit_matrix_free(BitMatrix* matrix);
+
+static inline BitWord* bit_row(const BitMatrix* matrix, int row) {
+    return matrix->bits + (size_t)row * (size_t)matrix->words;
+}
+static inline void bit_set(BitWord* row, int bit) {
+    row[bit / BIT_WORD_BITS] |= (BitWord)1 << (bit % BIT_WORD_BITS);
+}
+static inline int bit_test(const BitWord* row, int bit) {
+    return (int)(row[bit / BIT_WORD_BITS] >> (bit % BIT_WORD_BITS) & 1);
+}
+// First set bit at or after `from`, or -1: for (b = bit_next(r, w, 0); b >= 0; b = bit_next(r, w, b + 1)).
+int bit_next(const BitWord* row, int words, int from);
+
+typedef enum {
+    DATAFLOW_FORWARD,
+    DATAFLOW_BACKWARD
+} DataflowDirection;
+
+typedef enum {
+    DATAFLOW_UNION,             // may problems: liveness, reaching definitions
+    DATAFLOW_INTERSECTION       // must problems: available expressions
+} DataflowMeet;
+
+typedef struct {
+    DataflowDirection direction;
+    DataflowMeet meet;
+    int bits;
+    BitMatrix gen, kill;        // filled by the client between init and solve
+    BitMatrix in, out;          // per block, at its start and at its end
+    int* order;                 // reachable blocks in reverse postorder
+    int order_count;
+    int visits;                 // blocks evaluated by the last solve
+} Dataflow;
+
+void dataflow_init(Dataflow* flow, const IrFunction* function, DataflowDirection direction, DataflowMeet meet,
+                   int bits);
+void dataflow_solve(Dataflow* flow, const IrFunction* function);
+void dataflow_free(Dataflow* flow);
+
+// Blocks reachable from the entry in reverse postorder; returns their number.
+int ir_reverse_postorder(const IrFunction* function, int* order);
+
+// Live values at block boundaries. Only values used outside their own block
+// can be live there, so only those get a bit; `tracked`, if not NULL,
+// narrows them further (the back end leaves out constants). A phi operand
+// is used at the end of the corresponding predecessor and a phi is defined
+// at the start of its block, so phis are not live into their own block.
+typedef struct {
+    Dataflow flow;
+    int* bit_of;                // per value, or IR_NONE
+    int* value_of;              // per bit
+    int count;
+} IrLiveness;
+
+void ir_liveness(IrLiveness* liveness, const IrFunction* function, int (*tracked)(const void* context, int value),
+                 const void* context);
+void ir_liveness_free(IrLiveness* liveness);
+
+// Stores that may reach each block boundary. A store to a frame word known
+// at compile time (a scalar slot or a constant index) kills the other
+// stores to that word; a store with a computed index kills nothing.
+typedef struct {
+    Dataflow flow;
+    int* bit_of;                // per instruction: its store number, or IR_NONE
+    int* store_of;              // per bit
+    int count;
+} IrReaching;
+
+void ir_reaching_definitions(IrReaching* reaching, const IrFunction* function);
+void ir_reaching_free(IrReaching* reaching);
+
+// Expressions computed on every path to each block boundary. Arithmetic,
+// comparisons and element addresses are keyed by operator and operands
+// (operands of commutative operators sorted), which SSA never invalidates;
+// a load is keyed by its address and killed by any store to the same
+// frame slot. Only expressions computed by more than one instruction,
+// the ones that can be redundant, get a bit.
+typedef struct {
+    Dataflow flow;
+    int* bit_of;                // per instruction: its expression number, or IR_NONE
+    int* first_of;              // per bit: the first instruction computing it
+    int count;
+} IrAvailable;
+
+void ir_available_expressions(IrAvailable* available, const IrFunction* function);
+void ir_available_free(IrAvailable* available);
+
+// Control flow analyses that the pass manager computes and caches
+// (passes.c), kept here so that the loop analyses can build on them.
+typedef struct {
+    int* order;                 // reachable blocks in reverse postorder
+    int count;
+    int* index;                 // per block, its position in order or IR_NONE
+} IrCfg;
+
+// Immediate dominators (Cooper, Harvey and Kennedy's iterative algorithm
+// over the reverse postorder) and a numbering of the dominator tree that
+// answers "does a dominate b" in constant time.
+typedef struct {
+    int* idom;                  // per block; the entry's is itself, IR_NONE if unreachable
+    int* first_child;           // dominator tree, per block
+    int* next_sibling;
+    int* enter;                 // per block, preorder number in the tree
+    int* leave;                 // per block, largest preorder number in its subtree
+} IrDominators;
+
+int ir_dominates(const IrDominators* dominators, int a, int b);
+
+// Natural loops: one per header, holding the blocks of every back edge to
+// it, nested by containment into a forest.
+typedef struct {
+    int header;
+    int parent;                 // enclosing loop, or IR_NONE
+    int first_child, next_sibling;  // nested loops
+    int depth;                  // 1 for outermost loops
+    int* blocks;
+    int block_count;
+    int latch_count;            // blocks with a back edge to the header
+    int preheader;              // the header's only predecessor outside the loop, if it has no
+                                // other successor; IR_NONE otherwise
+    int* exits;                 // edges from a block of the loop to a block outside it
+    int exit_count;
+} IrLoop;
+
+typedef struct {
+    IrLoop* loops;              // outer loops before the loops they contain
+    int count;
+    int first_root;             // outermost loops, chained through next_sibling
+    int* innermost;             // per block, its innermost loop or IR_NONE
+} IrLoops;
+
+int ir_loop_contains(const IrLoops* loops, int loop, int block);
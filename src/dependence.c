@@ -0,0 +1,614 @@
+#include "dependence.h"
+#include "passes.h"
+#include "remarks.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Array dependence testing. For two accesses A and B with subscripts
+//
+//     ca + sum a_j * k_j    and    cb + sum b_j * k'_j
+//
+// (after a common base has cancelled) there is a dependence when the two
+// can name the same word, that is when
+//
+//     sum a_j * k_j - sum b_j * k'_j = cb - ca
+//
+// has a solution with every k in [0, last iteration of its loop]. The
+// loops around both accesses are paired, k and k' standing for the same
+// loop in the two iterations that are compared, and each pair is given a
+// direction: k < k', k = k' or k > k'. For a direction vector the GCD
+// test asks for an integer solution and Banerjee's bounds for a real one
+// inside the iteration space; each paired term is bounded by evaluating
+// it at the corners of its (trapezoidal) region. Vectors are refined one
+// level at a time from "any direction", so that a level is split only
+// while the outer ones leave a solution.
+
+static void* checked(void* data) {
+    if (data == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    return data;
+}
+
+// Iteration numbers beyond this would wrap any subscript that moves with
+// them out of its array.
+#define ITERATION_LIMIT ((int64_t)INT32_MAX)
+
+static int64_t saturating_add(int64_t a, int64_t b) {
+    if (b > 0 && a > INT64_MAX - b) return INT64_MAX;
+    if (b < 0 && a < INT64_MIN - b) return INT64_MIN;
+    return a + b;
+}
+
+static int64_t gcd(int64_t a, int64_t b) {
+    if (a < 0) a = -a;
+    if (b < 0) b = -b;
+    while (b != 0) {
+        int64_t r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+// Last iteration in which a block of `loop` runs: the header runs once more
+// than the body, to find that the loop is done. -1 if it never runs.
+static int64_t last_iteration(const IrLoops* loops, const IrInduction* induction, int loop, int block) {
+    const IrTripCount* trip = &induction->trips[loop];
+    if (trip->kind != TRIP_CONSTANT) return ITERATION_LIMIT;
+    int64_t count = trip->count < ITERATION_LIMIT ? trip->count : ITERATION_LIMIT;
+    return block == loops->loops[loop].header ? count : count - 1;
+}
+
+// Loops around a block, outermost first, up to the limit; returns how many
+// there are in all.
+static int loops_around(const IrLoops* loops, int block, int* chain) {
+    int depth = 0;
+    for (int l = loops->innermost[block]; l != IR_NONE; l = loops->loops[l].parent) depth++;
+    int level = depth;
+    for (int l = loops->innermost[block]; l != IR_NONE; l = loops->loops[l].parent) {
+        level--;
+        if (level < IR_DEPENDENCE_LEVELS) chain[level] = l;
+    }
+    return depth;
+}
+
+// ---------------------------------------------------------------------------
+// One dependence problem
+
+typedef struct {
+    int levels;
+    int64_t a[IR_DEPENDENCE_LEVELS], b[IR_DEPENDENCE_LEVELS];   // coefficients of k and k'
+    int64_t ua[IR_DEPENDENCE_LEVELS], ub[IR_DEPENDENCE_LEVELS]; // their last iterations
+    int64_t free_low, free_high;    // range of the terms of loops around only one access
+    int64_t free_gcd;
+    int64_t difference;             // cb - ca
+    int never;                      // an access sits in a loop that never runs
+} Problem;
+
+static const IrAffine zero_form = { .base = IR_NONE };
+
+static const IrAffine* subscript(const IrInduction* induction, const IrAccess* access) {
+    return access->index == IR_NONE ? &zero_form : &induction->forms[access->index];
+}
+
+static int in_chain(const int* chain, int depth, int loop) {
+    for (int i = 0; i < depth; i++) {
+        if (chain[i] == loop) return 1;
+    }
+    return 0;
+}
+
+// Sets up the problem for A and B with `pairs` loops paired level by level
+// (pair_a[i] around A with pair_b[i] around B); returns 0 when the
+// subscripts cannot be compared.
+static int set_up(Problem* problem, const IrFunction* function, const IrLoops* loops, const IrInduction* induction,
+                  const IrAccess* a, const IrAccess* b, const int* pair_a, const int* pair_b, int pairs) {
+    memset(problem, 0, sizeof(*problem));
+    problem->levels = pairs;
+    const IrAffine* fa = subscript(induction, a);
+    const IrAffine* fb = subscript(induction, b);
+    int chain_a[IR_DEPENDENCE_LEVELS], chain_b[IR_DEPENDENCE_LEVELS];
+    int block_a = function->insns[a->insn].block;
+    int block_b = function->insns[b->insn].block;
+    int depth_a = loops_around(loops, block_a, chain_a);
+    int depth_b = loops_around(loops, block_b, chain_b);
+    if (depth_a > IR_DEPENDENCE_LEVELS || depth_b > IR_DEPENDENCE_LEVELS) return 0;
+
+    // A common base cancels only if neither access sees it change.
+    if (fa->base != fb->base || fa->scale != fb->scale) return 0;
+    if (fa->base != IR_NONE) {
+        int defined = function->insns[fa->base].block;
+        for (int i = 0; i < depth_a; i++) {
+            if (ir_loop_contains(loops, chain_a[i], defined)) return 0;
+        }
+        for (int i = 0; i < depth_b; i++) {
+            if (ir_loop_contains(loops, chain_b[i], defined)) return 0;
+        }
+    }
+    for (int t = 0; t < fa->term_count; t++) {
+        if (!in_chain(chain_a, depth_a, fa->terms[t].loop)) return 0;
+    }
+    for (int t = 0; t < fb->term_count; t++) {
+        if (!in_chain(chain_b, depth_b, fb->terms[t].loop)) return 0;
+    }
+
+    for (int i = 0; i < pairs; i++) {
+        problem->a[i] = ir_affine_step(fa, pair_a[i]);
+        problem->b[i] = ir_affine_step(fb, pair_b[i]);
+        problem->ua[i] = last_iteration(loops, induction, pair_a[i], block_a);
+        problem->ub[i] = last_iteration(loops, induction, pair_b[i], block_b);
+        if (problem->ua[i] < 0 || problem->ub[i] < 0) problem->never = 1;
+    }
+    for (int side = 0; side < 2; side++) {
+        const int* chain = side ? chain_b : chain_a;
+        int depth = side ? depth_b : depth_a;
+        const int* paired = side ? pair_b : pair_a;
+        for (int i = 0; i < depth; i++) {
+            if (in_chain(paired, pairs, chain[i])) continue;
+            int64_t last = last_iteration(loops, induction, chain[i], side ? block_b : block_a);
+            if (last < 0) problem->never = 1;
+            int64_t step = ir_affine_step(side ? fb : fa, chain[i]);
+            if (side) step = -step;
+            int64_t end = step * (last > 0 ? last : 0);
+            problem->free_low = saturating_add(problem->free_low, end < 0 ? end : 0);
+            problem->free_high = saturating_add(problem->free_high, end > 0 ? end : 0);
+            problem->free_gcd = gcd(problem->free_gcd, step);
+        }
+    }
+    problem->difference = (int64_t)fb->constant - (int64_t)fa->constant;
+    return 1;
+}
+
+// Range of a * k - b * k' over k in [0, ua], k' in [0, ub] related by
+// `direction`; 0 if no such k and k' exist.
+static int term_range(int64_t a, int64_t b, int64_t ua, int64_t ub, int direction, int64_t* low, int64_t* high) {
+    int64_t points[4][2];
+    int count = 0;
+    int64_t m;
+    switch (direction) {
+        case DIRECTION_EQ:
+            m = ua < ub ? ua : ub;
+            points[count][0] = 0, points[count++][1] = 0;
+            points[count][0] = m, points[count++][1] = m;
+            break;
+        case DIRECTION_LT:
+            m = ua < ub - 1 ? ua : ub - 1;
+            if (m < 0) return 0;
+            points[count][0] = 0, points[count++][1] = 1;
+            points[count][0] = 0, points[count++][1] = ub;
+            points[count][0] = m, points[count++][1] = m + 1;
+            points[count][0] = m, points[count++][1] = ub;
+            break;
+        case DIRECTION_GT:
+            m = ub < ua - 1 ? ub : ua - 1;
+            if (m < 0) return 0;
+            points[count][0] = 1, points[count++][1] = 0;
+            points[count][0] = ua, points[count++][1] = 0;
+            points[count][0] = m + 1, points[count++][1] = m;
+            points[count][0] = ua, points[count++][1] = m;
+            break;
+        default:
+            points[count][0] = 0, points[count++][1] = 0;
+            points[count][0] = ua, points[count++][1] = 0;
+            points[count][0] = 0, points[count++][1] = ub;
+            points[count][0] = ua, points[count++][1] = ub;
+            break;
+    }
+    for (int p = 0; p < count; p++) {
+        int64_t value = a * points[p][0] - b * points[p][1];
+        if (p == 0 || value < *low) *low = value;
+        if (p == 0 || value > *high) *high = value;
+    }
+    return 1;
+}
+
+// Can the accesses meet with the paired loops in `directions`?
+static int feasible(const Problem* problem, const uint8_t* directions) {
+    if (problem->never) return 0;
+    int64_t low = problem->free_low, high = problem->free_high;
+    int64_t divisor = problem->free_gcd, shift = 0;
+    for (int i = 0; i < problem->levels; i++) {
+        int64_t a = problem->a[i], b = problem->b[i];
+        int64_t term_low, term_high;
+        if (!term_range(a, b, problem->ua[i], problem->ub[i], directions[i], &term_low, &term_high)) return 0;
+        low = saturating_add(low, term_low);
+        high = saturating_add(high, term_high);
+        // With k' = k + 1 + t (or k = k' + 1 + t), t >= 0, the term is
+        // (a - b) * k - b - b * t (or (a - b) * k' + a + a * t).
+        switch (directions[i]) {
+            case DIRECTION_EQ:
+                divisor = gcd(divisor, a - b);
+                break;
+            case DIRECTION_LT:
+                divisor = gcd(gcd(divisor, a - b), b);
+                shift -= b;
+                break;
+            case DIRECTION_GT:
+                divisor = gcd(gcd(divisor, a - b), a);
+                shift += a;
+                break;
+            default:
+                divisor = gcd(gcd(divisor, a), b);
+                break;
+        }
+    }
+    int64_t target = problem->difference - shift;
+    if (divisor == 0 ? target != 0 : target % divisor != 0) return 0;
+    return low <= problem->difference && problem->difference <= high;
+}
+
+// Direction bits seen per level over the feasible full vectors, split by
+// which access runs first: forward (A's iteration first, or the same
+// iterations), backward (B's first).
+typedef struct {
+    int found[2];
+    uint8_t direction[2][IR_DEPENDENCE_LEVELS];
+} Vectors;
+
+static void refine(const Problem* problem, uint8_t* directions, int level, Vectors* vectors) {
+    if (!feasible(problem, directions)) return;
+    if (level == problem->levels) {
+        int first = 0;
+        while (first < level && directions[first] == DIRECTION_EQ) first++;
+        int backward = first < level && directions[first] == DIRECTION_GT;
+        vectors->found[backward] = 1;
+        for (int i = 0; i < level; i++) vectors->direction[backward][i] |= directions[i];
+        return;
+    }
+    static const uint8_t splits[] = { DIRECTION_LT, DIRECTION_EQ, DIRECTION_GT };
+    for (int s = 0; s < 3; s++) {
+        directions[level] = splits[s];
+        refine(problem, directions, level + 1, vectors);
+    }
+    directions[level] = DIRECTION_ANY;
+}
+
+// ---------------------------------------------------------------------------
+// The analysis
+
+static IrDependenceKind kind_of(const IrFunction* function, const IrAccess* source, const IrAccess* sink) {
+    int source_store = function->insns[source->insn].op == IR_STORE;
+    int sink_store = function->insns[sink->insn].op == IR_STORE;
+    return source_store && sink_store ? DEPENDENCE_OUTPUT : source_store ? DEPENDENCE_FLOW : DEPENDENCE_ANTI;
+}
+
+static uint8_t reversed(uint8_t direction) {
+    return (uint8_t)((direction & DIRECTION_EQ) | (direction & DIRECTION_LT ? DIRECTION_GT : 0) |
+                     (direction & DIRECTION_GT ? DIRECTION_LT : 0));
+}
+
+static void add_dependence(IrDependences* dependences, int* capacity, const IrFunction* function, int source,
+                           int sink, const int* loops, int levels, const uint8_t* direction) {
+    if (dependences->count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 16;
+        dependences->dependences = checked(realloc(dependences->dependences, (size_t)*capacity * sizeof(IrDependence)));
+    }
+    IrDependence* dependence = &dependences->dependences[dependences->count++];
+    memset(dependence, 0, sizeof(*dependence));
+    dependence->source = source;
+    dependence->sink = sink;
+    dependence->kind = kind_of(function, &dependences->accesses[source], &dependences->accesses[sink]);
+    dependence->levels = levels;
+    memcpy(dependence->loops, loops, (size_t)levels * sizeof(int));
+    memcpy(dependence->direction, direction, (size_t)levels);
+}
+
+// A level that allows only "=" has distance 0. When the subscripts differ
+// only in their constants and every other level is "=", so is the last one:
+// its terms must make up the difference of the constants.
+static void set_distance(IrDependence* dependence, const IrAffine* source, const IrAffine* sink) {
+    int open = -1;
+    for (int i = 0; i < dependence->levels; i++) {
+        if (dependence->direction[i] == DIRECTION_EQ) {
+            dependence->has_distance |= (uint8_t)(1u << i);
+            dependence->distance[i] = 0;
+        } else if (open >= 0) {
+            return;
+        } else {
+            open = i;
+        }
+    }
+    if (open < 0 || source->term_count != sink->term_count) return;
+    for (int t = 0; t < source->term_count; t++) {
+        if (source->terms[t].loop != sink->terms[t].loop || source->terms[t].step != sink->terms[t].step) return;
+        int common = 0;
+        for (int i = 0; i < dependence->levels; i++) common |= dependence->loops[i] == source->terms[t].loop;
+        if (!common) return;
+    }
+    int64_t step = ir_affine_step(source, dependence->loops[open]);
+    int64_t difference = (int64_t)source->constant - (int64_t)sink->constant;
+    if (step == 0 || difference % step != 0) return;
+    dependence->has_distance |= (uint8_t)(1u << open);
+    dependence->distance[open] = (int32_t)(difference / step);
+}
+
+static void test_pair(IrDependences* dependences, int* capacity, const IrFunction* function, const IrLoops* loops,
+                      const IrInduction* induction, int first, int second) {
+    const IrAccess* a = &dependences->accesses[first];
+    const IrAccess* b = &dependences->accesses[second];
+    int chain_a[IR_DEPENDENCE_LEVELS], chain_b[IR_DEPENDENCE_LEVELS], common[IR_DEPENDENCE_LEVELS];
+    int depth_a = loops_around(loops, function->insns[a->insn].block, chain_a);
+    int depth_b = loops_around(loops, function->insns[b->insn].block, chain_b);
+    int levels = 0;
+    while (levels < depth_a && levels < depth_b && levels < IR_DEPENDENCE_LEVELS &&
+           chain_a[levels] == chain_b[levels]) {
+        common[levels] = chain_a[levels];
+        levels++;
+    }
+    // Outside a common loop only the order of the statements relates the
+    // two, and nothing asks about that.
+    if (levels == 0) return;
+    uint8_t any[IR_DEPENDENCE_LEVELS];
+    memset(any, DIRECTION_ANY, sizeof(any));
+
+    Problem problem;
+    if (a->slot == IR_NONE || b->slot == IR_NONE ||
+        !set_up(&problem, function, loops, induction, a, b, common, common, levels)) {
+        // Nothing known: either may come first, in any iterations.
+        add_dependence(dependences, capacity, function, first, second, common, levels, any);
+        if (first != second) add_dependence(dependences, capacity, function, second, first, common, levels, any);
+        return;
+    }
+    Vectors vectors = { { 0, 0 }, { { 0 }, { 0 } } };
+    uint8_t directions[IR_DEPENDENCE_LEVELS];
+    memcpy(directions, any, sizeof(directions));
+    refine(&problem, directions, 0, &vectors);
+
+    // All levels equal is the same iteration: the access that comes first
+    // in the body is the source, and an access is no dependence of itself.
+    if (vectors.found[0]) {
+        int same_iteration = 1;
+        for (int i = 0; i < levels; i++) same_iteration &= vectors.direction[0][i] == DIRECTION_EQ;
+        if (!(same_iteration && first == second)) {
+            add_dependence(dependences, capacity, function, first, second, common, levels, vectors.direction[0]);
+            set_distance(&dependences->dependences[dependences->count - 1], subscript(induction, a),
+                         subscript(induction, b));
+        }
+    }
+    if (vectors.found[1]) {
+        for (int i = 0; i < levels; i++) vectors.direction[1][i] = reversed(vectors.direction[1][i]);
+        add_dependence(dependences, capacity, function, second, first, common, levels, vectors.direction[1]);
+        set_distance(&dependences->dependences[dependences->count - 1], subscript(induction, b),
+                     subscript(induction, a));
+    }
+}
+
+// Carried by the loop at `level`: the same iteration of every outer loop,
+// an earlier one of this.
+static int carried_at(const IrDependence* dependence, int level) {
+    for (int i = 0; i < level; i++) {
+        if (!(dependence->direction[i] & DIRECTION_EQ)) return 0;
+    }
+    return (dependence->direction[level] & DIRECTION_LT) != 0;
+}
+
+void ir_compute_dependences(IrDependences* dependences, const IrFunction* function, const IrCfg* cfg,
+                            const IrLoops* loops, const IrInduction* induction) {
+    memset(dependences, 0, sizeof(*dependences));
+    int capacity = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        int count = 0;
+        for (int i = 0; i < cfg->count; i++) {
+            int block = cfg->order[i];
+            for (int insn = function->blocks[block].first; insn != IR_NONE; insn = function->insns[insn].next) {
+                IrOp op = (IrOp)function->insns[insn].op;
+                if (op != IR_LOAD && op != IR_STORE) continue;
+                if (pass == 1) {
+                    IrAccess* access = &dependences->accesses[count];
+                    int address = ir_args(function, insn)[0];
+                    const IrInsn* pointer = &function->insns[address];
+                    access->insn = insn;
+                    access->slot = IR_NONE;
+                    access->index = IR_NONE;
+                    access->loop = loops->innermost[block];
+                    if (pointer->op == IR_SLOT) {
+                        access->slot = pointer->imm;
+                    } else if (pointer->op == IR_ELEMENT) {
+                        const int32_t* element = ir_args(function, address);
+                        if (function->insns[element[0]].op == IR_SLOT) {
+                            access->slot = function->insns[element[0]].imm;
+                            access->index = element[1];
+                        }
+                    }
+                }
+                count++;
+            }
+        }
+        if (pass == 0) dependences->accesses = checked(calloc((size_t)(count > 0 ? count : 1), sizeof(IrAccess)));
+        dependences->access_count = count;
+    }
+
+    for (int i = 0; i < dependences->access_count && !dependences->truncated; i++) {
+        for (int j = i; j < dependences->access_count; j++) {
+            if (dependences->count >= IR_DEPENDENCE_LIMIT) {
+                dependences->truncated = 1;
+                break;
+            }
+            const IrAccess* a = &dependences->accesses[i];
+            const IrAccess* b = &dependences->accesses[j];
+            if (function->insns[a->insn].op != IR_STORE && function->insns[b->insn].op != IR_STORE) continue;
+            if (a->slot != IR_NONE && b->slot != IR_NONE && a->slot != b->slot) continue;
+            test_pair(dependences, &capacity, function, loops, induction, i, j);
+        }
+    }
+
+    // Loops nested too deeply for a dependence to record them, and all loops
+    // once the dependences stop being recorded, are taken to carry one that
+    // spans a single iteration.
+    dependences->carried = checked(calloc((size_t)(loops->count > 0 ? loops->count : 1), sizeof(uint8_t)));
+    dependences->span = checked(calloc((size_t)(loops->count > 0 ? loops->count : 1), sizeof(int32_t)));
+    for (int l = 0; l < loops->count; l++) {
+        int deep = loops->loops[l].depth > IR_DEPENDENCE_LEVELS || dependences->truncated;
+        dependences->carried[l] = (uint8_t)deep;
+        dependences->span[l] = deep ? 1 : INT32_MAX;
+    }
+    for (int d = 0; d < dependences->count; d++) {
+        const IrDependence* dependence = &dependences->dependences[d];
+        for (int level = 0; level < dependence->levels; level++) {
+            if (!carried_at(dependence, level)) continue;
+            int loop = dependence->loops[level];
+            dependences->carried[loop] = 1;
+            // A source earlier in the body still runs first for every lane.
+            if (dependence->source < dependence->sink) continue;
+            int32_t span = dependence->has_distance & (1u << level) ? dependence->distance[level] : 1;
+            if (span < dependences->span[loop]) dependences->span[loop] = span;
+        }
+    }
+}
+
+void ir_dependences_free(IrDependences* dependences) {
+    free(dependences->accesses);
+    free(dependences->dependences);
+    free(dependences->carried);
+    free(dependences->span);
+}
+
+// ---------------------------------------------------------------------------
+// Queries
+
+int ir_loop_carries_dependence(const IrDependences* dependences, int loop) {
+    return dependences->carried[loop];
+}
+
+int ir_loop_vectorizable(const IrDependences* dependences, const IrLoops* loops, int loop, int width) {
+    return loops->loops[loop].first_child == IR_NONE && width <= dependences->span[loop];
+}
+
+static int same_affine(const IrAffine* a, const IrAffine* b) {
+    if (a->constant != b->constant || a->base != b->base || a->scale != b->scale || a->term_count != b->term_count) {
+        return 0;
+    }
+    for (int t = 0; t < a->term_count; t++) {
+        if (a->terms[t].loop != b->terms[t].loop || a->terms[t].step != b->terms[t].step) return 0;
+    }
+    return 1;
+}
+
+static int same_trip_count(const IrTripCount* a, const IrTripCount* b) {
+    if (a->kind == TRIP_UNKNOWN || a->kind != b->kind || !a->exact || !b->exact) return 0;
+    if (a->kind == TRIP_CONSTANT) return a->count == b->count;
+    return a->op == b->op && a->step == b->step && same_affine(&a->start, &b->start) &&
+           same_affine(&a->limit, &b->limit);
+}
+
+int ir_loops_fusable(const IrFunction* function, const IrLoops* loops, const IrInduction* induction,
+                     const IrDependences* dependences, int first, int second) {
+    const IrLoop* before = &loops->loops[first];
+    const IrLoop* after = &loops->loops[second];
+    if (dependences->truncated || before->parent != after->parent || before->depth > IR_DEPENDENCE_LEVELS) return 0;
+    if (!same_trip_count(&induction->trips[first], &induction->trips[second])) return 0;
+    // Adjacent: the first leaves straight into the preheader of the second,
+    // which touches no memory.
+    if (before->exit_count != 1 || after->preheader == IR_NONE ||
+        function->edges[before->exits[0]].to != after->preheader) {
+        return 0;
+    }
+    for (int insn = function->blocks[after->preheader].first; insn != IR_NONE; insn = function->insns[insn].next) {
+        IrOp op = (IrOp)function->insns[insn].op;
+        if (op == IR_LOAD || op == IR_STORE || op == IR_CALL) return 0;
+    }
+
+    // Pair the loops around both, then the two loops themselves; fusing is
+    // wrong if an access of the first can meet one of the second in an
+    // earlier iteration.
+    int pair_a[IR_DEPENDENCE_LEVELS], pair_b[IR_DEPENDENCE_LEVELS];
+    int levels = 0;
+    for (int l = before->parent; l != IR_NONE; l = loops->loops[l].parent) levels++;
+    int level = levels;
+    for (int l = before->parent; l != IR_NONE; l = loops->loops[l].parent) {
+        level--;
+        pair_a[level] = pair_b[level] = l;
+    }
+    pair_a[levels] = first;
+    pair_b[levels] = second;
+    uint8_t directions[IR_DEPENDENCE_LEVELS];
+    memset(directions, DIRECTION_EQ, sizeof(directions));
+    directions[levels] = DIRECTION_GT;
+
+    for (int i = 0; i < dependences->access_count; i++) {
+        const IrAccess* a = &dependences->accesses[i];
+        if (!ir_loop_contains(loops, first, function->insns[a->insn].block)) continue;
+        for (int j = 0; j < dependences->access_count; j++) {
+            const IrAccess* b = &dependences->accesses[j];
+            if (!ir_loop_contains(loops, second, function->insns[b->insn].block)) continue;
+            if (function->insns[a->insn].op != IR_STORE && function->insns[b->insn].op != IR_STORE) continue;
+            if (a->slot != IR_NONE && b->slot != IR_NONE && a->slot != b->slot) continue;
+            Problem problem;
+            if (a->slot == IR_NONE || b->slot == IR_NONE ||
+                !set_up(&problem, function, loops, induction, a, b, pair_a, pair_b, levels + 1) ||
+                feasible(&problem, directions)) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+// ---------------------------------------------------------------------------
+// Remarks
+
+static const char* direction_text(uint8_t direction) {
+    static const char* const texts[] = { "none", "<", "=", "<=", ">", "<>", ">=", "*" };
+    return texts[direction & DIRECTION_ANY];
+}
+
+static int loop_line(const IrFunction* function, const IrLoops* loops, int loop) {
+    int branch = ir_terminator(function, loops->loops[loop].header);
+    return branch != IR_NONE ? function->insns[branch].line : 0;
+}
+
+#define VECTOR_WIDTH 4
+
+PassResult ir_report_dependences(IrFunction* function, PassContext* context) {
+    if (!remarks_enabled) return (PassResult){ 0, PRESERVE_CFG };
+    const IrLoops* loops = pass_loops(context);
+    const IrInduction* induction = pass_induction(context);
+    const IrDependences* dependences = pass_dependences(context);
+    static const char* const kinds[] = { "flow", "anti", "output" };
+
+    for (int d = 0; d < dependences->count; d++) {
+        const IrDependence* dependence = &dependences->dependences[d];
+        if (dependence->levels == 0) continue;
+        const IrAccess* source = &dependences->accesses[dependence->source];
+        const IrAccess* sink = &dependences->accesses[dependence->sink];
+        char vector[IR_DEPENDENCE_LEVELS * 24 + 4];
+        size_t used = 0;
+        for (int i = 0; i < dependence->levels && used < sizeof(vector); i++) {
+            int written = dependence->has_distance & (1u << i)
+                              ? snprintf(vector + used, sizeof(vector) - used, "%s%d", i ? ", " : "",
+                                         dependence->distance[i])
+                              : snprintf(vector + used, sizeof(vector) - used, "%s%s", i ? ", " : "",
+                                         direction_text(dependence->direction[i]));
+            if (written > 0) used += (size_t)written;
+        }
+        const char* array = source->slot != IR_NONE ? ir_string(function, function->slots[source->slot].name)
+                                                    : "memory";
+        remark(REMARK_ANALYSIS, "dependences", "Dependence", function->name, function->insns[sink->insn].line,
+               "%s dependence on %s from line %d, vector (%s)", kinds[dependence->kind], array,
+               function->insns[source->insn].line, vector);
+    }
+
+    for (int l = 0; l < loops->count; l++) {
+        int line = loop_line(function, loops, l);
+        if (!ir_loop_carries_dependence(dependences, l)) {
+            remark(REMARK_ANALYSIS, "dependences", "Parallel", function->name, line,
+                   "iterations of the loop are independent and can run in any order");
+        } else {
+            remark(REMARK_ANALYSIS, "dependences", "Carried", function->name, line,
+                   "the loop carries a dependence from one iteration to a later one");
+        }
+        if (loops->loops[l].first_child == IR_NONE && ir_loop_vectorizable(dependences, loops, l, VECTOR_WIDTH)) {
+            remark(REMARK_ANALYSIS, "dependences", "Vectorizable", function->name, line,
+                   "%d iterations of the loop can run at once", VECTOR_WIDTH);
+        }
+        for (int m = 0; m < loops->count; m++) {
+            if (m != l && ir_loops_fusable(function, loops, induction, dependences, l, m)) {
+                remark(REMARK_ANALYSIS, "dependences", "Fusable", function->name, line,
+                       "the loop can be fused with the loop on line %d", loop_line(function, loops, m));
+            }
+        }
+    }
+    return (PassResult){ 0, PRESERVE_CFG };
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "dataflow.h"
+#include "induction.h"
+#include "ir.h"
+#include <stdint.h>
+
+// Dependences between the loads and stores of frame arrays.
+// Subscripts are the affine forms of the induction analysis; two accesses
+// to the same array conflict when their subscripts can be equal, which a
+// GCD test and Banerjee's bounds decide per direction vector over the
+// loops around both, each loop's iterations bounded by its trip count.
+// Loops are assumed to run fewer than 2^31 times (beyond that every
+// subscript that moves with them would wrap out of its array). Accesses
+// whose subscripts the forms cannot describe depend on everything. Only
+// pairs inside a common loop are recorded, at most IR_DEPENDENCE_LIMIT.
+#define IR_DEPENDENCE_LEVELS 8
+#define IR_DEPENDENCE_LIMIT (1 << 16)
+
+#define DIRECTION_LT 1          // the source runs in an earlier iteration
+#define DIRECTION_EQ 2
+#define DIRECTION_GT 4
+#define DIRECTION_ANY 7
+
+typedef struct {
+    int insn;                   // the load or store
+    int slot;                   // IR_NONE if unknown
+    int index;                  // subscript value, IR_NONE for the slot's first word
+    int loop;                   // innermost loop around it, or IR_NONE
+} IrAccess;
+
+typedef enum {
+    DEPENDENCE_FLOW,            // store, then a load of the word
+    DEPENDENCE_ANTI,            // load, then a store
+    DEPENDENCE_OUTPUT           // store, then a store
+} IrDependenceKind;
+
+typedef struct {
+    int source, sink;           // accesses, in execution order
+    IrDependenceKind kind;
+    int levels;                 // loops around both, outermost first (at most IR_DEPENDENCE_LEVELS)
+    int loops[IR_DEPENDENCE_LEVELS];
+    uint8_t direction[IR_DEPENDENCE_LEVELS];  // DIRECTION_ bits possible per level
+    uint8_t has_distance;       // bit per level whose distance is known
+    int32_t distance[IR_DEPENDENCE_LEVELS];   // sink iteration minus source iteration
+} IrDependence;
+
+typedef struct {
+    IrAccess* accesses;         // in reverse postorder
+    int access_count;
+    IrDependence* dependences;
+    int count;
+    int truncated;              // more than IR_DEPENDENCE_LIMIT: all loops are taken to carry one
+    uint8_t* carried;           // per loop, whether it carries a dependence
+    int32_t* span;              // per loop, fewest iterations a dependence it carries backwards spans
+} IrDependences;
+
+void ir_compute_dependences(IrDependences* dependences, const IrFunction* function, const IrCfg* cfg,
+                            const IrLoops* loops, const IrInduction* induction);
+void ir_dependences_free(IrDependences* dependences);
+// Does some dependence run from one iteration of `loop` to a later one?
+// Without one, its iterations can run in any order.
+int ir_loop_carries_dependence(const IrDependences* dependences, int loop);
+// Can an innermost loop run `width` iterations at once, as vector code
+// does: every dependence it carries goes forward in the body, or spans at
+// least `width` iterations.
+int ir_loop_vectorizable(const IrDependences* dependences, const IrLoops* loops, int loop, int width);
+// Can two loops, the second right after the first, run as one: same trip
+// count, and no dependence from an iteration of the first to an earlier
+// iteration of the second.
+int ir_loops_fusable(const IrFunction* function, const IrLoops* loops, const IrInduction* induction,
+                     const IrDependences* dependences, int first, int second);
@@ -0,0 +1,538 @@
+#define _GNU_SOURCE
+#include "distrib.h"
+#include "compiler.h"
+#include "driver.h"
+#include "remarks.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#define DIST_MAX_PAYLOAD (64u * 1024 * 1024)
+
+typedef struct {
+    const char* input_path;
+    char* output_path;
+    char* source;
+    size_t source_len;
+    int attempts;
+    int failed;
+} DistJob;
+
+// Coordinator sockets are non-blocking and driven from one poll loop, so
+// a worker writing a large reply never waits on a coordinator that is
+// stuck writing it a large request.
+typedef struct {
+    char* address;
+    int fd;
+    int jobs[DIST_WINDOW];    // outstanding requests, oldest first
+    int head;
+    int count;
+    int sent;                 // of those, requests written out completely
+    size_t send_offset;       // into the next request, header included
+    uint32_t reply[3];        // reply being received
+    size_t received;          // of its header and payload
+    char* payload;
+    double last_activity;     // ms; a worker is lost after timeout_ms without progress
+    int completed;
+} Worker;
+
+static int read_full(int fd, void* data, size_t len) {
+    char* p = data;
+    while (len > 0) {
+        ssize_t n = recv(fd, p, len, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static int write_full(int fd, const void* data, size_t len) {
+    const char* p = data;
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+// Splits "host:port" (or just "port", on default_host) into getaddrinfo()
+// arguments.
+static struct addrinfo* resolve(const char* address, const char* default_host) {
+    char host[256] = "";
+    const char* port = address;
+    const char* colon = strrchr(address, ':');
+    if (colon) {
+        size_t len = (size_t)(colon - address);
+        if (len >= sizeof(host)) return NULL;
+        memcpy(host, address, len);
+        host[len] = '\0';
+        port = colon + 1;
+    }
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* result = NULL;
+    if (getaddrinfo(host[0] ? host : default_host, port, &hints, &result) != 0) return NULL;
+    return result;
+}
+
+/* ---- worker ---- */
+
+// OptLimits travel as four saturated 32-bit words.
+static void encode_limits(const OptLimits* limits, uint32_t* words) {
+    double values[4] = { (double)limits->function_fuel, (double)limits->compile_fuel, limits->function_ms * 1e3,
+                         limits->compile_ms * 1e3 };
+    for (int i = 0; i < 4; i++) {
+        uint32_t value = values[i] <= 0 ? 0 : values[i] >= (double)UINT32_MAX ? UINT32_MAX : (uint32_t)values[i];
+        words[i] = htonl(value);
+    }
+}
+
+static void decode_limits(const uint32_t* words, OptLimits* limits) {
+    limits->function_fuel = (long)ntohl(words[0]);
+    limits->compile_fuel = (long)ntohl(words[1]);
+    limits->function_ms = ntohl(words[2]) / 1e3;
+    limits->compile_ms = ntohl(words[3]) / 1e3;
+}
+
+static void serve_connection(int fd) {
+    for (;;) {
+        uint32_t header[8];
+        if (read_full(fd, header, sizeof(header)) != 0) break;
+        uint32_t magic = ntohl(header[0]);
+        if (magic != (DIST_MAGIC | DIST_VERSION)) {
+            if ((magic & ~0xFFu) == DIST_MAGIC) {
+                uint32_t reply[3] = { htonl(DIST_MAGIC | DIST_VERSION), htonl(DIST_STATUS_VERSION), 0 };
+                write_full(fd, reply, sizeof(reply));
+            }
+            break;
+        }
+        uint32_t level = ntohl(header[1]);
+        uint32_t flags = ntohl(header[2]);
+        OptLimits limits;
+        decode_limits(header + 3, &limits);
+        uint32_t len = ntohl(header[7]);
+        if (level > OPT_OS || len > DIST_MAX_PAYLOAD) break;
+        compile_buffer_set_options((OptLevel)level, (flags & DIST_FLAG_IR) != 0, &limits);
+        char* source = malloc(len ? len : 1);
+        if (source == NULL || read_full(fd, source, len) != 0) {
+            free(source);
+            break;
+        }
+
+        char* output = NULL;
+        size_t output_len = 0;
+        uint32_t status = DIST_STATUS_OK;
+        if (compile_buffer(source, len, &output, &output_len) != 0) {
+            status = DIST_STATUS_FAILED;
+            char message[64];
+            snprintf(message, sizeof(message), "Compilation failed at line %d", yylineno);
+            output = strdup(message);
+            output_len = strlen(message);
+        }
+        free(source);
+
+        uint32_t reply[3] = { htonl(DIST_MAGIC | DIST_VERSION), htonl(status), htonl((uint32_t)output_len) };
+        int sent = write_full(fd, reply, sizeof(reply)) == 0 && write_full(fd, output, output_len) == 0;
+        free(output);
+        if (!sent) break;
+    }
+    close(fd);
+}
+
+int run_worker(const char* address) {
+    // The protocol has no authentication: only listen beyond this machine
+    // when asked to by name.
+    struct addrinfo* info = resolve(address, "127.0.0.1");
+    if (!info) {
+        fprintf(stderr, "Error: Cannot resolve %s\n", address);
+        return 1;
+    }
+    int listener = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+    int one = 1;
+    if (listener >= 0) setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (listener < 0 || bind(listener, info->ai_addr, info->ai_addrlen) != 0 || listen(listener, 16) != 0) {
+        fprintf(stderr, "Error: Cannot listen on %s: %s\n", address, strerror(errno));
+        freeaddrinfo(info);
+        return 1;
+    }
+    freeaddrinfo(info);
+
+    // Each coordinator connection gets its own process: the compiler keeps
+    // its state in globals, and a crash only costs that connection. At most
+    // DIST_MAX_CONNECTIONS of them run at once; further connections wait in
+    // the listen backlog until one ends.
+    printf("Worker listening on %s\n", address);
+    fflush(stdout);
+    int children = 0;
+    for (;;) {
+        while (children > 0 && waitpid(-1, NULL, WNOHANG) > 0) children--;
+        while (children >= DIST_MAX_CONNECTIONS) {
+            if (waitpid(-1, NULL, 0) > 0) {
+                children--;
+            } else if (errno != EINTR) {
+                children = 0;
+            }
+        }
+        int fd = accept(listener, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "Error: accept failed: %s\n", strerror(errno));
+            close(listener);
+            return 1;
+        }
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(listener);
+            serve_connection(fd);
+            _exit(0);
+        }
+        if (pid > 0) {
+            children++;
+        } else {
+            fprintf(stderr, "Warning: fork failed: %s\n", strerror(errno));
+        }
+        close(fd);
+    }
+}
+
+/* ---- coordinator ---- */
+
+static int connect_worker(const char* address) {
+    struct addrinfo* info = resolve(address, NULL);
+    if (!info) return -1;
+    int fd = -1;
+    for (struct addrinfo* ai = info; ai && fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd >= 0 && connect(fd, ai->ai_addr, ai->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(info);
+    if (fd >= 0) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+    return fd;
+}
+
+static double now_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1e3 + (double)now.tv_nsec / 1e6;
+}
+
+static void finish_job(DistJob* job, int ok, char* output, size_t output_len) {
+    if (!ok) {
+        fprintf(stderr, "%s: %.*s\n", job->input_path, (int)output_len, output ? output : "");
+        job->failed = 1;
+    } else if (write_output_file(job->output_path, output, output_len) != 0) {
+        fprintf(stderr, "Error: Cannot create output file %s\n", job->output_path);
+        job->failed = 1;
+    }
+    free(output);
+    free(job->source);
+    job->source = NULL;
+}
+
+static void compile_locally(DistJob* job) {
+    char* output = NULL;
+    size_t output_len = 0;
+    remarks_set_source(job->input_path);
+    if (compile_buffer(job->source, job->source_len, &output, &output_len) != 0) {
+        char message[64];
+        snprintf(message, sizeof(message), "Compilation failed at line %d", yylineno);
+        finish_job(job, 0, strdup(message), strlen(message));
+    } else {
+        finish_job(job, 1, output, output_len);
+    }
+}
+
+typedef struct {
+    DistJob* jobs;
+    int* pending;       // ring of job indices waiting to be sent
+    int pending_head;
+    int pending_count;
+    int capacity;
+    uint32_t level;
+    uint32_t flags;
+    uint32_t limits[4];         // encoded OptLimits
+    int timeout_ms;
+    int done;
+    int retried;
+    int local;
+} Coordinator;
+
+static void push_pending(Coordinator* c, int job) {
+    c->pending[(c->pending_head + c->pending_count) % c->capacity] = job;
+    c->pending_count++;
+}
+
+static int pop_pending(Coordinator* c) {
+    int job = c->pending[c->pending_head];
+    c->pending_head = (c->pending_head + 1) % c->capacity;
+    c->pending_count--;
+    return job;
+}
+
+// Jobs the worker still owed are sent again elsewhere, or compiled here once
+// they have been tried often enough.
+static void lose_worker(Coordinator* c, Worker* worker, const char* reason) {
+    fprintf(stderr, "Warning: Lost worker %s (%s)\n", worker->address, reason);
+    close(worker->fd);
+    worker->fd = -1;
+    free(worker->payload);
+    worker->payload = NULL;
+    for (int i = 0; i < worker->count; i++) {
+        int index = worker->jobs[(worker->head + i) % DIST_WINDOW];
+        DistJob* job = &c->jobs[index];
+        if (job->attempts >= DIST_MAX_ATTEMPTS) {
+            compile_locally(job);
+            c->local++;
+            c->done++;
+        } else {
+            push_pending(c, index);
+            c->retried++;
+        }
+    }
+    worker->count = 0;
+    worker->sent = 0;
+    worker->send_offset = 0;
+    worker->received = 0;
+}
+
+// Writes as much of the queued requests as the socket takes. Returns NULL
+// unless the worker is unusable, and then why.
+static const char* send_requests(Coordinator* c, Worker* worker) {
+    while (worker->sent < worker->count) {
+        DistJob* job = &c->jobs[worker->jobs[(worker->head + worker->sent) % DIST_WINDOW]];
+        uint32_t header[8] = { htonl(DIST_MAGIC | DIST_VERSION), htonl(c->level), htonl(c->flags), c->limits[0],
+                               c->limits[1], c->limits[2], c->limits[3], htonl((uint32_t)job->source_len) };
+        const char* data;
+        size_t left;
+        if (worker->send_offset < sizeof(header)) {
+            data = (const char*)header + worker->send_offset;
+            left = sizeof(header) - worker->send_offset;
+        } else {
+            data = job->source + (worker->send_offset - sizeof(header));
+            left = sizeof(header) + job->source_len - worker->send_offset;
+        }
+        ssize_t n = left ? send(worker->fd, data, left, MSG_NOSIGNAL) : 0;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return NULL;
+            return "send failed";
+        }
+        worker->last_activity = now_ms();
+        worker->send_offset += (size_t)n;
+        if (worker->send_offset == sizeof(header) + job->source_len) {
+            worker->sent++;
+            worker->send_offset = 0;
+        }
+    }
+    return NULL;
+}
+
+// Reads whatever reply bytes have arrived and finishes the jobs whose
+// replies are complete. Returns NULL unless the worker is unusable, and
+// then why.
+static const char* receive_replies(Coordinator* c, Worker* worker) {
+    for (;;) {
+        size_t header = sizeof(worker->reply);
+        uint32_t len = ntohl(worker->reply[2]);
+        ssize_t n;
+        if (worker->received < header) {
+            n = recv(worker->fd, (char*)worker->reply + worker->received, header - worker->received, 0);
+        } else {
+            n = recv(worker->fd, worker->payload + (worker->received - header), header + len - worker->received,
+                     0);
+        }
+        if (n == 0) return "connection lost";
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return NULL;
+            return "connection lost";
+        }
+        worker->last_activity = now_ms();
+        worker->received += (size_t)n;
+        if (worker->received == header) {
+            if ((ntohl(worker->reply[0]) & ~0xFFu) != DIST_MAGIC) return "not a worker";
+            if (ntohl(worker->reply[0]) != (DIST_MAGIC | DIST_VERSION)
+                || ntohl(worker->reply[1]) == DIST_STATUS_VERSION) {
+                return "protocol version mismatch";
+            }
+            if (worker->sent == 0) return "unexpected reply";
+            len = ntohl(worker->reply[2]);
+            if (len > DIST_MAX_PAYLOAD) return "reply too large";
+            worker->payload = malloc(len ? len : 1);
+            if (worker->payload == NULL) return "out of memory";
+        }
+        if (worker->received < header || worker->received < header + ntohl(worker->reply[2])) continue;
+
+        int index = worker->jobs[worker->head];
+        worker->head = (worker->head + 1) % DIST_WINDOW;
+        worker->count--;
+        worker->sent--;
+        worker->completed++;
+        finish_job(&c->jobs[index], ntohl(worker->reply[1]) == DIST_STATUS_OK, worker->payload,
+                   ntohl(worker->reply[2]));
+        worker->payload = NULL;
+        worker->received = 0;
+        c->done++;
+    }
+}
+
+static Worker* least_loaded(Worker* workers, int count) {
+    Worker* best = NULL;
+    for (int i = 0; i < count; i++) {
+        Worker* worker = &workers[i];
+        if (worker->fd < 0 || worker->count == DIST_WINDOW) continue;
+        if (!best || worker->count < best->count) best = worker;
+    }
+    return best;
+}
+
+int distributed_compile(char** inputs, int count, const char* workers_spec, OptLevel level, int use_ir,
+                        const OptLimits* limits, int timeout_ms) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    Coordinator c;
+    memset(&c, 0, sizeof(c));
+    c.capacity = count ? count : 1;
+    c.level = (uint32_t)level;
+    c.flags = use_ir ? DIST_FLAG_IR : 0;
+    OptLimits none = {0};
+    encode_limits(limits ? limits : &none, c.limits);
+    c.timeout_ms = timeout_ms;
+    c.jobs = calloc((size_t)c.capacity, sizeof(DistJob));
+    c.pending = calloc((size_t)c.capacity, sizeof(int));
+    if (!c.jobs || !c.pending) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    for (int i = 0; i < count; i++) {
+        DistJob* job = &c.jobs[i];
+        job->input_path = inputs[i];
+        job->output_path = assembly_path_for(inputs[i]);
+        if (read_source_file(inputs[i], &job->source, &job->source_len) != 0) {
+            fprintf(stderr, "Error: Cannot open file %s\n", inputs[i]);
+            job->failed = 1;
+            c.done++;
+        } else {
+            push_pending(&c, i);
+        }
+    }
+
+    int worker_count = 0;
+    Worker* workers = NULL;
+    char* spec = strdup(workers_spec);
+    char* saveptr = NULL;
+    for (char* address = strtok_r(spec, ",", &saveptr); address; address = strtok_r(NULL, ",", &saveptr)) {
+        workers = realloc(workers, (size_t)(worker_count + 1) * sizeof(Worker));
+        Worker* worker = &workers[worker_count++];
+        memset(worker, 0, sizeof(*worker));
+        worker->address = strdup(address);
+        worker->fd = connect_worker(address);
+        if (worker->fd < 0) fprintf(stderr, "Warning: Cannot connect to worker %s\n", address);
+    }
+    free(spec);
+
+    struct pollfd* fds = calloc((size_t)(worker_count ? worker_count : 1), sizeof(struct pollfd));
+    Worker** polled = calloc((size_t)(worker_count ? worker_count : 1), sizeof(Worker*));
+    while (c.done < count) {
+        Worker* worker;
+        while (c.pending_count > 0 && (worker = least_loaded(workers, worker_count)) != NULL) {
+            int index = pop_pending(&c);
+            c.jobs[index].attempts++;
+            if (worker->count == 0) worker->last_activity = now_ms();
+            worker->jobs[(worker->head + worker->count) % DIST_WINDOW] = index;
+            worker->count++;
+        }
+
+        int nfds = 0;
+        int wait_ms = -1;
+        double now = now_ms();
+        for (int i = 0; i < worker_count; i++) {
+            if (workers[i].fd >= 0 && workers[i].count > 0) {
+                fds[nfds].fd = workers[i].fd;
+                fds[nfds].events = POLLIN | (workers[i].sent < workers[i].count ? POLLOUT : 0);
+                polled[nfds++] = &workers[i];
+                if (c.timeout_ms > 0) {
+                    double left = workers[i].last_activity + c.timeout_ms - now;
+                    int left_ms = left > 0 ? (int)left + 1 : 0;
+                    if (wait_ms < 0 || left_ms < wait_ms) wait_ms = left_ms;
+                }
+            }
+        }
+        if (nfds == 0) {
+            // No worker left: finish everything here.
+            while (c.pending_count > 0) {
+                compile_locally(&c.jobs[pop_pending(&c)]);
+                c.local++;
+                c.done++;
+            }
+            break;
+        }
+
+        int ready = poll(fds, (nfds_t)nfds, wait_ms);
+        if (ready < 0 && errno == EINTR) continue;
+        now = now_ms();
+        for (int i = 0; i < nfds; i++) {
+            worker = polled[i];
+            const char* problem = NULL;
+            if (fds[i].revents & POLLOUT) problem = send_requests(&c, worker);
+            if (!problem && (fds[i].revents & (POLLIN | POLLHUP | POLLERR))) problem = receive_replies(&c, worker);
+            if (!problem && worker->count > 0 && c.timeout_ms > 0 && now - worker->last_activity >= c.timeout_ms) {
+                problem = "timed out";
+            }
+            if (problem) lose_worker(&c, worker, problem);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    int failures = 0, alive = 0;
+    for (int i = 0; i < count; i++) {
+        failures += c.jobs[i].failed;
+        free(c.jobs[i].source);
+        free(c.jobs[i].output_path);
+    }
+    for (int i = 0; i < worker_count; i++) {
+        if (workers[i].fd >= 0) {
+            alive++;
+            close(workers[i].fd);
+        }
+        printf("  worker %-24s %d files\n", workers[i].address, workers[i].completed);
+        free(workers[i].address);
+    }
+    double ms = (double)(end.tv_sec - start.tv_sec) * 1e3 + (double)(end.tv_nsec - start.tv_nsec) / 1e6;
+    printf("Compiled %d of %d files on %d of %d workers (%d resent, %d local) in %.2f ms\n",
+           count - failures, count, alive, worker_count, c.retried, c.local, ms);
+
+    free(fds);
+    free(polled);
+    free(workers);
+    free(c.jobs);
+    free(c.pending);
+    return failures;
+}
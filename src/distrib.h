@@ -0,0 +1,43 @@
+#pragma once
+
+#include "passes.h"
+
+// Distributed compilation over TCP. Workers ("compiler --worker=[host:]port")
+// compile source buffers they receive and send the assembly back. Requests
+// are not authenticated, so a worker listens on the loopback interface
+// unless it is given a host ("0.0.0.0:port" for every interface). The
+// coordinator spreads inputs over its workers, keeps each one busy with a
+// small window of requests, re-sends the work of a worker it loses and
+// compiles locally when no worker is left.
+//
+// Wire format, all integers big-endian:
+//   request: magic, optimization level, flags, function fuel, compile fuel,
+//            function and compile time limits in microseconds (OptLimits,
+//            saturated; 0 for none), source length, source bytes
+//   reply:   magic, status, payload length, assembly or error text
+// The magic's last byte is the protocol version. A worker answers a request
+// of another version with DIST_STATUS_VERSION and closes the connection;
+// the coordinator then stops using it.
+
+#define DIST_MAGIC        0x53434400u   // "SCD" and the version
+#define DIST_VERSION      2
+#define DIST_FLAG_IR      1u            // IR back end at -O0 (-fir)
+#define DIST_STATUS_OK      0
+#define DIST_STATUS_FAILED  1           // compilation error; the payload says where
+#define DIST_STATUS_VERSION 2
+#define DIST_WINDOW       2             // requests in flight per worker
+#define DIST_MAX_ATTEMPTS 3             // sends per input before compiling locally
+#define DIST_TIMEOUT_MS   10000         // default --worker-timeout
+#define DIST_MAX_CONNECTIONS 32         // connections a worker serves at once
+
+int run_worker(const char* address);
+
+// workers is a comma-separated "host:port" list. Every input "name.c" is
+// compiled to "name.s" at `level`, with the IR back end if use_ir is set;
+// inputs compiled locally use the compile_buffer options, which the caller
+// sets to match. limits (NULL for none) bound each file's optimization. A worker that owes replies and neither takes request bytes
+// nor sends reply bytes for timeout_ms (0: never) is given up on, so the
+// timeout bounds the compile time of one file rather than of a whole window.
+// Returns the number of inputs that failed.
+int distributed_compile(char** inputs, int count, const char* workers, OptLevel level, int use_ir,
+                        const OptLimits* limits, int timeout_ms);
@@ -0,0 +1,124 @@
+#define _POSIX_C_SOURCE 200809L
+#include "driver.h"
+#include "compiler.h"
+#include "riscv.h"
+#include "phase.h"
+#include "memstats.h"
+#include "ir.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+typedef struct yy_buffer_state* YY_BUFFER_STATE;
+YY_BUFFER_STATE yy_scan_bytes(const char* bytes, int len);
+void yy_delete_buffer(YY_BUFFER_STATE buffer);
+
+static OptLevel buffer_level = OPT_O0;
+static int buffer_use_ir;
+static OptLimits buffer_limits;
+
+void compile_buffer_set_options(OptLevel level, int use_ir, const OptLimits* limits) {
+    buffer_level = level;
+    buffer_use_ir = use_ir || level != OPT_O0;
+    if (limits) {
+        buffer_limits = *limits;
+    } else {
+        memset(&buffer_limits, 0, sizeof(buffer_limits));
+    }
+}
+
+int compile_buffer(const char* source, size_t len, char** asm_out, size_t* asm_len) {
+    *asm_out = NULL;
+    *asm_len = 0;
+
+    root = NULL;
+    yylineno = 1;
+    phase_begin(PHASE_PARSE);
+    YY_BUFFER_STATE buffer = yy_scan_bytes(source, (int)len);
+    int parsed = yyparse() == 0;
+    yy_delete_buffer(buffer);
+    phase_end(PHASE_PARSE);
+
+    if (!parsed) {
+        free_ast(root);
+        root = NULL;
+        return -1;
+    }
+
+    FILE* output = open_memstream(asm_out, asm_len);
+    if (!output) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    phase_begin(PHASE_CODEGEN);
+    // Both back ends number labels from the generator's counter.
+    reset_codegen_state();
+    if (buffer_use_ir) {
+        OptBudget budget;
+        opt_budget_init(&budget, &buffer_limits);
+        ir_generate_code(root, output, NULL, buffer_level, &budget);
+        opt_budget_free(&budget);
+    } else {
+        generate_riscv_code(root, output);
+    }
+    fclose(output);
+    phase_end(PHASE_CODEGEN);
+
+    mem_record_functions(root);
+    free_ast(root);
+    root = NULL;
+    return 0;
+}
+
+char* assembly_path_for(const char* input) {
+    size_t len = strlen(input);
+    if (len > 2 && strcmp(input + len - 2, ".c") == 0) len -= 2;
+    char* path = malloc(len + 3);
+    if (path == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    memcpy(path, input, len);
+    strcpy(path + len, ".s");
+    return path;
+}
+
+int read_source_file(const char* path, char** data, size_t* len) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+    char* buffer = malloc(st.st_size ? (size_t)st.st_size : 1);
+    size_t total = 0;
+    while (buffer && total < (size_t)st.st_size) {
+        ssize_t n = read(fd, buffer + total, (size_t)st.st_size - total);
+        if (n <= 0) break;
+        total += (size_t)n;
+    }
+    close(fd);
+    if (buffer == NULL || total != (size_t)st.st_size) {
+        free(buffer);
+        return -1;
+    }
+    *data = buffer;
+    *len = total;
+    return 0;
+}
+
+int write_output_file(const char* path, const char* data, size_t len) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return -1;
+    size_t total = 0;
+    while (total < len) {
+        ssize_t n = write(fd, data + total, len - total);
+        if (n <= 0) break;
+        total += (size_t)n;
+    }
+    return close(fd) == 0 && total == len ? 0 : -1;
+}
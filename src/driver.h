@@ -0,0 +1,19 @@
+#pragma once
+
+#include "passes.h"
+#include <stddef.h>
+
+// Compiles one Small C translation unit held in memory. On success returns 0
+// and stores a malloc'ed, NUL-terminated assembly listing in *asm_out.
+// The lexer, parser and code generator are global, so this is not reentrant.
+int compile_buffer(const char* source, size_t len, char** asm_out, size_t* asm_len);
+// Code generation used by compile_buffer: the direct generator at -O0
+// unless use_ir is set, the IR pipeline of `level` otherwise. Each buffer
+// gets its own optimization budget from limits (NULL for none), so
+// -fopt-fuel-total and -fopt-deadline apply per file.
+void compile_buffer_set_options(OptLevel level, int use_ir, const OptLimits* limits);
+
+// "dir/name.c" -> "dir/name.s"; the result is malloc'ed.
+char* assembly_path_for(const char* input);
+int read_source_file(const char* path, char** data, size_t* len);
+int write_output_file(const char* path, const char* data, size_t len);
@@ -0,0 +1,127 @@
+#include "frame.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void* xcalloc(size_t count, size_t size) {
+    void* data = calloc(count ? count : 1, size);
+    if (data == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    return data;
+}
+
+void frame_init(FrameLayout* layout) {
+    memset(layout, 0, sizeof(*layout));
+}
+
+void frame_free(FrameLayout* layout) {
+    free(layout->objects);
+    memset(layout, 0, sizeof(*layout));
+}
+
+int frame_add(FrameLayout* layout, int words, int array) {
+    if (layout->count == layout->capacity) {
+        layout->capacity = layout->capacity ? layout->capacity * 2 : 16;
+        layout->objects = realloc(layout->objects, (size_t)layout->capacity * sizeof(FrameObject));
+        if (layout->objects == NULL) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(1);
+        }
+    }
+    layout->objects[layout->count] = (FrameObject){ words, array, INT_MAX, INT_MIN, 0, 0 };
+    return layout->count++;
+}
+
+void frame_use(FrameLayout* layout, int object, int start, int end, long weight) {
+    FrameObject* o = &layout->objects[object];
+    if (start < o->start) o->start = start;
+    if (end > o->end) o->end = end;
+    o->weight += weight;
+}
+
+void frame_cover(FrameLayout* layout, int start, int end) {
+    for (int i = 0; i < layout->count; i++) {
+        FrameObject* o = &layout->objects[i];
+        if (o->start < end && start < o->end) frame_use(layout, i, start, end, 0);
+    }
+}
+
+static int interfere(const FrameObject* a, const FrameObject* b) {
+    return a->start < b->end && b->start < a->end;
+}
+
+static const FrameLayout* sorted_layout;
+
+// Heaviest first; equal weights keep the order the objects were added in.
+static int by_weight(const void* a, const void* b) {
+    const FrameObject* x = &sorted_layout->objects[*(const int*)a];
+    const FrameObject* y = &sorted_layout->objects[*(const int*)b];
+    if (x->weight != y->weight) return x->weight > y->weight ? -1 : 1;
+    return *(const int*)a - *(const int*)b;
+}
+
+int frame_assign(FrameLayout* layout, int base) {
+    int count = layout->count;
+    int* order = xcalloc((size_t)count, sizeof(int));
+    for (int i = 0; i < count; i++) order[i] = i;
+    sorted_layout = layout;
+    qsort(order, (size_t)count, sizeof(int), by_weight);
+
+    // Per slot its size and class and the list of its objects, threaded
+    // through `member`.
+    int* slot_words = xcalloc((size_t)count, sizeof(int));
+    int* slot_array = xcalloc((size_t)count, sizeof(int));
+    int* slot_first = xcalloc((size_t)count, sizeof(int));
+    int* slot_offset = xcalloc((size_t)count, sizeof(int));
+    int* member = xcalloc((size_t)count, sizeof(int));
+    int* slot_of = xcalloc((size_t)count, sizeof(int));
+    int slots = 0;
+    for (int i = 0; i < count; i++) {
+        int object = order[i];
+        const FrameObject* o = &layout->objects[object];
+        int chosen = -1;
+        for (int s = 0; s < slots && chosen < 0; s++) {
+            if (slot_array[s] != o->array) continue;
+            chosen = s;
+            for (int m = slot_first[s]; m >= 0; m = member[m]) {
+                if (interfere(o, &layout->objects[m])) {
+                    chosen = -1;
+                    break;
+                }
+            }
+        }
+        if (chosen < 0) {
+            chosen = slots++;
+            slot_words[chosen] = o->words;
+            slot_array[chosen] = o->array;
+            slot_first[chosen] = -1;
+        }
+        if (o->words > slot_words[chosen]) slot_words[chosen] = o->words;
+        member[object] = slot_first[chosen];
+        slot_first[chosen] = object;
+        slot_of[object] = chosen;
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+        for (int s = 0; s < slots; s++) {
+            if (slot_array[s] != pass) continue;
+            // The lowest word of a slot is its base.
+            base += slot_words[s] * 4;
+            slot_offset[s] = base;
+        }
+    }
+    for (int i = 0; i < count; i++) layout->objects[i].offset = slot_offset[slot_of[i]];
+    layout->slots = slots;
+
+    free(order);
+    free(slot_words);
+    free(slot_array);
+    free(slot_first);
+    free(slot_offset);
+    free(member);
+    free(slot_of);
+    return base;
+}
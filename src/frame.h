@@ -0,0 +1,47 @@
+#pragma once
+
+// Stack frame layout with slot sharing.
+//
+// A code generator describes everything that needs frame storage as an
+// object: its size in words, the interval of positions over which it is
+// live and a weight that estimates how often it is accessed. Objects whose
+// intervals overlap interfere; frame_assign colors the interference graph,
+// the heaviest object first, by putting each object into the first slot of
+// its class (scalar or array) that holds nothing it interferes with, and
+// opening a new slot otherwise; a slot is as large as its largest object.
+// Scalar slots are then placed nearest s0 in the order they were opened, so
+// the most accessed objects get the smallest offsets and stay within reach
+// of a 12-bit immediate; array slots follow them.
+//
+// Every object is a whole number of 4-byte words and every slot starts on a
+// word, so the layout keeps them aligned; rounding the frame to 16 bytes is
+// left to the prologue.
+
+typedef struct {
+    int words;
+    int array;                  // arrays never share a slot with scalars
+    int start, end;             // live over [start, end); empty while start >= end
+    long weight;
+    int offset;                 // result: lives at -offset(s0), arrays growing upwards from there
+} FrameObject;
+
+typedef struct {
+    FrameObject* objects;
+    int count, capacity;
+    int slots;                  // result: slots opened by frame_assign
+} FrameLayout;
+
+void frame_init(FrameLayout* layout);
+void frame_free(FrameLayout* layout);
+
+// Adds an object that is not live anywhere yet and returns its index.
+int frame_add(FrameLayout* layout, int words, int array);
+// Makes an object live over [start, end), adding `weight` to its weight.
+void frame_use(FrameLayout* layout, int object, int start, int end, long weight);
+// Every object live somewhere in [start, end) becomes live over all of it:
+// what is live in a loop is live around its back edge.
+void frame_cover(FrameLayout* layout, int start, int end);
+
+// Assigns offsets above `base`, the offset of the last word already in use,
+// and returns the offset of the last word of the frame.
+int frame_assign(FrameLayout* layout, int base);
@@ -0,0 +1,466 @@
+#include "induction.h"
+#include "passes.h"
+#include "remarks.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Induction variables and trip counts. Forms are computed over the blocks
+// in reverse postorder, so that the operands of everything but a phi come
+// first. A header phi is an induction variable when the values arriving
+// around the back edges are the phi plus one constant; that is decided on
+// a first sweep with every phi opaque, and a second sweep gives each
+// induction variable its recurrence and rebuilds the forms that use it.
+
+static void* checked(void* data) {
+    if (data == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    return data;
+}
+
+static int32_t wrap_add(int32_t a, int32_t b) {
+    return (int32_t)((uint32_t)a + (uint32_t)b);
+}
+
+static int32_t wrap_mul(int32_t a, int32_t b) {
+    return (int32_t)((uint32_t)a * (uint32_t)b);
+}
+
+static IrAffine constant_form(int32_t value) {
+    return (IrAffine){ .constant = value, .base = IR_NONE };
+}
+
+static IrAffine opaque_form(int value) {
+    return (IrAffine){ .base = value, .scale = 1 };
+}
+
+static int same_form(const IrAffine* a, const IrAffine* b) {
+    if (a->constant != b->constant || a->base != b->base || a->scale != b->scale || a->term_count != b->term_count) {
+        return 0;
+    }
+    for (int t = 0; t < a->term_count; t++) {
+        if (a->terms[t].loop != b->terms[t].loop || a->terms[t].step != b->terms[t].step) return 0;
+    }
+    return 1;
+}
+
+// a + factor * b, or 0 if the sum has two bases or too many terms.
+static int add_forms(IrAffine* sum, const IrAffine* a, const IrAffine* b, int32_t factor) {
+    IrAffine result = constant_form(wrap_add(a->constant, wrap_mul(factor, b->constant)));
+    int32_t b_scale = wrap_mul(factor, b->scale);
+    if (a->base == IR_NONE || b->base == IR_NONE || a->base == b->base) {
+        result.base = a->base != IR_NONE ? a->base : b->base;
+        result.scale = wrap_add(a->base != IR_NONE ? a->scale : 0, b->base != IR_NONE ? b_scale : 0);
+        if (result.scale == 0) result.base = IR_NONE;
+    } else {
+        return 0;
+    }
+    // Both term lists are ordered by loop, so they merge.
+    int i = 0, j = 0;
+    while (i < a->term_count || j < b->term_count) {
+        int loop;
+        int32_t step = 0;
+        if (j == b->term_count || (i < a->term_count && a->terms[i].loop < b->terms[j].loop)) {
+            loop = a->terms[i].loop;
+            step = a->terms[i++].step;
+        } else if (i == a->term_count || b->terms[j].loop < a->terms[i].loop) {
+            loop = b->terms[j].loop;
+            step = wrap_mul(factor, b->terms[j++].step);
+        } else {
+            loop = a->terms[i].loop;
+            step = wrap_add(a->terms[i++].step, wrap_mul(factor, b->terms[j++].step));
+        }
+        if (step == 0) continue;
+        if (result.term_count == IR_AFFINE_TERMS) return 0;
+        result.terms[result.term_count].loop = loop;
+        result.terms[result.term_count++].step = step;
+    }
+    *sum = result;
+    return 1;
+}
+
+int ir_affine_is_constant(const IrAffine* form) {
+    return form->base == IR_NONE && form->term_count == 0;
+}
+
+int32_t ir_affine_step(const IrAffine* form, int loop) {
+    for (int t = 0; t < form->term_count; t++) {
+        if (form->terms[t].loop == loop) return form->terms[t].step;
+    }
+    return 0;
+}
+
+static IrAffine form_of(const IrFunction* function, const IrAffine* forms, int value) {
+    const IrInsn* insn = &function->insns[value];
+    if (insn->type != IR_TYPE_I32) return opaque_form(value);
+    const int32_t* args = ir_args(function, value);
+    IrAffine result;
+    switch ((IrOp)insn->op) {
+        case IR_CONST:
+            return constant_form(insn->imm);
+        case IR_COPY:
+            return forms[args[0]];
+        case IR_ADD:
+            if (add_forms(&result, &forms[args[0]], &forms[args[1]], 1)) return result;
+            break;
+        case IR_SUB:
+            if (add_forms(&result, &forms[args[0]], &forms[args[1]], -1)) return result;
+            break;
+        case IR_NEG:
+            if (add_forms(&result, &(IrAffine){ .base = IR_NONE }, &forms[args[0]], -1)) return result;
+            break;
+        case IR_MUL:
+            for (int side = 0; side < 2; side++) {
+                const IrAffine* factor = &forms[args[side]];
+                if (!ir_affine_is_constant(factor)) continue;
+                if (add_forms(&result, &(IrAffine){ .base = IR_NONE }, &forms[args[!side]], factor->constant)) {
+                    return result;
+                }
+            }
+            break;
+        default:
+            break;
+    }
+    return opaque_form(value);
+}
+
+// The loop step of a header phi when it is an induction variable, with
+// its value on entry in `init`; 0 otherwise.
+static int32_t recognize_phi(const IrFunction* function, const IrCfg* cfg, const IrLoops* loops,
+                             const IrAffine* forms, int loop, int phi, int* init) {
+    const int32_t* args = ir_args(function, phi);
+    int32_t step = 0;
+    *init = IR_NONE;
+    int index = 0;
+    for (int e = function->blocks[function->insns[phi].block].first_pred; e != IR_NONE;
+         e = function->edges[e].next_pred, index++) {
+        int pred = function->edges[e].from;
+        if (cfg->index[pred] == IR_NONE) continue;
+        const IrAffine* incoming = &forms[args[index]];
+        if (!ir_loop_contains(loops, loop, pred)) {
+            if (*init != IR_NONE && !same_form(&forms[*init], incoming)) return 0;
+            *init = args[index];
+            continue;
+        }
+        // Around a back edge: the phi plus a constant, the same on every one.
+        if (incoming->base != phi || incoming->scale != 1 || incoming->term_count != 0) return 0;
+        if (step != 0 && incoming->constant != step) return 0;
+        step = incoming->constant;
+    }
+    return *init == IR_NONE ? 0 : step;
+}
+
+// Iterations of a loop that runs while start + step * k `op` limit, or
+// -1 if that is not a finite count or a value on the way would wrap.
+static int64_t constant_trip(IrOp op, int64_t start, int64_t step, int64_t limit) {
+    int64_t count;
+    switch (op) {
+        case IR_LT:
+            if (step <= 0) return start < limit ? -1 : 0;
+            count = start < limit ? (limit - start + step - 1) / step : 0;
+            break;
+        case IR_LE:
+            if (step <= 0) return start <= limit ? -1 : 0;
+            count = start <= limit ? (limit - start) / step + 1 : 0;
+            break;
+        case IR_GT:
+            if (step >= 0) return start > limit ? -1 : 0;
+            count = start > limit ? (start - limit - step - 1) / -step : 0;
+            break;
+        case IR_GE:
+            if (step >= 0) return start >= limit ? -1 : 0;
+            count = start >= limit ? (start - limit) / -step + 1 : 0;
+            break;
+        case IR_NE:
+            if (step == 0 || (limit - start) % step != 0 || (limit - start) / step < 0) return start != limit ? -1 : 0;
+            count = (limit - start) / step;
+            break;
+        case IR_EQ:
+            count = start == limit ? (step == 0 ? -1 : 1) : 0;
+            break;
+        default:
+            return -1;
+    }
+    // The value that ends the loop must not have wrapped.
+    int64_t last = start + step * count;
+    return count >= 0 && last >= INT32_MIN && last <= INT32_MAX ? count : -1;
+}
+
+// Whether a symbolic count has a closed form: a bound approached from the
+// right side.
+static int symbolic_trip(IrOp op, int32_t step) {
+    switch (op) {
+        case IR_LT:
+        case IR_LE:
+            return step > 0;
+        case IR_GT:
+        case IR_GE:
+            return step < 0;
+        case IR_NE:
+            return step == 1 || step == -1;
+        default:
+            return 0;
+    }
+}
+
+// Does the form stay the same throughout `loop`?
+static int invariant_in(const IrFunction* function, const IrLoops* loops, const IrAffine* form, int loop) {
+    if (form->base != IR_NONE && ir_loop_contains(loops, loop, function->insns[form->base].block)) return 0;
+    for (int t = 0; t < form->term_count; t++) {
+        int other = form->terms[t].loop;
+        if (other == loop || ir_loop_contains(loops, loop, loops->loops[other].header)) return 0;
+    }
+    return 1;
+}
+
+static IrOp swapped(IrOp op) {
+    switch (op) {
+        case IR_LT: return IR_GT;
+        case IR_LE: return IR_GE;
+        case IR_GT: return IR_LT;
+        case IR_GE: return IR_LE;
+        default: return op;
+    }
+}
+
+static IrOp inverted(IrOp op) {
+    switch (op) {
+        case IR_EQ: return IR_NE;
+        case IR_NE: return IR_EQ;
+        case IR_LT: return IR_GE;
+        case IR_LE: return IR_GT;
+        case IR_GT: return IR_LE;
+        default: return IR_LT;
+    }
+}
+
+// The trip count of a loop whose header decides whether to run the body.
+static IrTripCount count_trips(const IrFunction* function, const IrLoops* loops, const IrAffine* forms, int loop) {
+    IrTripCount trip = { .kind = TRIP_UNKNOWN, .count = -1, .test = IR_NONE };
+    const IrLoop* info = &loops->loops[loop];
+    int branch = ir_terminator(function, info->header);
+    if (branch == IR_NONE || function->insns[branch].op != IR_BRANCH) return trip;
+    int test = ir_args(function, branch)[0];
+    IrOp op = (IrOp)function->insns[test].op;
+    if (op < IR_EQ || op > IR_GE) return trip;
+    int taken_inside = ir_loop_contains(loops, loop, ir_succ(function, info->header, 0));
+    int other_inside = ir_loop_contains(loops, loop, ir_succ(function, info->header, 1));
+    if (taken_inside == other_inside) return trip;
+    if (!taken_inside) op = inverted(op);
+
+    const int32_t* args = ir_args(function, test);
+    const IrAffine* left = &forms[args[0]];
+    const IrAffine* right = &forms[args[1]];
+    if (ir_affine_step(left, loop) == 0) {
+        const IrAffine* swap = left;
+        left = right;
+        right = swap;
+        op = swapped(op);
+    }
+    int32_t step = ir_affine_step(left, loop);
+    IrAffine start;
+    IrAffine term = { .base = IR_NONE, .term_count = 1 };
+    term.terms[0].loop = loop;
+    term.terms[0].step = step;
+    if (step == 0 || !add_forms(&start, left, &term, -1)) return trip;
+    if (!invariant_in(function, loops, &start, loop) || !invariant_in(function, loops, right, loop)) return trip;
+
+    trip.test = test;
+    trip.op = op;
+    trip.start = start;
+    trip.step = step;
+    trip.limit = *right;
+    trip.exact = info->exit_count == 1;
+    if (ir_affine_is_constant(&start) && ir_affine_is_constant(right)) {
+        trip.count = constant_trip(op, start.constant, step, right->constant);
+        if (trip.count >= 0) trip.kind = TRIP_CONSTANT;
+    } else if (symbolic_trip(op, step)) {
+        trip.kind = TRIP_SYMBOLIC;
+    }
+    return trip;
+}
+
+void ir_compute_induction(IrInduction* induction, const IrFunction* function, const IrCfg* cfg,
+                          const IrLoops* loops) {
+    int values = function->insn_count;
+    IrAffine* forms = checked(malloc((size_t)(values > 0 ? values : 1) * sizeof(IrAffine)));
+    int32_t* steps = checked(calloc((size_t)(values > 0 ? values : 1), sizeof(int32_t)));
+    int* init = checked(malloc((size_t)(values > 0 ? values : 1) * sizeof(int)));
+    for (int v = 0; v < values; v++) forms[v] = opaque_form(v);
+
+    for (int sweep = 0; sweep < 2; sweep++) {
+        for (int i = 0; i < cfg->count; i++) {
+            int block = cfg->order[i];
+            for (int insn = function->blocks[block].first; insn != IR_NONE; insn = function->insns[insn].next) {
+                if (function->insns[insn].op != IR_PHI) {
+                    forms[insn] = form_of(function, forms, insn);
+                } else if (sweep == 1 && steps[insn] != 0) {
+                    IrAffine recurrence = { .base = IR_NONE, .term_count = 1 };
+                    recurrence.terms[0].loop = loops->innermost[block];
+                    recurrence.terms[0].step = steps[insn];
+                    if (!add_forms(&forms[insn], &forms[init[insn]], &recurrence, 1)) steps[insn] = 0;
+                }
+            }
+        }
+        if (sweep == 1) break;
+        for (int l = 0; l < loops->count; l++) {
+            int header = loops->loops[l].header;
+            for (int phi = function->blocks[header].first; phi != IR_NONE && function->insns[phi].op == IR_PHI;
+                 phi = function->insns[phi].next) {
+                if (function->insns[phi].type == IR_TYPE_I32) {
+                    steps[phi] = recognize_phi(function, cfg, loops, forms, l, phi, &init[phi]);
+                }
+            }
+        }
+    }
+
+    induction->forms = forms;
+    induction->first_iv = checked(calloc((size_t)loops->count + 1, sizeof(int)));
+    int count = 0;
+    for (int l = 0; l < loops->count; l++) {
+        int header = loops->loops[l].header;
+        for (int phi = function->blocks[header].first; phi != IR_NONE && function->insns[phi].op == IR_PHI;
+             phi = function->insns[phi].next) {
+            count += steps[phi] != 0;
+        }
+    }
+    induction->ivs = checked(malloc((size_t)(count > 0 ? count : 1) * sizeof(int)));
+    induction->trips = checked(malloc((size_t)(loops->count > 0 ? loops->count : 1) * sizeof(IrTripCount)));
+    count = 0;
+    for (int l = 0; l < loops->count; l++) {
+        induction->first_iv[l] = count;
+        int header = loops->loops[l].header;
+        for (int phi = function->blocks[header].first; phi != IR_NONE && function->insns[phi].op == IR_PHI;
+             phi = function->insns[phi].next) {
+            if (steps[phi] != 0) induction->ivs[count++] = phi;
+        }
+        induction->trips[l] = count_trips(function, loops, forms, l);
+    }
+    induction->first_iv[loops->count] = count;
+    free(steps);
+    free(init);
+}
+
+void ir_induction_free(IrInduction* induction) {
+    free(induction->forms);
+    free(induction->ivs);
+    free(induction->first_iv);
+    free(induction->trips);
+}
+
+// ---------------------------------------------------------------------------
+// Text
+
+static void append(char* buffer, size_t size, size_t* used, const char* format, ...)
+    __attribute__((format(printf, 4, 5)));
+
+static void append(char* buffer, size_t size, size_t* used, const char* format, ...) {
+    if (*used >= size) return;
+    va_list arguments;
+    va_start(arguments, format);
+    int written = vsnprintf(buffer + *used, size - *used, format, arguments);
+    va_end(arguments);
+    if (written > 0) *used += (size_t)written;
+}
+
+void ir_format_affine(const IrAffine* form, const IrLoops* loops, char* buffer, size_t size) {
+    size_t used = 0;
+    buffer[0] = '\0';
+    for (int t = form->term_count - 1; t >= 0; t--) append(buffer, size, &used, "{");
+    if (form->base == IR_NONE) {
+        append(buffer, size, &used, "%d", form->constant);
+    } else {
+        if (form->scale == -1) {
+            append(buffer, size, &used, "-");
+        } else if (form->scale != 1) {
+            append(buffer, size, &used, "%d*", form->scale);
+        }
+        append(buffer, size, &used, "%%%d", form->base);
+        if (form->constant != 0) {
+            append(buffer, size, &used, " %c %u", form->constant < 0 ? '-' : '+',
+                   form->constant < 0 ? 0u - (uint32_t)form->constant : (uint32_t)form->constant);
+        }
+    }
+    for (int t = 0; t < form->term_count; t++) {
+        append(buffer, size, &used, ",+,%d}<bb%d>", form->terms[t].step, loops->loops[form->terms[t].loop].header);
+    }
+}
+
+void ir_format_trip_count(const IrTripCount* trip, const IrLoops* loops, char* buffer, size_t size) {
+    if (trip->kind == TRIP_UNKNOWN) {
+        snprintf(buffer, size, "unknown");
+        return;
+    }
+    if (trip->kind == TRIP_CONSTANT) {
+        snprintf(buffer, size, "%lld", (long long)trip->count);
+        return;
+    }
+    char start[128], limit[128];
+    ir_format_affine(&trip->start, loops, start, sizeof(start));
+    ir_format_affine(&trip->limit, loops, limit, sizeof(limit));
+    // Counting up, the distance is limit - start; counting down, the other way.
+    int down = trip->step < 0;
+    const char* from = down ? limit : start;
+    const char* to = down ? start : limit;
+    int32_t stride = down ? -trip->step : trip->step;
+    // "to - from", or just "to" from zero.
+    char distance[272];
+    if (strcmp(from, "0") == 0) {
+        snprintf(distance, sizeof(distance), "%s", to);
+    } else {
+        const char* open = strchr(from, ' ') ? "(" : "";
+        snprintf(distance, sizeof(distance), "%s - %s%s%s", to, open, from, open[0] ? ")" : "");
+    }
+    switch (trip->op) {
+        case IR_LT:
+        case IR_GT:
+            if (stride == 1) {
+                snprintf(buffer, size, "max(0, %s)", distance);
+            } else {
+                snprintf(buffer, size, "max(0, (%s + %d) / %d)", distance, stride - 1, stride);
+            }
+            break;
+        case IR_LE:
+        case IR_GE:
+            if (stride == 1) {
+                snprintf(buffer, size, "max(0, %s + 1)", distance);
+            } else {
+                snprintf(buffer, size, "max(0, (%s) / %d + 1)", distance, stride);
+            }
+            break;
+        default:
+            snprintf(buffer, size, "%s", distance);
+            break;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Remarks
+
+PassResult ir_report_loops(IrFunction* function, PassContext* context) {
+    if (!remarks_enabled) return (PassResult){ 0, PRESERVE_CFG };
+    const IrLoops* loops = pass_loops(context);
+    const IrInduction* induction = pass_induction(context);
+    char count[320], form[160];
+    for (int l = 0; l < loops->count; l++) {
+        const IrLoop* loop = &loops->loops[l];
+        const IrTripCount* trip = &induction->trips[l];
+        int branch = ir_terminator(function, loop->header);
+        int line = branch != IR_NONE ? function->insns[branch].line : 0;
+        ir_format_trip_count(trip, loops, count, sizeof(count));
+        remark(REMARK_ANALYSIS, "loops", "Loop", function->name, line,
+               "loop at depth %d: %d blocks, %s preheader, %d exit%s, trip count %s%s", loop->depth,
+               loop->block_count, loop->preheader != IR_NONE ? "a" : "no", loop->exit_count,
+               loop->exit_count == 1 ? "" : "s", count, trip->kind != TRIP_UNKNOWN && !trip->exact ? " at most" : "");
+        for (int i = induction->first_iv[l]; i < induction->first_iv[l + 1]; i++) {
+            int phi = induction->ivs[i];
+            ir_format_affine(&induction->forms[phi], loops, form, sizeof(form));
+            remark(REMARK_ANALYSIS, "loops", "InductionVariable", function->name, line,
+                   "%%%d = %s", phi, form);
+        }
+    }
+    return (PassResult){ 0, PRESERVE_CFG };
+}
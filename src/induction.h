@@ -0,0 +1,69 @@
+#pragma once
+
+#include "dataflow.h"
+#include "ir.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Induction variables and trip counts, in the manner of scalar evolution.
+// Every i32 value gets an affine form in the iteration
+// numbers k_L of the loops around it, counted from 0:
+//
+//     constant + scale * base + sum over terms of step * k_loop
+//
+// where base is a value the analysis does not see through (a parameter,
+// a load, a call, a phi that is not an induction variable), or IR_NONE.
+// A value the form cannot describe is its own base. Arithmetic wraps, as
+// the IR's does. Basic induction variables are the header phis that enter
+// the loop with some value and come around every back edge incremented by
+// a constant: {start,+,step}<header>.
+#define IR_AFFINE_TERMS 4
+
+typedef struct {
+    int32_t constant;
+    int base;
+    int32_t scale;
+    int term_count;
+    struct {
+        int loop;
+        int32_t step;
+    } terms[IR_AFFINE_TERMS];   // outer loops first, steps non-zero
+} IrAffine;
+
+// A loop whose header leaves it on a comparison of an affine value with a
+// loop-invariant one: iteration k runs while start + step * k `op` limit.
+typedef enum {
+    TRIP_UNKNOWN,
+    TRIP_CONSTANT,
+    TRIP_SYMBOLIC               // depends on values computed outside the loop
+} IrTripKind;
+
+typedef struct {
+    IrTripKind kind;
+    int exact;                  // the counted exit is the loop's only way out
+    int64_t count;              // TRIP_CONSTANT: iterations of the body
+    int test;                   // the comparison
+    IrOp op;                    // on which the loop continues
+    IrAffine start;             // tested value in the first iteration
+    int32_t step;
+    IrAffine limit;
+} IrTripCount;
+
+typedef struct {
+    IrAffine* forms;            // per value
+    int* ivs;                   // basic induction variables, grouped by loop
+    int* first_iv;              // per loop, its range in ivs; loop count + 1 entries
+    IrTripCount* trips;         // per loop
+} IrInduction;
+
+int ir_affine_is_constant(const IrAffine* form);
+// Step of the form per iteration of `loop`, 0 if it does not vary with it.
+int32_t ir_affine_step(const IrAffine* form, int loop);
+// "{{0,+,32}<bb1>,+,1}<bb4>"-style text of a form: the chain of
+// recurrences, outermost loop inside.
+void ir_format_affine(const IrAffine* form, const IrLoops* loops, char* buffer, size_t size);
+void ir_format_trip_count(const IrTripCount* trip, const IrLoops* loops, char* buffer, size_t size);
+
+void ir_compute_induction(IrInduction* induction, const IrFunction* function, const IrCfg* cfg,
+                          const IrLoops* loops);
+void ir_induction_free(IrInduction* induction);
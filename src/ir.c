@@ -0,0 +1,391 @@
+#include "ir.h"
+#include "memstats.h"
+#include "passes.h"
+#include "phase.h"
+#include "probes.h"
+#include "riscv.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* op_names[IR_OP_COUNT] = {
+    "const", "param", "slot", "add", "sub", "mul", "div", "rem", "and", "or", "xor",
+    "shr", "mulhu", "eq", "ne", "lt", "le", "gt", "ge", "neg", "not", "bool", "element", "load", "store",
+    "call", "copy", "phi", "jump", "br", "ret"
+};
+
+static const char* type_names[] = { "void", "i32", "ptr" };
+
+const char* ir_op_name(IrOp op) {
+    return op < IR_OP_COUNT ? op_names[op] : "?";
+}
+
+// Makes room for `needed` elements. All IR memory is allocated here, so this
+// is what -fmem-report and the arena__grow probe see.
+static void* grow(void* data, int* capacity, int needed, size_t size, const char* arena) {
+    if (needed <= *capacity) return data;
+    int new_capacity = *capacity ? *capacity * 2 : 16;
+    while (new_capacity < needed) new_capacity *= 2;
+    void* grown = realloc(data, (size_t)new_capacity * size);
+    if (grown == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    mem_alloc(MEM_IR, (size_t)(new_capacity - *capacity) * size);
+    CC_PROBE2(arena__grow, arena, (size_t)new_capacity * size);
+    *capacity = new_capacity;
+    return grown;
+}
+
+IrFunction* ir_function_new(const char* name) {
+    IrFunction* function = calloc(1, sizeof(IrFunction));
+    if (function == NULL || (function->name = malloc(strlen(name) + 1)) == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    strcpy(function->name, name);
+    return function;
+}
+
+void ir_function_free(IrFunction* function) {
+    if (!function) return;
+    mem_free((size_t)function->insn_capacity * sizeof(IrInsn) + (size_t)function->block_capacity * sizeof(IrBlock) +
+             (size_t)function->edge_capacity * sizeof(IrEdge) + (size_t)function->arg_capacity * sizeof(int32_t) +
+             (size_t)function->slot_capacity * sizeof(IrSlot) + (size_t)function->string_capacity);
+    free(function->insns);
+    free(function->blocks);
+    free(function->edges);
+    free(function->args);
+    free(function->slots);
+    free(function->strings);
+    free(function->name);
+    free(function);
+}
+
+int ir_new_block(IrFunction* function) {
+    function->blocks = grow(function->blocks, &function->block_capacity, function->block_count + 1,
+                            sizeof(IrBlock), "blocks");
+    IrBlock* block = &function->blocks[function->block_count];
+    block->first = block->last = IR_NONE;
+    block->first_pred = block->last_pred = IR_NONE;
+    block->first_succ = block->last_succ = IR_NONE;
+    block->pred_count = block->succ_count = 0;
+    return function->block_count++;
+}
+
+void ir_add_edge(IrFunction* function, int from, int to) {
+    function->edges = grow(function->edges, &function->edge_capacity, function->edge_count + 1, sizeof(IrEdge),
+                           "edges");
+    int index = function->edge_count++;
+    IrEdge* edge = &function->edges[index];
+    edge->from = from;
+    edge->to = to;
+    edge->next_pred = edge->next_succ = IR_NONE;
+
+    IrBlock* source = &function->blocks[from];
+    if (source->last_succ == IR_NONE) {
+        source->first_succ = index;
+    } else {
+        function->edges[source->last_succ].next_succ = index;
+    }
+    source->last_succ = index;
+    source->succ_count++;
+
+    IrBlock* target = &function->blocks[to];
+    if (target->last_pred == IR_NONE) {
+        target->first_pred = index;
+    } else {
+        function->edges[target->last_pred].next_pred = index;
+    }
+    target->last_pred = index;
+    target->pred_count++;
+}
+
+int ir_insert(IrFunction* function, int block, int before, IrOp op, IrType type, const int32_t* args, int count,
+              int32_t imm) {
+    function->insns = grow(function->insns, &function->insn_capacity, function->insn_count + 1, sizeof(IrInsn),
+                           "insns");
+    function->args = grow(function->args, &function->arg_capacity, function->arg_count + count, sizeof(int32_t),
+                          "args");
+    int index = function->insn_count++;
+    IrInsn* insn = &function->insns[index];
+    insn->op = (uint8_t)op;
+    insn->type = (uint8_t)type;
+    insn->arg_count = (uint16_t)count;
+    insn->block = block;
+    insn->args = function->arg_count;
+    insn->imm = imm;
+    insn->line = function->line;
+    if (args) {
+        memcpy(function->args + function->arg_count, args, (size_t)count * sizeof(int32_t));
+    } else {
+        for (int i = 0; i < count; i++) function->args[function->arg_count + i] = IR_NONE;
+    }
+    function->arg_count += count;
+
+    IrBlock* owner = &function->blocks[block];
+    insn->next = before;
+    insn->prev = before == IR_NONE ? owner->last : function->insns[before].prev;
+    if (insn->prev == IR_NONE) {
+        owner->first = index;
+    } else {
+        function->insns[insn->prev].next = index;
+    }
+    if (before == IR_NONE) {
+        owner->last = index;
+    } else {
+        function->insns[before].prev = index;
+    }
+    return index;
+}
+
+int ir_append(IrFunction* function, int block, IrOp op, IrType type, const int32_t* args, int count, int32_t imm) {
+    return ir_insert(function, block, IR_NONE, op, type, args, count, imm);
+}
+
+void ir_remove(IrFunction* function, int index) {
+    IrInsn* insn = &function->insns[index];
+    IrBlock* owner = &function->blocks[insn->block];
+    if (insn->prev == IR_NONE) {
+        owner->first = insn->next;
+    } else {
+        function->insns[insn->prev].next = insn->next;
+    }
+    if (insn->next == IR_NONE) {
+        owner->last = insn->prev;
+    } else {
+        function->insns[insn->next].prev = insn->prev;
+    }
+    insn->block = insn->prev = insn->next = IR_NONE;
+}
+
+void ir_set_args(IrFunction* function, int index, const int32_t* args, int count) {
+    function->args = grow(function->args, &function->arg_capacity, function->arg_count + count, sizeof(int32_t),
+                          "args");
+    memcpy(function->args + function->arg_count, args, (size_t)count * sizeof(int32_t));
+    function->insns[index].args = function->arg_count;
+    function->insns[index].arg_count = (uint16_t)count;
+    function->arg_count += count;
+}
+
+int ir_first_non_phi(const IrFunction* function, int block) {
+    int insn = function->blocks[block].first;
+    while (insn != IR_NONE && function->insns[insn].op == IR_PHI) insn = function->insns[insn].next;
+    return insn;
+}
+
+// The new block takes over the edge as its only predecessor, and a new
+// edge from it replaces the old one in the target's predecessor list.
+static void split_edge(IrFunction* function, int index) {
+    int middle = ir_new_block(function);
+    function->edges = grow(function->edges, &function->edge_capacity, function->edge_count + 1, sizeof(IrEdge),
+                           "edges");
+    int replacement = function->edge_count++;
+    IrEdge* edge = &function->edges[index];
+    IrBlock* target = &function->blocks[edge->to];
+    function->edges[replacement] = (IrEdge){ middle, edge->to, edge->next_pred, IR_NONE };
+    if (target->first_pred == index) {
+        target->first_pred = replacement;
+    } else {
+        int previous = target->first_pred;
+        while (function->edges[previous].next_pred != index) previous = function->edges[previous].next_pred;
+        function->edges[previous].next_pred = replacement;
+    }
+    if (target->last_pred == index) target->last_pred = replacement;
+
+    edge->to = middle;
+    edge->next_pred = IR_NONE;
+    IrBlock* block = &function->blocks[middle];
+    block->first_pred = block->last_pred = index;
+    block->first_succ = block->last_succ = replacement;
+    block->pred_count = block->succ_count = 1;
+    ir_append(function, middle, IR_JUMP, IR_TYPE_VOID, NULL, 0, 0);
+}
+
+void ir_split_critical_edges(IrFunction* function) {
+    int edges = function->edge_count;
+    for (int e = 0; e < edges; e++) {
+        const IrEdge* edge = &function->edges[e];
+        // Removed edges keep their index with no ends.
+        if (edge->from == IR_NONE) continue;
+        if (function->blocks[edge->from].succ_count > 1 && function->blocks[edge->to].pred_count > 1) {
+            split_edge(function, e);
+        }
+    }
+}
+
+void ir_remove_edge(IrFunction* function, int index) {
+    IrEdge* edge = &function->edges[index];
+    IrBlock* source = &function->blocks[edge->from];
+    IrBlock* target = &function->blocks[edge->to];
+
+    int previous = IR_NONE;
+    for (int e = source->first_succ; e != index; e = function->edges[e].next_succ) previous = e;
+    if (previous == IR_NONE) {
+        source->first_succ = edge->next_succ;
+    } else {
+        function->edges[previous].next_succ = edge->next_succ;
+    }
+    if (source->last_succ == index) source->last_succ = previous;
+    source->succ_count--;
+
+    int position = 0;
+    previous = IR_NONE;
+    for (int e = target->first_pred; e != index; e = function->edges[e].next_pred) {
+        previous = e;
+        position++;
+    }
+    if (previous == IR_NONE) {
+        target->first_pred = edge->next_pred;
+    } else {
+        function->edges[previous].next_pred = edge->next_pred;
+    }
+    if (target->last_pred == index) target->last_pred = previous;
+    target->pred_count--;
+
+    for (int phi = target->first; phi != IR_NONE && function->insns[phi].op == IR_PHI;
+         phi = function->insns[phi].next) {
+        int32_t* args = ir_args(function, phi);
+        int count = function->insns[phi].arg_count;
+        memmove(args + position, args + position + 1, (size_t)(count - position - 1) * sizeof(int32_t));
+        function->insns[phi].arg_count--;
+    }
+    edge->from = edge->to = IR_NONE;
+    edge->next_pred = edge->next_succ = IR_NONE;
+}
+
+void ir_replace_uses(IrFunction* function, const int32_t* replacement) {
+    for (int b = 0; b < function->block_count; b++) {
+        for (int insn = function->blocks[b].first; insn != IR_NONE; insn = function->insns[insn].next) {
+            int32_t* args = ir_args(function, insn);
+            for (int a = 0; a < function->insns[insn].arg_count; a++) {
+                while (replacement[args[a]] != IR_NONE) args[a] = replacement[args[a]];
+            }
+        }
+    }
+}
+
+int ir_add_string(IrFunction* function, const char* text, size_t length) {
+    function->strings = grow(function->strings, &function->string_capacity,
+                             function->string_size + (int)length + 1, 1, "strings");
+    int offset = function->string_size;
+    memcpy(function->strings + offset, text, length);
+    function->strings[offset + length] = '\0';
+    function->string_size += (int)length + 1;
+    return offset;
+}
+
+int ir_add_slot(IrFunction* function, const char* name, size_t length, int words) {
+    int string = ir_add_string(function, name, length);
+    function->slots = grow(function->slots, &function->slot_capacity, function->slot_count + 1, sizeof(IrSlot),
+                           "slots");
+    IrSlot* slot = &function->slots[function->slot_count];
+    slot->name = string;
+    slot->words = words;
+    slot->offset = 0;
+    return function->slot_count++;
+}
+
+int ir_is_terminator(IrOp op) {
+    return op == IR_JUMP || op == IR_BRANCH || op == IR_RET;
+}
+
+int ir_terminator(const IrFunction* function, int block) {
+    int last = function->blocks[block].last;
+    return last != IR_NONE && ir_is_terminator((IrOp)function->insns[last].op) ? last : IR_NONE;
+}
+
+int ir_succ(const IrFunction* function, int block, int n) {
+    int edge = function->blocks[block].first_succ;
+    while (n-- > 0 && edge != IR_NONE) edge = function->edges[edge].next_succ;
+    return edge == IR_NONE ? IR_NONE : function->edges[edge].to;
+}
+
+int ir_pred(const IrFunction* function, int block, int n) {
+    int edge = function->blocks[block].first_pred;
+    while (n-- > 0 && edge != IR_NONE) edge = function->edges[edge].next_pred;
+    return edge == IR_NONE ? IR_NONE : function->edges[edge].from;
+}
+
+static void print_insn(const IrFunction* function, int index, FILE* output) {
+    const IrInsn* insn = &function->insns[index];
+    const int32_t* args = ir_args(function, index);
+    fprintf(output, "    ");
+    if (insn->type != IR_TYPE_VOID) fprintf(output, "%%%d = ", index);
+    fprintf(output, "%s", ir_op_name((IrOp)insn->op));
+    if (insn->type != IR_TYPE_VOID) fprintf(output, " %s", type_names[insn->type]);
+    switch ((IrOp)insn->op) {
+        case IR_CONST:
+        case IR_PARAM:
+            fprintf(output, " %d", insn->imm);
+            break;
+        case IR_SLOT:
+            fprintf(output, " %s", ir_string(function, function->slots[insn->imm].name));
+            break;
+        case IR_CALL:
+            fprintf(output, " %s(", ir_string(function, insn->imm));
+            for (int i = 0; i < insn->arg_count; i++) fprintf(output, "%s%%%d", i ? ", " : "", args[i]);
+            fputc(')', output);
+            break;
+        case IR_PHI:
+            for (int i = 0; i < insn->arg_count; i++) {
+                fprintf(output, "%s [%%%d, bb%d]", i ? "," : "", args[i], ir_pred(function, insn->block, i));
+            }
+            break;
+        default:
+            for (int i = 0; i < insn->arg_count; i++) fprintf(output, "%s %%%d", i ? "," : "", args[i]);
+            break;
+    }
+    if (insn->op == IR_JUMP || insn->op == IR_BRANCH) {
+        for (int i = 0; i < function->blocks[insn->block].succ_count; i++) {
+            fprintf(output, "%s bb%d", i || insn->arg_count ? "," : "", ir_succ(function, insn->block, i));
+        }
+    }
+    fputc('\n', output);
+}
+
+void ir_print_function(const IrFunction* function, FILE* output) {
+    fprintf(output, "function %s, %d parameter%s\n", function->name, function->param_count,
+            function->param_count == 1 ? "" : "s");
+    for (int i = 0; i < function->slot_count; i++) {
+        const IrSlot* slot = &function->slots[i];
+        fprintf(output, "  slot %s, %d word%s\n", ir_string(function, slot->name), slot->words,
+                slot->words == 1 ? "" : "s");
+    }
+    for (int b = 0; b < function->block_count; b++) {
+        const IrBlock* block = &function->blocks[b];
+        // Blocks emptied and detached by the passes are not shown.
+        if (b > 0 && block->first == IR_NONE && block->pred_count == 0) continue;
+        fprintf(output, "bb%d:", b);
+        if (block->pred_count > 0) {
+            fprintf(output, "    ; preds");
+            for (int i = 0; i < block->pred_count; i++) fprintf(output, " bb%d", ir_pred(function, b, i));
+        }
+        fputc('\n', output);
+        for (int insn = block->first; insn != IR_NONE; insn = function->insns[insn].next) {
+            print_insn(function, insn, output);
+        }
+    }
+}
+
+void ir_generate_code(ASTNode* program, FILE* output, FILE* dump, int level, OptBudget* budget) {
+    for (ASTNode* node = program; node; node = node->next) {
+        phase_function_begin(node->value);
+        CC_PROBE1(function__begin, node->value);
+        long start = CC_PROBE_ENABLED(function__end) ? ftell(output) : 0;
+        int optimized = 0;
+        if (!budget || opt_budget_begin_function(budget, node->value)) {
+            IrFunction* function = ir_lower_function(node);
+            optimized = run_passes(function, (OptLevel)level, budget);
+            if (optimized) {
+                if (dump) ir_print_function(function, dump);
+                ir_emit_function(function, output);
+            }
+            ir_function_free(function);
+        }
+        if (!optimized) generate_function(node, output);
+        if (budget) opt_budget_end_function(budget, optimized);
+        CC_PROBE2(function__end, node->value, CC_PROBE_ENABLED(function__end) ? ftell(output) - start : 0);
+        phase_function_end();
+    }
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "budget.h"
+#include "compiler.h"
+#include <stdint.h>
+#include <stdio.h>
+
+// Mid-level three-address IR between the AST and the RISC-V back end.
+//
+// A function owns a handful of dense arenas (instructions, blocks, CFG
+// edges, operand lists, frame slots, strings) and everything refers to
+// everything else by 32-bit index into them, so a function is a few
+// contiguous arrays rather than a pointer graph. Every instruction defines
+// at most one value, and the value is named by the instruction's index:
+// %7 is the result of insns[7]. Instructions of a block form a doubly
+// linked list through the arena, so passes can insert and delete in place.
+// The CFG is explicit: each block has ordered successor and predecessor
+// edge lists, and a terminator's targets are its block's successors (the
+// taken target of IR_BRANCH first).
+
+#define IR_NONE (-1)
+
+typedef enum {
+    IR_TYPE_VOID,
+    IR_TYPE_I32,
+    IR_TYPE_PTR                 // address of a frame slot or an element in it
+} IrType;
+
+typedef enum {
+    IR_CONST,                   // imm
+    IR_PARAM,                   // incoming argument number imm
+    IR_SLOT,                    // address of frame slot imm
+    IR_ADD,
+    IR_SUB,
+    IR_MUL,
+    IR_DIV,
+    IR_REM,
+    IR_AND,
+    IR_OR,
+    IR_XOR,
+    IR_SHR,                     // logical right shift by operand 1, 0..31
+    IR_MULHU,                   // high word of the unsigned 64-bit product
+    IR_EQ,                      // comparisons give 0 or 1
+    IR_NE,
+    IR_LT,
+    IR_LE,
+    IR_GT,
+    IR_GE,
+    IR_NEG,
+    IR_NOT,                     // x == 0
+    IR_BOOL,                    // x != 0
+    IR_ELEMENT,                 // address of word operand 1 of the array at operand 0
+    IR_LOAD,                    // word at operand 0
+    IR_STORE,                   // operand 1 to the word at operand 0
+    IR_CALL,                    // function named by string imm, operands are the arguments
+    IR_COPY,
+    IR_PHI,                     // one operand per predecessor, in edge order
+    IR_JUMP,
+    IR_BRANCH,                  // to the first successor if operand 0 is non-zero, else the second
+    IR_RET,                     // operand 0
+    IR_OP_COUNT
+} IrOp;
+
+typedef struct {
+    uint8_t op;                 // IrOp
+    uint8_t type;               // IrType of the result, IR_TYPE_VOID if none
+    uint16_t arg_count;
+    int32_t block;              // containing block, IR_NONE once removed
+    int32_t prev, next;         // neighbours in the block
+    int32_t args;               // first operand in IrFunction.args
+    int32_t imm;
+    int32_t line;               // source line, 0 if unknown
+} IrInsn;
+
+typedef struct {
+    int32_t first, last;        // instructions
+    int32_t first_pred, last_pred;
+    int32_t first_succ, last_succ;
+    int32_t pred_count, succ_count;
+} IrBlock;
+
+typedef struct {
+    int32_t from, to;
+    int32_t next_pred;          // next edge into `to`
+    int32_t next_succ;          // next edge out of `from`
+} IrEdge;
+
+typedef struct {
+    int32_t name;               // string offset
+    int32_t words;              // 1 for scalars
+    int32_t offset;             // the slot starts at -offset(s0); set by the back end
+} IrSlot;
+
+typedef struct {
+    char* name;
+    int param_count;
+    IrInsn* insns;
+    int insn_count, insn_capacity;
+    IrBlock* blocks;
+    int block_count, block_capacity;
+    IrEdge* edges;
+    int edge_count, edge_capacity;
+    int32_t* args;
+    int arg_count, arg_capacity;
+    IrSlot* slots;
+    int slot_count, slot_capacity;
+    char* strings;
+    int string_size, string_capacity;
+    int line;                   // source line given to new instructions
+} IrFunction;
+
+IrFunction* ir_function_new(const char* name);
+void ir_function_free(IrFunction* function);
+
+int ir_new_block(IrFunction* function);
+void ir_add_edge(IrFunction* function, int from, int to);
+// Appends an instruction with `count` operands to the block and returns
+// its value number. args may be NULL to leave the operands to the caller.
+int ir_append(IrFunction* function, int block, IrOp op, IrType type, const int32_t* args, int count, int32_t imm);
+// Same, placed before instruction `before` (or at the end when IR_NONE).
+int ir_insert(IrFunction* function, int block, int before, IrOp op, IrType type, const int32_t* args, int count,
+              int32_t imm);
+// Unlinks an instruction from its block; its index stays reserved.
+void ir_remove(IrFunction* function, int insn);
+// Gives an instruction a new operand list (phis grow as predecessors are
+// added); the old list is left unused in the arena.
+void ir_set_args(IrFunction* function, int insn, const int32_t* args, int count);
+// First instruction of a block that is not a phi, or IR_NONE.
+int ir_first_non_phi(const IrFunction* function, int block);
+// Puts a new block with a jump on every edge from a block with several
+// successors to a block with several predecessors, keeping the edge's
+// position in both lists, so that phi copies have a place to go.
+void ir_split_critical_edges(IrFunction* function);
+// Unlinks an edge from both blocks and drops the matching operand of the
+// target's phis. The edge's index stays reserved.
+void ir_remove_edge(IrFunction* function, int edge);
+// Rewrites every operand v for which replacement[v] is not IR_NONE,
+// following chains of replacements.
+void ir_replace_uses(IrFunction* function, const int32_t* replacement);
+int ir_add_string(IrFunction* function, const char* text, size_t length);
+int ir_add_slot(IrFunction* function, const char* name, size_t length, int words);
+
+static inline const char* ir_string(const IrFunction* function, int32_t offset) {
+    return function->strings + offset;
+}
+static inline int32_t* ir_args(const IrFunction* function, int insn) {
+    return function->args + function->insns[insn].args;
+}
+// Terminator of a block, or IR_NONE if the block does not end in one yet.
+int ir_terminator(const IrFunction* function, int block);
+int ir_is_terminator(IrOp op);
+// The n-th successor / predecessor block.
+int ir_succ(const IrFunction* function, int block, int n);
+int ir_pred(const IrFunction* function, int block, int n);
+
+const char* ir_op_name(IrOp op);
+void ir_print_function(const IrFunction* function, FILE* output);
+
+// AST to IR (ir_lower.c).
+IrFunction* ir_lower_function(ASTNode* node);
+// IR to RISC-V assembly (ir_emit.c).
+void ir_emit_function(IrFunction* function, FILE* output);
+// The IR pipeline for a whole program: the counterpart of
+// generate_riscv_code. Each function is lowered, optimized by the pass
+// pipeline of `level` (an OptLevel from passes.h; none at -O0) and emitted.
+// dump, if not NULL, receives the IR of each function as it is emitted.
+// With a budget (which may be NULL), a function that runs out of it is
+// written by the direct generator instead, as the tiered compiler does.
+void ir_generate_code(ASTNode* program, FILE* output, FILE* dump, int level, OptBudget* budget);
@@ -0,0 +1,779 @@
+#include "dataflow.h"
+#include "frame.h"
+#include "ir.h"
+#include "remarks.h"
+#include "riscv.h"
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// IR to RISC-V. Blocks are laid out in reverse postorder, values get live
+// intervals from a liveness pass over that layout, and a linear scan
+// assigns registers: t0-t3 to values that are not live across a call,
+// s1-s11 (saved in the prologue) to any value, and a frame word to the rest.
+// Constants and slot addresses are rematerialized at each use instead of
+// occupying a register. t4-t6 are kept free as scratch registers for
+// spilled operands, constants and out-of-range frame offsets.
+//
+// Phis leave SSA form as copies at the end of each predecessor: critical
+// edges are split first, so every predecessor of a block with phis ends in
+// a jump, and the copies for one edge are sequenced as a parallel move.
+
+#define NO_REG (-1)
+
+static const RiscvReg allocatable[] = { T0, T1, T2, T3, S1, S2, S3, S4, S5, S6, S7, S8, S9, S10, S11 };
+#define ALLOCATABLE_COUNT (int)(sizeof(allocatable) / sizeof(allocatable[0]))
+#define CALLER_SAVED_COUNT 4
+
+typedef struct {
+    IrFunction* function;
+    FILE* output;
+    int* layout;                // blocks in emission order
+    int layout_count;
+    int* position;              // per instruction, even numbers in layout order
+    int* block_start;           // per block, position of its first instruction
+    int* block_end;             // per block, position after its terminator
+    int* uses;                  // per value, number of uses
+    uint8_t* folded;            // comparisons emitted as part of their branch
+    int* start;                 // per value, live interval
+    int* end;
+    int8_t* reg;                // per value, RiscvReg or NO_REG
+    int* spill;                 // per value, frame offset when spilled (1 until layout_frame)
+    int frame_words;            // stack_offset of riscv.c: 8 + 4 per word
+    int saved_used[32];
+    int label_base;             // block b is .L(label_base + b)
+    int return_label;
+} Emitter;
+
+static void* xcalloc(size_t count, size_t size) {
+    void* data = calloc(count ? count : 1, size);
+    if (data == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    return data;
+}
+
+static int is_comparison(IrOp op) {
+    return op >= IR_EQ && op <= IR_GE;
+}
+
+// Values that live in a register or a spill slot; constants and slot
+// addresses are rebuilt wherever they are used, and unused results are
+// not computed at all.
+static int needs_location(const Emitter* emitter, int value) {
+    const IrInsn* insn = &emitter->function->insns[value];
+    return insn->type != IR_TYPE_VOID && insn->op != IR_CONST && insn->op != IR_SLOT && !emitter->folded[value] &&
+           emitter->uses[value] > 0;
+}
+
+// Reverse postorder with the successors visited last-first, so that a
+// branch's taken successor (the then-part or the loop body) follows it and
+// the code reads in source order.
+static void compute_layout(Emitter* emitter) {
+    IrFunction* function = emitter->function;
+    int count = function->block_count;
+    int* stack = xcalloc((size_t)count, sizeof(int));
+    int* next_edge = xcalloc((size_t)count, sizeof(int));
+    uint8_t* visited = xcalloc((size_t)count, 1);
+    int* postorder = xcalloc((size_t)count, sizeof(int));
+    int depth = 0;
+    int finished = 0;
+
+    // Successor edges are walked back to front through a per-block cursor.
+    for (int b = 0; b < count; b++) next_edge[b] = function->blocks[b].succ_count - 1;
+    stack[depth++] = 0;
+    visited[0] = 1;
+    while (depth > 0) {
+        int block = stack[depth - 1];
+        if (next_edge[block] >= 0) {
+            int succ = ir_succ(function, block, next_edge[block]--);
+            if (!visited[succ]) {
+                visited[succ] = 1;
+                stack[depth++] = succ;
+            }
+        } else {
+            postorder[finished++] = block;
+            depth--;
+        }
+    }
+    emitter->layout = xcalloc((size_t)finished, sizeof(int));
+    for (int i = 0; i < finished; i++) emitter->layout[i] = postorder[finished - 1 - i];
+    emitter->layout_count = finished;
+    free(stack);
+    free(next_edge);
+    free(visited);
+    free(postorder);
+}
+
+// Phi operands on edges from unreachable blocks are never copied, so they
+// do not count: a phi only they read must not get a location, or its copies
+// would clobber whatever shares it.
+static void count_uses(Emitter* emitter) {
+    IrFunction* function = emitter->function;
+    uint8_t* reachable = xcalloc((size_t)function->block_count, 1);
+    for (int i = 0; i < emitter->layout_count; i++) reachable[emitter->layout[i]] = 1;
+    for (int i = 0; i < emitter->layout_count; i++) {
+        const IrBlock* block = &function->blocks[emitter->layout[i]];
+        for (int insn = block->first; insn != IR_NONE; insn = function->insns[insn].next) {
+            const int32_t* args = ir_args(function, insn);
+            int edge = block->first_pred;
+            for (int a = 0; a < function->insns[insn].arg_count; a++) {
+                if (function->insns[insn].op == IR_PHI) {
+                    int from = function->edges[edge].from;
+                    edge = function->edges[edge].next_pred;
+                    if (!reachable[from]) continue;
+                }
+                emitter->uses[args[a]]++;
+            }
+        }
+    }
+    free(reachable);
+}
+
+// A comparison used only by the branch right after it becomes a compare
+// and branch instruction.
+static void fold_comparisons(Emitter* emitter) {
+    IrFunction* function = emitter->function;
+    for (int i = 0; i < emitter->layout_count; i++) {
+        int branch = ir_terminator(function, emitter->layout[i]);
+        if (branch == IR_NONE || function->insns[branch].op != IR_BRANCH) continue;
+        int condition = ir_args(function, branch)[0];
+        if (function->insns[branch].prev == condition && is_comparison((IrOp)function->insns[condition].op) &&
+            emitter->uses[condition] == 1) {
+            emitter->folded[condition] = 1;
+        }
+    }
+}
+
+static void number_instructions(Emitter* emitter) {
+    IrFunction* function = emitter->function;
+    int position = 0;
+    for (int i = 0; i < emitter->layout_count; i++) {
+        int b = emitter->layout[i];
+        emitter->block_start[b] = position;
+        for (int insn = function->blocks[b].first; insn != IR_NONE; insn = function->insns[insn].next) {
+            emitter->position[insn] = position;
+            position += 2;
+        }
+        emitter->block_end[b] = position;
+        position += 2;
+    }
+}
+
+static int tracked_value(const void* emitter, int value) {
+    return needs_location(emitter, value);
+}
+
+// Live intervals: from the definition to the last use, stretched over every
+// block the value is live into or out of, which covers loops.
+static void compute_intervals(Emitter* emitter) {
+    IrFunction* function = emitter->function;
+    for (int v = 0; v < function->insn_count; v++) {
+        emitter->start[v] = INT32_MAX;
+        emitter->end[v] = -1;
+    }
+    for (int i = 0; i < emitter->layout_count; i++) {
+        int b = emitter->layout[i];
+        for (int insn = function->blocks[b].first; insn != IR_NONE; insn = function->insns[insn].next) {
+            // The operands of a folded comparison are read by the branch.
+            int at = emitter->folded[insn] ? emitter->position[function->insns[insn].next] : emitter->position[insn];
+            const int32_t* args = ir_args(function, insn);
+            int edge = function->blocks[b].first_pred;
+            for (int a = 0; a < function->insns[insn].arg_count; a++) {
+                // A phi operand is read by the copy at the end of its predecessor.
+                if (function->insns[insn].op == IR_PHI) {
+                    at = emitter->position[function->blocks[function->edges[edge].from].last];
+                    edge = function->edges[edge].next_pred;
+                }
+                int value = args[a];
+                if (needs_location(emitter, value) && at > emitter->end[value]) emitter->end[value] = at;
+            }
+            if (needs_location(emitter, insn)) {
+                // All phis of a block are written together, before its first instruction.
+                emitter->start[insn] =
+                    function->insns[insn].op == IR_PHI ? emitter->block_start[b] : emitter->position[insn];
+                if (emitter->end[insn] < emitter->start[insn]) emitter->end[insn] = emitter->start[insn];
+            }
+        }
+    }
+
+    IrLiveness liveness;
+    ir_liveness(&liveness, function, tracked_value, emitter);
+    int words = liveness.flow.in.words;
+    for (int i = 0; i < emitter->layout_count; i++) {
+        int b = emitter->layout[i];
+        const BitWord* in = bit_row(&liveness.flow.in, b);
+        const BitWord* out = bit_row(&liveness.flow.out, b);
+        for (int bit = bit_next(in, words, 0); bit >= 0; bit = bit_next(in, words, bit + 1)) {
+            int value = liveness.value_of[bit];
+            if (emitter->block_start[b] < emitter->start[value]) emitter->start[value] = emitter->block_start[b];
+        }
+        for (int bit = bit_next(out, words, 0); bit >= 0; bit = bit_next(out, words, bit + 1)) {
+            int value = liveness.value_of[bit];
+            if (emitter->block_end[b] > emitter->end[value]) emitter->end[value] = emitter->block_end[b];
+        }
+    }
+    ir_liveness_free(&liveness);
+}
+
+static void report_spill(const Emitter* emitter, int value, int at) {
+    if (!remarks_enabled) return;
+    const IrFunction* function = emitter->function;
+    remark(REMARK_MISSED, "regalloc", "Spilled", function->name, function->insns[value].line,
+           "%s value %%%d lives in the frame: no register free at line %d", ir_op_name((IrOp)function->insns[value].op),
+           value, function->insns[at].line);
+}
+
+// Linear scan over intervals in order of their start (definition order in
+// the layout). When no register is free, the interval that ends last is
+// spilled for its whole lifetime.
+static void allocate_registers(Emitter* emitter) {
+    IrFunction* function = emitter->function;
+    int values = function->insn_count;
+    int positions = emitter->layout_count ? emitter->block_end[emitter->layout[emitter->layout_count - 1]] + 2 : 2;
+    int* calls_before = xcalloc((size_t)positions + 1, sizeof(int));
+    int* order = xcalloc((size_t)values, sizeof(int));
+    int order_count = 0;
+    int owner[32];
+    for (int r = 0; r < 32; r++) owner[r] = IR_NONE;
+
+    for (int i = 0; i < emitter->layout_count; i++) {
+        int b = emitter->layout[i];
+        for (int insn = function->blocks[b].first; insn != IR_NONE; insn = function->insns[insn].next) {
+            if (function->insns[insn].op == IR_CALL) calls_before[emitter->position[insn] + 1]++;
+            if (needs_location(emitter, insn)) order[order_count++] = insn;
+        }
+    }
+    for (int p = 1; p <= positions; p++) calls_before[p] += calls_before[p - 1];
+
+    for (int v = 0; v < values; v++) emitter->reg[v] = NO_REG;
+    for (int i = 0; i < order_count; i++) {
+        int value = order[i];
+        int start = emitter->start[value];
+        int end = emitter->end[value];
+        // A value live across a call needs a callee-saved register.
+        int crosses_call = end > start + 1 && calls_before[end] - calls_before[start + 1] > 0;
+        int first = crosses_call ? CALLER_SAVED_COUNT : 0;
+
+        int chosen = NO_REG;
+        int victim = IR_NONE;
+        for (int r = first; r < ALLOCATABLE_COUNT; r++) {
+            int holder = owner[allocatable[r]];
+            if (holder == IR_NONE || emitter->end[holder] <= start) {
+                chosen = allocatable[r];
+                break;
+            }
+            if (victim == IR_NONE || emitter->end[holder] > emitter->end[victim]) victim = holder;
+        }
+        if (chosen == NO_REG && victim != IR_NONE && emitter->end[victim] > end) {
+            chosen = emitter->reg[victim];
+            emitter->reg[victim] = NO_REG;
+            emitter->spill[victim] = 1;
+            report_spill(emitter, victim, value);
+        }
+        if (chosen == NO_REG) {
+            emitter->spill[value] = 1;
+            report_spill(emitter, value, value);
+            continue;
+        }
+        emitter->reg[value] = (int8_t)chosen;
+        owner[chosen] = value;
+        if (chosen == S1 || (chosen >= S2 && chosen <= S11)) emitter->saved_used[chosen] = 1;
+    }
+    free(calls_before);
+    free(order);
+}
+
+// Frame slots and spilled values go through the frame layout. Spilled
+// values are live over their intervals, as in a register, so those whose
+// intervals do not overlap share a word; slots are live throughout. The
+// most used come first, within reach of a 12-bit offset from s0, then
+// arrays.
+static void layout_frame(Emitter* emitter) {
+    IrFunction* function = emitter->function;
+    FrameLayout frame;
+    frame_init(&frame);
+    for (int i = 0; i < function->slot_count; i++) {
+        frame_add(&frame, function->slots[i].words, function->slots[i].words > 1);
+        frame_use(&frame, i, 0, INT_MAX, 0);
+    }
+    for (int value = 0; value < function->insn_count; value++) {
+        const IrInsn* insn = &function->insns[value];
+        if (insn->op == IR_SLOT) frame_use(&frame, insn->imm, 0, INT_MAX, emitter->uses[value]);
+    }
+    int* object = xcalloc((size_t)function->insn_count, sizeof(int));
+    for (int value = 0; value < function->insn_count; value++) {
+        if (!emitter->spill[value]) continue;
+        object[value] = frame_add(&frame, 1, 0);
+        frame_use(&frame, object[value], emitter->start[value], emitter->end[value], emitter->uses[value]);
+    }
+    emitter->frame_words = frame_assign(&frame, 8);
+    for (int i = 0; i < function->slot_count; i++) function->slots[i].offset = frame.objects[i].offset;
+    for (int value = 0; value < function->insn_count; value++) {
+        if (emitter->spill[value]) emitter->spill[value] = frame.objects[object[value]].offset;
+    }
+    free(object);
+    frame_free(&frame);
+}
+
+static void frame_access(Emitter* emitter, const char* op, RiscvReg reg, int offset) {
+    if (offset <= 2048) {
+        fprintf(emitter->output, "    %s %s, -%d(s0)\n", op, get_register_name(reg), offset);
+    } else {
+        fprintf(emitter->output, "    li t4, -%d\n", offset);
+        fprintf(emitter->output, "    add t4, t4, s0\n");
+        fprintf(emitter->output, "    %s %s, 0(t4)\n", op, get_register_name(reg));
+    }
+}
+
+// Puts `value` in `target` if it is not already in a register, and returns
+// the register holding it.
+static RiscvReg fetch(Emitter* emitter, int value, RiscvReg target) {
+    const IrInsn* insn = &emitter->function->insns[value];
+    FILE* output = emitter->output;
+    if (insn->op == IR_CONST) {
+        if (insn->imm == 0) return ZERO;
+        fprintf(output, "    li %s, %d\n", get_register_name(target), insn->imm);
+        return target;
+    }
+    if (insn->op == IR_SLOT) {
+        int offset = emitter->function->slots[insn->imm].offset;
+        if (offset <= 2048) {
+            fprintf(output, "    addi %s, s0, -%d\n", get_register_name(target), offset);
+        } else {
+            fprintf(output, "    li %s, -%d\n", get_register_name(target), offset);
+            fprintf(output, "    add %s, %s, s0\n", get_register_name(target), get_register_name(target));
+        }
+        return target;
+    }
+    if (emitter->reg[value] != NO_REG) return (RiscvReg)emitter->reg[value];
+    frame_access(emitter, "lw", target, emitter->spill[value]);
+    return target;
+}
+
+static void move_to(Emitter* emitter, int value, RiscvReg target) {
+    RiscvReg reg = fetch(emitter, value, target);
+    if (reg != target) fprintf(emitter->output, "    mv %s, %s\n", get_register_name(target), get_register_name(reg));
+}
+
+// Register to compute a value into, and the store that completes a spilled one.
+static RiscvReg result_reg(Emitter* emitter, int value) {
+    return emitter->reg[value] != NO_REG ? (RiscvReg)emitter->reg[value] : T6;
+}
+
+static void finish_result(Emitter* emitter, int value) {
+    if (emitter->reg[value] == NO_REG) frame_access(emitter, "sw", T6, emitter->spill[value]);
+}
+
+static int small_constant(const Emitter* emitter, int value, int negate) {
+    const IrInsn* insn = &emitter->function->insns[value];
+    if (insn->op != IR_CONST) return 0;
+    int64_t imm = negate ? -(int64_t)insn->imm : insn->imm;
+    return imm >= -2048 && imm <= 2047;
+}
+
+static void emit_binary(Emitter* emitter, int insn) {
+    IrFunction* function = emitter->function;
+    FILE* output = emitter->output;
+    IrOp op = (IrOp)function->insns[insn].op;
+    int left = ir_args(function, insn)[0];
+    int right = ir_args(function, insn)[1];
+    RiscvReg dest = result_reg(emitter, insn);
+    const char* d = get_register_name(dest);
+
+    // Register-immediate forms.
+    static const struct {
+        IrOp op;
+        const char* name;
+        int commutes;
+    } immediates[] = {
+        { IR_ADD, "addi", 1 }, { IR_AND, "andi", 1 }, { IR_OR, "ori", 1 }, { IR_XOR, "xori", 1 }, { IR_LT, "slti", 0 },
+        { IR_SHR, "srli", 0 }
+    };
+    for (size_t i = 0; i < sizeof(immediates) / sizeof(immediates[0]); i++) {
+        if (immediates[i].op != op) continue;
+        if (immediates[i].commutes && small_constant(emitter, left, 0) && !small_constant(emitter, right, 0)) {
+            int swap = left;
+            left = right;
+            right = swap;
+        }
+        if (small_constant(emitter, right, 0)) {
+            RiscvReg source = fetch(emitter, left, T5);
+            fprintf(output, "    %s %s, %s, %d\n", immediates[i].name, d, get_register_name(source),
+                    function->insns[right].imm);
+            finish_result(emitter, insn);
+            return;
+        }
+    }
+    if (op == IR_SUB && small_constant(emitter, right, 1)) {
+        RiscvReg source = fetch(emitter, left, T5);
+        fprintf(output, "    addi %s, %s, %d\n", d, get_register_name(source), -function->insns[right].imm);
+        finish_result(emitter, insn);
+        return;
+    }
+
+    const char* a = get_register_name(fetch(emitter, left, T5));
+    const char* b = get_register_name(fetch(emitter, right, T6));
+    switch (op) {
+        case IR_ADD: fprintf(output, "    add %s, %s, %s\n", d, a, b); break;
+        case IR_SUB: fprintf(output, "    sub %s, %s, %s\n", d, a, b); break;
+        case IR_MUL: fprintf(output, "    mul %s, %s, %s\n", d, a, b); break;
+        case IR_DIV: fprintf(output, "    div %s, %s, %s\n", d, a, b); break;
+        case IR_REM: fprintf(output, "    rem %s, %s, %s\n", d, a, b); break;
+        case IR_AND: fprintf(output, "    and %s, %s, %s\n", d, a, b); break;
+        case IR_OR: fprintf(output, "    or %s, %s, %s\n", d, a, b); break;
+        case IR_XOR: fprintf(output, "    xor %s, %s, %s\n", d, a, b); break;
+        case IR_SHR: fprintf(output, "    srl %s, %s, %s\n", d, a, b); break;
+        case IR_MULHU: fprintf(output, "    mulhu %s, %s, %s\n", d, a, b); break;
+        case IR_EQ:
+            fprintf(output, "    xor %s, %s, %s\n", d, a, b);
+            fprintf(output, "    seqz %s, %s\n", d, d);
+            break;
+        case IR_NE:
+            fprintf(output, "    xor %s, %s, %s\n", d, a, b);
+            fprintf(output, "    snez %s, %s\n", d, d);
+            break;
+        case IR_LT: fprintf(output, "    slt %s, %s, %s\n", d, a, b); break;
+        case IR_GT: fprintf(output, "    slt %s, %s, %s\n", d, b, a); break;
+        case IR_LE:
+            fprintf(output, "    slt %s, %s, %s\n", d, b, a);
+            fprintf(output, "    xori %s, %s, 1\n", d, d);
+            break;
+        case IR_GE:
+            fprintf(output, "    slt %s, %s, %s\n", d, a, b);
+            fprintf(output, "    xori %s, %s, 1\n", d, d);
+            break;
+        default:
+            break;
+    }
+    finish_result(emitter, insn);
+}
+
+// Base register and displacement of the word a pointer value addresses. An
+// element address of a frame array is kept as index * 4 + s0, so that the
+// array's offset goes into the load or store.
+static RiscvReg address_of(Emitter* emitter, int pointer, int* displacement) {
+    const IrInsn* insn = &emitter->function->insns[pointer];
+    *displacement = 0;
+    if (insn->op == IR_SLOT) {
+        *displacement = -emitter->function->slots[insn->imm].offset;
+        return S0;
+    }
+    if (insn->op == IR_ELEMENT) {
+        const IrInsn* base = &emitter->function->insns[ir_args(emitter->function, pointer)[0]];
+        int offset = base->op == IR_SLOT ? emitter->function->slots[base->imm].offset : 0;
+        if (offset <= 2048) *displacement = -offset;
+    }
+    return fetch(emitter, pointer, T5);
+}
+
+static void emit_memory(Emitter* emitter, int insn) {
+    IrFunction* function = emitter->function;
+    const int32_t* args = ir_args(function, insn);
+    const IrInsn* pointer = &function->insns[args[0]];
+    if (pointer->op == IR_SLOT) {
+        int offset = function->slots[pointer->imm].offset;
+        if (function->insns[insn].op == IR_LOAD) {
+            frame_access(emitter, "lw", result_reg(emitter, insn), offset);
+            finish_result(emitter, insn);
+        } else {
+            frame_access(emitter, "sw", fetch(emitter, args[1], T6), offset);
+        }
+        return;
+    }
+    int displacement;
+    if (function->insns[insn].op == IR_LOAD) {
+        RiscvReg base = address_of(emitter, args[0], &displacement);
+        RiscvReg dest = result_reg(emitter, insn);
+        fprintf(emitter->output, "    lw %s, %d(%s)\n", get_register_name(dest), displacement, get_register_name(base));
+        finish_result(emitter, insn);
+    } else {
+        RiscvReg base = address_of(emitter, args[0], &displacement);
+        RiscvReg value = fetch(emitter, args[1], T6);
+        fprintf(emitter->output, "    sw %s, %d(%s)\n", get_register_name(value), displacement, get_register_name(base));
+    }
+}
+
+static void emit_element(Emitter* emitter, int insn) {
+    IrFunction* function = emitter->function;
+    FILE* output = emitter->output;
+    int base = ir_args(function, insn)[0];
+    RiscvReg index = fetch(emitter, ir_args(function, insn)[1], T5);
+    const char* d = get_register_name(result_reg(emitter, insn));
+    if (function->insns[base].op == IR_SLOT) {
+        fprintf(output, "    slli %s, %s, 2\n", d, get_register_name(index));
+        fprintf(output, "    add %s, %s, s0\n", d, d);
+        int offset = function->slots[function->insns[base].imm].offset;
+        if (offset > 2048) {
+            fprintf(output, "    li t4, -%d\n", offset);
+            fprintf(output, "    add %s, %s, t4\n", d, d);
+        }
+    } else {
+        fprintf(output, "    slli t5, %s, 2\n", get_register_name(index));
+        fprintf(output, "    add %s, t5, %s\n", d, get_register_name(fetch(emitter, base, T4)));
+    }
+    finish_result(emitter, insn);
+}
+
+static void emit_call(Emitter* emitter, int insn) {
+    IrFunction* function = emitter->function;
+    const int32_t* args = ir_args(function, insn);
+    // Allocated values never live in argument registers, so the arguments
+    // can be moved in one at a time.
+    for (int a = 0; a < function->insns[insn].arg_count; a++) move_to(emitter, args[a], (RiscvReg)(A0 + a));
+    fprintf(emitter->output, "    call %s\n", ir_string(function, function->insns[insn].imm));
+    if (needs_location(emitter, insn)) {
+        RiscvReg dest = result_reg(emitter, insn);
+        if (dest != A0) fprintf(emitter->output, "    mv %s, a0\n", get_register_name(dest));
+        finish_result(emitter, insn);
+    }
+}
+
+static int next_in_layout(const Emitter* emitter, int index) {
+    return index + 1 < emitter->layout_count ? emitter->layout[index + 1] : IR_NONE;
+}
+
+static void emit_branch(Emitter* emitter, int insn, int layout_index) {
+    IrFunction* function = emitter->function;
+    FILE* output = emitter->output;
+    int block = function->insns[insn].block;
+    int if_true = ir_succ(function, block, 0);
+    int if_false = ir_succ(function, block, 1);
+    int next = next_in_layout(emitter, layout_index);
+    int condition = ir_args(function, insn)[0];
+    // Branch to the false target when the true one follows, else to the true one.
+    int invert = next == if_true;
+    int target = emitter->label_base + (invert ? if_false : if_true);
+
+    if (emitter->folded[condition]) {
+        static const char* taken[] = { "beq", "bne", "blt", "bge", "blt", "bge" };
+        static const char* inverted[] = { "bne", "beq", "bge", "blt", "bge", "blt" };
+        IrOp op = (IrOp)function->insns[condition].op;
+        int left = ir_args(function, condition)[0];
+        int right = ir_args(function, condition)[1];
+        // a > b is b < a and a <= b is b >= a.
+        if (op == IR_GT || op == IR_LE) {
+            int swap = left;
+            left = right;
+            right = swap;
+        }
+        RiscvReg a = fetch(emitter, left, T5);
+        RiscvReg b = fetch(emitter, right, T6);
+        const char* name = (invert ? inverted : taken)[op - IR_EQ];
+        fprintf(output, "    %s %s, %s, .L%d\n", name, get_register_name(a), get_register_name(b), target);
+    } else {
+        RiscvReg reg = fetch(emitter, condition, T5);
+        fprintf(output, "    %s %s, .L%d\n", invert ? "beqz" : "bnez", get_register_name(reg), target);
+    }
+    if (!invert && next != if_false) fprintf(output, "    j .L%d\n", emitter->label_base + if_false);
+}
+
+// Where a value lives for the phi copies: its register, or minus its
+// spill offset.
+static int location(const Emitter* emitter, int value) {
+    return emitter->reg[value] != NO_REG ? emitter->reg[value] : -emitter->spill[value];
+}
+
+static void copy_location(Emitter* emitter, int dest, int source) {
+    if (dest >= 0 && source >= 0) {
+        fprintf(emitter->output, "    mv %s, %s\n", get_register_name((RiscvReg)dest), get_register_name((RiscvReg)source));
+    } else if (dest >= 0) {
+        frame_access(emitter, "lw", (RiscvReg)dest, -source);
+    } else if (source >= 0) {
+        frame_access(emitter, "sw", (RiscvReg)source, -dest);
+    } else {
+        frame_access(emitter, "lw", T5, -source);
+        frame_access(emitter, "sw", T5, -dest);
+    }
+}
+
+// Copies this block's operands into the phis of its successor. The copies
+// happen at once: one is emitted when no other still reads its
+// destination, a cycle is broken by saving one destination in t6, and
+// constants, which overwrite nothing anyone reads, go last.
+static void emit_phi_copies(Emitter* emitter, int block) {
+    IrFunction* function = emitter->function;
+    int succ = ir_succ(function, block, 0);
+    int first = function->blocks[succ].first;
+    if (ir_first_non_phi(function, succ) == first) return;
+    int index = 0;
+    for (int edge = function->blocks[succ].first_pred; function->edges[edge].from != block;
+         edge = function->edges[edge].next_pred) {
+        index++;
+    }
+    int count = 0;
+    for (int phi = first; phi != IR_NONE && function->insns[phi].op == IR_PHI; phi = function->insns[phi].next) count++;
+
+    int* dest = xcalloc((size_t)count, sizeof(int));
+    int* source = xcalloc((size_t)count, sizeof(int));
+    int moves = 0;
+    for (int phi = first; phi != IR_NONE && function->insns[phi].op == IR_PHI; phi = function->insns[phi].next) {
+        int value = ir_args(function, phi)[index];
+        if (!needs_location(emitter, phi) || !needs_location(emitter, value)) continue;
+        if (location(emitter, phi) != location(emitter, value)) {
+            dest[moves] = location(emitter, phi);
+            source[moves++] = location(emitter, value);
+        }
+    }
+    while (moves > 0) {
+        int ready = IR_NONE;
+        for (int i = 0; i < moves && ready == IR_NONE; i++) {
+            ready = i;
+            for (int j = 0; j < moves; j++) {
+                if (source[j] == dest[i]) ready = IR_NONE;
+            }
+        }
+        if (ready == IR_NONE) {
+            copy_location(emitter, T6, dest[0]);
+            for (int j = 0; j < moves; j++) {
+                if (source[j] == dest[0]) source[j] = T6;
+            }
+            continue;
+        }
+        copy_location(emitter, dest[ready], source[ready]);
+        moves--;
+        dest[ready] = dest[moves];
+        source[ready] = source[moves];
+    }
+    for (int phi = first; phi != IR_NONE && function->insns[phi].op == IR_PHI; phi = function->insns[phi].next) {
+        int value = ir_args(function, phi)[index];
+        if (!needs_location(emitter, phi) || needs_location(emitter, value)) continue;
+        int to = location(emitter, phi);
+        if (to >= 0) {
+            move_to(emitter, value, (RiscvReg)to);
+        } else {
+            frame_access(emitter, "sw", fetch(emitter, value, T5), -to);
+        }
+    }
+    free(dest);
+    free(source);
+}
+
+static void emit_insn(Emitter* emitter, int insn, int layout_index) {
+    IrFunction* function = emitter->function;
+    FILE* output = emitter->output;
+    const IrInsn* ir = &function->insns[insn];
+    const int32_t* args = ir_args(function, insn);
+    // Folded comparisons are part of their branch; unused results other
+    // than those of calls need no code.
+    if (emitter->folded[insn] || (ir->type != IR_TYPE_VOID && ir->op != IR_CALL && !needs_location(emitter, insn))) {
+        return;
+    }
+    switch ((IrOp)ir->op) {
+        case IR_CONST:
+        case IR_SLOT:
+            break;
+        case IR_PARAM: {
+            RiscvReg dest = result_reg(emitter, insn);
+            fprintf(output, "    mv %s, %s\n", get_register_name(dest), get_register_name((RiscvReg)(A0 + ir->imm)));
+            finish_result(emitter, insn);
+            break;
+        }
+        case IR_ADD: case IR_SUB: case IR_MUL: case IR_DIV: case IR_REM:
+        case IR_AND: case IR_OR: case IR_XOR: case IR_SHR: case IR_MULHU:
+        case IR_EQ: case IR_NE: case IR_LT: case IR_LE: case IR_GT: case IR_GE:
+            emit_binary(emitter, insn);
+            break;
+        case IR_NEG:
+        case IR_NOT:
+        case IR_BOOL:
+        case IR_COPY: {
+            static const char* names[] = { "neg", "seqz", "snez", "mv" };
+            RiscvReg source = fetch(emitter, args[0], T5);
+            RiscvReg dest = result_reg(emitter, insn);
+            if (ir->op != IR_COPY || dest != source) {
+                fprintf(output, "    %s %s, %s\n", names[ir->op == IR_COPY ? 3 : ir->op - IR_NEG],
+                        get_register_name(dest), get_register_name(source));
+            }
+            finish_result(emitter, insn);
+            break;
+        }
+        case IR_ELEMENT:
+            emit_element(emitter, insn);
+            break;
+        case IR_LOAD:
+        case IR_STORE:
+            emit_memory(emitter, insn);
+            break;
+        case IR_CALL:
+            emit_call(emitter, insn);
+            break;
+        case IR_JUMP: {
+            int target = ir_succ(function, ir->block, 0);
+            emit_phi_copies(emitter, ir->block);
+            if (target != next_in_layout(emitter, layout_index)) {
+                fprintf(output, "    j .L%d\n", emitter->label_base + target);
+            }
+            break;
+        }
+        case IR_BRANCH:
+            emit_branch(emitter, insn, layout_index);
+            break;
+        case IR_RET:
+            move_to(emitter, args[0], A0);
+            if (layout_index + 1 < emitter->layout_count) fprintf(output, "    j .L%d\n", emitter->return_label);
+            break;
+        default:
+            break;
+    }
+}
+
+void ir_emit_function(IrFunction* function, FILE* output) {
+    ir_split_critical_edges(function);
+    Emitter emitter = { 0 };
+    emitter.function = function;
+    emitter.output = output;
+    size_t values = (size_t)function->insn_count;
+    size_t blocks = (size_t)function->block_count;
+    emitter.position = xcalloc(values, sizeof(int));
+    emitter.block_start = xcalloc(blocks, sizeof(int));
+    emitter.block_end = xcalloc(blocks, sizeof(int));
+    emitter.uses = xcalloc(values, sizeof(int));
+    emitter.folded = xcalloc(values, 1);
+    emitter.start = xcalloc(values, sizeof(int));
+    emitter.end = xcalloc(values, sizeof(int));
+    emitter.reg = xcalloc(values, 1);
+    emitter.spill = xcalloc(values, sizeof(int));
+
+    compute_layout(&emitter);
+    count_uses(&emitter);
+    fold_comparisons(&emitter);
+    number_instructions(&emitter);
+    compute_intervals(&emitter);
+    allocate_registers(&emitter);
+    layout_frame(&emitter);
+
+    emitter.label_base = reserve_labels(function->block_count + 1);
+    emitter.return_label = emitter.label_base + function->block_count;
+
+    RiscvReg saved[ALLOCATABLE_COUNT];
+    int saved_count = 0;
+    for (int r = CALLER_SAVED_COUNT; r < ALLOCATABLE_COUNT; r++) {
+        if (emitter.saved_used[allocatable[r]]) saved[saved_count++] = allocatable[r];
+    }
+    int locals = (emitter.frame_words - 8 + saved_count * 4 + 15) / 16 * 16;
+    emit_prologue(output, function->name, locals, saved, saved_count);
+    for (int i = 0; i < emitter.layout_count; i++) {
+        int b = emitter.layout[i];
+        if (i > 0) fprintf(output, ".L%d:\n", emitter.label_base + b);
+        for (int insn = function->blocks[b].first; insn != IR_NONE; insn = function->insns[insn].next) {
+            emit_insn(&emitter, insn, i);
+        }
+    }
+    fprintf(output, ".L%d:\n", emitter.return_label);
+    emit_epilogue(output, locals, saved, saved_count);
+
+    free(emitter.layout);
+    free(emitter.position);
+    free(emitter.block_start);
+    free(emitter.block_end);
+    free(emitter.uses);
+    free(emitter.folded);
+    free(emitter.start);
+    free(emitter.end);
+    free(emitter.reg);
+    free(emitter.spill);
+}
@@ -0,0 +1,618 @@
+#include "ir.h"
+#include "remarks.h"
+#include "symtab.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Lowering of one function's AST to IR. It mirrors the direct code
+// generator in riscv.c statement for statement, so the two stay
+// interchangeable: operands are evaluated left to right, && and || evaluate
+// both sides, and the index of an array assignment is evaluated before the
+// value.
+//
+// Scalar variables that are never indexed (Small C has no address-of
+// operator, so nothing else can reach them) are promoted to SSA values as
+// the code is lowered, following Braun et al., "Simple and Efficient
+// Construction of Static Single Assignment Form": each block records the
+// current value of the variables assigned in it, a read in a block that
+// has none looks through the predecessors, and phis are placed on demand.
+// A block is sealed once all of its predecessors are known; reads in an
+// unsealed block (a loop header while its body is lowered) get an
+// operand-less phi that is completed when the block is sealed. Phis that
+// turn out to merge a single value are forwarded to it and removed. Arrays
+// and scalars that are also indexed live in frame slots.
+typedef struct {
+    const char* name;           // points into the AST
+    size_t length;
+    int words;
+    int indexed;                // appears as name[...]
+    int slot;                   // frame slot, or IR_NONE for an SSA variable
+    int line;                   // of the declaration or the first mention
+} Variable;
+
+typedef struct {
+    uint64_t key;               // variable << 32 | block, plus one; 0 is empty
+    int32_t value;
+} Definition;
+
+typedef struct {
+    int variable;
+    int phi;
+    int next;                   // next incomplete phi of the same block
+} IncompletePhi;
+
+typedef struct {
+    IrFunction* function;
+    int block;                  // block being filled, IR_NONE after a return
+    Variable* variables;
+    int variable_count, variable_capacity;
+    SymbolTable names;          // variable name -> index in variables
+    Definition* definitions;    // open addressing, current value per (variable, block)
+    int definition_count, definition_capacity;
+    uint8_t* sealed;            // per block
+    int* incomplete_head;       // per block, into incomplete
+    int block_capacity;
+    IncompletePhi* incomplete;
+    int incomplete_count, incomplete_capacity;
+    int32_t* forward;           // per instruction: the value a removed phi stands for
+    int forward_capacity;
+    int undefined;              // the value of a variable read before any assignment
+} Lowering;
+
+static void* grow_array(void* data, int* capacity, int needed, size_t size) {
+    if (needed <= *capacity) return data;
+    int new_capacity = *capacity ? *capacity * 2 : 16;
+    while (new_capacity < needed) new_capacity *= 2;
+    data = realloc(data, (size_t)new_capacity * size);
+    if (data == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    *capacity = new_capacity;
+    return data;
+}
+
+static int emit(Lowering* lowering, IrOp op, IrType type, const int32_t* args, int count, int32_t imm) {
+    return ir_append(lowering->function, lowering->block, op, type, args, count, imm);
+}
+
+static int emit2(Lowering* lowering, IrOp op, IrType type, int a, int b) {
+    int32_t args[2] = { a, b };
+    return emit(lowering, op, type, args, 2, 0);
+}
+
+static int emit1(Lowering* lowering, IrOp op, IrType type, int a) {
+    int32_t args[1] = { a };
+    return emit(lowering, op, type, args, 1, 0);
+}
+
+static int constant(Lowering* lowering, int32_t value) {
+    return emit(lowering, IR_CONST, IR_TYPE_I32, NULL, 0, value);
+}
+
+// Ends the current block with a jump to `target`.
+static void jump(Lowering* lowering, int target) {
+    emit(lowering, IR_JUMP, IR_TYPE_VOID, NULL, 0, 0);
+    ir_add_edge(lowering->function, lowering->block, target);
+}
+
+static void branch(Lowering* lowering, int condition, int if_true, int if_false) {
+    emit(lowering, IR_BRANCH, IR_TYPE_VOID, (int32_t[]){ condition }, 1, 0);
+    ir_add_edge(lowering->function, lowering->block, if_true);
+    ir_add_edge(lowering->function, lowering->block, if_false);
+}
+
+// Length of the variable name in a declaration value ("arr[16]" -> 3) and
+// the number of words it occupies.
+static size_t declared_name(const char* value, int* words) {
+    const char* bracket = strchr(value, '[');
+    *words = 1;
+    if (bracket == NULL) return strlen(value);
+    int count = atoi(bracket + 1);
+    if (count > 1) *words = count;
+    return (size_t)(bracket - value);
+}
+
+static int find_variable(const Lowering* lowering, const char* name, size_t length) {
+    const Symbol* symbol = symtab_lookup_text(&lowering->names, name, length);
+    return symbol ? symbol->value : IR_NONE;
+}
+
+static int add_variable(Lowering* lowering, const char* name, size_t length, int words, int line) {
+    int id = symtab_intern(&lowering->names, name, length);
+    const Symbol* symbol = symtab_lookup(&lowering->names, id);
+    if (symbol) {
+        Variable* variable = &lowering->variables[symbol->value];
+        if (words > variable->words) variable->words = words;
+        return symbol->value;
+    }
+    symtab_bind(&lowering->names, id, words > 1 ? SYMBOL_ARRAY : SYMBOL_LOCAL, lowering->variable_count);
+    lowering->variables = grow_array(lowering->variables, &lowering->variable_capacity,
+                                     lowering->variable_count + 1, sizeof(Variable));
+    Variable* variable = &lowering->variables[lowering->variable_count];
+    variable->name = name;
+    variable->length = length;
+    variable->words = words;
+    variable->indexed = 0;
+    variable->slot = IR_NONE;
+    variable->line = line;
+    return lowering->variable_count++;
+}
+
+// Finds every variable the body mentions and whether it is ever indexed.
+static void collect_variables(Lowering* lowering, ASTNode* node) {
+    for (; node; node = node->next) {
+        switch (node->type) {
+            case NODE_DECLARATION: {
+                int words;
+                size_t length = declared_name(node->value, &words);
+                add_variable(lowering, node->value, length, words, node->line);
+                break;
+            }
+            case NODE_EXPRESSION:
+            case NODE_ASSIGNMENT:
+            case NODE_ARRAY_ACCESS:
+                if (node->value && isalpha((unsigned char)node->value[0])) {
+                    int variable = add_variable(lowering, node->value, strlen(node->value), 1, node->line);
+                    if (node->type == NODE_ARRAY_ACCESS) lowering->variables[variable].indexed = 1;
+                }
+                break;
+            default:
+                break;
+        }
+        collect_variables(lowering, node->left);
+        collect_variables(lowering, node->right);
+    }
+}
+
+// Frame slots for the variables that stay in memory, scalars first.
+static void assign_slots(Lowering* lowering) {
+    for (int arrays = 0; arrays < 2; arrays++) {
+        for (int i = 0; i < lowering->variable_count; i++) {
+            Variable* variable = &lowering->variables[i];
+            if ((variable->words > 1 || variable->indexed) && (variable->words > 1) == arrays) {
+                variable->slot = ir_add_slot(lowering->function, variable->name, variable->length, variable->words);
+            }
+        }
+    }
+    if (!remarks_enabled) return;
+    for (int i = 0; i < lowering->variable_count; i++) {
+        const Variable* variable = &lowering->variables[i];
+        int length = (int)variable->length;
+        if (variable->slot == IR_NONE) {
+            remark(REMARK_PASSED, "mem2reg", "Promoted", lowering->function->name, variable->line,
+                   "'%.*s' promoted to SSA values", length, variable->name);
+        } else {
+            remark(REMARK_MISSED, "mem2reg", "NotPromoted", lowering->function->name, variable->line,
+                   "'%.*s' stays in the frame: %s", length, variable->name,
+                   variable->words > 1 ? "it is an array" : "it is indexed");
+        }
+    }
+}
+
+static int new_block(Lowering* lowering) {
+    int block = ir_new_block(lowering->function);
+    if (block >= lowering->block_capacity) {
+        // Both arrays grow from the same capacity by the same rule.
+        int capacity = lowering->block_capacity;
+        lowering->sealed = grow_array(lowering->sealed, &capacity, block + 1, 1);
+        lowering->incomplete_head = grow_array(lowering->incomplete_head, &lowering->block_capacity, block + 1,
+                                               sizeof(int));
+    }
+    lowering->sealed[block] = 0;
+    lowering->incomplete_head[block] = IR_NONE;
+    return block;
+}
+
+static uint64_t definition_key(int variable, int block) {
+    return ((uint64_t)(uint32_t)variable << 32 | (uint32_t)block) + 1;
+}
+
+static Definition* find_definition(Lowering* lowering, uint64_t key) {
+    uint64_t mask = (uint64_t)lowering->definition_capacity - 1;
+    uint64_t hash = key * 0x9E3779B97F4A7C15ull;
+    for (uint64_t i = hash >> 32 & mask;; i = (i + 1) & mask) {
+        Definition* entry = &lowering->definitions[i];
+        if (entry->key == key || entry->key == 0) return entry;
+    }
+}
+
+static void write_variable(Lowering* lowering, int variable, int block, int value) {
+    if (2 * (lowering->definition_count + 1) > lowering->definition_capacity) {
+        Definition* old = lowering->definitions;
+        int old_capacity = lowering->definition_capacity;
+        lowering->definition_capacity = old_capacity ? old_capacity * 2 : 64;
+        lowering->definitions = calloc((size_t)lowering->definition_capacity, sizeof(Definition));
+        if (lowering->definitions == NULL) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(1);
+        }
+        for (int i = 0; i < old_capacity; i++) {
+            if (old[i].key != 0) *find_definition(lowering, old[i].key) = old[i];
+        }
+        free(old);
+    }
+    uint64_t key = definition_key(variable, block);
+    Definition* entry = find_definition(lowering, key);
+    if (entry->key == 0) lowering->definition_count++;
+    entry->key = key;
+    entry->value = value;
+}
+
+static int resolve(const Lowering* lowering, int value) {
+    while (value < lowering->forward_capacity && lowering->forward[value] != IR_NONE) value = lowering->forward[value];
+    return value;
+}
+
+static void forward_value(Lowering* lowering, int from, int to) {
+    int old_capacity = lowering->forward_capacity;
+    lowering->forward = grow_array(lowering->forward, &lowering->forward_capacity, lowering->function->insn_count,
+                                   sizeof(int32_t));
+    for (int i = old_capacity; i < lowering->forward_capacity; i++) lowering->forward[i] = IR_NONE;
+    lowering->forward[from] = to;
+}
+
+static int undefined_value(Lowering* lowering) {
+    if (lowering->undefined == IR_NONE) {
+        IrFunction* function = lowering->function;
+        lowering->undefined = ir_insert(function, 0, function->blocks[0].first, IR_CONST, IR_TYPE_I32, NULL, 0, 0);
+    }
+    return lowering->undefined;
+}
+
+static int new_phi(Lowering* lowering, int block) {
+    IrFunction* function = lowering->function;
+    return ir_insert(function, block, function->blocks[block].first, IR_PHI, IR_TYPE_I32, NULL, 0, 0);
+}
+
+// A phi whose operands are all one value (or itself) is that value.
+static int remove_trivial_phi(Lowering* lowering, int phi) {
+    IrFunction* function = lowering->function;
+    int same = IR_NONE;
+    for (int i = 0; i < function->insns[phi].arg_count; i++) {
+        int operand = resolve(lowering, ir_args(function, phi)[i]);
+        if (operand == same || operand == phi) continue;
+        if (same != IR_NONE) return phi;
+        same = operand;
+    }
+    if (same == IR_NONE) same = undefined_value(lowering);
+    ir_remove(function, phi);
+    forward_value(lowering, phi, same);
+    return same;
+}
+
+static int read_variable(Lowering* lowering, int variable, int block);
+
+static int add_phi_operands(Lowering* lowering, int variable, int phi) {
+    IrFunction* function = lowering->function;
+    int block = function->insns[phi].block;
+    int count = function->blocks[block].pred_count;
+    int32_t* operands = malloc((size_t)count * sizeof(int32_t));
+    if (operands == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    int n = 0;
+    for (int edge = function->blocks[block].first_pred; edge != IR_NONE; edge = function->edges[edge].next_pred) {
+        operands[n++] = read_variable(lowering, variable, function->edges[edge].from);
+    }
+    ir_set_args(function, phi, operands, count);
+    free(operands);
+    return remove_trivial_phi(lowering, phi);
+}
+
+static int read_variable(Lowering* lowering, int variable, int block) {
+    if (lowering->definition_count > 0) {
+        Definition* entry = find_definition(lowering, definition_key(variable, block));
+        if (entry->key != 0) return resolve(lowering, entry->value);
+    }
+
+    const IrBlock* info = &lowering->function->blocks[block];
+    int value;
+    if (!lowering->sealed[block]) {
+        value = new_phi(lowering, block);
+        lowering->incomplete = grow_array(lowering->incomplete, &lowering->incomplete_capacity,
+                                          lowering->incomplete_count + 1, sizeof(IncompletePhi));
+        lowering->incomplete[lowering->incomplete_count] =
+            (IncompletePhi){ variable, value, lowering->incomplete_head[block] };
+        lowering->incomplete_head[block] = lowering->incomplete_count++;
+    } else if (info->pred_count == 0) {
+        value = undefined_value(lowering);
+    } else if (info->pred_count == 1) {
+        value = read_variable(lowering, variable, lowering->function->edges[info->first_pred].from);
+    } else {
+        // The phi is recorded first so that a cycle back to this block ends at it.
+        value = new_phi(lowering, block);
+        write_variable(lowering, variable, block, value);
+        value = add_phi_operands(lowering, variable, value);
+    }
+    write_variable(lowering, variable, block, value);
+    return value;
+}
+
+static void seal_block(Lowering* lowering, int block) {
+    for (int i = lowering->incomplete_head[block]; i != IR_NONE; i = lowering->incomplete[i].next) {
+        add_phi_operands(lowering, lowering->incomplete[i].variable, lowering->incomplete[i].phi);
+    }
+    lowering->incomplete_head[block] = IR_NONE;
+    lowering->sealed[block] = 1;
+}
+
+static int variable_address(Lowering* lowering, int variable) {
+    return emit(lowering, IR_SLOT, IR_TYPE_PTR, NULL, 0, lowering->variables[variable].slot);
+}
+
+static int read_scalar(Lowering* lowering, const char* name) {
+    int variable = add_variable(lowering, name, strlen(name), 1, lowering->function->line);
+    if (lowering->variables[variable].slot == IR_NONE) return read_variable(lowering, variable, lowering->block);
+    return emit1(lowering, IR_LOAD, IR_TYPE_I32, variable_address(lowering, variable));
+}
+
+static void write_scalar(Lowering* lowering, int variable, int value) {
+    if (lowering->variables[variable].slot == IR_NONE) {
+        write_variable(lowering, variable, lowering->block, value);
+    } else {
+        emit2(lowering, IR_STORE, IR_TYPE_VOID, variable_address(lowering, variable), value);
+    }
+}
+
+// Element address of an array; a name that is indexed always has a slot.
+static int element_address(Lowering* lowering, const char* name, int index) {
+    int variable = add_variable(lowering, name, strlen(name), 1, lowering->function->line);
+    return emit2(lowering, IR_ELEMENT, IR_TYPE_PTR, variable_address(lowering, variable), index);
+}
+
+static IrOp binary_op(const char* op) {
+    static const struct {
+        const char* text;
+        IrOp op;
+    } ops[] = {
+        { "+", IR_ADD }, { "-", IR_SUB }, { "*", IR_MUL }, { "/", IR_DIV }, { "%", IR_REM },
+        { "==", IR_EQ }, { "!=", IR_NE }, { "<", IR_LT }, { ">", IR_GT }, { "<=", IR_LE }, { ">=", IR_GE },
+        { "&&", IR_AND }, { "||", IR_OR }
+    };
+    for (size_t i = 0; i < sizeof(ops) / sizeof(ops[0]); i++) {
+        if (strcmp(op, ops[i].text) == 0) return ops[i].op;
+    }
+    return IR_OP_COUNT;
+}
+
+static int lower_expression(Lowering* lowering, ASTNode* node);
+
+static int lower_call(Lowering* lowering, ASTNode* node) {
+    int32_t args[8];
+    int count = 0;
+    for (ASTNode* arg = node->left; arg && count < 8; arg = arg->next) {
+        args[count++] = lower_expression(lowering, arg);
+    }
+    int callee = ir_add_string(lowering->function, node->value, strlen(node->value));
+    return emit(lowering, IR_CALL, IR_TYPE_I32, args, count, callee);
+}
+
+static int lower_expression(Lowering* lowering, ASTNode* node) {
+    if (!node) return constant(lowering, 0);
+
+    switch (node->type) {
+        case NODE_EXPRESSION: {
+            const char* value = node->value;
+            if (value && (isdigit((unsigned char)value[0]) || (value[0] == '-' && isdigit((unsigned char)value[1])))) {
+                return constant(lowering, (int32_t)strtol(value, NULL, 10));
+            }
+            if (value && isalpha((unsigned char)value[0])) {
+                return read_scalar(lowering, value);
+            }
+            if (node->left && node->right) {
+                int left = lower_expression(lowering, node->left);
+                int right = lower_expression(lowering, node->right);
+                IrOp op = value ? binary_op(value) : IR_OP_COUNT;
+                if (op == IR_AND || op == IR_OR) {
+                    // Non-zero operands are not necessarily 1.
+                    if (op == IR_AND) {
+                        left = emit1(lowering, IR_BOOL, IR_TYPE_I32, left);
+                        right = emit1(lowering, IR_BOOL, IR_TYPE_I32, right);
+                        return emit2(lowering, IR_AND, IR_TYPE_I32, left, right);
+                    }
+                    return emit1(lowering, IR_BOOL, IR_TYPE_I32, emit2(lowering, IR_OR, IR_TYPE_I32, left, right));
+                }
+                if (op == IR_OP_COUNT) return constant(lowering, 0);
+                return emit2(lowering, op, IR_TYPE_I32, left, right);
+            }
+            if (node->right && value && strcmp(value, "!") == 0) {
+                return emit1(lowering, IR_NOT, IR_TYPE_I32, lower_expression(lowering, node->right));
+            }
+            if (node->right && value && strcmp(value, "-") == 0) {
+                return emit1(lowering, IR_NEG, IR_TYPE_I32, lower_expression(lowering, node->right));
+            }
+            return constant(lowering, 0);
+        }
+        case NODE_FUNCTION_CALL:
+            return node->value ? lower_call(lowering, node) : constant(lowering, 0);
+        case NODE_ASSIGNMENT:
+            if (node->value) {
+                int value = lower_expression(lowering, node->right);
+                int variable = add_variable(lowering, node->value, strlen(node->value), 1, node->line);
+                write_scalar(lowering, variable, value);
+                return value;
+            }
+            if (node->left && node->left->type == NODE_ARRAY_ACCESS) {
+                int index = lower_expression(lowering, node->left->left);
+                int value = lower_expression(lowering, node->right);
+                emit2(lowering, IR_STORE, IR_TYPE_VOID, element_address(lowering, node->left->value, index), value);
+                return value;
+            }
+            return constant(lowering, 0);
+        case NODE_ARRAY_ACCESS:
+            if (node->value) {
+                int index = lower_expression(lowering, node->left);
+                return emit1(lowering, IR_LOAD, IR_TYPE_I32, element_address(lowering, node->value, index));
+            }
+            return constant(lowering, 0);
+        default:
+            return constant(lowering, 0);
+    }
+}
+
+static void lower_statements(Lowering* lowering, ASTNode* node);
+
+static void lower_if(Lowering* lowering, ASTNode* node) {
+    int condition = lower_expression(lowering, node->left);
+    int then_block = new_block(lowering);
+    int else_block = new_block(lowering);
+    branch(lowering, condition, then_block, else_block);
+    seal_block(lowering, then_block);
+    seal_block(lowering, else_block);
+
+    int join = IR_NONE;
+    lowering->block = then_block;
+    lower_statements(lowering, node->right);
+    if (lowering->block != IR_NONE) {
+        join = new_block(lowering);
+        jump(lowering, join);
+    }
+    lowering->block = else_block;
+    // The ELSE node stays in the statement list; lower_statements skips it.
+    if (node->next && node->next->type == NODE_ELSE) lower_statements(lowering, node->next->right);
+    if (lowering->block != IR_NONE) {
+        if (join == IR_NONE) join = new_block(lowering);
+        jump(lowering, join);
+    }
+    if (join != IR_NONE) seal_block(lowering, join);
+    lowering->block = join;
+}
+
+// Shared by while and for: header evaluating the condition, body, then the
+// iteration expression (for only) and the back edge.
+static void lower_loop(Lowering* lowering, ASTNode* condition, ASTNode* iteration, ASTNode* body) {
+    int header = new_block(lowering);
+    int body_block = new_block(lowering);
+    int exit = new_block(lowering);
+    jump(lowering, header);
+    lowering->block = header;
+    if (condition) lowering->function->line = condition->line;
+    branch(lowering, lower_expression(lowering, condition), body_block, exit);
+    seal_block(lowering, body_block);
+    seal_block(lowering, exit);
+    lowering->block = body_block;
+    lower_statements(lowering, body);
+    if (lowering->block != IR_NONE) {
+        if (iteration) {
+            lowering->function->line = iteration->line;
+            lower_expression(lowering, iteration);
+        }
+        jump(lowering, header);
+    }
+    // The back edge is the header's last predecessor.
+    seal_block(lowering, header);
+    lowering->block = exit;
+}
+
+static void lower_statement(Lowering* lowering, ASTNode* node) {
+    lowering->function->line = node->line;
+    switch (node->type) {
+        case NODE_IF:
+            lower_if(lowering, node);
+            break;
+        case NODE_WHILE:
+            lower_loop(lowering, node->left, NULL, node->right);
+            break;
+        case NODE_FOR:
+            if (node->left) lower_expression(lowering, node->left);
+            if (node->right) {
+                ASTNode* iteration = node->right->next;
+                lower_loop(lowering, node->right, iteration, iteration ? iteration->next : NULL);
+            }
+            break;
+        case NODE_RETURN: {
+            int value = node->left ? lower_expression(lowering, node->left) : constant(lowering, 0);
+            emit(lowering, IR_RET, IR_TYPE_VOID, (int32_t[]){ value }, 1, 0);
+            lowering->block = IR_NONE;
+            break;
+        }
+        case NODE_EXPRESSION:
+        case NODE_ASSIGNMENT:
+        case NODE_FUNCTION_CALL:
+            lower_expression(lowering, node);
+            break;
+        case NODE_DECLARATION:
+            if (node->right) {
+                int words;
+                size_t length = declared_name(node->value, &words);
+                int value = lower_expression(lowering, node->right);
+                write_scalar(lowering, add_variable(lowering, node->value, length, words, node->line), value);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// Statements after a return are unreachable and are not lowered.
+static void lower_statements(Lowering* lowering, ASTNode* node) {
+    for (; node && lowering->block != IR_NONE; node = node->next) {
+        lower_statement(lowering, node);
+    }
+}
+
+// Braun et al. remove a trivial phi's users recursively; here the phis
+// that became trivial only after their operands were simplified are
+// cleaned up once the whole function is built, and every operand is
+// rewritten past the removed phis.
+static void finish_ssa(Lowering* lowering) {
+    IrFunction* function = lowering->function;
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int insn = 0; insn < function->insn_count; insn++) {
+            if (function->insns[insn].block == IR_NONE) continue;
+            int32_t* args = ir_args(function, insn);
+            for (int i = 0; i < function->insns[insn].arg_count; i++) args[i] = resolve(lowering, args[i]);
+        }
+        for (int insn = 0; insn < function->insn_count; insn++) {
+            if (function->insns[insn].block == IR_NONE || function->insns[insn].op != IR_PHI) continue;
+            if (remove_trivial_phi(lowering, insn) != insn) changed = 1;
+        }
+    }
+}
+
+IrFunction* ir_lower_function(ASTNode* node) {
+    if (!node || node->type != NODE_FUNCTION) {
+        fprintf(stderr, "Error: Top level node is not a function\n");
+        exit(1);
+    }
+    Lowering lowering = { 0 };
+    lowering.function = ir_function_new(node->value);
+    lowering.undefined = IR_NONE;
+    IrFunction* function = lowering.function;
+    function->line = node->line;
+    lowering.block = new_block(&lowering);
+    seal_block(&lowering, lowering.block);
+
+    for (ASTNode* param = node->left; param; param = param->next) {
+        add_variable(&lowering, param->value, strlen(param->value), 1, param->line);
+    }
+    collect_variables(&lowering, node->right);
+    assign_slots(&lowering);
+
+    for (ASTNode* param = node->left; param && function->param_count < 8; param = param->next) {
+        int value = emit(&lowering, IR_PARAM, IR_TYPE_I32, NULL, 0, function->param_count++);
+        write_scalar(&lowering, find_variable(&lowering, param->value, strlen(param->value)), value);
+    }
+
+    lower_statements(&lowering, node->right);
+    if (lowering.block != IR_NONE) {
+        function->line = node->line;
+        emit(&lowering, IR_RET, IR_TYPE_VOID, (int32_t[]){ constant(&lowering, 0) }, 1, 0);
+    }
+    finish_ssa(&lowering);
+
+    free(lowering.variables);
+    symtab_free(&lowering.names);
+    free(lowering.definitions);
+    free(lowering.sealed);
+    free(lowering.incomplete_head);
+    free(lowering.incomplete);
+    free(lowering.forward);
+    return function;
+}
@@ -0,0 +1,706 @@
+#include "passes.h"
+#include "range.h"
+#include "remarks.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Scalar transformations on SSA form. Each pass returns the number of
+// rewrites it made and the analyses it left valid; values that a pass
+// makes redundant are recorded in a replacement map and substituted in one
+// sweep at the end, so a pass never has to find the users of a value.
+
+static void* checked(void* data) {
+    if (data == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    return data;
+}
+
+static int32_t* replacement_map(const IrFunction* function) {
+    int32_t* replacement = checked(malloc((size_t)(function->insn_count > 0 ? function->insn_count : 1) *
+                                          sizeof(int32_t)));
+    for (int i = 0; i < function->insn_count; i++) replacement[i] = IR_NONE;
+    return replacement;
+}
+
+static int32_t resolve(const int32_t* replacement, int32_t value) {
+    while (replacement[value] != IR_NONE) value = replacement[value];
+    return value;
+}
+
+static int is_constant(const IrFunction* function, int32_t value, int32_t* imm) {
+    if (function->insns[value].op != IR_CONST) return 0;
+    *imm = function->insns[value].imm;
+    return 1;
+}
+
+static void make_constant(IrFunction* function, int insn, int32_t value) {
+    function->insns[insn].op = IR_CONST;
+    function->insns[insn].type = IR_TYPE_I32;
+    function->insns[insn].arg_count = 0;
+    function->insns[insn].imm = value;
+}
+
+// Moves a phi that became a constant behind the block's other phis.
+static void move_after_phis(IrFunction* function, int insn) {
+    int block = function->insns[insn].block;
+    ir_remove(function, insn);
+    int before = ir_first_non_phi(function, block);
+    IrBlock* owner = &function->blocks[block];
+    IrInsn* moved = &function->insns[insn];
+    moved->block = block;
+    moved->next = before;
+    moved->prev = before == IR_NONE ? owner->last : function->insns[before].prev;
+    if (moved->prev == IR_NONE) {
+        owner->first = insn;
+    } else {
+        function->insns[moved->prev].next = insn;
+    }
+    if (before == IR_NONE) {
+        owner->last = insn;
+    } else {
+        function->insns[before].prev = insn;
+    }
+}
+
+// Removes `insn`, which now computes `value`, and records the substitution.
+static void replace(IrFunction* function, int32_t* replacement, int insn, int32_t value) {
+    replacement[insn] = value;
+    ir_remove(function, insn);
+}
+
+// ---------------------------------------------------------------------------
+// Constant folding
+
+// Arithmetic wraps as on RV32; division by zero and INT_MIN / -1 trap in C
+// but not on the target, so they are left to run there.
+static int evaluate_binary(IrOp op, int32_t a, int32_t b, int32_t* result) {
+    uint32_t x = (uint32_t)a, y = (uint32_t)b;
+    switch (op) {
+    case IR_ADD: *result = (int32_t)(x + y); return 1;
+    case IR_SUB: *result = (int32_t)(x - y); return 1;
+    case IR_MUL: *result = (int32_t)(x * y); return 1;
+    case IR_DIV:
+        if (b == 0 || (a == INT32_MIN && b == -1)) return 0;
+        *result = a / b;
+        return 1;
+    case IR_REM:
+        if (b == 0 || (a == INT32_MIN && b == -1)) return 0;
+        *result = a % b;
+        return 1;
+    case IR_AND: *result = a & b; return 1;
+    case IR_OR: *result = a | b; return 1;
+    case IR_XOR: *result = a ^ b; return 1;
+    case IR_SHR: *result = (int32_t)(x >> (y & 31)); return 1;
+    case IR_MULHU: *result = (int32_t)(((uint64_t)x * y) >> 32); return 1;
+    case IR_EQ: *result = a == b; return 1;
+    case IR_NE: *result = a != b; return 1;
+    case IR_LT: *result = a < b; return 1;
+    case IR_LE: *result = a <= b; return 1;
+    case IR_GT: *result = a > b; return 1;
+    case IR_GE: *result = a >= b; return 1;
+    default: return 0;
+    }
+}
+
+static int is_comparison(IrOp op) {
+    return (op >= IR_EQ && op <= IR_GE) || op == IR_NOT || op == IR_BOOL;
+}
+
+// Identities with one constant operand or two equal ones. Returns the value
+// the instruction reduces to, or IR_NONE; a constant result is returned
+// through *constant with the value set to the instruction itself.
+static int32_t simplify_binary(IrFunction* function, int insn, int32_t left, int32_t right, int32_t* constant) {
+    IrOp op = function->insns[insn].op;
+    int32_t c;
+    if (is_constant(function, right, &c)) {
+        if (c == 0 && (op == IR_ADD || op == IR_SUB || op == IR_OR || op == IR_XOR || op == IR_SHR)) return left;
+        if (c == 1 && (op == IR_MUL || op == IR_DIV)) return left;
+        if (c == -1 && op == IR_AND) return left;
+        if ((c == 0 && (op == IR_MUL || op == IR_AND)) || (c == 1 && op == IR_REM)) {
+            *constant = 0;
+            return insn;
+        }
+    }
+    if (is_constant(function, left, &c)) {
+        if (c == 0 && (op == IR_ADD || op == IR_OR || op == IR_XOR)) return right;
+        if (c == 1 && op == IR_MUL) return right;
+        if (c == -1 && op == IR_AND) return right;
+        if (c == 0 && (op == IR_MUL || op == IR_AND)) {
+            *constant = 0;
+            return insn;
+        }
+    }
+    if (left == right) {
+        switch (op) {
+        case IR_AND:
+        case IR_OR: return left;
+        case IR_SUB:
+        case IR_XOR:
+        case IR_NE:
+        case IR_LT:
+        case IR_GT: *constant = 0; return insn;
+        case IR_EQ:
+        case IR_LE:
+        case IR_GE: *constant = 1; return insn;
+        default: break;
+        }
+    }
+    return IR_NONE;
+}
+
+// Turns a branch on a constant into a jump, dropping the other edge.
+static void fold_branch(IrFunction* function, int block, int insn, int32_t condition, const char* pass) {
+    int taken = function->blocks[block].first_succ;
+    int other = function->edges[taken].next_succ;
+    if (condition == 0) {
+        int swap = taken;
+        taken = other;
+        other = swap;
+    }
+    ir_remove_edge(function, other);
+    function->insns[insn].op = IR_JUMP;
+    function->insns[insn].arg_count = 0;
+    remark(REMARK_PASSED, pass, "BranchFolded", function->name, function->insns[insn].line,
+           "condition is always %s; the branch became a jump", condition ? "true" : "false");
+}
+
+PassResult ir_fold_constants(IrFunction* function, PassContext* context) {
+    const IrCfg* cfg = pass_cfg(context);
+    int32_t* replacement = replacement_map(function);
+    int changes = 0, branches = 0;
+
+    // Reverse postorder sees every operand but loop-carried phi operands
+    // before its users, so folds cascade in one sweep.
+    for (int i = 0; i < cfg->count; i++) {
+        int block = cfg->order[i];
+        int next;
+        for (int insn = function->blocks[block].first; insn != IR_NONE; insn = next) {
+            next = function->insns[insn].next;
+            IrOp op = function->insns[insn].op;
+            int32_t* args = ir_args(function, insn);
+            int count = function->insns[insn].arg_count;
+            for (int a = 0; a < count; a++) args[a] = resolve(replacement, args[a]);
+
+            int32_t a, b, result = 0;
+            int32_t value = IR_NONE;
+            if (op >= IR_ADD && op <= IR_GE) {
+                if (is_constant(function, args[0], &a) && is_constant(function, args[1], &b) &&
+                    evaluate_binary(op, a, b, &result)) {
+                    value = insn;
+                } else {
+                    value = simplify_binary(function, insn, args[0], args[1], &result);
+                }
+            } else if (op == IR_NEG || op == IR_NOT || op == IR_BOOL) {
+                if (is_constant(function, args[0], &a)) {
+                    result = op == IR_NEG ? (int32_t)(0u - (uint32_t)a) : op == IR_NOT ? a == 0 : a != 0;
+                    value = insn;
+                } else if (op == IR_BOOL && is_comparison(function->insns[args[0]].op)) {
+                    value = args[0];
+                }
+            } else if (op == IR_COPY) {
+                value = args[0];
+            } else if (op == IR_PHI && count > 0) {
+                // A phi whose operands are all one value, or all one constant.
+                int same = 1, constant = is_constant(function, args[0], &a);
+                for (int k = 1; k < count && (same || constant); k++) {
+                    if (args[k] != args[0]) same = 0;
+                    if (!is_constant(function, args[k], &b) || b != a) constant = 0;
+                }
+                if (same && args[0] != insn) {
+                    value = args[0];
+                } else if (constant) {
+                    result = a;
+                    value = insn;
+                }
+            } else if (op == IR_BRANCH && is_constant(function, args[0], &a)) {
+                fold_branch(function, block, insn, a, "fold");
+                branches++;
+                changes++;
+            }
+
+            if (value == insn) {
+                make_constant(function, insn, result);
+                if (op == IR_PHI) move_after_phis(function, insn);
+                changes++;
+            } else if (value != IR_NONE) {
+                replace(function, replacement, insn, value);
+                changes++;
+            }
+        }
+    }
+
+    if (changes > 0) ir_replace_uses(function, replacement);
+    free(replacement);
+    return (PassResult){ changes, branches ? PRESERVE_NONE : PRESERVE_CFG };
+}
+
+// ---------------------------------------------------------------------------
+// Value ranges
+
+static int insert_constant(IrFunction* function, int before, int32_t value) {
+    int insn = ir_insert(function, function->insns[before].block, before, IR_CONST, IR_TYPE_I32, NULL, 0, value);
+    function->insns[insn].line = function->insns[before].line;
+    return insn;
+}
+
+static int insert_binary(IrFunction* function, int before, IrOp op, int32_t left, int32_t right) {
+    int32_t args[2] = { left, right };
+    int insn = ir_insert(function, function->insns[before].block, before, op, IR_TYPE_I32, args, 2, 0);
+    function->insns[insn].line = function->insns[before].line;
+    return insn;
+}
+
+static void set_binary(IrFunction* function, int insn, IrOp op, int32_t left, int32_t right) {
+    int32_t* args = ir_args(function, insn);
+    function->insns[insn].op = op;
+    args[0] = left;
+    args[1] = right;
+}
+
+// Fixed-point reciprocal of `divisor` for dividends in [0, largest]: the
+// smallest s for which m = ceil(2^(32+s) / divisor) fits in a word and
+// x * m >> (32 + s) is x / divisor for every such x, which holds while the
+// rounding error of m, times largest, stays below 2^(32+s) (Granlund and
+// Montgomery).
+static int reciprocal(int32_t divisor, int32_t largest, uint32_t* multiplier, int* shift) {
+    for (int s = 0; s < 32; s++) {
+        uint64_t power = (uint64_t)1 << (32 + s);
+        uint64_t m = (power + (uint64_t)divisor - 1) / (uint64_t)divisor;
+        if (m > UINT32_MAX) return 0;
+        if ((m * (uint64_t)divisor - power) * (uint64_t)largest < power) {
+            *multiplier = (uint32_t)m;
+            *shift = s;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// x / c and x % c for a constant c > 1 and x >= 0. Signed division rounds
+// towards zero, so for a negative x a shift needs a correction that a
+// range without negative values makes unnecessary: a power of two becomes
+// a shift or a mask, another c a multiply-high by its reciprocal and a
+// shift, x % c then x - x / c * c. The multiplications are longer than a
+// div, so -Os keeps it.
+static int reduce_division(IrFunction* function, int insn, const IrRange* dividend, int for_size) {
+    IrOp op = function->insns[insn].op;
+    int32_t x = ir_args(function, insn)[0];
+    int32_t divisor;
+    if (dividend->low < 0 || !is_constant(function, ir_args(function, insn)[1], &divisor) || divisor < 2) return 0;
+    const char* what = op == IR_DIV ? "division" : "remainder";
+    if ((divisor & (divisor - 1)) == 0) {
+        int k = 0;
+        while ((1 << k) != divisor) k++;
+        if (op == IR_DIV) {
+            set_binary(function, insn, IR_SHR, x, insert_constant(function, insn, k));
+        } else {
+            set_binary(function, insn, IR_AND, x, insert_constant(function, insn, divisor - 1));
+        }
+        remark(REMARK_PASSED, "ranges", "DivisionReduced", function->name, function->insns[insn].line,
+               "%s by %d of a value in [0, %d] became a %s", what, divisor, dividend->high,
+               op == IR_DIV ? "shift" : "mask");
+        return 1;
+    }
+    uint32_t multiplier;
+    int shift;
+    if (for_size || !reciprocal(divisor, dividend->high, &multiplier, &shift)) return 0;
+    int32_t m = insert_constant(function, insn, (int32_t)multiplier);
+    if (op == IR_DIV && shift == 0) {
+        set_binary(function, insn, IR_MULHU, x, m);
+    } else {
+        int32_t quotient = insert_binary(function, insn, IR_MULHU, x, m);
+        int32_t s = shift > 0 ? insert_constant(function, insn, shift) : IR_NONE;
+        if (op == IR_DIV) {
+            set_binary(function, insn, IR_SHR, quotient, s);
+        } else {
+            if (shift > 0) quotient = insert_binary(function, insn, IR_SHR, quotient, s);
+            int32_t product = insert_binary(function, insn, IR_MUL, quotient, insert_constant(function, insn, divisor));
+            set_binary(function, insn, IR_SUB, x, product);
+        }
+    }
+    remark(REMARK_PASSED, "ranges", "DivisionReduced", function->name, function->insns[insn].line,
+           "%s by %d of a value in [0, %d] became a multiplication by its reciprocal", what, divisor,
+           dividend->high);
+    return 1;
+}
+
+PassResult ir_propagate_ranges(IrFunction* function, PassContext* context) {
+    const IrCfg* cfg = pass_cfg(context);
+    const IrDominators* dominators = pass_dominators(context);
+    const IrRanges* ranges = pass_ranges(context);
+    int for_size = context->level == OPT_OS;
+    int count = function->insn_count;
+    int32_t* replacement = replacement_map(function);
+    int changes = 0, branches = 0;
+
+    for (int i = 0; i < cfg->count; i++) {
+        int block = cfg->order[i];
+        int next;
+        for (int insn = function->blocks[block].first; insn != IR_NONE; insn = next) {
+            next = function->insns[insn].next;
+            IrOp op = function->insns[insn].op;
+            int32_t* args = ir_args(function, insn);
+            for (int a = 0; a < function->insns[insn].arg_count; a++) args[a] = resolve(replacement, args[a]);
+
+            if (op == IR_BRANCH) {
+                IrRange condition = ir_range_at(ranges, function, dominators, args[0], block);
+                if (ir_range_is_empty(&condition) || (condition.ulow == 0 && condition.uhigh != 0)) continue;
+                fold_branch(function, block, insn, condition.ulow != 0, "ranges");
+                branches++;
+                changes++;
+                continue;
+            }
+            IrRange range = ranges->ranges[insn];
+            if (function->insns[insn].type != IR_TYPE_I32 || op == IR_CONST || op == IR_PARAM || op == IR_LOAD ||
+                op == IR_CALL || ir_range_is_empty(&range)) {
+                continue;
+            }
+            int32_t value;
+            if (ir_range_constant(&range, &value)) {
+                if (is_comparison(op)) {
+                    remark(REMARK_PASSED, "ranges", "ComparisonFolded", function->name, function->insns[insn].line,
+                           "%s is always %s given the ranges of its operands", ir_op_name(op),
+                           value ? "true" : "false");
+                }
+                make_constant(function, insn, value);
+                if (op == IR_PHI) move_after_phis(function, insn);
+                changes++;
+                continue;
+            }
+            IrRange left = ir_range_at(ranges, function, dominators, args[0], block);
+            if (op == IR_BOOL && left.uhigh <= 1) {
+                // Already 0 or 1: no snez.
+                replace(function, replacement, insn, args[0]);
+                changes++;
+            } else if (op == IR_REM && left.low >= 0 &&
+                       ir_range_at(ranges, function, dominators, args[1], block).low > left.high) {
+                remark(REMARK_PASSED, "ranges", "RemainderRemoved", function->name, function->insns[insn].line,
+                       "the dividend is always smaller than the divisor");
+                replace(function, replacement, insn, args[0]);
+                changes++;
+            } else if (op == IR_DIV || op == IR_REM) {
+                changes += reduce_division(function, insn, &left, for_size);
+            }
+        }
+    }
+
+    // The reduced divisions added instructions the map does not cover yet.
+    replacement = checked(realloc(replacement, (size_t)function->insn_count * sizeof(int32_t)));
+    for (int v = count; v < function->insn_count; v++) replacement[v] = IR_NONE;
+    if (changes > 0) ir_replace_uses(function, replacement);
+    free(replacement);
+    return (PassResult){ changes, branches ? PRESERVE_NONE : PRESERVE_CFG };
+}
+
+// ---------------------------------------------------------------------------
+// CFG simplification
+
+static void clear_block(IrFunction* function, int block) {
+    while (function->blocks[block].first != IR_NONE) ir_remove(function, function->blocks[block].first);
+    while (function->blocks[block].first_succ != IR_NONE) ir_remove_edge(function, function->blocks[block].first_succ);
+}
+
+// Appends `block` to `pred`, its only predecessor, whose only successor it
+// is: the jump between them goes and the block's successors become pred's.
+static void merge_into(IrFunction* function, int pred, int block) {
+    IrBlock* target = &function->blocks[pred];
+    IrBlock* source = &function->blocks[block];
+    int edge = target->first_succ;
+
+    ir_remove(function, target->last);
+    for (int insn = source->first; insn != IR_NONE; insn = function->insns[insn].next) {
+        function->insns[insn].block = pred;
+    }
+    if (source->first != IR_NONE) {
+        if (target->last == IR_NONE) {
+            target->first = source->first;
+        } else {
+            function->insns[target->last].next = source->first;
+            function->insns[source->first].prev = target->last;
+        }
+        target->last = source->last;
+    }
+    for (int e = source->first_succ; e != IR_NONE; e = function->edges[e].next_succ) function->edges[e].from = pred;
+    target->first_succ = source->first_succ;
+    target->last_succ = source->last_succ;
+    target->succ_count = source->succ_count;
+
+    function->edges[edge].from = function->edges[edge].to = IR_NONE;
+    source->first = source->last = IR_NONE;
+    source->first_pred = source->last_pred = IR_NONE;
+    source->first_succ = source->last_succ = IR_NONE;
+    source->pred_count = source->succ_count = 0;
+}
+
+PassResult ir_simplify_cfg(IrFunction* function, PassContext* context) {
+    const IrCfg* cfg = pass_cfg(context);
+    int changes = 0;
+
+    // Unreachable blocks lose their code and their edges, and with them
+    // their operands of reachable phis.
+    for (int b = 0; b < function->block_count; b++) {
+        if (cfg->index[b] != IR_NONE) continue;
+        if (function->blocks[b].first == IR_NONE && function->blocks[b].first_succ == IR_NONE) continue;
+        if (remarks_enabled) {
+            int count = 0;
+            for (int insn = function->blocks[b].first; insn != IR_NONE; insn = function->insns[insn].next) count++;
+            // Blocks holding only a jump are lowering artefacts, not code.
+            if (count > 1) {
+                remark(REMARK_PASSED, "simplifycfg", "UnreachableRemoved", function->name,
+                       function->insns[function->blocks[b].first].line, "removed %d unreachable instructions", count);
+            }
+        }
+        clear_block(function, b);
+        changes++;
+    }
+
+    // Phis left with a single operand, then straight-line chains of blocks.
+    int32_t* replacement = replacement_map(function);
+    int* order = checked(malloc((size_t)(cfg->count > 0 ? cfg->count : 1) * sizeof(int)));
+    int count = cfg->count;
+    memcpy(order, cfg->order, (size_t)count * sizeof(int));
+    for (int i = 0; i < count; i++) {
+        int block = order[i];
+        int next;
+        for (int phi = function->blocks[block].first; phi != IR_NONE && function->insns[phi].op == IR_PHI; phi = next) {
+            next = function->insns[phi].next;
+            if (function->insns[phi].arg_count == 1) {
+                replace(function, replacement, phi, ir_args(function, phi)[0]);
+                changes++;
+            }
+        }
+    }
+    if (changes > 0) ir_replace_uses(function, replacement);
+    free(replacement);
+
+    for (int i = 1; i < count; i++) {
+        int block = order[i];
+        const IrBlock* current = &function->blocks[block];
+        if (current->pred_count != 1) continue;
+        int pred = function->edges[current->first_pred].from;
+        if (pred == block || function->blocks[pred].succ_count != 1) continue;
+        merge_into(function, pred, block);
+        changes++;
+    }
+    free(order);
+    return (PassResult){ changes, PRESERVE_NONE };
+}
+
+// ---------------------------------------------------------------------------
+// Common subexpression elimination
+
+// Pure operations keyed by operator and operands, as in available
+// expressions, but over the dominator tree: an expression computed in a
+// dominator is available wherever its block dominates, so the table is
+// scoped, with every entry made in a block undone when the walk leaves it.
+typedef struct {
+    int64_t left, right;
+    int32_t op;
+    int32_t value;              // current dominating instruction, or IR_NONE
+} ExpressionEntry;
+
+typedef struct {
+    ExpressionEntry* entries;
+    int capacity;               // power of two
+    int count;
+    int32_t* undo;              // entries set in the blocks on the walk's stack
+    int undo_count, undo_capacity;
+} ExpressionTable;
+
+static int64_t operand_key(const IrFunction* function, int32_t value) {
+    const IrInsn* insn = &function->insns[value];
+    if (insn->op == IR_CONST) return ((int64_t)1 << 40) | (uint32_t)insn->imm;
+    if (insn->op == IR_SLOT) return ((int64_t)2 << 40) | (uint32_t)insn->imm;
+    return value;
+}
+
+static int is_commutative(IrOp op) {
+    return op == IR_ADD || op == IR_MUL || op == IR_AND || op == IR_OR || op == IR_XOR || op == IR_EQ || op == IR_NE;
+}
+
+static uint64_t expression_hash(int32_t op, int64_t left, int64_t right) {
+    uint64_t hash = (uint64_t)op * 0x9e3779b97f4a7c15ull;
+    hash = (hash ^ (uint64_t)left) * 0xff51afd7ed558ccdull;
+    hash = (hash ^ (uint64_t)right) * 0xc4ceb9fe1a85ec53ull;
+    return hash ^ (hash >> 29);
+}
+
+static void table_grow(ExpressionTable* table) {
+    ExpressionEntry* old = table->entries;
+    int old_capacity = table->capacity;
+    table->capacity = old_capacity ? old_capacity * 2 : 256;
+    table->entries = checked(malloc((size_t)table->capacity * sizeof(ExpressionEntry)));
+    for (int i = 0; i < table->capacity; i++) table->entries[i].op = -1;
+    // Entries keep their positions' meaning through the undo log, so it is
+    // rewritten along with them.
+    int32_t* moved = checked(malloc((size_t)(old_capacity > 0 ? old_capacity : 1) * sizeof(int32_t)));
+    for (int i = 0; i < old_capacity; i++) {
+        if (old[i].op < 0) continue;
+        uint64_t slot = expression_hash(old[i].op, old[i].left, old[i].right) & (uint64_t)(table->capacity - 1);
+        while (table->entries[slot].op >= 0) slot = (slot + 1) & (uint64_t)(table->capacity - 1);
+        table->entries[slot] = old[i];
+        moved[i] = (int32_t)slot;
+    }
+    for (int i = 0; i < table->undo_count; i += 2) table->undo[i] = moved[table->undo[i]];
+    free(moved);
+    free(old);
+}
+
+static int table_find(ExpressionTable* table, int32_t op, int64_t left, int64_t right) {
+    if ((table->count + 1) * 2 > table->capacity) table_grow(table);
+    uint64_t mask = (uint64_t)(table->capacity - 1);
+    uint64_t slot = expression_hash(op, left, right) & mask;
+    for (;; slot = (slot + 1) & mask) {
+        ExpressionEntry* entry = &table->entries[slot];
+        if (entry->op < 0) {
+            entry->op = op;
+            entry->left = left;
+            entry->right = right;
+            entry->value = IR_NONE;
+            table->count++;
+            return (int)slot;
+        }
+        if (entry->op == op && entry->left == left && entry->right == right) return (int)slot;
+    }
+}
+
+// The undo log holds (entry, previous value) pairs.
+static void table_set(ExpressionTable* table, int slot, int32_t value) {
+    if (table->undo_count + 2 > table->undo_capacity) {
+        table->undo_capacity = table->undo_capacity ? table->undo_capacity * 2 : 256;
+        table->undo = checked(realloc(table->undo, (size_t)table->undo_capacity * sizeof(int32_t)));
+    }
+    table->undo[table->undo_count++] = slot;
+    table->undo[table->undo_count++] = table->entries[slot].value;
+    table->entries[slot].value = value;
+}
+
+static void table_unwind(ExpressionTable* table, int mark) {
+    while (table->undo_count > mark) {
+        int32_t previous = table->undo[--table->undo_count];
+        int32_t slot = table->undo[--table->undo_count];
+        table->entries[slot].value = previous;
+    }
+}
+
+static int cse_block(IrFunction* function, ExpressionTable* table, int32_t* replacement, int block) {
+    int changes = 0, next;
+    for (int insn = function->blocks[block].first; insn != IR_NONE; insn = next) {
+        next = function->insns[insn].next;
+        IrOp op = function->insns[insn].op;
+        int32_t* args = ir_args(function, insn);
+        for (int a = 0; a < function->insns[insn].arg_count; a++) args[a] = resolve(replacement, args[a]);
+        if (op < IR_ADD || op > IR_ELEMENT) continue;
+
+        int64_t left = operand_key(function, args[0]);
+        int64_t right = function->insns[insn].arg_count > 1 ? operand_key(function, args[1]) : -1;
+        if (is_commutative(op) && right < left) {
+            int64_t swap = left;
+            left = right;
+            right = swap;
+        }
+        int slot = table_find(table, op, left, right);
+        if (table->entries[slot].value != IR_NONE) {
+            int dominating = table->entries[slot].value;
+            remark(REMARK_PASSED, "cse", "Eliminated", function->name, function->insns[insn].line,
+                   "redundant %s reuses the value computed on line %d", ir_op_name(op),
+                   function->insns[dominating].line);
+            replace(function, replacement, insn, dominating);
+            changes++;
+        } else {
+            table_set(table, slot, insn);
+        }
+    }
+    return changes;
+}
+
+PassResult ir_eliminate_common_subexpressions(IrFunction* function, PassContext* context) {
+    const IrCfg* cfg = pass_cfg(context);
+    const IrDominators* dominators = pass_dominators(context);
+    if (cfg->count == 0) return (PassResult){ 0, PRESERVE_CFG };
+
+    ExpressionTable table = { 0 };
+    int32_t* replacement = replacement_map(function);
+    // Depth-first over the dominator tree: (block, undo mark) per level.
+    int* stack = checked(malloc((size_t)cfg->count * 2 * sizeof(int)));
+    int* child = checked(malloc((size_t)function->block_count * sizeof(int)));
+    int depth = 0, changes = 0;
+
+    int entry = cfg->order[0];
+    stack[0] = entry;
+    stack[1] = table.undo_count;
+    depth = 1;
+    changes += cse_block(function, &table, replacement, entry);
+    child[entry] = dominators->first_child[entry];
+    while (depth > 0) {
+        int block = stack[2 * (depth - 1)];
+        int next = child[block];
+        if (next == IR_NONE) {
+            table_unwind(&table, stack[2 * (depth - 1) + 1]);
+            depth--;
+            continue;
+        }
+        child[block] = dominators->next_sibling[next];
+        stack[2 * depth] = next;
+        stack[2 * depth + 1] = table.undo_count;
+        depth++;
+        changes += cse_block(function, &table, replacement, next);
+        child[next] = dominators->first_child[next];
+    }
+
+    if (changes > 0) ir_replace_uses(function, replacement);
+    free(stack);
+    free(child);
+    free(replacement);
+    free(table.entries);
+    free(table.undo);
+    return (PassResult){ changes, PRESERVE_CFG };
+}
+
+// ---------------------------------------------------------------------------
+// Dead code elimination
+
+static int has_effect(IrOp op) {
+    return op == IR_STORE || op == IR_CALL || ir_is_terminator(op);
+}
+
+PassResult ir_eliminate_dead_code(IrFunction* function, PassContext* context) {
+    (void)context;
+    char* live = checked(calloc((size_t)(function->insn_count > 0 ? function->insn_count : 1), 1));
+    int32_t* work = checked(malloc((size_t)(function->insn_count > 0 ? function->insn_count : 1) * sizeof(int32_t)));
+    int size = 0;
+
+    for (int b = 0; b < function->block_count; b++) {
+        for (int insn = function->blocks[b].first; insn != IR_NONE; insn = function->insns[insn].next) {
+            if (!has_effect((IrOp)function->insns[insn].op)) continue;
+            live[insn] = 1;
+            work[size++] = insn;
+        }
+    }
+    while (size > 0) {
+        int insn = work[--size];
+        const int32_t* args = ir_args(function, insn);
+        for (int a = 0; a < function->insns[insn].arg_count; a++) {
+            if (live[args[a]]) continue;
+            live[args[a]] = 1;
+            work[size++] = args[a];
+        }
+    }
+
+    int changes = 0;
+    for (int b = 0; b < function->block_count; b++) {
+        int next;
+        for (int insn = function->blocks[b].first; insn != IR_NONE; insn = next) {
+            next = function->insns[insn].next;
+            if (live[insn]) continue;
+            ir_remove(function, insn);
+            changes++;
+        }
+    }
+    free(live);
+    free(work);
+    return (PassResult){ changes, PRESERVE_CFG };
+}
@@ -0,0 +1,16 @@
+#include "json.h"
+
+void write_json_string(FILE* output, const char* text) {
+    fputc('"', output);
+    for (const unsigned char* c = (const unsigned char*)text; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', output);
+            fputc(*c, output);
+        } else if (*c < 0x20) {
+            fprintf(output, "\\u%04x", *c);
+        } else {
+            fputc(*c, output);
+        }
+    }
+    fputc('"', output);
+}
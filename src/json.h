@@ -0,0 +1,8 @@
+#pragma once
+
+#include <stdio.h>
+
+// JSON output shared by the -ftime-trace and -fsave-optimization-record
+// writers. Writes text as a quoted JSON string, escaping quotes,
+// backslashes and control characters.
+void write_json_string(FILE* output, const char* text);
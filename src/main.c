@@ -1,39 +1,314 @@
 #include "compiler.h"
 #include "riscv.h"
+#include "ast_cache.h"
+#include "batch.h"
+#include "tiered.h"
+#include "distrib.h"
+#include "phase.h"
+#include "memstats.h"
+#include "probes.h"
+#include "driver.h"
+#include "rvasm.h"
+#include "rvmca.h"
+#include "ir.h"
+#include "passes.h"
+#include "remarks.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+static void print_usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [--ast-cache=<file>] [-O0|-O1|-O2|-Os] [-fir [-fdump-ir]] [-ftiered]\n"
+                    "          [-fopt-fuel=<n>] [-fopt-fuel-total=<n>] [-fopt-time=<ms>] [-fopt-deadline=<ms>]\n"
+                    "          [-ffuel-report] [-ftime-report] [-ftime-trace=<file.json>] [-fperf-report]\n"
+                    "          [-fmem-report] [-fmca-report[=<model>]] [-fpass-stats]\n"
+                    "          [-fsave-optimization-record=<file.json>] <input_file>\n", prog);
+    fprintf(stderr, "       %s --batch [--batch-io=auto|io_uring|threads|stdio] [<options>] <input_file>...\n", prog);
+    fprintf(stderr, "       %s --workers=<host:port>[,<host:port>...] [--worker-timeout=<ms>] [<options>]\n"
+                    "          <input_file>...\n", prog);
+    fprintf(stderr, "       %s --worker=[<host>:]<port>\n", prog);
+    fprintf(stderr, "The -fopt-* limits and -ffuel-report need -O1, -O2, -Os, -fir or -ftiered. With --batch and\n"
+                    "--workers the limits apply to each file, and -ffuel-report is not available.\n");
+}
+
+static void report_tier(CompileTier tier, const char* output_path, void* user) {
+    (void)user;
+    printf("RISC-V assembly generated in %s (%s tier)\n", output_path, compile_tier_name(tier));
+    fflush(stdout);
+}
+
+// Runs the static throughput analyzer over the generated assembly.
+static void report_throughput(const char* path, const RvCoreModel* model) {
+    char* text;
+    size_t len;
+    if (read_source_file(path, &text, &len) != 0) {
+        fprintf(stderr, "Error: Cannot open file %s\n", path);
+        return;
+    }
+    RvProgram program;
+    if (rv_assemble(text, len, &program) != 0) {
+        fprintf(stderr, "Error: %s:%s\n", path, program.error);
+    } else {
+        RvMcaOptions options = { model, 100, NULL };
+        rv_mca_report(&program, &options, stderr);
+        rv_program_free(&program);
+    }
+    free(text);
+}
+
+static int parse_input(FILE* input_file) {
+    phase_begin(PHASE_PARSE);
+    yyin = input_file;
+    int parsed = yyparse() == 0;
+    phase_end(PHASE_PARSE);
+    return parsed;
+}
+
+static uint64_t hash_file(FILE* file) {
+    char buffer[65536];
+    size_t n;
+    uint64_t hash = AST_CACHE_HASH_SEED;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        hash = ast_cache_hash(hash, buffer, n);
+    }
+    rewind(file);
+    return hash;
+}
 
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        fprintf(stderr, "Usage: %s <input_file>\n", argv[0]);
+    const char* ast_cache_path = NULL;
+    int batch = 0;
+    int tiered = 0;
+    int fuel_report = 0;
+    int time_report = 0;
+    const char* time_trace = NULL;
+    int mem_report_enabled = 0;
+    int perf_report = 0;
+    const RvCoreModel* mca_model = NULL;
+    int use_ir = 0;
+    int dump_ir = 0;
+    OptLevel opt_level = OPT_O0;
+    int pass_stats = 0;
+    const char* optimization_record = NULL;
+    OptLimits limits = {0};
+    const char* limit_option = NULL;
+    BatchIoMode batch_io = BATCH_IO_AUTO;
+    const char* workers = NULL;
+    int worker_timeout = DIST_TIMEOUT_MS;
+    char** inputs = malloc((size_t)argc * sizeof(char*));
+    int input_count = 0;
+    if (!inputs) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return 1;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--ast-cache=", 12) == 0) {
+            ast_cache_path = argv[i] + 12;
+        } else if (strcmp(argv[i], "-ftiered") == 0) {
+            tiered = 1;
+        } else if (strncmp(argv[i], "-fopt-fuel=", 11) == 0) {
+            limit_option = argv[i];
+            limits.function_fuel = atol(argv[i] + 11);
+        } else if (strncmp(argv[i], "-fopt-fuel-total=", 17) == 0) {
+            limit_option = argv[i];
+            limits.compile_fuel = atol(argv[i] + 17);
+        } else if (strncmp(argv[i], "-fopt-time=", 11) == 0) {
+            limit_option = argv[i];
+            limits.function_ms = atof(argv[i] + 11);
+        } else if (strncmp(argv[i], "-fopt-deadline=", 15) == 0) {
+            limit_option = argv[i];
+            limits.compile_ms = atof(argv[i] + 15);
+        } else if (strcmp(argv[i], "-ffuel-report") == 0) {
+            fuel_report = 1;
+        } else if (strcmp(argv[i], "-ftime-report") == 0) {
+            time_report = 1;
+        } else if (strncmp(argv[i], "-ftime-trace=", 13) == 0) {
+            time_trace = argv[i] + 13;
+        } else if (strcmp(argv[i], "-fperf-report") == 0) {
+            perf_report = 1;
+        } else if (strcmp(argv[i], "-fir") == 0) {
+            use_ir = 1;
+        } else if (strcmp(argv[i], "-fdump-ir") == 0) {
+            dump_ir = 1;
+        } else if (parse_opt_level(argv[i], &opt_level) == 0) {
+            // -O1 and up go through the IR; -O0 keeps the direct generator.
+        } else if (strcmp(argv[i], "-fpass-stats") == 0) {
+            pass_stats = 1;
+        } else if (strncmp(argv[i], "-fsave-optimization-record=", 27) == 0) {
+            optimization_record = argv[i] + 27;
+        } else if (strcmp(argv[i], "-fmca-report") == 0) {
+            mca_model = rv_core_model(NULL);
+        } else if (strncmp(argv[i], "-fmca-report=", 13) == 0) {
+            mca_model = rv_core_model(argv[i] + 13);
+            if (!mca_model) {
+                fprintf(stderr, "Error: Unknown core model '%s'; models:\n", argv[i] + 13);
+                rv_core_model_list(stderr);
+                free(inputs);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-fmem-report") == 0) {
+            mem_report_enabled = 1;
+        } else if (strncmp(argv[i], "--worker=", 9) == 0) {
+            free(inputs);
+            return run_worker(argv[i] + 9);
+        } else if (strncmp(argv[i], "--workers=", 10) == 0) {
+            workers = argv[i] + 10;
+        } else if (strncmp(argv[i], "--worker-timeout=", 17) == 0) {
+            worker_timeout = atoi(argv[i] + 17);
+        } else if (strcmp(argv[i], "--batch") == 0) {
+            batch = 1;
+        } else if (strncmp(argv[i], "--batch-io=", 11) == 0) {
+            if (parse_batch_io_mode(argv[i] + 11, &batch_io) != 0) {
+                print_usage(argv[0]);
+                free(inputs);
+                return 1;
+            }
+        } else if (argv[i][0] != '-') {
+            inputs[input_count++] = argv[i];
+        } else {
+            print_usage(argv[0]);
+            free(inputs);
+            return 1;
+        }
+    }
+    if (time_report || time_trace || perf_report || mem_report_enabled) phase_enable(time_report, time_trace);
+    if (perf_report) phase_enable_counters();
+    if (mem_report_enabled) mem_enable();
+    if (pass_stats) pass_stats_enable();
+    if (optimization_record && remarks_open(optimization_record) != 0) {
+        fprintf(stderr, "Error: Cannot create optimization record %s\n", optimization_record);
+        free(inputs);
         return 1;
     }
+    if (opt_level != OPT_O0) use_ir = 1;
+    if ((limit_option || fuel_report) && !use_ir && !tiered) {
+        // The direct generator has no optimization to bound.
+        fprintf(stderr, "Error: %s needs -O1, -O2, -Os, -fir or -ftiered\n",
+                limit_option ? limit_option : "-ffuel-report");
+        free(inputs);
+        remarks_close();
+        return 1;
+    }
+    if (fuel_report && (workers || batch)) {
+        fprintf(stderr, "Error: -ffuel-report needs a single input file\n");
+        free(inputs);
+        remarks_close();
+        return 1;
+    }
+    if (workers || batch) {
+        compile_buffer_set_options(opt_level, use_ir, &limits);
+        int failures = workers ? distributed_compile(inputs, input_count, workers, opt_level, use_ir, &limits,
+                                                     worker_timeout)
+                               : batch_compile(inputs, input_count, batch_io);
+        free(inputs);
+        remarks_close();
+        if (pass_stats) pass_stats_report(stderr);
+        phase_finish();
+        mem_report(stderr);
+        return failures ? 1 : 0;
+    }
+    if (input_count != 1) {
+        print_usage(argv[0]);
+        free(inputs);
+        remarks_close();
+        return 1;
+    }
+    const char* input_filename = inputs[0];
+    free(inputs);
+    remarks_set_source(input_filename);
 
-    FILE* input_file = fopen(argv[1], "r");
+    phase_begin(PHASE_INPUT);
+    FILE* input_file = fopen(input_filename, "r");
+    phase_end(PHASE_INPUT);
     if (!input_file) {
-        fprintf(stderr, "Error: Cannot open file %s\n", argv[1]);
+        fprintf(stderr, "Error: Cannot open file %s\n", input_filename);
+        remarks_close();
         return 1;
     }
 
-    yyin = input_file;
-    
-    if (yyparse() == 0) {
+    AstCache cache = {0};
+    int cached = 0;
+    int parsed = 0;
+    if (ast_cache_path) {
+        phase_begin(PHASE_INPUT);
+        uint64_t source_hash = hash_file(input_file);
+        cached = ast_cache_load(ast_cache_path, source_hash, &cache) == 0;
+        CC_PROBE3(cache__lookup, ast_cache_path, cached, cache.node_count);
+        phase_end(PHASE_INPUT);
+        if (cached) {
+            root = cache.root;
+            parsed = 1;
+        } else {
+            parsed = parse_input(input_file);
+            phase_begin(PHASE_OUTPUT);
+            if (parsed && ast_cache_write(root, source_hash, ast_cache_path) != 0) {
+                fprintf(stderr, "Warning: Cannot write AST cache %s\n", ast_cache_path);
+            }
+            phase_end(PHASE_OUTPUT);
+        }
+    } else {
+        parsed = parse_input(input_file);
+    }
+
+    // Output errors still go through the cleanup below, which finishes the
+    // optimization record and releases the AST or its cache mapping.
+    int status = 0;
+    int generated = 0;
+    if (parsed && tiered) {
+        phase_begin(PHASE_CODEGEN);
+        TieredCompile* compile = tiered_compile_start(root, "output.s", &limits, opt_level, use_ir, report_tier,
+                                                       NULL);
+        phase_end(PHASE_CODEGEN);
+        if (!compile) {
+            fprintf(stderr, "Error: Cannot create output file %s\n", "output.s");
+            status = 1;
+        } else {
+            if (fuel_report) opt_budget_report(tiered_compile_budget(compile), stdout);
+            tiered_compile_finish(compile);
+            generated = 1;
+        }
+    } else if (parsed) {
         char* output_filename = "output.s";
+        phase_begin(PHASE_OUTPUT);
         FILE* output_file = fopen(output_filename, "w");
+        phase_end(PHASE_OUTPUT);
         if (!output_file) {
             fprintf(stderr, "Error: Cannot create output file %s\n", output_filename);
-            fclose(input_file);
-            return 1;
+            status = 1;
+        } else {
+            phase_begin(PHASE_CODEGEN);
+            if (use_ir) {
+                OptBudget budget;
+                opt_budget_init(&budget, &limits);
+                ir_generate_code(root, output_file, dump_ir ? stderr : NULL, opt_level, &budget);
+                if (fuel_report) opt_budget_report(&budget, stdout);
+                opt_budget_free(&budget);
+            } else {
+                generate_riscv_code(root, output_file);
+            }
+            phase_end(PHASE_CODEGEN);
+            phase_begin(PHASE_OUTPUT);
+            fclose(output_file);
+            phase_end(PHASE_OUTPUT);
+            printf("RISC-V assembly generated in %s\n", output_filename);
+            generated = 1;
         }
-        
-        generate_riscv_code(root, output_file);
-        fclose(output_file);
-        printf("RISC-V assembly generated in %s\n", output_filename);
     } else {
         fprintf(stderr, "Compilation failed at line %d\n", yylineno);
     }
 
-    free_ast(root);
+    if (generated && mca_model) report_throughput("output.s", mca_model);
+    if (parsed) mem_record_functions(root);
+    if (cached) {
+        ast_cache_close(&cache);
+    } else {
+        free_ast(root);
+    }
     fclose(input_file);
-    return 0;
-} 
\ No newline at end of file
+    remarks_close();
+    if (pass_stats) pass_stats_report(stderr);
+    phase_finish();
+    mem_report(stderr);
+    return status;
+}
@@ -0,0 +1,134 @@
+#define _POSIX_C_SOURCE 200809L
+#include "memstats.h"
+#include "phase.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#define REPORT_FUNCTIONS 10
+
+typedef struct {
+    long allocs;
+    size_t bytes;
+    size_t peak_live;
+} MemCounter;
+
+typedef struct {
+    char* name;
+    long nodes;
+} FunctionSize;
+
+int mem_tracking = 0;
+
+static MemCounter by_phase[PHASE_COUNT + 1];    // last slot: outside any phase
+static MemCounter by_kind[MEM_KIND_COUNT];
+static long node_counts[NODE_ARRAY_ACCESS + 1];
+static size_t node_value_bytes[NODE_ARRAY_ACCESS + 1];
+static size_t live_bytes = 0;
+static size_t peak_live_bytes = 0;
+static FunctionSize* function_sizes = NULL;
+static int function_count = 0;
+
+static const char* kind_names[MEM_KIND_COUNT] = {
+    "AST nodes", "lexer strings", "my_strdup strings", "AST cache view", "IR arenas"
+};
+
+void mem_enable(void) {
+    mem_tracking = 1;
+}
+
+void mem_alloc(MemKind kind, size_t bytes) {
+    if (!mem_tracking) return;
+    MemCounter* phase = &by_phase[phase_current()];
+    live_bytes += bytes;
+    if (live_bytes > peak_live_bytes) peak_live_bytes = live_bytes;
+    phase->allocs++;
+    phase->bytes += bytes;
+    if (live_bytes > phase->peak_live) phase->peak_live = live_bytes;
+    by_kind[kind].allocs++;
+    by_kind[kind].bytes += bytes;
+}
+
+void mem_free(size_t bytes) {
+    if (!mem_tracking) return;
+    live_bytes = bytes > live_bytes ? 0 : live_bytes - bytes;
+}
+
+void mem_node_alloc(NodeType type, size_t value_bytes) {
+    if (!mem_tracking) return;
+    node_counts[type]++;
+    node_value_bytes[type] += value_bytes;
+    mem_alloc(MEM_AST_NODE, sizeof(ASTNode));
+}
+
+static long count_nodes(ASTNode* node) {
+    long count = 0;
+    for (; node; node = node->next) {
+        count += 1 + count_nodes(node->left) + count_nodes(node->right);
+    }
+    return count;
+}
+
+void mem_record_functions(ASTNode* program) {
+    if (!mem_tracking) return;
+    for (ASTNode* function = program; function; function = function->next) {
+        FunctionSize* sizes = realloc(function_sizes, (size_t)(function_count + 1) * sizeof(FunctionSize));
+        if (sizes == NULL) return;
+        function_sizes = sizes;
+        function_sizes[function_count].name = strdup(function->value ? function->value : "?");
+        function_sizes[function_count].nodes = 1 + count_nodes(function->left) + count_nodes(function->right);
+        function_count++;
+    }
+}
+
+static int by_size(const void* a, const void* b) {
+    long na = ((const FunctionSize*)a)->nodes;
+    long nb = ((const FunctionSize*)b)->nodes;
+    return na < nb ? 1 : na > nb ? -1 : 0;
+}
+
+void mem_report(FILE* output) {
+    if (!mem_tracking) return;
+
+    fprintf(output, "\nMemory usage by phase\n");
+    fprintf(output, " %-22s %10s %12s %12s\n", "phase", "allocs", "bytes", "peak live");
+    for (int i = 0; i <= PHASE_COUNT; i++) {
+        const MemCounter* counter = &by_phase[i];
+        fprintf(output, " %-22s %10ld %12zu %12zu\n", i < PHASE_COUNT ? phase_name((CompilerPhase)i) : "other",
+                counter->allocs, counter->bytes, counter->peak_live);
+    }
+
+    fprintf(output, "\nMemory usage by kind\n");
+    fprintf(output, " %-22s %10s %12s\n", "kind", "allocs", "bytes");
+    for (int i = 0; i < MEM_KIND_COUNT; i++) {
+        fprintf(output, " %-22s %10ld %12zu\n", kind_names[i], by_kind[i].allocs, by_kind[i].bytes);
+    }
+
+    fprintf(output, "\nAST nodes by type (node size %zu bytes)\n", sizeof(ASTNode));
+    fprintf(output, " %-22s %10s %12s %12s\n", "type", "nodes", "node bytes", "value bytes");
+    for (int i = 0; i <= NODE_ARRAY_ACCESS; i++) {
+        if (node_counts[i] == 0) continue;
+        fprintf(output, " %-22s %10ld %12zu %12zu\n", node_type_name((NodeType)i), node_counts[i],
+                (size_t)node_counts[i] * sizeof(ASTNode), node_value_bytes[i]);
+    }
+
+    if (function_count > 0) {
+        qsort(function_sizes, (size_t)function_count, sizeof(FunctionSize), by_size);
+        int shown = function_count < REPORT_FUNCTIONS ? function_count : REPORT_FUNCTIONS;
+        fprintf(output, "\nLargest functions by AST size (%d of %d)\n", shown, function_count);
+        for (int i = 0; i < shown; i++) {
+            fprintf(output, " %-22s %10ld nodes\n", function_sizes[i].name, function_sizes[i].nodes);
+        }
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    fprintf(output, "\nPeak live AST memory: %zu bytes\n", peak_live_bytes);
+    fprintf(output, "Peak RSS: %ld KB\n", usage.ru_maxrss);
+
+    for (int i = 0; i < function_count; i++) free(function_sizes[i].name);
+    free(function_sizes);
+    function_sizes = NULL;
+    function_count = 0;
+}
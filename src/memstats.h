@@ -0,0 +1,28 @@
+#pragma once
+
+#include "compiler.h"
+#include <stddef.h>
+
+// -fmem-report bookkeeping. Allocation sites report what they allocate and
+// free; each event is attributed to the current compiler phase (see phase.h)
+// and, for AST nodes, to the node type. Does nothing until mem_enable().
+typedef enum {
+    MEM_AST_NODE,       // create_node
+    MEM_LEXER_STRING,   // identifier and literal text from yylex
+    MEM_PARSER_STRING,  // my_strdup
+    MEM_AST_CACHE,      // node view of a loaded AST cache
+    MEM_IR,             // IR arenas (ir.c)
+    MEM_KIND_COUNT
+} MemKind;
+
+extern int mem_tracking;
+
+void mem_enable(void);
+void mem_alloc(MemKind kind, size_t bytes);
+// Frees only lower the live total, which is what the peaks are taken from.
+void mem_free(size_t bytes);
+void mem_node_alloc(NodeType type, size_t value_bytes);
+
+// Records per-function AST sizes; call while the tree is still alive.
+void mem_record_functions(ASTNode* program);
+void mem_report(FILE* output);
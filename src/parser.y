@@ -3,17 +3,47 @@
 #include <stdlib.h>
 #include <string.h>
 #include "compiler.h"
+#include "phase.h"
+#include "memstats.h"
 
 void yyerror(const char* s);
 int yylex(void);
 
+// The lexer is timed as a phase of its own, so the parser calls it through
+// phase_yylex(), defined at the end of this file.
+static int phase_yylex(void);
+#define yylex phase_yylex
+
+// Appends item, which may itself be a chain (an IF and its ELSE, the
+// statements of a block), walking only the appended part.
+static NodeList list_append(NodeList list, ASTNode* item) {
+    if (item == NULL) return list;
+    if (list.head == NULL) {
+        list.head = item;
+    } else {
+        list.tail->next = item;
+    }
+    while (item->next != NULL) item = item->next;
+    list.tail = item;
+    return list;
+}
+
+static NodeList empty_list(void) {
+    NodeList list = { NULL, NULL };
+    return list;
+}
+
 char* my_strdup(const char* s) {
-    char* result = malloc(strlen(s) + 1);
+    phase_begin(PHASE_AST);
+    size_t size = strlen(s) + 1;
+    char* result = malloc(size);
     if (result == NULL) {
         fprintf(stderr, "Memory allocation failed\n");
         exit(1);
     }
     strcpy(result, s);
+    mem_alloc(MEM_PARSER_STRING, size);
+    phase_end(PHASE_AST);
     return result;
 }
 
@@ -28,6 +58,7 @@ ASTNode* root = NULL;
     int num;
     char* str;
     ASTNode* node;
+    NodeList list;
 }
 
 %token <num> NUMBER
@@ -40,10 +71,11 @@ ASTNode* root = NULL;
 %token LPAREN RPAREN LBRACE RBRACE LBRACKET RBRACKET
 %token SEMICOLON COMMA
 
-%type <node> program function_def declaration statements statement
+%type <list> program statements params args
+%type <node> function_def declaration statement
 %type <node> expression assignment_expr logical_expr relational_expr
 %type <node> additive_expr term factor function_call array_access
-%type <node> type param_list params arg_list args if_statement
+%type <node> type param_list arg_list if_statement
 %type <node> while_statement for_statement return_statement
 
 %%
@@ -51,33 +83,30 @@ ASTNode* root = NULL;
 program
     : function_def
     {
-        $$ = $1;
-        root = $$;
+        $$ = list_append(empty_list(), $1);
+        root = $1;
     }
     | program function_def
     {
-        ASTNode* temp = $1;
-        while(temp->next != NULL) {
-            temp = temp->next;
-        }
-        temp->next = $2;
-        $$ = $1;
+        $$ = list_append($1, $2);
     }
     ;
 
 function_def
-    : type IDENTIFIER LPAREN param_list RPAREN LBRACE statements RBRACE
+    : type IDENTIFIER { $<num>$ = yylineno; } LPAREN param_list RPAREN LBRACE statements RBRACE
     {
+        // Created after the body; the line is the one of the name.
         $$ = create_node(NODE_FUNCTION, $2);
-        $$->left = $4;
-        $$->right = $7;
+        $$->line = $<num>3;
+        $$->left = $5;
+        $$->right = $8.head;
     }
     ;
 
 param_list
     : params
     {
-        $$ = $1;
+        $$ = $1.head;
     }
     | /* empty */
     {
@@ -88,17 +117,11 @@ param_list
 params
     : type IDENTIFIER
     {
-        $$ = create_node(NODE_DECLARATION, $2);
+        $$ = list_append(empty_list(), create_node(NODE_DECLARATION, $2));
     }
     | params COMMA type IDENTIFIER
     {
-        ASTNode* param = create_node(NODE_DECLARATION, $4);
-        ASTNode* temp = $1;
-        while(temp->next != NULL) {
-            temp = temp->next;
-        }
-        temp->next = param;
-        $$ = $1;
+        $$ = list_append($1, create_node(NODE_DECLARATION, $4));
     }
     ;
 
@@ -120,24 +143,15 @@ type
 statements
     : statement
     {
-        $$ = $1;
+        $$ = list_append(empty_list(), $1);
     }
     | statements statement
     {
-        if ($1 == NULL) {
-            $$ = $2;
-        } else {
-            ASTNode* temp = $1;
-            while(temp->next != NULL) {
-                temp = temp->next;
-            }
-            temp->next = $2;
-            $$ = $1;
-        }
+        $$ = list_append($1, $2);
     }
     | /* empty */
     {
-        $$ = NULL;
+        $$ = empty_list();
     }
     ;
 
@@ -168,7 +182,7 @@ statement
     }
     | LBRACE statements RBRACE
     {
-        $$ = $2;
+        $$ = $2.head;
     }
     ;
 
@@ -194,12 +208,14 @@ if_statement
     : IF LPAREN expression RPAREN statement
     {
         $$ = create_node(NODE_IF, NULL);
+        $$->line = $3->line;
         $$->left = $3;
         $$->right = $5;
     }
     | IF LPAREN expression RPAREN statement ELSE statement
     {
         $$ = create_node(NODE_IF, NULL);
+        $$->line = $3->line;
         $$->left = $3;
         $$->right = $5;
         ASTNode* else_node = create_node(NODE_ELSE, NULL);
@@ -212,6 +228,7 @@ while_statement
     : WHILE LPAREN expression RPAREN statement
     {
         $$ = create_node(NODE_WHILE, NULL);
+        $$->line = $3->line;
         $$->left = $3;
         $$->right = $5;
     }
@@ -221,6 +238,7 @@ for_statement
     : FOR LPAREN expression SEMICOLON expression SEMICOLON expression RPAREN statement
     {
         $$ = create_node(NODE_FOR, NULL);
+        $$->line = $3->line;
         $$->left = $3;
         $$->right = $5;
         $5->next = $7;
@@ -260,7 +278,7 @@ assignment_expr
     | IDENTIFIER PLUS_ASSIGN assignment_expr
     {
         ASTNode* plus = create_node(NODE_EXPRESSION, my_strdup("+"));
-        plus->left = create_node(NODE_EXPRESSION, $1);
+        plus->left = create_node(NODE_EXPRESSION, my_strdup($1));
         plus->right = $3;
         $$ = create_node(NODE_ASSIGNMENT, $1);
         $$->right = plus;
@@ -268,7 +286,7 @@ assignment_expr
     | IDENTIFIER MINUS_ASSIGN assignment_expr
     {
         ASTNode* minus = create_node(NODE_EXPRESSION, my_strdup("-"));
-        minus->left = create_node(NODE_EXPRESSION, $1);
+        minus->left = create_node(NODE_EXPRESSION, my_strdup($1));
         minus->right = $3;
         $$ = create_node(NODE_ASSIGNMENT, $1);
         $$->right = minus;
@@ -449,7 +467,7 @@ array_access
 arg_list
     : args
     {
-        $$ = $1;
+        $$ = $1.head;
     }
     | /* empty */
     {
@@ -460,26 +478,34 @@ arg_list
 args
     : expression
     {
-        $$ = $1;
+        $$ = list_append(empty_list(), $1);
     }
     | args COMMA expression
     {
-        ASTNode* temp = $1;
-        while(temp->next != NULL) {
-            temp = temp->next;
-        }
-        temp->next = $3;
-        $$ = $1;
+        $$ = list_append($1, $3);
     }
     ;
 
 %%
 
+#undef yylex
+static int phase_yylex(void) {
+    if (!phase_tracking) return yylex();
+    phase_begin(PHASE_LEX);
+    int token = yylex();
+    if (token == IDENTIFIER || token == STRING_LITERAL || token == CHAR_LITERAL) {
+        mem_alloc(MEM_LEXER_STRING, strlen(yylval.str) + 1);
+    }
+    phase_end(PHASE_LEX);
+    return token;
+}
+
 void yyerror(const char* s) {
     fprintf(stderr, "Syntax error at line %d: %s\n", yylineno, s);
 }
 
 ASTNode* create_node(NodeType type, char* value) {
+    phase_begin(PHASE_AST);
     ASTNode* node = malloc(sizeof(ASTNode));
     if (node == NULL) {
         fprintf(stderr, "Memory allocation failed for AST node\n");
@@ -490,28 +516,38 @@ ASTNode* create_node(NodeType type, char* value) {
     node->left = NULL;
     node->right = NULL;
     node->next = NULL;
+    // The lexer is at most a token ahead, so this is the line a leaf or a
+    // one-line statement is on; compound statements take their
+    // condition's line instead.
+    node->line = yylineno;
+    mem_node_alloc(type, value ? strlen(value) + 1 : 0);
+    phase_end(PHASE_AST);
     return node;
 }
 
 void free_ast(ASTNode* node) {
-    if (node == NULL) return;
-    if (node->left) {
+    // Lists are walked iteratively; only nesting uses the stack.
+    while (node != NULL) {
+        ASTNode* next = node->next;
         free_ast(node->left);
-        node->left = NULL;
-    }
-    if (node->right) {
         free_ast(node->right);
-        node->right = NULL;
-    }
-    if (node->next) {
-        free_ast(node->next);
-        node->next = NULL;
-    }
-    if (node->value) {
-        free(node->value);
-        node->value = NULL;
+        if (node->value) {
+            mem_free(strlen(node->value) + 1);
+            free(node->value);
+        }
+        mem_free(sizeof(ASTNode));
+        free(node);
+        node = next;
     }
-    free(node);
+}
+
+const char* node_type_name(NodeType type) {
+    static const char* names[] = {
+        "program", "function", "declaration", "assignment", "expression", "statement",
+        "if", "else", "while", "for", "return", "function_call", "type", "string",
+        "char", "array_access"
+    };
+    return type <= NODE_ARRAY_ACCESS ? names[type] : "?";
 }
 
 void print_ast(ASTNode* node, int level) {
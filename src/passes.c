@@ -0,0 +1,501 @@
+#define _POSIX_C_SOURCE 200809L
+#include "passes.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static void* checked(void* data) {
+    if (data == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    return data;
+}
+
+static int* int_array(int count, int fill) {
+    int* array = checked(malloc((size_t)(count > 0 ? count : 1) * sizeof(int)));
+    for (int i = 0; i < count; i++) array[i] = fill;
+    return array;
+}
+
+int parse_opt_level(const char* arg, OptLevel* level) {
+    static const struct {
+        const char* flag;
+        OptLevel level;
+    } levels[] = {
+        { "-O0", OPT_O0 }, { "-O1", OPT_O1 }, { "-O", OPT_O1 }, { "-O2", OPT_O2 }, { "-Os", OPT_OS },
+    };
+    for (size_t i = 0; i < sizeof(levels) / sizeof(levels[0]); i++) {
+        if (strcmp(arg, levels[i].flag) == 0) {
+            *level = levels[i].level;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char* opt_level_name(OptLevel level) {
+    static const char* const names[] = { "-O0", "-O1", "-O2", "-Os" };
+    return names[level];
+}
+
+// ---------------------------------------------------------------------------
+// Statistics
+
+static const char* const analysis_names[ANALYSIS_COUNT] = { "cfg", "dominators", "liveness", "loops",
+                                                                  "induction", "dependences", "ranges" };
+
+typedef struct {
+    const Pass* pass;
+    long runs;
+    long functions_changed;     // runs that changed something
+    long changes;
+    double seconds;
+} PassStats;
+
+typedef struct {
+    long computed;
+    long reused;
+    double seconds;
+} AnalysisStats;
+
+#define MAX_PASS_STATS 16
+
+static int stats_enabled;
+static PassStats pass_stats[MAX_PASS_STATS];
+static int pass_stats_count;
+static AnalysisStats analysis_stats[ANALYSIS_COUNT];
+
+void pass_stats_enable(void) {
+    stats_enabled = 1;
+}
+
+static double now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+static PassStats* stats_for(const Pass* pass) {
+    for (int i = 0; i < pass_stats_count; i++) {
+        if (pass_stats[i].pass == pass) return &pass_stats[i];
+    }
+    if (pass_stats_count == MAX_PASS_STATS) return NULL;
+    pass_stats[pass_stats_count].pass = pass;
+    return &pass_stats[pass_stats_count++];
+}
+
+void pass_stats_report(FILE* output) {
+    fprintf(output, "\nPass statistics\n");
+    fprintf(output, " %-22s %8s %8s %10s %10s\n", "pass", "runs", "changed", "changes", "seconds");
+    for (int i = 0; i < pass_stats_count; i++) {
+        const PassStats* stats = &pass_stats[i];
+        fprintf(output, " %-22s %8ld %8ld %10ld %10.6f\n", stats->pass->name, stats->runs, stats->functions_changed,
+                stats->changes, stats->seconds);
+    }
+    fprintf(output, " %-22s %8s %8s %10s %10s\n", "analysis", "computed", "reused", "", "seconds");
+    for (int kind = 0; kind < ANALYSIS_COUNT; kind++) {
+        const AnalysisStats* stats = &analysis_stats[kind];
+        fprintf(output, " %-22s %8ld %8ld %10s %10.6f\n", analysis_names[kind], stats->computed, stats->reused, "",
+                stats->seconds);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Analyses
+
+static void compute_cfg(IrCfg* cfg, const IrFunction* function) {
+    cfg->order = int_array(function->block_count, IR_NONE);
+    cfg->count = ir_reverse_postorder(function, cfg->order);
+    cfg->index = int_array(function->block_count, IR_NONE);
+    for (int i = 0; i < cfg->count; i++) cfg->index[cfg->order[i]] = i;
+}
+
+static int intersect(const IrDominators* dominators, const IrCfg* cfg, int a, int b) {
+    while (a != b) {
+        while (cfg->index[a] > cfg->index[b]) a = dominators->idom[a];
+        while (cfg->index[b] > cfg->index[a]) b = dominators->idom[b];
+    }
+    return a;
+}
+
+static void compute_dominators(IrDominators* dominators, const IrFunction* function, const IrCfg* cfg) {
+    int blocks = function->block_count;
+    dominators->idom = int_array(blocks, IR_NONE);
+    dominators->first_child = int_array(blocks, IR_NONE);
+    dominators->next_sibling = int_array(blocks, IR_NONE);
+    dominators->enter = int_array(blocks, IR_NONE);
+    dominators->leave = int_array(blocks, IR_NONE);
+    if (cfg->count == 0) return;
+
+    int entry = cfg->order[0];
+    dominators->idom[entry] = entry;
+    for (int changed = 1; changed;) {
+        changed = 0;
+        for (int i = 1; i < cfg->count; i++) {
+            int block = cfg->order[i];
+            int idom = IR_NONE;
+            for (int e = function->blocks[block].first_pred; e != IR_NONE; e = function->edges[e].next_pred) {
+                int pred = function->edges[e].from;
+                if (dominators->idom[pred] == IR_NONE) continue;
+                idom = idom == IR_NONE ? pred : intersect(dominators, cfg, pred, idom);
+            }
+            if (dominators->idom[block] != idom) {
+                dominators->idom[block] = idom;
+                changed = 1;
+            }
+        }
+    }
+
+    // Children in reverse postorder, then a preorder walk numbering them.
+    for (int i = cfg->count - 1; i > 0; i--) {
+        int block = cfg->order[i];
+        int parent = dominators->idom[block];
+        dominators->next_sibling[block] = dominators->first_child[parent];
+        dominators->first_child[parent] = block;
+    }
+    int* stack = int_array(cfg->count, IR_NONE);
+    int depth = 0, number = 0;
+    stack[depth++] = entry;
+    dominators->enter[entry] = number++;
+    while (depth > 0) {
+        int block = stack[depth - 1];
+        // Until a block is finished, leave holds its last visited child.
+        int child = dominators->leave[block] == IR_NONE ? dominators->first_child[block]
+                                                         : dominators->next_sibling[dominators->leave[block]];
+        if (child == IR_NONE) {
+            dominators->leave[block] = number - 1;
+            depth--;
+            continue;
+        }
+        dominators->leave[block] = child;
+        dominators->enter[child] = number++;
+        stack[depth++] = child;
+    }
+    free(stack);
+}
+
+int ir_dominates(const IrDominators* dominators, int a, int b) {
+    if (dominators->enter[a] == IR_NONE || dominators->enter[b] == IR_NONE) return 0;
+    return dominators->enter[a] <= dominators->enter[b] && dominators->enter[b] <= dominators->leave[a];
+}
+
+static int compare_loop_size(const void* a, const void* b) {
+    const IrLoop* x = a;
+    const IrLoop* y = b;
+    return y->block_count - x->block_count;
+}
+
+static void compute_loops(IrLoops* loops, const IrFunction* function, const IrCfg* cfg,
+                          const IrDominators* dominators) {
+    int blocks = function->block_count;
+    loops->loops = NULL;
+    loops->count = 0;
+    loops->innermost = int_array(blocks, IR_NONE);
+    int capacity = 0;
+    int* mark = int_array(blocks, IR_NONE);
+    int* work = int_array(2 * blocks, IR_NONE);  // blocks of a loop, then its exit edges
+
+    for (int i = 0; i < cfg->count; i++) {
+        int header = cfg->order[i];
+        int count = 0, size = 0, latches = 0;
+        for (int e = function->blocks[header].first_pred; e != IR_NONE; e = function->edges[e].next_pred) {
+            int tail = function->edges[e].from;
+            if (!ir_dominates(dominators, header, tail)) continue;
+            latches++;
+            if (size == 0) {
+                mark[header] = header;
+                work[size++] = header;
+            }
+            if (mark[tail] != header) {
+                mark[tail] = header;
+                work[size++] = tail;
+            }
+        }
+        if (size == 0) continue;
+        // Walk back from the tails to the header; the list doubles as the
+        // loop's block set.
+        for (count = 1; count < size; count++) {
+            int block = work[count];
+            for (int e = function->blocks[block].first_pred; e != IR_NONE; e = function->edges[e].next_pred) {
+                int pred = function->edges[e].from;
+                if (cfg->index[pred] == IR_NONE || mark[pred] == header) continue;
+                mark[pred] = header;
+                work[size++] = pred;
+            }
+        }
+        if (loops->count == capacity) {
+            capacity = capacity ? capacity * 2 : 8;
+            loops->loops = checked(realloc(loops->loops, (size_t)capacity * sizeof(IrLoop)));
+        }
+        IrLoop* loop = &loops->loops[loops->count++];
+        loop->header = header;
+        loop->parent = IR_NONE;
+        loop->first_child = loop->next_sibling = IR_NONE;
+        loop->depth = 1;
+        loop->block_count = size;
+        loop->latch_count = latches;
+        loop->preheader = IR_NONE;
+        loop->exits = NULL;
+        loop->exit_count = 0;
+        loop->blocks = checked(malloc((size_t)size * sizeof(int)));
+        memcpy(loop->blocks, work, (size_t)size * sizeof(int));
+    }
+
+    // A loop contains every smaller loop whose header it holds, so going
+    // from the largest down leaves each block with its innermost loop and
+    // finds each loop's parent as the innermost loop of its header so far.
+    if (loops->count > 1) qsort(loops->loops, (size_t)loops->count, sizeof(IrLoop), compare_loop_size);
+    for (int l = 0; l < loops->count; l++) {
+        IrLoop* loop = &loops->loops[l];
+        loop->parent = loops->innermost[loop->header];
+        if (loop->parent != IR_NONE) loop->depth = loops->loops[loop->parent].depth + 1;
+        for (int b = 0; b < loop->block_count; b++) loops->innermost[loop->blocks[b]] = l;
+    }
+    // Children are chained from the last, so each list ends up in order.
+    loops->first_root = IR_NONE;
+    for (int l = loops->count - 1; l >= 0; l--) {
+        IrLoop* loop = &loops->loops[l];
+        int* first = loop->parent == IR_NONE ? &loops->first_root : &loops->loops[loop->parent].first_child;
+        loop->next_sibling = *first;
+        *first = l;
+    }
+
+    // Preheaders and exits, with the loop's blocks marked in turn.
+    for (int b = 0; b < blocks; b++) mark[b] = IR_NONE;
+    for (int l = 0; l < loops->count; l++) {
+        IrLoop* loop = &loops->loops[l];
+        for (int b = 0; b < loop->block_count; b++) mark[loop->blocks[b]] = l;
+        int outside = 0, entry = IR_NONE;
+        for (int e = function->blocks[loop->header].first_pred; e != IR_NONE; e = function->edges[e].next_pred) {
+            int pred = function->edges[e].from;
+            if (mark[pred] == l || cfg->index[pred] == IR_NONE) continue;
+            outside++;
+            entry = pred;
+        }
+        if (outside == 1 && function->blocks[entry].succ_count == 1) loop->preheader = entry;
+        int exits = 0;
+        for (int b = 0; b < loop->block_count; b++) {
+            int block = loop->blocks[b];
+            for (int e = function->blocks[block].first_succ; e != IR_NONE; e = function->edges[e].next_succ) {
+                if (mark[function->edges[e].to] != l) work[exits++] = e;
+            }
+        }
+        loop->exit_count = exits;
+        loop->exits = int_array(exits, IR_NONE);
+        memcpy(loop->exits, work, (size_t)exits * sizeof(int));
+    }
+    free(mark);
+    free(work);
+}
+
+int ir_loop_contains(const IrLoops* loops, int loop, int block) {
+    for (int l = loops->innermost[block]; l != IR_NONE; l = loops->loops[l].parent) {
+        if (l == loop) return 1;
+    }
+    return 0;
+}
+
+static void release(PassContext* context, AnalysisKind kind) {
+    switch (kind) {
+    case ANALYSIS_CFG:
+        free(context->cfg.order);
+        free(context->cfg.index);
+        break;
+    case ANALYSIS_DOMINATORS:
+        free(context->dominators.idom);
+        free(context->dominators.first_child);
+        free(context->dominators.next_sibling);
+        free(context->dominators.enter);
+        free(context->dominators.leave);
+        break;
+    case ANALYSIS_LIVENESS:
+        ir_liveness_free(&context->liveness);
+        break;
+    case ANALYSIS_LOOPS:
+        for (int l = 0; l < context->loops.count; l++) {
+            free(context->loops.loops[l].blocks);
+            free(context->loops.loops[l].exits);
+        }
+        free(context->loops.loops);
+        free(context->loops.innermost);
+        break;
+    case ANALYSIS_INDUCTION:
+        ir_induction_free(&context->induction);
+        break;
+    case ANALYSIS_DEPENDENCES:
+        ir_dependences_free(&context->dependences);
+        break;
+    case ANALYSIS_RANGES:
+        ir_ranges_free(&context->ranges);
+        break;
+    default:
+        break;
+    }
+}
+
+// Returns whether the analysis is already valid, counting the reuse; if
+// not, the caller computes it between this and analysis_done.
+static int analysis_cached(PassContext* context, AnalysisKind kind, double* start) {
+    if (context->valid & (1u << kind)) {
+        analysis_stats[kind].reused++;
+        return 1;
+    }
+    if (stats_enabled) *start = now();
+    return 0;
+}
+
+// An analysis costs the optimization budget a unit per instruction of the
+// function; run_passes notices an exhausted budget after the pass.
+static void analysis_done(PassContext* context, AnalysisKind kind, double start) {
+    context->valid |= 1u << kind;
+    if (context->budget) opt_budget_consume(context->budget, context->function->insn_count);
+    analysis_stats[kind].computed++;
+    if (stats_enabled) analysis_stats[kind].seconds += now() - start;
+}
+
+const IrCfg* pass_cfg(PassContext* context) {
+    double start = 0;
+    if (!analysis_cached(context, ANALYSIS_CFG, &start)) {
+        compute_cfg(&context->cfg, context->function);
+        analysis_done(context, ANALYSIS_CFG, start);
+    }
+    return &context->cfg;
+}
+
+const IrDominators* pass_dominators(PassContext* context) {
+    const IrCfg* cfg = pass_cfg(context);
+    double start = 0;
+    if (!analysis_cached(context, ANALYSIS_DOMINATORS, &start)) {
+        compute_dominators(&context->dominators, context->function, cfg);
+        analysis_done(context, ANALYSIS_DOMINATORS, start);
+    }
+    return &context->dominators;
+}
+
+const IrLiveness* pass_liveness(PassContext* context) {
+    double start = 0;
+    if (!analysis_cached(context, ANALYSIS_LIVENESS, &start)) {
+        ir_liveness(&context->liveness, context->function, NULL, NULL);
+        analysis_done(context, ANALYSIS_LIVENESS, start);
+    }
+    return &context->liveness;
+}
+
+const IrLoops* pass_loops(PassContext* context) {
+    const IrCfg* cfg = pass_cfg(context);
+    const IrDominators* dominators = pass_dominators(context);
+    double start = 0;
+    if (!analysis_cached(context, ANALYSIS_LOOPS, &start)) {
+        compute_loops(&context->loops, context->function, cfg, dominators);
+        analysis_done(context, ANALYSIS_LOOPS, start);
+    }
+    return &context->loops;
+}
+
+const IrInduction* pass_induction(PassContext* context) {
+    const IrCfg* cfg = pass_cfg(context);
+    const IrLoops* loops = pass_loops(context);
+    double start = 0;
+    if (!analysis_cached(context, ANALYSIS_INDUCTION, &start)) {
+        ir_compute_induction(&context->induction, context->function, cfg, loops);
+        analysis_done(context, ANALYSIS_INDUCTION, start);
+    }
+    return &context->induction;
+}
+
+const IrDependences* pass_dependences(PassContext* context) {
+    const IrCfg* cfg = pass_cfg(context);
+    const IrLoops* loops = pass_loops(context);
+    const IrInduction* induction = pass_induction(context);
+    double start = 0;
+    if (!analysis_cached(context, ANALYSIS_DEPENDENCES, &start)) {
+        ir_compute_dependences(&context->dependences, context->function, cfg, loops, induction);
+        analysis_done(context, ANALYSIS_DEPENDENCES, start);
+    }
+    return &context->dependences;
+}
+
+const IrRanges* pass_ranges(PassContext* context) {
+    const IrCfg* cfg = pass_cfg(context);
+    const IrDominators* dominators = pass_dominators(context);
+    const IrLoops* loops = pass_loops(context);
+    const IrInduction* induction = pass_induction(context);
+    double start = 0;
+    if (!analysis_cached(context, ANALYSIS_RANGES, &start)) {
+        ir_compute_ranges(&context->ranges, context->function, cfg, dominators, loops, induction);
+        analysis_done(context, ANALYSIS_RANGES, start);
+    }
+    return &context->ranges;
+}
+
+// Drops the analyses a pass did not preserve, and those built on them.
+static void invalidate(PassContext* context, unsigned preserved) {
+    if (!(preserved & (1u << ANALYSIS_CFG))) preserved &= ~(1u << ANALYSIS_DOMINATORS);
+    if (!(preserved & (1u << ANALYSIS_DOMINATORS))) preserved &= ~(1u << ANALYSIS_LOOPS);
+    if (!(preserved & (1u << ANALYSIS_LOOPS))) preserved &= ~(1u << ANALYSIS_INDUCTION);
+    if (!(preserved & (1u << ANALYSIS_INDUCTION))) {
+        preserved &= ~((1u << ANALYSIS_DEPENDENCES) | (1u << ANALYSIS_RANGES));
+    }
+    for (int kind = 0; kind < ANALYSIS_COUNT; kind++) {
+        unsigned bit = 1u << kind;
+        if ((context->valid & bit) && !(preserved & bit)) {
+            release(context, (AnalysisKind)kind);
+            context->valid &= ~bit;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Pipelines
+
+static const Pass fold = { "fold", ir_fold_constants };
+static const Pass simplify_cfg = { "simplifycfg", ir_simplify_cfg };
+static const Pass cse = { "cse", ir_eliminate_common_subexpressions };
+static const Pass dce = { "dce", ir_eliminate_dead_code };
+static const Pass ranges = { "ranges", ir_propagate_ranges };
+static const Pass loop_report = { "loops", ir_report_loops };
+static const Pass dependence_report = { "dependences", ir_report_dependences };
+
+// The range pass runs on the simplified CFG, and before CSE so that CSE
+// shares the multiplications it makes of x / c and x % c. Folding again
+// after CSE catches comparisons of values it made equal; simplifycfg then
+// drops the branches that folded. The loop and dependence reports only do
+// work when remarks are being recorded.
+static const Pass* const o1_pipeline[] = { &fold, &dce, NULL };
+static const Pass* const o2_pipeline[] = { &fold, &simplify_cfg, &ranges, &cse, &fold, &simplify_cfg, &dce,
+                                           &loop_report, &dependence_report, NULL };
+static const Pass* const os_pipeline[] = { &fold, &simplify_cfg, &ranges, &simplify_cfg, &cse, &dce,
+                                           &loop_report, &dependence_report, NULL };
+
+int run_passes(IrFunction* function, OptLevel level, OptBudget* budget) {
+    const Pass* const* pipeline = level == OPT_O1 ? o1_pipeline
+                                : level == OPT_O2 ? o2_pipeline
+                                : level == OPT_OS ? os_pipeline
+                                                  : NULL;
+    if (pipeline == NULL) return 1;
+
+    PassContext context = { .function = function, .level = level, .budget = budget };
+    for (int i = 0; pipeline[i]; i++) {
+        const Pass* pass = pipeline[i];
+        double start = stats_enabled ? now() : 0;
+        PassResult result = pass->run(function, &context);
+        if (result.changes > 0) invalidate(&context, result.preserved);
+        if (stats_enabled) {
+            PassStats* stats = stats_for(pass);
+            if (stats) {
+                stats->runs++;
+                stats->functions_changed += result.changes > 0;
+                stats->changes += result.changes;
+                stats->seconds += now() - start;
+            }
+        }
+        // A pass costs a unit, and another for each change it made.
+        if (budget && !opt_budget_consume(budget, 1 + result.changes)) {
+            invalidate(&context, PRESERVE_NONE);
+            return 0;
+        }
+    }
+    invalidate(&context, PRESERVE_NONE);
+    return 1;
+}
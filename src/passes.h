@@ -0,0 +1,106 @@
+#pragma once
+
+#include "budget.h"
+#include "dataflow.h"
+#include "dependence.h"
+#include "induction.h"
+#include "ir.h"
+#include "range.h"
+#include <stdio.h>
+
+// Optimization levels and the pass manager that runs their IR pipelines.
+//
+// -O0 is the direct AST-to-assembly generator of riscv.c and runs no pass.
+// The other levels lower each function to IR, run a fixed pipeline of
+// passes over it and emit it with ir_emit_function. Passes get their
+// analyses from a PassContext, which computes each one on first request
+// and keeps it until a pass reports a change that it does not preserve;
+// analyses that depend on an invalidated one (dominators on the CFG, loops
+// on dominators, induction variables on loops, array dependences and value
+// ranges on induction variables) go with it.
+typedef enum {
+    OPT_O0,
+    OPT_O1,                     // folding and dead code: cheap clean-ups
+    OPT_O2,                     // plus CFG simplification and common subexpressions
+    OPT_OS                      // O2 without passes that trade code size for speed
+} OptLevel;
+
+// "-O0".."-O2", "-Os" (also "-O" for -O1); returns -1 for anything else.
+int parse_opt_level(const char* arg, OptLevel* level);
+const char* opt_level_name(OptLevel level);
+
+typedef enum {
+    ANALYSIS_CFG,               // reachable blocks in reverse postorder
+    ANALYSIS_DOMINATORS,
+    ANALYSIS_LIVENESS,
+    ANALYSIS_LOOPS,
+    ANALYSIS_INDUCTION,
+    ANALYSIS_DEPENDENCES,
+    ANALYSIS_RANGES,
+    ANALYSIS_COUNT
+} AnalysisKind;
+
+#define PRESERVE_NONE 0u
+// Instructions changed but no edge: everything but liveness still holds.
+#define PRESERVE_CFG ((1u << ANALYSIS_CFG) | (1u << ANALYSIS_DOMINATORS) | (1u << ANALYSIS_LOOPS))
+
+typedef struct {
+    IrFunction* function;
+    OptLevel level;
+    OptBudget* budget;          // may be NULL
+    unsigned valid;             // bit per AnalysisKind
+    IrCfg cfg;
+    IrDominators dominators;
+    IrLiveness liveness;
+    IrLoops loops;
+    IrInduction induction;
+    IrDependences dependences;
+    IrRanges ranges;
+} PassContext;
+
+const IrCfg* pass_cfg(PassContext* context);
+const IrDominators* pass_dominators(PassContext* context);
+const IrLiveness* pass_liveness(PassContext* context);
+const IrLoops* pass_loops(PassContext* context);
+const IrInduction* pass_induction(PassContext* context);
+const IrDependences* pass_dependences(PassContext* context);
+const IrRanges* pass_ranges(PassContext* context);
+
+typedef struct {
+    int changes;                // rewrites made; 0 leaves every analysis valid
+    unsigned preserved;         // analyses still valid after the changes
+} PassResult;
+
+typedef struct {
+    const char* name;
+    PassResult (*run)(IrFunction* function, PassContext* context);
+} Pass;
+
+// Transformations (ir_opt.c).
+PassResult ir_fold_constants(IrFunction* function, PassContext* context);
+PassResult ir_simplify_cfg(IrFunction* function, PassContext* context);
+PassResult ir_eliminate_common_subexpressions(IrFunction* function, PassContext* context);
+PassResult ir_eliminate_dead_code(IrFunction* function, PassContext* context);
+// Folds comparisons and branches that value ranges decide and rewrites
+// divisions of non-negative values by constants as shifts, masks or
+// multiplications (the last not at -Os).
+PassResult ir_propagate_ranges(IrFunction* function, PassContext* context);
+
+// Analysis passes.
+// Reports the loops, their induction variables and trip counts as
+// optimization remarks; changes nothing (induction.c).
+PassResult ir_report_loops(IrFunction* function, PassContext* context);
+// Reports which loops can be reordered, vectorized or fused, and the
+// dependences that prevent it; changes nothing (dependence.c).
+PassResult ir_report_dependences(IrFunction* function, PassContext* context);
+
+// Runs the pipeline of `level` over the function. With a budget (which may
+// be NULL), every pass and every analysis it computes is charged to it, and
+// the pipeline stops once the budget is exhausted; then 0 is returned and
+// the caller should fall back to the direct code generator.
+int run_passes(IrFunction* function, OptLevel level, OptBudget* budget);
+
+// -fpass-stats: time, runs and changes per pass, and how often each
+// analysis was computed or reused, summed over the compilation.
+void pass_stats_enable(void);
+void pass_stats_report(FILE* output);
@@ -0,0 +1,174 @@
+#define _POSIX_C_SOURCE 200809L
+#include "peephole.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_OPERANDS 3
+#define OPERAND_SIZE 64
+
+typedef struct {
+    char* text;
+    int deleted;
+} AsmLine;
+
+typedef struct {
+    char op[OPERAND_SIZE];
+    char operands[MAX_OPERANDS][OPERAND_SIZE];
+    int count;
+} Instruction;
+
+static const char* skip_spaces(const char* s) {
+    while (*s == ' ' || *s == '\t') s++;
+    return s;
+}
+
+static int is_label(const char* line) {
+    size_t len = strlen(line);
+    return len > 0 && line[len - 1] == ':';
+}
+
+static int is_directive(const char* line) {
+    return *skip_spaces(line) == '.' && !is_label(line);
+}
+
+// Splits "    op a, b, c" into its mnemonic and operands.
+static int parse_instruction(const char* line, Instruction* insn) {
+    memset(insn, 0, sizeof(*insn));
+    if (is_label(line) || is_directive(line)) return 0;
+    const char* p = skip_spaces(line);
+    size_t n = strcspn(p, " \t");
+    if (n == 0 || n >= OPERAND_SIZE) return 0;
+    memcpy(insn->op, p, n);
+    p = skip_spaces(p + n);
+    while (*p && insn->count < MAX_OPERANDS) {
+        n = strcspn(p, ",");
+        size_t len = n;
+        while (len > 0 && (p[len - 1] == ' ' || p[len - 1] == '\t')) len--;
+        if (len >= OPERAND_SIZE) return 0;
+        memcpy(insn->operands[insn->count++], p, len);
+        p += n;
+        if (*p == ',') p = skip_spaces(p + 1);
+    }
+    return *p == '\0';
+}
+
+static int next_live(AsmLine* lines, int count, int i) {
+    for (i++; i < count; i++) {
+        if (!lines[i].deleted) return i;
+    }
+    return -1;
+}
+
+static void delete_line(AsmLine* line, int* changes) {
+    line->deleted = 1;
+    (*changes)++;
+}
+
+// Returns -1 if the budget ran out part way through.
+static int run_pass(AsmLine* lines, int count, OptBudget* budget) {
+    int changes = 0, charged = 0;
+    for (int i = 0; i < count; i++) {
+        // Charge rewrites in batches; checking every 256 lines also keeps
+        // deadlines honest on long listings where little changes.
+        if (budget && (i & 255) == 0) {
+            if (!opt_budget_consume(budget, changes - charged)) return -1;
+            charged = changes;
+        }
+        if (lines[i].deleted) continue;
+        Instruction insn, next_insn;
+        if (!parse_instruction(lines[i].text, &insn)) continue;
+
+        if (strcmp(insn.op, "mv") == 0 && insn.count == 2 && strcmp(insn.operands[0], insn.operands[1]) == 0) {
+            delete_line(&lines[i], &changes);
+            continue;
+        }
+
+        // Nothing after an unconditional transfer runs until the next label.
+        if (strcmp(insn.op, "j") == 0 || strcmp(insn.op, "ret") == 0) {
+            int j = next_live(lines, count, i);
+            while (j >= 0 && !is_label(lines[j].text) && !is_directive(lines[j].text)) {
+                delete_line(&lines[j], &changes);
+                j = next_live(lines, count, j);
+            }
+            if (j >= 0 && strcmp(insn.op, "j") == 0 && insn.count == 1) {
+                size_t len = strlen(insn.operands[0]);
+                const char* label = skip_spaces(lines[j].text);
+                if (strncmp(label, insn.operands[0], len) == 0 && strcmp(label + len, ":") == 0) {
+                    delete_line(&lines[i], &changes);
+                }
+            }
+            continue;
+        }
+
+        int j = next_live(lines, count, i);
+        if (j < 0 || !parse_instruction(lines[j].text, &next_insn)) continue;
+
+        if (strcmp(insn.op, "sw") == 0 && insn.count == 2 && next_insn.count == 2
+            && strcmp(insn.operands[1], next_insn.operands[1]) == 0) {
+            if (strcmp(next_insn.op, "lw") == 0) {
+                // The value being reloaded is still in the stored register.
+                if (strcmp(insn.operands[0], next_insn.operands[0]) == 0) {
+                    delete_line(&lines[j], &changes);
+                } else {
+                    char buffer[3 * OPERAND_SIZE];
+                    snprintf(buffer, sizeof(buffer), "    mv %s, %s", next_insn.operands[0], insn.operands[0]);
+                    free(lines[j].text);
+                    lines[j].text = strdup(buffer);
+                    changes++;
+                }
+            } else if (strcmp(next_insn.op, "sw") == 0) {
+                delete_line(&lines[i], &changes);
+            }
+        }
+    }
+    if (budget && !opt_budget_consume(budget, changes - charged)) return -1;
+    return changes;
+}
+
+char* peephole_optimize(const char* text, size_t len, size_t* out_len, int* changes, OptBudget* budget) {
+    int count = 0, capacity = 0;
+    AsmLine* lines = NULL;
+    size_t start = 0;
+    while (start < len) {
+        size_t end = start;
+        while (end < len && text[end] != '\n') end++;
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            lines = realloc(lines, (size_t)capacity * sizeof(AsmLine));
+            if (lines == NULL) {
+                fprintf(stderr, "Memory allocation failed\n");
+                exit(1);
+            }
+        }
+        lines[count].text = strndup(text + start, end - start);
+        lines[count].deleted = 0;
+        count++;
+        start = end + 1;
+    }
+
+    int total = 0, pass_changes;
+    while ((pass_changes = run_pass(lines, count, budget)) > 0) total += pass_changes;
+    if (changes) *changes = total;
+    if (pass_changes < 0) {
+        for (int i = 0; i < count; i++) free(lines[i].text);
+        free(lines);
+        return NULL;
+    }
+
+    char* result = NULL;
+    size_t result_len = 0;
+    FILE* output = open_memstream(&result, &result_len);
+    if (!output) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    for (int i = 0; i < count; i++) {
+        if (!lines[i].deleted) fprintf(output, "%s\n", lines[i].text);
+        free(lines[i].text);
+    }
+    fclose(output);
+    free(lines);
+    if (out_len) *out_len = result_len;
+    return result;
+}
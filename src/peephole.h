@@ -0,0 +1,12 @@
+#pragma once
+
+#include "budget.h"
+#include <stddef.h>
+
+// Local clean-ups on an assembly listing produced by the code generator:
+// store-to-load forwarding, dead stores, self moves, jumps to the next line
+// and unreachable code after unconditional jumps. Returns a malloc'ed,
+// NUL-terminated listing and the number of rewrites made. Each rewrite costs
+// one unit of fuel; if the budget runs out, NULL is returned and the caller
+// keeps the input listing. budget may be NULL.
+char* peephole_optimize(const char* text, size_t len, size_t* out_len, int* changes, OptBudget* budget);
@@ -0,0 +1,103 @@
+#define _GNU_SOURCE
+#include "perfcount.h"
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+typedef struct {
+    uint32_t type;
+    uint64_t config;
+} CounterConfig;
+
+#define CACHE_READ_MISS(cache) \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const CounterConfig configs[PERF_COUNTER_COUNT] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    { PERF_TYPE_HW_CACHE, CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D) },
+    { PERF_TYPE_HW_CACHE, CACHE_READ_MISS(PERF_COUNT_HW_CACHE_LL) },
+};
+
+static const char* counter_names[PERF_COUNTER_COUNT] = {
+    "cycles", "instructions", "branch-misses", "L1d-misses", "LLC-misses"
+};
+
+static int fds[PERF_COUNTER_COUNT] = { -1, -1, -1, -1, -1 };
+// Position of each counter in the group read, or -1.
+static int slots[PERF_COUNTER_COUNT] = { -1, -1, -1, -1, -1 };
+static int leader = -1;
+static int opened = 0;
+
+static int open_counter(const CounterConfig* config, int group_fd) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = config->type;
+    attr.config = config->config;
+    attr.disabled = group_fd < 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+int perf_counters_open(const char** reason) {
+    *reason = NULL;
+    // Cycles lead the group; if even that fails there is no usable PMU.
+    leader = open_counter(&configs[PERF_CYCLES], -1);
+    if (leader < 0) {
+        *reason = errno == ENOENT || errno == ENODEV || errno == EOPNOTSUPP
+                      ? "no hardware PMU available"
+                  : errno == EACCES || errno == EPERM ? "not permitted (see perf_event_paranoid)"
+                                                      : strerror(errno);
+        return 0;
+    }
+    fds[PERF_CYCLES] = leader;
+    slots[PERF_CYCLES] = 0;
+    opened = 1;
+    for (int i = PERF_CYCLES + 1; i < PERF_COUNTER_COUNT; i++) {
+        fds[i] = open_counter(&configs[i], leader);
+        if (fds[i] >= 0) slots[i] = opened++;
+    }
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return opened;
+}
+
+const char* perf_counter_name(PerfCounter counter) {
+    return counter_names[counter];
+}
+
+int perf_counter_available(PerfCounter counter) {
+    return slots[counter] >= 0;
+}
+
+int perf_counters_read(uint64_t values[PERF_COUNTER_COUNT]) {
+    // nr, time_enabled, time_running, then one value per group member.
+    uint64_t buffer[3 + PERF_COUNTER_COUNT];
+    memset(values, 0, PERF_COUNTER_COUNT * sizeof(uint64_t));
+    if (leader < 0) return 0;
+    ssize_t got = read(leader, buffer, sizeof(buffer));
+    if (got < (ssize_t)(3 * sizeof(uint64_t)) || buffer[2] == 0) return 0;
+    double scale = (double)buffer[1] / (double)buffer[2];
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        if (slots[i] >= 0 && (uint64_t)slots[i] < buffer[0]) {
+            values[i] = (uint64_t)((double)buffer[3 + slots[i]] * scale);
+        }
+    }
+    return 1;
+}
+
+void perf_counters_close(void) {
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        if (fds[i] >= 0) close(fds[i]);
+        fds[i] = slots[i] = -1;
+    }
+    leader = -1;
+    opened = 0;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+
+// Hardware performance counters for -fperf-report, read through
+// perf_event_open(2). The counters count user-space events of this process
+// only, so they work with the default perf_event_paranoid setting; in
+// containers and VMs without a PMU opening them fails and the report falls
+// back to timings.
+typedef enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_BRANCH_MISSES,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_COUNTER_COUNT
+} PerfCounter;
+
+// Opens the counters as one group. Returns the number that could be opened;
+// on 0, *reason describes why.
+int perf_counters_open(const char** reason);
+const char* perf_counter_name(PerfCounter counter);
+int perf_counter_available(PerfCounter counter);
+
+// Current counter values (0 for unavailable counters), scaled up if the
+// kernel had to multiplex the group. Returns 0 if the group never ran.
+int perf_counters_read(uint64_t values[PERF_COUNTER_COUNT]);
+void perf_counters_close(void);
@@ -0,0 +1,311 @@
+#define _POSIX_C_SOURCE 200809L
+#include "phase.h"
+#include "json.h"
+#include "perfcount.h"
+#include "probes.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_PHASE_DEPTH 16
+#define REPORT_FUNCTIONS 20
+
+typedef struct {
+    double wall;
+    double cpu;
+} Clock;
+
+typedef struct {
+    const char* name;
+    int is_function;
+    double start;       // microseconds since phase_enable()
+    double duration;
+} TraceEvent;
+
+typedef struct {
+    char* name;
+    Clock start;
+    Clock total;
+} FunctionTime;
+
+int phase_tracking = 0;
+
+static int report_enabled = 0;
+static char* trace_path = NULL;
+static Clock origin;
+static Clock last;
+static Clock totals[PHASE_COUNT];
+static long entries[PHASE_COUNT];
+static CompilerPhase stack[MAX_PHASE_DEPTH];
+static double stack_start[MAX_PHASE_DEPTH];
+static int depth = 0;
+
+static int counters_requested = 0;
+static int counters_active = 0;
+static const char* counters_unavailable = NULL;
+static uint64_t last_counts[PERF_COUNTER_COUNT];
+static uint64_t counter_totals[PHASE_COUNT][PERF_COUNTER_COUNT];
+
+static FunctionTime* functions = NULL;
+static int function_count = 0;
+static int function_capacity = 0;
+static int current_function = -1;
+
+static TraceEvent* events = NULL;
+static int event_count = 0;
+static int event_capacity = 0;
+
+static const char* phase_names[PHASE_COUNT] = {
+    "input", "lex", "parse", "ast", "codegen", "output"
+};
+
+static Clock now(void) {
+    struct timespec wall, cpu;
+    clock_gettime(CLOCK_MONOTONIC, &wall);
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu);
+    Clock clock = {
+        (double)wall.tv_sec + (double)wall.tv_nsec / 1e9,
+        (double)cpu.tv_sec + (double)cpu.tv_nsec / 1e9,
+    };
+    return clock;
+}
+
+static double micros_since_origin(Clock clock) {
+    return (clock.wall - origin.wall) * 1e6;
+}
+
+static void add_event(const char* name, int is_function, double start, double end) {
+    if (!trace_path) return;
+    if (event_count == event_capacity) {
+        event_capacity = event_capacity ? event_capacity * 2 : 256;
+        events = realloc(events, (size_t)event_capacity * sizeof(TraceEvent));
+        if (events == NULL) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(1);
+        }
+    }
+    events[event_count].name = name;
+    events[event_count].is_function = is_function;
+    events[event_count].start = start;
+    events[event_count].duration = end - start;
+    event_count++;
+}
+
+// Lexing and node construction happen once per token or node; tracing each
+// of those would swamp the trace, so they only show up in the report.
+static int traced(CompilerPhase phase) {
+    return phase != PHASE_LEX && phase != PHASE_AST;
+}
+
+static Clock charge(void) {
+    Clock clock = now();
+    uint64_t counts[PERF_COUNTER_COUNT];
+    if (counters_active) perf_counters_read(counts);
+    if (depth > 0) {
+        CompilerPhase top = stack[depth - 1];
+        totals[top].wall += clock.wall - last.wall;
+        totals[top].cpu += clock.cpu - last.cpu;
+        if (counters_active) {
+            for (int i = 0; i < PERF_COUNTER_COUNT; i++) counter_totals[top][i] += counts[i] - last_counts[i];
+        }
+    }
+    last = clock;
+    if (counters_active) memcpy(last_counts, counts, sizeof(last_counts));
+    return clock;
+}
+
+void phase_enable(int time_report, const char* trace) {
+    report_enabled = time_report;
+    if (trace) trace_path = strdup(trace);
+    phase_tracking = 1;
+    origin = last = now();
+}
+
+void phase_enable_counters(void) {
+    counters_requested = 1;
+    report_enabled = 1;
+    if (perf_counters_open(&counters_unavailable) == 0) return;
+    if (!perf_counters_read(last_counts)) {
+        counters_unavailable = "counters are not scheduled on this CPU";
+        perf_counters_close();
+        return;
+    }
+    counters_active = 1;
+}
+
+const char* phase_name(CompilerPhase phase) {
+    return phase_names[phase];
+}
+
+CompilerPhase phase_current(void) {
+    return depth > 0 ? stack[depth - 1] : PHASE_COUNT;
+}
+
+void phase_begin(CompilerPhase phase) {
+    CC_PROBE2(phase__begin, phase, phase_names[phase]);
+    if (!phase_tracking) return;
+    Clock clock = charge();
+    if (depth == MAX_PHASE_DEPTH) {
+        fprintf(stderr, "Error: Compiler phases nested too deeply\n");
+        exit(1);
+    }
+    stack[depth] = phase;
+    stack_start[depth] = micros_since_origin(clock);
+    depth++;
+    entries[phase]++;
+}
+
+void phase_end(CompilerPhase phase) {
+    CC_PROBE2(phase__end, phase, phase_names[phase]);
+    if (!phase_tracking) return;
+    Clock clock = charge();
+    if (depth == 0 || stack[depth - 1] != phase) {
+        fprintf(stderr, "Error: Unbalanced end of compiler phase %s\n", phase_names[phase]);
+        exit(1);
+    }
+    depth--;
+    if (traced(phase)) add_event(phase_names[phase], 0, stack_start[depth], micros_since_origin(clock));
+}
+
+void phase_function_begin(const char* name) {
+    if (!phase_tracking) return;
+    if (function_count == function_capacity) {
+        function_capacity = function_capacity ? function_capacity * 2 : 32;
+        functions = realloc(functions, (size_t)function_capacity * sizeof(FunctionTime));
+        if (functions == NULL) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(1);
+        }
+    }
+    current_function = function_count++;
+    FunctionTime* function = &functions[current_function];
+    function->name = strdup(name ? name : "?");
+    function->start = now();
+    memset(&function->total, 0, sizeof(function->total));
+}
+
+void phase_function_end(void) {
+    if (!phase_tracking || current_function < 0) return;
+    FunctionTime* function = &functions[current_function];
+    Clock clock = now();
+    function->total.wall = clock.wall - function->start.wall;
+    function->total.cpu = clock.cpu - function->start.cpu;
+    add_event(function->name, 1, micros_since_origin(function->start), micros_since_origin(clock));
+    current_function = -1;
+}
+
+static int by_wall_time(const void* a, const void* b) {
+    double wa = ((const FunctionTime*)a)->total.wall;
+    double wb = ((const FunctionTime*)b)->total.wall;
+    return wa < wb ? 1 : wa > wb ? -1 : 0;
+}
+
+static void print_count(FILE* output, PerfCounter counter, uint64_t value) {
+    if (perf_counter_available(counter)) {
+        fprintf(output, " %14llu", (unsigned long long)value);
+    } else {
+        fprintf(output, " %14s", "n/a");
+    }
+}
+
+static void print_counters(FILE* output) {
+    if (!counters_active) {
+        fprintf(output, "\nHardware counters unavailable (%s); timings only\n",
+                counters_unavailable ? counters_unavailable : "unknown error");
+        return;
+    }
+    uint64_t sum[PERF_COUNTER_COUNT] = {0};
+    fprintf(output, "\nHardware counters (user space)\n");
+    fprintf(output, " %-22s", "phase");
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) fprintf(output, " %14s", perf_counter_name(i));
+    fprintf(output, " %6s\n", "IPC");
+    for (int phase = 0; phase <= PHASE_COUNT; phase++) {
+        const uint64_t* counts = phase < PHASE_COUNT ? counter_totals[phase] : sum;
+        fprintf(output, " %-22s", phase < PHASE_COUNT ? phase_names[phase] : "TOTAL");
+        for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+            print_count(output, i, counts[i]);
+            if (phase < PHASE_COUNT) sum[i] += counts[i];
+        }
+        if (counts[PERF_CYCLES] > 0 && perf_counter_available(PERF_INSTRUCTIONS)) {
+            fprintf(output, " %6.2f\n", (double)counts[PERF_INSTRUCTIONS] / (double)counts[PERF_CYCLES]);
+        } else {
+            fprintf(output, " %6s\n", "-");
+        }
+    }
+}
+
+static void print_report(FILE* output) {
+    Clock total = {0, 0};
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        total.wall += totals[i].wall;
+        total.cpu += totals[i].cpu;
+    }
+    fprintf(output, "\nExecution times (seconds)\n");
+    fprintf(output, " %-22s %10s %6s %10s %6s %10s\n", "phase", "wall", "", "cpu", "", "entries");
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        fprintf(output, " %-22s %10.6f (%3.0f%%) %10.6f (%3.0f%%) %10ld\n", phase_names[i],
+                totals[i].wall, total.wall > 0 ? 100.0 * totals[i].wall / total.wall : 0.0,
+                totals[i].cpu, total.cpu > 0 ? 100.0 * totals[i].cpu / total.cpu : 0.0, entries[i]);
+    }
+    fprintf(output, " %-22s %10.6f        %10.6f\n", "TOTAL", total.wall, total.cpu);
+    if (counters_requested) print_counters(output);
+
+    if (function_count == 0) return;
+    FunctionTime* sorted = malloc((size_t)function_count * sizeof(FunctionTime));
+    if (sorted == NULL) return;
+    memcpy(sorted, functions, (size_t)function_count * sizeof(FunctionTime));
+    qsort(sorted, (size_t)function_count, sizeof(FunctionTime), by_wall_time);
+    int shown = function_count < REPORT_FUNCTIONS ? function_count : REPORT_FUNCTIONS;
+    fprintf(output, "\nCode generation per function (slowest %d of %d)\n", shown, function_count);
+    for (int i = 0; i < shown; i++) {
+        fprintf(output, " %-22s %10.6f        %10.6f\n", sorted[i].name, sorted[i].total.wall, sorted[i].total.cpu);
+    }
+    free(sorted);
+}
+
+// Chrome trace event format, readable by chrome://tracing and Perfetto.
+static void write_trace(const char* path) {
+    FILE* output = fopen(path, "w");
+    if (!output) {
+        fprintf(stderr, "Error: Cannot create trace file %s\n", path);
+        return;
+    }
+    long pid = (long)getpid();
+    fprintf(output, "{\"traceEvents\":[\n");
+    for (int i = 0; i < event_count; i++) {
+        fprintf(output, "  {\"name\":");
+        write_json_string(output, events[i].name);
+        fprintf(output, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%ld,\"tid\":%ld},\n",
+                events[i].is_function ? "function" : "phase", events[i].start, events[i].duration,
+                pid, pid);
+    }
+    // Totals for the phases that are too fine-grained for individual events.
+    fprintf(output, "  {\"name\":\"phase totals\",\"ph\":\"i\",\"s\":\"p\",\"ts\":0,\"pid\":%ld,\"tid\":%ld,\"args\":{",
+            pid, pid);
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        fprintf(output, "%s\"%s_us\":%.3f", i ? "," : "", phase_names[i], totals[i].wall * 1e6);
+    }
+    fprintf(output, "}}\n],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(output);
+}
+
+void phase_finish(void) {
+    if (!phase_tracking) return;
+    charge();
+    if (report_enabled) print_report(stderr);
+    if (trace_path) write_trace(trace_path);
+
+    for (int i = 0; i < function_count; i++) free(functions[i].name);
+    free(functions);
+    free(events);
+    free(trace_path);
+    if (counters_active) perf_counters_close();
+    functions = NULL;
+    events = NULL;
+    trace_path = NULL;
+    counters_requested = counters_active = 0;
+    function_count = function_capacity = event_count = event_capacity = 0;
+    phase_tracking = 0;
+}
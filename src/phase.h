@@ -0,0 +1,37 @@
+#pragma once
+
+// Compiler phase accounting. Phases nest (the lexer and AST construction run
+// inside the parser), and time is charged exclusively to the innermost
+// active phase. Everything here is a no-op until phase_enable() is called,
+// and it is meant to be driven from one thread. Other reports (memory) use
+// phase_current() to attribute their own events.
+typedef enum {
+    PHASE_INPUT,        // opening and reading sources, AST cache
+    PHASE_LEX,          // yylex
+    PHASE_PARSE,        // yyparse minus lexing and node construction
+    PHASE_AST,          // create_node and the strings attached to nodes
+    PHASE_CODEGEN,      // generate_riscv_code
+    PHASE_OUTPUT,       // creating and flushing the assembly file
+    PHASE_COUNT
+} CompilerPhase;
+
+extern int phase_tracking;
+
+// Starts tracking; the time report and trace are only produced if asked for.
+void phase_enable(int time_report, const char* trace_path);
+// Also counts hardware events per phase (-fperf-report) and turns on the
+// time report, which carries the counter table or, when perf_event_open is
+// unavailable, a note saying why there is none.
+void phase_enable_counters(void);
+const char* phase_name(CompilerPhase phase);
+// Innermost active phase, or PHASE_COUNT outside of any phase.
+CompilerPhase phase_current(void);
+
+void phase_begin(CompilerPhase phase);
+void phase_end(CompilerPhase phase);
+// Per-function spans inside PHASE_CODEGEN.
+void phase_function_begin(const char* name);
+void phase_function_end(void);
+
+// Prints -ftime-report and writes the -ftime-trace file, if requested.
+void phase_finish(void);
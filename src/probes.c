@@ -0,0 +1,7 @@
+#include "probes.h"
+
+// One semaphore per probe, in the ".probes" section where tracers expect
+// them; a tracer increments it while attached to the probe.
+#define CC_DEFINE_SEMAPHORE(name) \
+    __attribute__((section(".probes"), used)) volatile unsigned short CC_PROBE_SEMAPHORE(name) = 0;
+CC_PROBE_LIST(CC_DEFINE_SEMAPHORE)
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stdint.h>
+
+// USDT (statically defined tracing) probes of provider "ccompiler", for
+// bpftrace/perf/systemtap on a running compiler or worker, e.g.
+//   bpftrace -e 'usdt:./compiler:ccompiler:function__end { @[str(arg0)] = sum(arg1); }'
+// A probe site is a single nop plus an ELF note describing where its
+// arguments live; it does nothing until a tracer attaches. Arguments that
+// are not free to compute are guarded with CC_PROBE_ENABLED(), which reads
+// the probe's semaphore (raised by the tracer while attached).
+//
+// Probes (see tools/bpftrace/ for scripts using them):
+//   phase__begin(phase, name)             phase boundaries, see phase.h
+//   phase__end(phase, name)
+//   function__begin(name)                 per-function code generation
+//   function__end(name, asm_bytes)
+//   cache__lookup(path, hit, nodes)       --ast-cache lookups
+//   arena__grow(arena, bytes)             an IR arena was reallocated to `bytes`
+//
+// With <sys/sdt.h> (systemtap-sdt-dev) available the build defines
+// HAVE_SYS_SDT_H and its macros are used; otherwise the same note format is
+// emitted here on x86-64 and AArch64, and the probes compile to nothing on
+// other targets or with -DCC_NO_PROBES.
+#define CC_PROBE_LIST(X) \
+    X(phase__begin)      \
+    X(phase__end)        \
+    X(function__begin)   \
+    X(function__end)     \
+    X(cache__lookup)     \
+    X(arena__grow)
+
+#define CC_PROBE_SEMAPHORE(name) ccompiler_##name##_semaphore
+#define CC_DECLARE_SEMAPHORE(name) extern volatile unsigned short CC_PROBE_SEMAPHORE(name);
+CC_PROBE_LIST(CC_DECLARE_SEMAPHORE)
+
+#define CC_PROBE_ARG(value) "nor"((uint64_t)(uintptr_t)(value))
+
+#if defined(CC_NO_PROBES)
+
+#define CC_PROBES_ENABLED 0
+
+#elif defined(HAVE_SYS_SDT_H)
+
+#define CC_PROBES_ENABLED 1
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+#define CC_PROBE1(name, a) STAP_PROBE1(ccompiler, name, (uint64_t)(uintptr_t)(a))
+#define CC_PROBE2(name, a, b) \
+    STAP_PROBE2(ccompiler, name, (uint64_t)(uintptr_t)(a), (uint64_t)(uintptr_t)(b))
+#define CC_PROBE3(name, a, b, c) \
+    STAP_PROBE3(ccompiler, name, (uint64_t)(uintptr_t)(a), (uint64_t)(uintptr_t)(b), (uint64_t)(uintptr_t)(c))
+
+#elif defined(__x86_64__) || defined(__aarch64__)
+
+#define CC_PROBES_ENABLED 1
+// The .note.stapsdt layout from systemtap's sdt.h: probe address, base
+// address (for prelink adjustment), semaphore address, provider, name and
+// an argument description such as "8@%rdi 8@-16(%rbp)".
+#define CC_PROBE_ASM(name, args)                                                       \
+    "990: nop\n"                                                                       \
+    ".pushsection .note.stapsdt,\"?\",\"note\"\n"                                      \
+    ".balign 4\n"                                                                      \
+    ".4byte 992f-991f, 994f-993f, 3\n"                                                 \
+    "991: .asciz \"stapsdt\"\n"                                                        \
+    "992: .balign 4\n"                                                                 \
+    "993: .8byte 990b\n"                                                               \
+    ".8byte _.stapsdt.base\n"                                                          \
+    ".8byte ccompiler_" #name "_semaphore\n"                                           \
+    ".asciz \"ccompiler\"\n"                                                           \
+    ".asciz \"" #name "\"\n"                                                           \
+    ".asciz \"" args "\"\n"                                                            \
+    "994: .balign 4\n"                                                                 \
+    ".popsection\n"                                                                    \
+    ".ifndef _.stapsdt.base\n"                                                         \
+    ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n"            \
+    ".weak _.stapsdt.base\n"                                                           \
+    ".hidden _.stapsdt.base\n"                                                         \
+    "_.stapsdt.base: .space 1\n"                                                       \
+    ".size _.stapsdt.base, 1\n"                                                        \
+    ".popsection\n"                                                                    \
+    ".endif\n"
+
+#define CC_PROBE1(name, a) \
+    __asm__ __volatile__(CC_PROBE_ASM(name, "8@%0") :: CC_PROBE_ARG(a))
+#define CC_PROBE2(name, a, b) \
+    __asm__ __volatile__(CC_PROBE_ASM(name, "8@%0 8@%1") :: CC_PROBE_ARG(a), CC_PROBE_ARG(b))
+#define CC_PROBE3(name, a, b, c)                                        \
+    __asm__ __volatile__(CC_PROBE_ASM(name, "8@%0 8@%1 8@%2")           \
+                         :: CC_PROBE_ARG(a), CC_PROBE_ARG(b), CC_PROBE_ARG(c))
+
+#else
+
+#define CC_PROBES_ENABLED 0
+
+#endif
+
+#if CC_PROBES_ENABLED
+#define CC_PROBE_ENABLED(name) __builtin_expect(CC_PROBE_SEMAPHORE(name) != 0, 0)
+#else
+#define CC_PROBE_ENABLED(name) 0
+#define CC_PROBE1(name, a) ((void)0)
+#define CC_PROBE2(name, a, b) ((void)0)
+#define CC_PROBE3(name, a, b, c) ((void)0)
+#endif
@@ -0,0 +1,587 @@
+#include "range.h"
+#include "passes.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Value ranges. The propagation is Wegman and Zadeck's conditional
+// constant propagation with intervals for lattice values: a block is
+// evaluated when the first edge into it becomes executable, a value's
+// users when its range grows, and a phi joins only the operands of
+// executable edges. Until a value is evaluated its range is empty, the
+// optimistic start. Ranges only grow during propagation (each new range is
+// joined with the old one), and a header phi that has grown WIDEN_AFTER
+// times jumps to the type's bounds in the direction it grows, so that
+// `i = i + 1` does not climb one value at a time. The fixed point this
+// reaches is then narrowed by re-evaluating everything without the join:
+// in a loop `for (i = 0; i < 100; ...)` the widened i is [0, INT32_MAX],
+// and one sweep brings it back to [0, 100] through the branch on i < 100.
+
+static void* checked(void* data) {
+    if (data == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    return data;
+}
+
+#define WIDEN_AFTER 3
+// Every value is forced to the full range after this many changes, header
+// phi or not, so that propagation ends whatever the shape of the CFG.
+#define CHANGE_LIMIT 64
+#define NARROWING_SWEEPS 2
+// Dominators a use looks through for branch conditions.
+#define FACT_DEPTH 64
+
+static const IrRange empty_range = { 1, 0, 1, 0 };
+static const IrRange full_range = { INT32_MIN, INT32_MAX, 0, UINT32_MAX };
+
+int ir_range_is_empty(const IrRange* range) {
+    return range->low > range->high || range->ulow > range->uhigh;
+}
+
+int ir_range_constant(const IrRange* range, int32_t* value) {
+    if (ir_range_is_empty(range) || range->low != range->high) return 0;
+    *value = range->low;
+    return 1;
+}
+
+// Narrows each interval by the other where the other does not wrap.
+static IrRange tighten(IrRange r) {
+    for (int round = 0; round < 2; round++) {
+        if (ir_range_is_empty(&r)) return empty_range;
+        if (r.low >= 0 || r.high < 0) {
+            if ((uint32_t)r.low > r.ulow) r.ulow = (uint32_t)r.low;
+            if ((uint32_t)r.high < r.uhigh) r.uhigh = (uint32_t)r.high;
+        }
+        if (r.ulow > r.uhigh) return empty_range;
+        if (r.uhigh <= INT32_MAX || r.ulow > INT32_MAX) {
+            if ((int32_t)r.ulow > r.low) r.low = (int32_t)r.ulow;
+            if ((int32_t)r.uhigh < r.high) r.high = (int32_t)r.uhigh;
+        }
+    }
+    return ir_range_is_empty(&r) ? empty_range : r;
+}
+
+// Exact bounds computed in 64 bits; outside the type the result wraps,
+// which an interval cannot follow.
+static IrRange signed_range(int64_t low, int64_t high) {
+    if (low > high) return empty_range;
+    if (low < INT32_MIN || high > INT32_MAX) return full_range;
+    return tighten((IrRange){ (int32_t)low, (int32_t)high, 0, UINT32_MAX });
+}
+
+static IrRange unsigned_range(uint64_t low, uint64_t high) {
+    if (low > high) return empty_range;
+    if (high > UINT32_MAX) return full_range;
+    return tighten((IrRange){ INT32_MIN, INT32_MAX, (uint32_t)low, (uint32_t)high });
+}
+
+static IrRange constant_range(int32_t value) {
+    return tighten((IrRange){ value, value, (uint32_t)value, (uint32_t)value });
+}
+
+static IrRange intersect(IrRange a, IrRange b) {
+    IrRange r = { a.low > b.low ? a.low : b.low, a.high < b.high ? a.high : b.high,
+                  a.ulow > b.ulow ? a.ulow : b.ulow, a.uhigh < b.uhigh ? a.uhigh : b.uhigh };
+    return tighten(r);
+}
+
+static IrRange join(IrRange a, IrRange b) {
+    if (ir_range_is_empty(&a)) return b;
+    if (ir_range_is_empty(&b)) return a;
+    return (IrRange){ a.low < b.low ? a.low : b.low, a.high > b.high ? a.high : b.high,
+                      a.ulow < b.ulow ? a.ulow : b.ulow, a.uhigh > b.uhigh ? a.uhigh : b.uhigh };
+}
+
+static int same_range(const IrRange* a, const IrRange* b) {
+    return a->low == b->low && a->high == b->high && a->ulow == b->ulow && a->uhigh == b->uhigh;
+}
+
+static int contains_zero(const IrRange* r) {
+    return r->low <= 0 && 0 <= r->high && r->ulow == 0;
+}
+
+static IrRange nonzero(IrRange r) {
+    if (r.low == 0) r.low = 1;
+    if (r.high == 0) r.high = -1;
+    if (r.ulow == 0) r.ulow = 1;
+    return tighten(r);
+}
+
+// All ones from the highest set bit of x down.
+static uint64_t fill_bits(uint64_t x) {
+    for (int shift = 1; shift < 64; shift *= 2) x |= x >> shift;
+    return x;
+}
+
+static IrRange boolean_range(int can_be_false, int can_be_true) {
+    return can_be_false && can_be_true ? (IrRange){ 0, 1, 0, 1 } : constant_range(can_be_true);
+}
+
+static IrRange compare(IrOp op, const IrRange* a, const IrRange* b) {
+    switch (op) {
+    case IR_EQ:
+    case IR_NE: {
+        int different = a->high < b->low || b->high < a->low || a->uhigh < b->ulow || b->uhigh < a->ulow;
+        int same = a->low == a->high && b->low == b->high && a->low == b->low;
+        int equal_possible = !different, unequal_possible = !same;
+        return op == IR_EQ ? boolean_range(unequal_possible, equal_possible)
+                           : boolean_range(equal_possible, unequal_possible);
+    }
+    case IR_LT: return boolean_range(a->high >= b->low, a->low < b->high);
+    case IR_LE: return boolean_range(a->high > b->low, a->low <= b->high);
+    case IR_GT: return boolean_range(a->low <= b->high, a->high > b->low);
+    case IR_GE: return boolean_range(a->low < b->high, a->high >= b->low);
+    default: return (IrRange){ 0, 1, 0, 1 };
+    }
+}
+
+static IrRange evaluate_binary(IrOp op, const IrRange* a, const IrRange* b) {
+    int64_t al = a->low, ah = a->high, bl = b->low, bh = b->high;
+    switch (op) {
+    case IR_ADD: {
+        IrRange r = signed_range(al + bl, ah + bh);
+        return intersect(r, unsigned_range((uint64_t)a->ulow + b->ulow, (uint64_t)a->uhigh + b->uhigh));
+    }
+    case IR_SUB: {
+        IrRange r = signed_range(al - bh, ah - bl);
+        if (a->ulow >= b->uhigh) r = intersect(r, unsigned_range(a->ulow - b->uhigh, a->uhigh - b->ulow));
+        return r;
+    }
+    case IR_MUL: {
+        int64_t products[4] = { al * bl, al * bh, ah * bl, ah * bh };
+        int64_t low = products[0], high = products[0];
+        for (int i = 1; i < 4; i++) {
+            if (products[i] < low) low = products[i];
+            if (products[i] > high) high = products[i];
+        }
+        IrRange r = signed_range(low, high);
+        return intersect(r, unsigned_range((uint64_t)a->ulow * b->ulow, (uint64_t)a->uhigh * b->uhigh));
+    }
+    case IR_DIV: {
+        // Division by zero gives -1 and INT32_MIN / -1 wraps on the target.
+        if (contains_zero(b) || (al == INT32_MIN && bl <= -1 && -1 <= bh)) return full_range;
+        // For a divisor of one sign the quotient is monotonic in each
+        // operand, so the corners bound it.
+        int64_t quotients[4] = { al / bl, al / bh, ah / bl, ah / bh };
+        int64_t low = quotients[0], high = quotients[0];
+        for (int i = 1; i < 4; i++) {
+            if (quotients[i] < low) low = quotients[i];
+            if (quotients[i] > high) high = quotients[i];
+        }
+        return signed_range(low, high);
+    }
+    case IR_REM: {
+        // The remainder has the dividend's sign and is smaller than the
+        // divisor in magnitude; by zero it is the dividend.
+        int64_t largest = -bl > bh ? -bl : bh;
+        if (largest == 0) return *a;
+        int64_t low = al < 0 ? (al > 1 - largest ? al : 1 - largest) : 0;
+        int64_t high = ah > 0 ? (ah < largest - 1 ? ah : largest - 1) : 0;
+        IrRange r = signed_range(low, high);
+        return contains_zero(b) ? join(r, *a) : r;
+    }
+    case IR_AND:
+        return unsigned_range(0, a->uhigh < b->uhigh ? a->uhigh : b->uhigh);
+    case IR_OR: {
+        uint32_t high = fill_bits(a->uhigh > b->uhigh ? a->uhigh : b->uhigh);
+        return unsigned_range(a->ulow > b->ulow ? a->ulow : b->ulow, high);
+    }
+    case IR_XOR:
+        return unsigned_range(0, fill_bits(a->uhigh > b->uhigh ? a->uhigh : b->uhigh));
+    case IR_SHR:
+        if (b->ulow == b->uhigh && b->uhigh < 32) return unsigned_range(a->ulow >> b->ulow, a->uhigh >> b->ulow);
+        return unsigned_range(0, a->uhigh);
+    case IR_MULHU:
+        return unsigned_range(((uint64_t)a->ulow * b->ulow) >> 32, ((uint64_t)a->uhigh * b->uhigh) >> 32);
+    default:
+        return compare(op, a, b);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Conditions
+
+static IrOp negated(IrOp op) {
+    switch (op) {
+    case IR_EQ: return IR_NE;
+    case IR_NE: return IR_EQ;
+    case IR_LT: return IR_GE;
+    case IR_LE: return IR_GT;
+    case IR_GT: return IR_LE;
+    default: return IR_LT;
+    }
+}
+
+// a op b as b op' a.
+static IrOp mirrored(IrOp op) {
+    switch (op) {
+    case IR_LT: return IR_GT;
+    case IR_LE: return IR_GE;
+    case IR_GT: return IR_LT;
+    case IR_GE: return IR_LE;
+    default: return op;
+    }
+}
+
+// Narrows `range`, the range of `value`, by `condition` having been found
+// true or false.
+static IrRange refine(const IrRanges* ranges, const IrFunction* function, int condition, int truth, int value,
+                      IrRange range) {
+    if (condition == value) return truth ? nonzero(range) : intersect(range, constant_range(0));
+    const IrInsn* insn = &function->insns[condition];
+    const int32_t* args = ir_args(function, condition);
+    IrOp op = (IrOp)insn->op;
+    if ((op == IR_NOT || op == IR_BOOL) && args[0] == value) {
+        int zero = (op == IR_NOT) == truth;
+        return zero ? intersect(range, constant_range(0)) : nonzero(range);
+    }
+    if (op < IR_EQ || op > IR_GE || args[0] == args[1] || (args[0] != value && args[1] != value)) return range;
+
+    IrOp relation = truth ? op : negated(op);
+    int other = args[0] == value ? args[1] : args[0];
+    if (args[1] == value) relation = mirrored(relation);
+    IrRange bound = ranges->ranges[other];
+    if (ir_range_is_empty(&bound)) return range;
+    switch (relation) {
+    case IR_EQ: return intersect(range, bound);
+    case IR_NE:
+        if (bound.low != bound.high) return range;
+        if (range.low == bound.low && range.low < INT32_MAX) {
+            range.low++;
+        } else if (range.high == bound.low && range.high > INT32_MIN) {
+            range.high--;
+        }
+        return tighten(range);
+    case IR_LT: return intersect(range, signed_range(INT32_MIN, (int64_t)bound.high - 1));
+    case IR_LE: return intersect(range, signed_range(INT32_MIN, bound.high));
+    case IR_GT: return intersect(range, signed_range((int64_t)bound.low + 1, INT32_MAX));
+    case IR_GE: return intersect(range, signed_range(bound.low, INT32_MAX));
+    default: return range;
+    }
+}
+
+static IrRange refine_on_edge(const IrRanges* ranges, const IrFunction* function, int edge, int value,
+                              IrRange range) {
+    int from = function->edges[edge].from;
+    int branch = ir_terminator(function, from);
+    if (branch == IR_NONE || function->insns[branch].op != IR_BRANCH) return range;
+    int taken = function->blocks[from].first_succ == edge;
+    return refine(ranges, function, ir_args(function, branch)[0], taken, value, range);
+}
+
+IrRange ir_range_at(const IrRanges* ranges, const IrFunction* function, const IrDominators* dominators, int value,
+                    int block) {
+    IrRange range = ranges->ranges[value];
+    int home = function->insns[value].block;
+    for (int depth = 0; depth < FACT_DEPTH && block != home && !ir_range_is_empty(&range); depth++) {
+        const IrBlock* current = &function->blocks[block];
+        if (current->pred_count == 1) range = refine_on_edge(ranges, function, current->first_pred, value, range);
+        int up = dominators->idom[block];
+        if (up == IR_NONE || up == block) break;
+        block = up;
+    }
+    return range;
+}
+
+// ---------------------------------------------------------------------------
+// Propagation
+
+typedef struct {
+    const IrFunction* function;
+    const IrDominators* dominators;
+    const IrLoops* loops;
+    const IrInduction* induction;
+    IrRanges* ranges;
+    uint8_t* reached;           // per block
+    int* user_start;            // users of each value, CSR
+    int* users;
+    int* partner_start;         // per value, the values a branch compares it with
+    int* partners;
+    uint8_t* changes;           // per value
+    int* values;                // worklist of values whose range grew
+    int value_count;
+    uint8_t* queued;
+    int* blocks;                // worklist of newly reached blocks
+    int block_count;
+} Propagation;
+
+// Bounds of an affine form over the iterations of its loops, when all of
+// them have constant trip counts: the body of a loop runs `count` times,
+// its header once more for the test that ends it, and code after the loop
+// sees the values of that last test.
+static IrRange form_range(const Propagation* p, int value) {
+    const IrAffine* form = &p->induction->forms[value];
+    if (form->term_count == 0 || form->base == value) return full_range;
+    int block = p->function->insns[value].block;
+    int64_t low = form->constant, high = form->constant;
+    const int64_t limit = (int64_t)1 << 40;
+    if (form->base != IR_NONE) {
+        const IrRange* base = &p->ranges->ranges[form->base];
+        if (ir_range_is_empty(base)) return full_range;
+        int64_t a = (int64_t)form->scale * base->low, b = (int64_t)form->scale * base->high;
+        low += a < b ? a : b;
+        high += a < b ? b : a;
+    }
+    for (int t = 0; t < form->term_count; t++) {
+        const IrTripCount* trip = &p->induction->trips[form->terms[t].loop];
+        if (trip->kind != TRIP_CONSTANT || trip->count > INT32_MAX) return full_range;
+        int loop = form->terms[t].loop;
+        int in_body = p->loops->loops[loop].header != block && ir_loop_contains(p->loops, loop, block);
+        int64_t last = in_body ? trip->count - 1 : trip->count;
+        int64_t end = (int64_t)form->terms[t].step * (last > 0 ? last : 0);
+        low += end < 0 ? end : 0;
+        high += end > 0 ? end : 0;
+        if (low < -limit || high > limit) return full_range;
+    }
+    return signed_range(low, high);
+}
+
+static int is_header(const Propagation* p, int block) {
+    int loop = p->loops->innermost[block];
+    return loop != IR_NONE && p->loops->loops[loop].header == block;
+}
+
+// The range of a value from the current ranges of its operands.
+static IrRange evaluate(const Propagation* p, int value) {
+    const IrFunction* function = p->function;
+    const IrInsn* insn = &function->insns[value];
+    const int32_t* args = ir_args(function, value);
+    int block = insn->block;
+    if (insn->type != IR_TYPE_I32) return full_range;
+
+    IrRange r;
+    IrOp op = (IrOp)insn->op;
+    if (op == IR_CONST) return constant_range(insn->imm);
+    if (op == IR_PHI) {
+        r = empty_range;
+        int e = function->blocks[block].first_pred;
+        for (int a = 0; a < insn->arg_count && e != IR_NONE; a++, e = function->edges[e].next_pred) {
+            if (!p->ranges->executable[e]) continue;
+            int from = function->edges[e].from;
+            IrRange operand = ir_range_at(p->ranges, function, p->dominators, args[a], from);
+            r = join(r, refine_on_edge(p->ranges, function, e, args[a], operand));
+        }
+    } else if ((op >= IR_ADD && op <= IR_GE) || op == IR_NEG || op == IR_NOT || op == IR_BOOL || op == IR_COPY) {
+        IrRange a = ir_range_at(p->ranges, function, p->dominators, args[0], block);
+        if (ir_range_is_empty(&a)) return empty_range;
+        if (op >= IR_ADD && op <= IR_GE) {
+            IrRange b = ir_range_at(p->ranges, function, p->dominators, args[1], block);
+            if (ir_range_is_empty(&b)) return empty_range;
+            r = evaluate_binary(op, &a, &b);
+        } else if (op == IR_NEG) {
+            r = signed_range(-(int64_t)a.high, -(int64_t)a.low);
+        } else if (op == IR_NOT) {
+            r = boolean_range(a.low != 0 || a.high != 0, contains_zero(&a));
+        } else if (op == IR_BOOL) {
+            r = boolean_range(contains_zero(&a), a.low != 0 || a.high != 0);
+        } else {
+            r = a;
+        }
+    } else {
+        return full_range;
+    }
+    return ir_range_is_empty(&r) ? r : intersect(r, form_range(p, value));
+}
+
+static void push_value(Propagation* p, int value) {
+    if (p->queued[value]) return;
+    p->queued[value] = 1;
+    p->values[p->value_count++] = value;
+}
+
+static void visit(Propagation* p, int insn);
+
+static void reach_edge(Propagation* p, int edge) {
+    if (p->ranges->executable[edge]) return;
+    p->ranges->executable[edge] = 1;
+    int to = p->function->edges[edge].to;
+    if (!p->reached[to]) {
+        p->reached[to] = 1;
+        p->blocks[p->block_count++] = to;
+        return;
+    }
+    // A new way into a block already evaluated changes only its phis.
+    for (int phi = p->function->blocks[to].first; phi != IR_NONE && p->function->insns[phi].op == IR_PHI;
+         phi = p->function->insns[phi].next) {
+        visit(p, phi);
+    }
+}
+
+static void visit(Propagation* p, int insn) {
+    const IrFunction* function = p->function;
+    const IrInsn* ir = &function->insns[insn];
+    int block = ir->block;
+    if (ir->op == IR_JUMP) {
+        reach_edge(p, function->blocks[block].first_succ);
+        return;
+    }
+    if (ir->op == IR_BRANCH) {
+        IrRange condition = ir_range_at(p->ranges, function, p->dominators, ir_args(function, insn)[0], block);
+        if (ir_range_is_empty(&condition)) return;
+        int taken = function->blocks[block].first_succ;
+        if (condition.low != 0 || condition.high != 0) reach_edge(p, taken);
+        if (contains_zero(&condition)) reach_edge(p, function->edges[taken].next_succ);
+        return;
+    }
+    if (ir->type == IR_TYPE_VOID) return;
+
+    IrRange* current = &p->ranges->ranges[insn];
+    IrRange next = join(*current, evaluate(p, insn));
+    if (same_range(&next, current)) return;
+    if (++p->changes[insn] > CHANGE_LIMIT) {
+        next = full_range;
+    } else if (ir->op == IR_PHI && p->changes[insn] > WIDEN_AFTER && is_header(p, block) &&
+               !ir_range_is_empty(current)) {
+        if (next.low < current->low) next.low = INT32_MIN;
+        if (next.high > current->high) next.high = INT32_MAX;
+        if (next.ulow < current->ulow) next.ulow = 0;
+        if (next.uhigh > current->uhigh) next.uhigh = UINT32_MAX;
+    }
+    *current = next;
+    push_value(p, insn);
+}
+
+static void grew(Propagation* p, int value) {
+    for (int u = p->user_start[value]; u < p->user_start[value + 1]; u++) {
+        if (p->reached[p->function->insns[p->users[u]].block]) visit(p, p->users[u]);
+    }
+    // Conditions comparing the value narrow the other side of the comparison.
+    for (int q = p->partner_start[value]; q < p->partner_start[value + 1]; q++) {
+        int other = p->partners[q];
+        for (int u = p->user_start[other]; u < p->user_start[other + 1]; u++) {
+            if (p->reached[p->function->insns[p->users[u]].block]) visit(p, p->users[u]);
+        }
+    }
+}
+
+// Counts into start[v + 1], then turns counts into offsets.
+static void offsets(int* start, int count) {
+    for (int v = 0; v < count; v++) start[v + 1] += start[v];
+}
+
+static void build_users(Propagation* p, const IrCfg* cfg) {
+    const IrFunction* function = p->function;
+    int count = function->insn_count;
+    p->user_start = checked(calloc((size_t)count + 1, sizeof(int)));
+    p->partner_start = checked(calloc((size_t)count + 1, sizeof(int)));
+    for (int pass = 0; pass < 2; pass++) {
+        int* user_fill = NULL;
+        int* partner_fill = NULL;
+        if (pass == 1) {
+            offsets(p->user_start, count);
+            offsets(p->partner_start, count);
+            p->users = checked(malloc((size_t)(p->user_start[count] > 0 ? p->user_start[count] : 1) * sizeof(int)));
+            p->partners = checked(malloc((size_t)(p->partner_start[count] > 0 ? p->partner_start[count] : 1) *
+                                         sizeof(int)));
+            user_fill = checked(malloc((size_t)count * sizeof(int)));
+            partner_fill = checked(malloc((size_t)count * sizeof(int)));
+            memcpy(user_fill, p->user_start, (size_t)count * sizeof(int));
+            memcpy(partner_fill, p->partner_start, (size_t)count * sizeof(int));
+        }
+        for (int i = 0; i < cfg->count; i++) {
+            int block = cfg->order[i];
+            for (int insn = function->blocks[block].first; insn != IR_NONE; insn = function->insns[insn].next) {
+                const int32_t* args = ir_args(function, insn);
+                for (int a = 0; a < function->insns[insn].arg_count; a++) {
+                    if (pass == 0) {
+                        p->user_start[args[a] + 1]++;
+                    } else {
+                        p->users[user_fill[args[a]]++] = insn;
+                    }
+                }
+                // form_range reads the base, which need not be an operand.
+                const IrAffine* form = &p->induction->forms[insn];
+                if (form->term_count > 0 && form->base != IR_NONE && form->base != insn) {
+                    if (pass == 0) {
+                        p->user_start[form->base + 1]++;
+                    } else {
+                        p->users[user_fill[form->base]++] = insn;
+                    }
+                }
+                if (function->insns[insn].op != IR_BRANCH) continue;
+                int condition = args[0];
+                IrOp op = (IrOp)function->insns[condition].op;
+                if (op < IR_EQ || op > IR_GE) continue;
+                const int32_t* sides = ir_args(function, condition);
+                for (int side = 0; side < 2; side++) {
+                    if (pass == 0) {
+                        p->partner_start[sides[side] + 1]++;
+                    } else {
+                        p->partners[partner_fill[sides[side]]++] = sides[1 - side];
+                    }
+                }
+            }
+        }
+        free(user_fill);
+        free(partner_fill);
+    }
+}
+
+void ir_compute_ranges(IrRanges* ranges, const IrFunction* function, const IrCfg* cfg,
+                       const IrDominators* dominators, const IrLoops* loops, const IrInduction* induction) {
+    int count = function->insn_count;
+    ranges->ranges = checked(malloc((size_t)(count > 0 ? count : 1) * sizeof(IrRange)));
+    for (int v = 0; v < count; v++) ranges->ranges[v] = empty_range;
+    ranges->executable = checked(calloc((size_t)(function->edge_count > 0 ? function->edge_count : 1), 1));
+    if (cfg->count == 0) return;
+
+    Propagation p = { 0 };
+    p.function = function;
+    p.dominators = dominators;
+    p.loops = loops;
+    p.induction = induction;
+    p.ranges = ranges;
+    p.reached = checked(calloc((size_t)function->block_count, 1));
+    p.changes = checked(calloc((size_t)(count > 0 ? count : 1), 1));
+    p.queued = checked(calloc((size_t)(count > 0 ? count : 1), 1));
+    p.values = checked(malloc((size_t)(count > 0 ? count : 1) * sizeof(int)));
+    p.blocks = checked(malloc((size_t)function->block_count * sizeof(int)));
+    build_users(&p, cfg);
+
+    int entry = cfg->order[0];
+    p.reached[entry] = 1;
+    p.blocks[p.block_count++] = entry;
+    while (p.block_count > 0 || p.value_count > 0) {
+        if (p.block_count > 0) {
+            int block = p.blocks[--p.block_count];
+            for (int insn = function->blocks[block].first; insn != IR_NONE; insn = function->insns[insn].next) {
+                visit(&p, insn);
+            }
+            continue;
+        }
+        int value = p.values[--p.value_count];
+        p.queued[value] = 0;
+        grew(&p, value);
+    }
+
+    // Narrowing: without the join a sweep can only shrink the fixed point,
+    // and every range it gives still holds all of the value's values.
+    for (int sweep = 0; sweep < NARROWING_SWEEPS; sweep++) {
+        for (int i = 0; i < cfg->count; i++) {
+            int block = cfg->order[i];
+            if (!p.reached[block]) continue;
+            for (int insn = function->blocks[block].first; insn != IR_NONE; insn = function->insns[insn].next) {
+                if (function->insns[insn].type == IR_TYPE_VOID) continue;
+                IrRange narrowed = evaluate(&p, insn);
+                if (!ir_range_is_empty(&narrowed)) ranges->ranges[insn] = intersect(ranges->ranges[insn], narrowed);
+            }
+        }
+    }
+
+    free(p.reached);
+    free(p.changes);
+    free(p.queued);
+    free(p.values);
+    free(p.blocks);
+    free(p.user_start);
+    free(p.users);
+    free(p.partner_start);
+    free(p.partners);
+}
+
+void ir_ranges_free(IrRanges* ranges) {
+    free(ranges->ranges);
+    free(ranges->executable);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "dataflow.h"
+#include "induction.h"
+#include "ir.h"
+#include <stdint.h>
+
+// Value ranges: a signed and an unsigned interval per i32 value,
+// each holding every value it takes; where one of them stays on one side
+// of the other's wrap-around point, each narrows the other. Propagation is
+// sparse, along def-use chains, and conditional: blocks and edges count
+// only once a branch on a reachable condition can take them. A value's
+// operands are read as narrowed by the branches leading to its block (x
+// below n past `if (x < n)`), and a value with an affine form in loops of
+// constant trip count is bounded by its first and last iteration. Header
+// phis that keep growing are widened to the type's bounds, then a couple
+// of sweeps narrow everything again.
+typedef struct {
+    int32_t low, high;          // signed; empty when low > high
+    uint32_t ulow, uhigh;       // unsigned
+} IrRange;
+
+typedef struct {
+    IrRange* ranges;            // per value, over all of its executions; empty if it never runs
+    uint8_t* executable;        // per edge
+} IrRanges;
+
+void ir_compute_ranges(IrRanges* ranges, const IrFunction* function, const IrCfg* cfg,
+                       const IrDominators* dominators, const IrLoops* loops, const IrInduction* induction);
+void ir_ranges_free(IrRanges* ranges);
+int ir_range_is_empty(const IrRange* range);
+// Is the range a single value, and which.
+int ir_range_constant(const IrRange* range, int32_t* value);
+// Range of `value` where `block` uses it: narrowed by the conditions on the
+// way to the block, as far as its immediate dominators go.
+IrRange ir_range_at(const IrRanges* ranges, const IrFunction* function, const IrDominators* dominators, int value,
+                    int block);
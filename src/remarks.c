@@ -0,0 +1,56 @@
+#include "remarks.h"
+#include "json.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+int remarks_enabled;
+
+static FILE* record;
+static const char* source = "";
+static long count;
+
+int remarks_open(const char* path) {
+    record = fopen(path, "w");
+    if (record == NULL) return -1;
+    fputs("[\n", record);
+    remarks_enabled = 1;
+    count = 0;
+    return 0;
+}
+
+void remarks_set_source(const char* path) {
+    source = path ? path : "";
+}
+
+void remark(RemarkKind kind, const char* pass, const char* name, const char* function, int line, const char* format,
+            ...) {
+    static const char* const kinds[] = { "passed", "missed", "analysis" };
+    if (!remarks_enabled) return;
+    char message[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    fputs(count++ ? ",\n{" : "{", record);
+    fprintf(record, "\"kind\": \"%s\", \"pass\": ", kinds[kind]);
+    write_json_string(record, pass);
+    fputs(", \"name\": ", record);
+    write_json_string(record, name);
+    fputs(", \"file\": ", record);
+    write_json_string(record, source);
+    fputs(", \"function\": ", record);
+    write_json_string(record, function ? function : "");
+    fprintf(record, ", \"line\": %d, \"message\": ", line);
+    write_json_string(record, message);
+    fputc('}', record);
+}
+
+long remarks_close(void) {
+    if (record == NULL) return 0;
+    fputs(count ? "\n]\n" : "]\n", record);
+    fclose(record);
+    record = NULL;
+    remarks_enabled = 0;
+    return count;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+// -fsave-optimization-record=<file.json>: one record per optimization
+// decision, written as a JSON array with one object per line:
+//
+//   {"kind": "missed", "pass": "regalloc", "name": "Spilled", "file": "a.c",
+//    "function": "main", "line": 12, "message": "..."}
+//
+// "passed" records a transformation that was made, "missed" one that was
+// considered and not made (or a cost the optimizer had to accept, such as
+// a spill), with the reason in the message. Lines are source lines, 0 when
+// unknown. Call sites test remarks_enabled before building a message.
+typedef enum {
+    REMARK_PASSED,
+    REMARK_MISSED,
+    REMARK_ANALYSIS
+} RemarkKind;
+
+extern int remarks_enabled;
+
+// Starts the record; returns -1 if the file cannot be created.
+int remarks_open(const char* path);
+// Source file named by the following records (batch builds change it per input).
+void remarks_set_source(const char* path);
+void remark(RemarkKind kind, const char* pass, const char* name, const char* function, int line, const char* format,
+            ...) __attribute__((format(printf, 6, 7)));
+// Finishes the array and closes the file; returns the number of records.
+long remarks_close(void);
@@ -1,4 +1,9 @@
+#define _POSIX_C_SOURCE 200809L
 #include "riscv.h"
+#include "phase.h"
+#include "frame.h"
+#include "probes.h"
+#include "symtab.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -6,7 +11,26 @@
 
 static int register_used[32] = {0};
 static int label_counter = 0;
-static int stack_offset = 0;
+
+// Stack slots of the current function. The frame is the 16-byte ra/s0 save
+// area followed by the slots layout_frame assigns: variables whose
+// lifetimes do not overlap share a slot, and the most used scalars come
+// first so that they stay within reach of a 12-bit offset from s0. Each
+// function gets a scope of its own in which every variable is bound to its
+// offset: the variable lives at -offset(s0).
+static SymbolTable frame_symbols;
+static int stack_offset = 8;
+
+// Registers handed out for expression temporaries: the caller-saved ones
+// first, then the callee-saved ones, which the prologue saves when used.
+static const RiscvReg temp_registers[] = { T0, T1, T2, T3, T4, T5, T6,
+                                           S1, S2, S3, S4, S5, S6, S7, S8, S9, S10, S11 };
+#define TEMP_REGISTER_COUNT (int)(sizeof(temp_registers) / sizeof(temp_registers[0]))
+#define CALLER_SAVED_TEMPS 7
+static int callee_saved_used[32] = {0};
+// Label of the shared epilogue, and the return that falls through into it.
+static int return_label = 0;
+static ASTNode* final_return = NULL;
 
 const char* get_register_name(RiscvReg reg) {
     static const char* names[] = {
@@ -19,10 +43,11 @@ const char* get_register_name(RiscvReg reg) {
 }
 
 RiscvReg allocate_register(void) {
-    for (int i = T0; i <= T6; i++) {
-        if (!register_used[i]) {
-            register_used[i] = 1;
-            return (RiscvReg)i;
+    for (int i = 0; i < TEMP_REGISTER_COUNT; i++) {
+        if (!register_used[temp_registers[i]]) {
+            register_used[temp_registers[i]] = 1;
+            if (i >= CALLER_SAVED_TEMPS) callee_saved_used[temp_registers[i]] = 1;
+            return temp_registers[i];
         }
     }
     fprintf(stderr, "Error: No free registers available\n");
@@ -33,45 +58,390 @@ void free_register(RiscvReg reg) {
     register_used[reg] = 0;
 }
 
+static void reset_frame(void) {
+    symtab_pop_scope(&frame_symbols);
+    symtab_push_scope(&frame_symbols);
+    stack_offset = 8;
+    memset(callee_saved_used, 0, sizeof(callee_saved_used));
+}
+
+void reset_codegen_state(void) {
+    memset(register_used, 0, sizeof(register_used));
+    label_counter = 0;
+    symtab_free(&frame_symbols);
+    reset_frame();
+}
+
+// Length of the variable name in a declaration value ("arr[16]" -> 3) and
+// the number of words it occupies.
+static size_t declared_name(const char* value, int* words) {
+    const char* bracket = strchr(value, '[');
+    *words = 1;
+    if (bracket == NULL) return strlen(value);
+    int count = atoi(bracket + 1);
+    if (count > 1) *words = count;
+    return (size_t)(bracket - value);
+}
+
+// Offset of a variable's slot, allocating a slot of its own on first sight.
+static int add_slot(const char* name, size_t length, int words, SymbolKind kind) {
+    int id = symtab_intern(&frame_symbols, name, length);
+    const Symbol* symbol = symtab_lookup(&frame_symbols, id);
+    if (symbol) return symbol->value;
+    // Arrays grow upwards from their base, so the base is the lowest word.
+    stack_offset += words * 4;
+    return symtab_bind(&frame_symbols, id, kind, stack_offset)->value;
+}
+
+// Frame layout of the function being generated. Positions number the
+// statements in source order, and every variable is live from the first
+// statement that mentions it to the last. A variable mentioned in a loop
+// is live across the whole outermost loop around it: its value can flow
+// around the back edge. Mentions are weighted by loop depth.
+typedef struct {
+    FrameLayout frame;
+    int* names;                 // per object, interned name
+    int position;
+    int loop_depth;
+} FrameBuilder;
+
+static void mention(FrameBuilder* builder, const char* name, size_t length, int words, SymbolKind kind) {
+    int id = symtab_intern(&frame_symbols, name, length);
+    Symbol* symbol = symtab_lookup(&frame_symbols, id);
+    if (symbol == NULL) {
+        int object = frame_add(&builder->frame, words, kind == SYMBOL_ARRAY);
+        builder->names = realloc(builder->names, (size_t)builder->frame.capacity * sizeof(int));
+        if (builder->names == NULL) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(1);
+        }
+        builder->names[object] = id;
+        symbol = symtab_bind(&frame_symbols, id, kind, object);
+    }
+    FrameObject* object = &builder->frame.objects[symbol->value];
+    if (words > object->words) object->words = words;
+    if (kind == SYMBOL_ARRAY) {
+        symbol->kind = kind;
+        object->array = 1;
+    }
+    int depth = builder->loop_depth < 5 ? builder->loop_depth : 5;
+    frame_use(&builder->frame, symbol->value, builder->position, builder->position + 1, 1L << (3 * depth));
+}
+
+// The variables an expression or a simple statement mentions.
+static void mention_variables(FrameBuilder* builder, ASTNode* node) {
+    if (!node) return;
+    int words = 1;
+    switch (node->type) {
+        case NODE_DECLARATION: {
+            size_t length = declared_name(node->value, &words);
+            mention(builder, node->value, length, words, words > 1 ? SYMBOL_ARRAY : SYMBOL_LOCAL);
+            break;
+        }
+        case NODE_EXPRESSION:
+        case NODE_ASSIGNMENT:
+        case NODE_ARRAY_ACCESS:
+            if (node->value && isalpha((unsigned char)node->value[0])) {
+                mention(builder, node->value, strlen(node->value), 1,
+                        node->type == NODE_ARRAY_ACCESS ? SYMBOL_ARRAY : SYMBOL_LOCAL);
+            }
+            break;
+        default:
+            break;
+    }
+    if (node->type == NODE_FUNCTION_CALL) {
+        for (ASTNode* arg = node->left; arg; arg = arg->next) mention_variables(builder, arg);
+    } else {
+        mention_variables(builder, node->left);
+    }
+    mention_variables(builder, node->right);
+}
+
+static void measure_statements(FrameBuilder* builder, ASTNode* node);
+
+static void measure_loop(FrameBuilder* builder, ASTNode* node) {
+    int start = builder->position;
+    builder->loop_depth++;
+    if (node->type == NODE_WHILE) {
+        mention_variables(builder, node->left);
+        builder->position++;
+        measure_statements(builder, node->right);
+    } else {
+        mention_variables(builder, node->left);
+        builder->position++;
+        ASTNode* condition = node->right;
+        if (condition) {
+            mention_variables(builder, condition);
+            builder->position++;
+            ASTNode* iteration = condition->next;
+            if (iteration) {
+                measure_statements(builder, iteration->next);
+                mention_variables(builder, iteration);
+                builder->position++;
+            }
+        }
+    }
+    if (--builder->loop_depth == 0) frame_cover(&builder->frame, start, builder->position);
+}
+
+static void measure_statements(FrameBuilder* builder, ASTNode* node) {
+    for (; node; node = node->next) {
+        switch (node->type) {
+            case NODE_IF:
+                mention_variables(builder, node->left);
+                builder->position++;
+                measure_statements(builder, node->right);
+                break;
+            case NODE_ELSE:
+                measure_statements(builder, node->right);
+                break;
+            case NODE_WHILE:
+            case NODE_FOR:
+                measure_loop(builder, node);
+                break;
+            default:
+                mention_variables(builder, node);
+                builder->position++;
+                break;
+        }
+    }
+}
+
+// Lays out the frame of a function: parameters, locals and arrays, with
+// variables whose lifetimes do not overlap sharing a slot.
+static void layout_frame(ASTNode* function) {
+    FrameBuilder builder = { 0 };
+    frame_init(&builder.frame);
+    // Incoming arguments are stored before the body runs.
+    for (ASTNode* param = function->left; param; param = param->next) {
+        mention(&builder, param->value, strlen(param->value), 1, SYMBOL_PARAM);
+    }
+    builder.position = 1;
+    measure_statements(&builder, function->right);
+
+    stack_offset = frame_assign(&builder.frame, stack_offset);
+    for (int i = 0; i < builder.frame.count; i++) {
+        symtab_lookup(&frame_symbols, builder.names[i])->value = builder.frame.objects[i].offset;
+    }
+    frame_free(&builder.frame);
+    free(builder.names);
+}
+
 int get_variable_offset(const char* name) {
-    // Simple offset calculation (replace with symbol table lookup)
-    int base_offset = 8;
-    int offset = base_offset + (name[0] - 'a') * 4;
-    return offset;
+    // Names outside the collected frame (code generated without a prologue)
+    // get a slot on first use.
+    return add_slot(name, strlen(name), 1, SYMBOL_LOCAL);
+}
+
+static int saved_register_count(void) {
+    int count = 0;
+    for (int i = CALLER_SAVED_TEMPS; i < TEMP_REGISTER_COUNT; i++) count += callee_saved_used[temp_registers[i]];
+    return count;
+}
+
+// Bytes of the frame below the ra/s0 save area: the variable slots, and at
+// the bottom the callee-saved registers the body uses.
+static int locals_size(void) {
+    return (stack_offset - 8 + saved_register_count() * 4 + 15) / 16 * 16;
+}
+
+// The callee-saved registers the body uses, in save order.
+static int saved_registers(RiscvReg* saved) {
+    int count = 0;
+    for (int i = CALLER_SAVED_TEMPS; i < TEMP_REGISTER_COUNT; i++) {
+        if (callee_saved_used[temp_registers[i]]) saved[count++] = temp_registers[i];
+    }
+    return count;
+}
+
+// Turns the element index in index_reg into an address that the element is
+// at -offset(index_reg) from, and returns that offset. Arrays beyond the
+// reach of a 12-bit offset get their base added explicitly.
+static int emit_element_address(FILE* output, RiscvReg index_reg, int offset) {
+    const char* index = get_register_name(index_reg);
+    fprintf(output, "    slli %s, %s, 2\n", index, index);
+    fprintf(output, "    add %s, %s, s0\n", index, index);
+    if (offset <= 2048) return offset;
+    RiscvReg base_reg = allocate_register();
+    fprintf(output, "    li %s, -%d\n", get_register_name(base_reg), offset);
+    fprintf(output, "    add %s, %s, %s\n", index, index, get_register_name(base_reg));
+    free_register(base_reg);
+    return 0;
+}
+
+// Loads or stores `reg` at -offset(s0); slots beyond the reach of a 12-bit
+// offset get their address built explicitly.
+static void emit_frame_access(FILE* output, const char* op, RiscvReg reg, int offset) {
+    if (offset <= 2048) {
+        fprintf(output, "    %s %s, -%d(s0)\n", op, get_register_name(reg), offset);
+        return;
+    }
+    RiscvReg base_reg = allocate_register();
+    const char* base = get_register_name(base_reg);
+    fprintf(output, "    li %s, -%d\n", base, offset);
+    fprintf(output, "    add %s, %s, s0\n", base, base);
+    fprintf(output, "    %s %s, 0(%s)\n", op, get_register_name(reg), base);
+    free_register(base_reg);
 }
 
 void generate_riscv_code(ASTNode* node, FILE* output) {
+    for (; node; node = node->next) {
+        phase_function_begin(node->value);
+        CC_PROBE1(function__begin, node->value);
+        long start = CC_PROBE_ENABLED(function__end) ? ftell(output) : 0;
+        generate_function(node, output);
+        CC_PROBE2(function__end, node->value, CC_PROBE_ENABLED(function__end) ? ftell(output) - start : 0);
+        phase_function_end();
+    }
+}
+
+void generate_function(ASTNode* node, FILE* output) {
     if (!node) return;
 
     switch (node->type) {
-        case NODE_FUNCTION:
+        case NODE_FUNCTION: {
+            reset_frame();
+            layout_frame(node);
+            return_label = label_counter++;
+            final_return = NULL;
+            for (ASTNode* statement = node->right; statement; statement = statement->next) {
+                final_return = statement->type == NODE_RETURN ? statement : NULL;
+            }
+
+            // The body is generated first: the prologue depends on which
+            // callee-saved registers it ends up using.
+            char* body = NULL;
+            size_t body_len = 0;
+            FILE* body_output = open_memstream(&body, &body_len);
+            if (!body_output) {
+                fprintf(stderr, "Memory allocation failed\n");
+                exit(1);
+            }
+            generate_statement(node->right, body_output);
+            fclose(body_output);
+
             generate_function_prologue(node->value, output);
-            generate_statement(node->right, output);
+            // Incoming arguments are spilled to their slots.
+            int arg_reg = A0;
+            for (ASTNode* param = node->left; param && arg_reg <= A7; param = param->next, arg_reg++) {
+                emit_frame_access(output, "sw", (RiscvReg)arg_reg, get_variable_offset(param->value));
+            }
+            fwrite(body, 1, body_len, output);
+            free(body);
+            fprintf(output, ".L%d:\n", return_label);
             generate_function_epilogue(output);
             break;
+        }
         default:
             fprintf(stderr, "Error: Top level node is not a function\n");
             exit(1);
     }
 }
 
-void generate_function_prologue(const char* func_name, FILE* output) {
+int reserve_labels(int count) {
+    int first = label_counter;
+    label_counter += count;
+    return first;
+}
+
+void emit_prologue(FILE* output, const char* func_name, int locals, const RiscvReg* saved, int saved_count) {
     fprintf(output, "    .text\n");
     fprintf(output, "    .globl %s\n", func_name);
     fprintf(output, "%s:\n", func_name);
-    fprintf(output, "    addi sp, sp, -16\n");
-    fprintf(output, "    sw ra, 12(sp)\n");
-    fprintf(output, "    sw s0, 8(sp)\n");
-    fprintf(output, "    addi s0, sp, 16\n");
+    if (locals + 16 < 2048) {
+        // One adjustment covers the save area and the locals; s0 = sp + 2048
+        // would be out of reach of addi.
+        fprintf(output, "    addi sp, sp, -%d\n", locals + 16);
+        fprintf(output, "    sw ra, %d(sp)\n", locals + 12);
+        fprintf(output, "    sw s0, %d(sp)\n", locals + 8);
+        fprintf(output, "    addi s0, sp, %d\n", locals + 16);
+    } else {
+        fprintf(output, "    addi sp, sp, -16\n");
+        fprintf(output, "    sw ra, 12(sp)\n");
+        fprintf(output, "    sw s0, 8(sp)\n");
+        fprintf(output, "    addi s0, sp, 16\n");
+        fprintf(output, "    li t0, -%d\n", locals);
+        fprintf(output, "    add sp, sp, t0\n");
+    }
+    for (int i = 0; i < saved_count; i++) {
+        fprintf(output, "    sw %s, %d(sp)\n", get_register_name(saved[i]), i * 4);
+    }
 }
 
-void generate_function_epilogue(FILE* output) {
+void emit_epilogue(FILE* output, int locals, const RiscvReg* saved, int saved_count) {
+    for (int i = 0; i < saved_count; i++) {
+        fprintf(output, "    lw %s, %d(sp)\n", get_register_name(saved[i]), i * 4);
+    }
+    if (locals > 0) {
+        fprintf(output, "    addi sp, s0, -16\n");
+    }
     fprintf(output, "    lw ra, 12(sp)\n");
     fprintf(output, "    lw s0, 8(sp)\n");
     fprintf(output, "    addi sp, sp, 16\n");
     fprintf(output, "    ret\n");
 }
 
+void generate_function_prologue(const char* func_name, FILE* output) {
+    RiscvReg saved[TEMP_REGISTER_COUNT];
+    emit_prologue(output, func_name, locals_size(), saved, saved_registers(saved));
+}
+
+void generate_function_epilogue(FILE* output) {
+    RiscvReg saved[TEMP_REGISTER_COUNT];
+    emit_epilogue(output, locals_size(), saved, saved_registers(saved));
+}
+
+// Calls clobber the caller-saved registers, so temporaries that are live
+// across the call are saved below sp around it. Arguments are evaluated
+// straight into a0-a7 unless a later argument makes a call of its own,
+// which would clobber the earlier ones; then they go through temporaries.
+static int contains_call(ASTNode* node) {
+    if (!node) return 0;
+    return node->type == NODE_FUNCTION_CALL || contains_call(node->left) || contains_call(node->right);
+}
+
+static void generate_call(ASTNode* node, FILE* output, RiscvReg dest_reg) {
+    RiscvReg staged[A7 - A0 + 1];
+    int arg_count = 0;
+    int nested = 0;
+    for (ASTNode* arg = node->left; arg; arg = arg->next) {
+        if (arg != node->left && contains_call(arg)) nested = 1;
+    }
+    for (ASTNode* arg = node->left; arg && arg_count <= A7 - A0; arg = arg->next, arg_count++) {
+        staged[arg_count] = nested ? allocate_register() : (RiscvReg)(A0 + arg_count);
+        generate_expression(arg, output, staged[arg_count]);
+    }
+    if (nested) {
+        for (int i = 0; i < arg_count; i++) {
+            fprintf(output, "    mv %s, %s\n", get_register_name((RiscvReg)(A0 + i)), get_register_name(staged[i]));
+            free_register(staged[i]);
+        }
+    }
+
+    RiscvReg live[CALLER_SAVED_TEMPS];
+    int live_count = 0;
+    for (int i = 0; i < CALLER_SAVED_TEMPS; i++) {
+        if (register_used[temp_registers[i]] && temp_registers[i] != dest_reg) live[live_count++] = temp_registers[i];
+    }
+    int save_size = (live_count * 4 + 15) / 16 * 16;
+    if (live_count > 0) {
+        fprintf(output, "    addi sp, sp, -%d\n", save_size);
+        for (int i = 0; i < live_count; i++) {
+            fprintf(output, "    sw %s, %d(sp)\n", get_register_name(live[i]), i * 4);
+        }
+    }
+    fprintf(output, "    call %s\n", node->value);
+    if (live_count > 0) {
+        for (int i = 0; i < live_count; i++) {
+            fprintf(output, "    lw %s, %d(sp)\n", get_register_name(live[i]), i * 4);
+        }
+        fprintf(output, "    addi sp, sp, %d\n", save_size);
+    }
+    if (dest_reg != A0) {
+        fprintf(output, "    mv %s, a0\n", get_register_name(dest_reg));
+    }
+}
+
 void generate_expression(ASTNode* node, FILE* output, RiscvReg dest_reg) {
     if (!node) {
         fprintf(output, "    li %s, 0\n", get_register_name(dest_reg));
@@ -83,12 +453,15 @@ void generate_expression(ASTNode* node, FILE* output, RiscvReg dest_reg) {
             if (node->value && (isdigit(node->value[0]) || (node->value[0] == '-' && isdigit(node->value[1])))) {
                 fprintf(output, "    li %s, %s\n", get_register_name(dest_reg), node->value);
             } else if (node->value && isalpha(node->value[0])) {
-                int offset = get_variable_offset(node->value);
-                fprintf(output, "    lw %s, -%d(s0)\n", get_register_name(dest_reg), offset);
+                emit_frame_access(output, "lw", dest_reg, get_variable_offset(node->value));
             } else if (node->left && node->right) {
-                RiscvReg left_reg = allocate_register();
-                RiscvReg right_reg = allocate_register();
+                // The left operand is built in dest_reg itself unless a call
+                // in the right operand could clobber it: temporaries are
+                // saved across calls, argument registers are not.
+                int direct = register_used[dest_reg] || !contains_call(node->right);
+                RiscvReg left_reg = direct ? dest_reg : allocate_register();
                 generate_expression(node->left, output, left_reg);
+                RiscvReg right_reg = allocate_register();
                 generate_expression(node->right, output, right_reg);
                 if (node->value) {
                     if (strcmp(node->value, "+") == 0) {
@@ -126,7 +499,7 @@ void generate_expression(ASTNode* node, FILE* output, RiscvReg dest_reg) {
                          fprintf(output, "    snez %s, %s\n", get_register_name(dest_reg), get_register_name(dest_reg));
                     }
                 }
-                free_register(left_reg);
+                if (!direct) free_register(left_reg);
                 free_register(right_reg);
             } else if (node->right && node->value && strcmp(node->value, "!") == 0) {
                  generate_expression(node->right, output, dest_reg);
@@ -140,17 +513,7 @@ void generate_expression(ASTNode* node, FILE* output, RiscvReg dest_reg) {
             break;
         case NODE_FUNCTION_CALL:
             if (node->value) {
-                ASTNode* arg = node->left;
-                int arg_reg = A0;
-                while (arg && arg_reg <= A7) {
-                    generate_expression(arg, output, (RiscvReg)arg_reg);
-                    arg = arg->next;
-                    arg_reg++;
-                }
-                fprintf(output, "    call %s\n", node->value);
-                if (dest_reg != A0) {
-                    fprintf(output, "    mv %s, a0\n", get_register_name(dest_reg));
-                }
+                generate_call(node, output, dest_reg);
             } else {
                 fprintf(output, "    li %s, 0\n", get_register_name(dest_reg));
             }
@@ -159,33 +522,24 @@ void generate_expression(ASTNode* node, FILE* output, RiscvReg dest_reg) {
              if (node->value) { // Simple variable assignment
                  int offset = get_variable_offset(node->value);
                  generate_expression(node->right, output, dest_reg);
-                 fprintf(output, "    sw %s, -%d(s0)\n", get_register_name(dest_reg), offset);
+                 emit_frame_access(output, "sw", dest_reg, offset);
              } else if (node->left && node->left->type == NODE_ARRAY_ACCESS) { // Array assignment
                  RiscvReg index_reg = allocate_register();
-                 RiscvReg addr_reg = allocate_register();
-                 generate_expression(node->right, output, dest_reg); // Value to store
+                 // The index goes first: dest_reg may be an argument register
+                 // that a call in the index would clobber.
                  generate_expression(node->left->left, output, index_reg); // Index
-                 int offset = get_variable_offset(node->left->value);
-                 fprintf(output, "    slli %s, %s, 2\n", get_register_name(index_reg), get_register_name(index_reg));
-                 fprintf(output, "    addi %s, s0, -%d\n", get_register_name(addr_reg), offset);
-                 fprintf(output, "    add %s, %s, %s\n", get_register_name(addr_reg), get_register_name(addr_reg), get_register_name(index_reg));
-                 fprintf(output, "    sw %s, 0(%s)\n", get_register_name(dest_reg), get_register_name(addr_reg));
+                 generate_expression(node->right, output, dest_reg); // Value to store
+                 int offset = emit_element_address(output, index_reg, get_variable_offset(node->left->value));
+                 fprintf(output, "    sw %s, -%d(%s)\n", get_register_name(dest_reg), offset, get_register_name(index_reg));
                  free_register(index_reg);
-                 free_register(addr_reg);
              }
              break;
         case NODE_ARRAY_ACCESS:
             if (node->value) {
-                RiscvReg index_reg = allocate_register();
-                RiscvReg addr_reg = allocate_register();
-                generate_expression(node->left, output, index_reg);
-                int offset = get_variable_offset(node->value);
-                fprintf(output, "    slli %s, %s, 2\n", get_register_name(index_reg), get_register_name(index_reg));
-                fprintf(output, "    addi %s, s0, -%d\n", get_register_name(addr_reg), offset);
-                fprintf(output, "    add %s, %s, %s\n", get_register_name(addr_reg), get_register_name(addr_reg), get_register_name(index_reg));
-                fprintf(output, "    lw %s, 0(%s)\n", get_register_name(dest_reg), get_register_name(addr_reg));
-                free_register(index_reg);
-                free_register(addr_reg);
+                // The index is built in dest_reg, which the load overwrites.
+                generate_expression(node->left, output, dest_reg);
+                int offset = emit_element_address(output, dest_reg, get_variable_offset(node->value));
+                fprintf(output, "    lw %s, -%d(%s)\n", get_register_name(dest_reg), offset, get_register_name(dest_reg));
             }
             break;
         default:
@@ -193,9 +547,7 @@ void generate_expression(ASTNode* node, FILE* output, RiscvReg dest_reg) {
     }
 }
 
-void generate_statement(ASTNode* node, FILE* output) {
-    if (!node) return;
-
+static void generate_single_statement(ASTNode* node, FILE* output) {
     switch (node->type) {
         case NODE_IF:
             generate_if(node, output);
@@ -219,15 +571,18 @@ void generate_statement(ASTNode* node, FILE* output) {
                  RiscvReg value_reg = allocate_register();
                  generate_expression(node->right, output, value_reg);
                  int offset = get_variable_offset(node->value);
-                 fprintf(output, "    sw %s, -%d(s0)\n", get_register_name(value_reg), offset);
+                 emit_frame_access(output, "sw", value_reg, offset);
                  free_register(value_reg);
              }
             break;
         default:
              break;
     }
-    if (node->next) {
-        generate_statement(node->next, output);
+}
+
+void generate_statement(ASTNode* node, FILE* output) {
+    for (; node; node = node->next) {
+        generate_single_statement(node, output);
     }
 }
 
@@ -237,15 +592,15 @@ void generate_if(ASTNode* node, FILE* output) {
     RiscvReg cond_reg = allocate_register();
     generate_expression(node->left, output, cond_reg);
     fprintf(output, "    beqz %s, .L%d\n", get_register_name(cond_reg), else_label);
+    free_register(cond_reg);
     generate_statement(node->right, output);
     fprintf(output, "    j .L%d\n", end_label);
     fprintf(output, ".L%d:\n", else_label);
+    // The ELSE node stays in the statement list; generate_statement skips it.
     if (node->next && node->next->type == NODE_ELSE) {
         generate_statement(node->next->right, output);
-        node->next = node->next->next;
     }
     fprintf(output, ".L%d:\n", end_label);
-    free_register(cond_reg);
 }
 
 void generate_while(ASTNode* node, FILE* output) {
@@ -255,10 +610,10 @@ void generate_while(ASTNode* node, FILE* output) {
     fprintf(output, ".L%d:\n", start_label);
     generate_expression(node->left, output, cond_reg);
     fprintf(output, "    beqz %s, .L%d\n", get_register_name(cond_reg), end_label);
+    free_register(cond_reg);
     generate_statement(node->right, output);
     fprintf(output, "    j .L%d\n", start_label);
     fprintf(output, ".L%d:\n", end_label);
-    free_register(cond_reg);
 }
 
 void generate_return(ASTNode* node, FILE* output) {
@@ -267,7 +622,9 @@ void generate_return(ASTNode* node, FILE* output) {
     } else {
         fprintf(output, "    li a0, 0\n");
     }
-    fprintf(output, "    ret\n");
+    if (node != final_return) {
+        fprintf(output, "    j .L%d\n", return_label);
+    }
 }
 
 void generate_for(ASTNode* node, FILE* output) {
@@ -282,6 +639,7 @@ void generate_for(ASTNode* node, FILE* output) {
         RiscvReg cond_reg = allocate_register();
         generate_expression(condition, output, cond_reg);
         fprintf(output, "    beqz %s, .L%d\n", get_register_name(cond_reg), end_label);
+        free_register(cond_reg);
         ASTNode* iteration = condition->next;
         ASTNode* body = NULL;
         if (iteration) {
@@ -294,7 +652,6 @@ void generate_for(ASTNode* node, FILE* output) {
             generate_expression(iteration, output, A0);
         }
         fprintf(output, "    j .L%d\n", start_label);
-        free_register(cond_reg);
     }
     fprintf(output, ".L%d:\n", end_label);
 } 
\ No newline at end of file
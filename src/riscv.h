@@ -41,6 +41,7 @@ typedef enum {
 
 
 void generate_riscv_code(ASTNode* node, FILE* output);
+void generate_function(ASTNode* node, FILE* output);
 void generate_function_prologue(const char* func_name, FILE* output);
 void generate_function_epilogue(FILE* output);
 void generate_expression(ASTNode* node, FILE* output, RiscvReg dest_reg);
@@ -51,7 +52,16 @@ void generate_for(ASTNode* node, FILE* output);
 void generate_return(ASTNode* node, FILE* output);
 
 
+// Frame set-up shared with the IR back end: `locals` bytes (a multiple of
+// 16) below the ra/s0 save area, with the callee-saved registers in `saved`
+// kept at the bottom of them.
+void emit_prologue(FILE* output, const char* func_name, int locals, const RiscvReg* saved, int saved_count);
+void emit_epilogue(FILE* output, int locals, const RiscvReg* saved, int saved_count);
+// Reserves `count` consecutive .L label numbers and returns the first.
+int reserve_labels(int count);
+
 const char* get_register_name(RiscvReg reg);
 RiscvReg allocate_register(void);
 void free_register(RiscvReg reg);
+void reset_codegen_state(void);
 
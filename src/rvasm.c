@@ -0,0 +1,1114 @@
+#define _POSIX_C_SOURCE 200809L
+#include "rvasm.h"
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_OPERANDS 4
+#define MAX_LINE 512
+
+static const char* opcode_names[RV_OP_COUNT] = {
+    "lui", "auipc", "jal", "jalr",
+    "beq", "bne", "blt", "bge", "bltu", "bgeu",
+    "lb", "lh", "lw", "lbu", "lhu", "sb", "sh", "sw",
+    "addi", "slti", "sltiu", "xori", "ori", "andi", "slli", "srli", "srai",
+    "add", "sub", "sll", "slt", "sltu", "xor", "srl", "sra", "or", "and",
+    "mul", "mulh", "mulhsu", "mulhu", "div", "divu", "rem", "remu",
+    "ecall", "ebreak",
+};
+
+static const char* register_names[32] = {
+    "zero", "ra", "sp", "gp", "tp", "t0", "t1", "t2",
+    "s0", "s1", "a0", "a1", "a2", "a3", "a4", "a5",
+    "a6", "a7", "s2", "s3", "s4", "s5", "s6", "s7",
+    "s8", "s9", "s10", "s11", "t3", "t4", "t5", "t6",
+};
+
+const char* rv_opcode_name(RvOpcode op) {
+    return op < RV_OP_COUNT ? opcode_names[op] : "?";
+}
+
+const char* rv_register_name(int reg) {
+    return reg >= 0 && reg < 32 ? register_names[reg] : "?";
+}
+
+RvClass rv_opcode_class(RvOpcode op) {
+    switch (op) {
+        case RV_MUL: case RV_MULH: case RV_MULHSU: case RV_MULHU:
+            return RV_CLASS_MUL;
+        case RV_DIV: case RV_DIVU: case RV_REM: case RV_REMU:
+            return RV_CLASS_DIV;
+        case RV_LB: case RV_LH: case RV_LW: case RV_LBU: case RV_LHU:
+            return RV_CLASS_LOAD;
+        case RV_SB: case RV_SH: case RV_SW:
+            return RV_CLASS_STORE;
+        case RV_BEQ: case RV_BNE: case RV_BLT: case RV_BGE: case RV_BLTU: case RV_BGEU:
+            return RV_CLASS_BRANCH;
+        case RV_JAL: case RV_JALR:
+            return RV_CLASS_JUMP;
+        case RV_ECALL: case RV_EBREAK:
+            return RV_CLASS_SYSTEM;
+        default:
+            return RV_CLASS_ALU;
+    }
+}
+
+int rv_source_registers(const RvInsn* insn, int sources[2]) {
+    switch (insn->op) {
+        case RV_LUI: case RV_AUIPC: case RV_JAL: case RV_EBREAK:
+            return 0;
+        case RV_ECALL:
+            // The system calls the simulator implements read a7 and a0.
+            sources[0] = 17;
+            sources[1] = 10;
+            return 2;
+        case RV_JALR: case RV_LB: case RV_LH: case RV_LW: case RV_LBU: case RV_LHU:
+        case RV_ADDI: case RV_SLTI: case RV_SLTIU: case RV_XORI: case RV_ORI: case RV_ANDI:
+        case RV_SLLI: case RV_SRLI: case RV_SRAI:
+            sources[0] = insn->rs1;
+            return 1;
+        default:
+            sources[0] = insn->rs1;
+            sources[1] = insn->rs2;
+            return 2;
+    }
+}
+
+int rv_writes_rd(const RvInsn* insn) {
+    RvClass class = rv_opcode_class(insn->op);
+    return class != RV_CLASS_STORE && class != RV_CLASS_BRANCH && class != RV_CLASS_SYSTEM && insn->rd != 0;
+}
+
+// --- Assembly state -------------------------------------------------------
+
+typedef enum { SECTION_TEXT, SECTION_DATA } Section;
+
+typedef enum {
+    FIXUP_NONE,
+    FIXUP_BRANCH,       // pc-relative offset in imm
+    FIXUP_PCREL_HI,     // auipc of a pc-relative pair
+    FIXUP_PCREL_LO,     // addi of a pc-relative pair; refers to the auipc before it
+    FIXUP_ABS_HI,       // %hi(symbol)
+    FIXUP_ABS_LO,       // %lo(symbol)
+} FixupKind;
+
+typedef struct {
+    int index;
+    FixupKind kind;
+    char* symbol;
+    int32_t addend;
+} Fixup;
+
+typedef struct {
+    int offset;         // into the data section
+    char* symbol;
+} DataFixup;
+
+typedef struct {
+    char* name;
+    Section section;
+    uint32_t offset;    // instruction index for text, byte offset for data
+    int global;
+    int defined;
+} Label;
+
+typedef struct {
+    RvProgram* program;
+    int text_capacity;
+    int data_capacity;
+    Label* labels;
+    int label_count;
+    int label_capacity;
+    Fixup* fixups;
+    int fixup_count;
+    int fixup_capacity;
+    DataFixup* data_fixups;
+    int data_fixup_count;
+    int data_fixup_capacity;
+    Section section;
+    int line;
+    int failed;
+} Assembler;
+
+static void* grow(void* items, int* capacity, int needed, size_t item_size) {
+    if (needed <= *capacity) return items;
+    int new_capacity = *capacity ? *capacity * 2 : 64;
+    while (new_capacity < needed) new_capacity *= 2;
+    void* grown = realloc(items, (size_t)new_capacity * item_size);
+    if (grown == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    *capacity = new_capacity;
+    return grown;
+}
+
+static char* copy_string(const char* text) {
+    char* copy = strdup(text);
+    if (copy == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    return copy;
+}
+
+static void fail(Assembler* as, const char* format, ...) {
+    if (as->failed) return;
+    as->failed = 1;
+    int used = snprintf(as->program->error, sizeof(as->program->error), "line %d: ", as->line);
+    va_list args;
+    va_start(args, format);
+    vsnprintf(as->program->error + used, sizeof(as->program->error) - (size_t)used, format, args);
+    va_end(args);
+}
+
+static Label* find_label(Assembler* as, const char* name) {
+    for (int i = 0; i < as->label_count; i++) {
+        if (strcmp(as->labels[i].name, name) == 0) return &as->labels[i];
+    }
+    return NULL;
+}
+
+static Label* label_entry(Assembler* as, const char* name) {
+    Label* label = find_label(as, name);
+    if (label) return label;
+    as->labels = grow(as->labels, &as->label_capacity, as->label_count + 1, sizeof(Label));
+    label = &as->labels[as->label_count++];
+    memset(label, 0, sizeof(*label));
+    label->name = copy_string(name);
+    return label;
+}
+
+static void define_label(Assembler* as, const char* name) {
+    Label* label = label_entry(as, name);
+    if (label->defined) {
+        fail(as, "symbol '%s' is already defined", name);
+        return;
+    }
+    label->defined = 1;
+    label->section = as->section;
+    label->offset = as->section == SECTION_TEXT ? (uint32_t)as->program->text_count : as->program->data_size;
+}
+
+static int emit(Assembler* as, RvOpcode op, int rd, int rs1, int rs2, int32_t imm) {
+    RvProgram* program = as->program;
+    program->text = grow(program->text, &as->text_capacity, program->text_count + 1, sizeof(RvInsn));
+    RvInsn* insn = &program->text[program->text_count];
+    insn->op = op;
+    insn->rd = (uint8_t)rd;
+    insn->rs1 = (uint8_t)rs1;
+    insn->rs2 = (uint8_t)rs2;
+    insn->imm = imm;
+    insn->line = as->line;
+    return program->text_count++;
+}
+
+static void add_fixup(Assembler* as, int index, FixupKind kind, const char* symbol, int32_t addend) {
+    as->fixups = grow(as->fixups, &as->fixup_capacity, as->fixup_count + 1, sizeof(Fixup));
+    as->fixups[as->fixup_count++] = (Fixup){ index, kind, copy_string(symbol), addend };
+}
+
+static void emit_data(Assembler* as, const void* bytes, uint32_t count) {
+    RvProgram* program = as->program;
+    program->data = grow(program->data, &as->data_capacity, (int)(program->data_size + count), 1);
+    if (bytes) {
+        memcpy(program->data + program->data_size, bytes, count);
+    } else {
+        memset(program->data + program->data_size, 0, count);
+    }
+    program->data_size += count;
+}
+
+// --- Operand parsing ------------------------------------------------------
+
+static int parse_register(const char* text) {
+    if (strcmp(text, "fp") == 0) return 8;
+    for (int i = 0; i < 32; i++) {
+        if (strcmp(text, register_names[i]) == 0) return i;
+    }
+    if (text[0] == 'x' && isdigit((unsigned char)text[1])) {
+        char* end;
+        long number = strtol(text + 1, &end, 10);
+        if (*end == '\0' && number >= 0 && number < 32) return (int)number;
+    }
+    return -1;
+}
+
+static int expect_register(Assembler* as, const char* text) {
+    int reg = parse_register(text);
+    if (reg < 0) fail(as, "expected a register, found '%s'", text);
+    return reg < 0 ? 0 : reg;
+}
+
+static int parse_number(const char* text, int64_t* value) {
+    if (text[0] == '\'' && text[1] && text[2] == '\'' && text[3] == '\0') {
+        *value = (unsigned char)text[1];
+        return 1;
+    }
+    char* end;
+    *value = strtoll(text, &end, 0);
+    return end != text && *end == '\0';
+}
+
+static int is_symbol(const char* text) {
+    if (!(isalpha((unsigned char)text[0]) || text[0] == '_' || text[0] == '.')) return 0;
+    for (const char* p = text; *p; p++) {
+        if (!(isalnum((unsigned char)*p) || *p == '_' || *p == '.' || *p == '$')) return 0;
+    }
+    return 1;
+}
+
+// Splits "symbol", "symbol+4" or "symbol-4" into name and addend.
+static int parse_symbol_reference(const char* text, char* name, size_t name_size, int32_t* addend) {
+    const char* sign = strpbrk(text + 1, "+-");
+    size_t length = sign ? (size_t)(sign - text) : strlen(text);
+    if (length == 0 || length >= name_size) return 0;
+    memcpy(name, text, length);
+    name[length] = '\0';
+    *addend = 0;
+    if (sign) {
+        int64_t value;
+        if (!parse_number(sign + 1, &value)) return 0;
+        *addend = (int32_t)(*sign == '-' ? -value : value);
+    }
+    return is_symbol(name);
+}
+
+static int32_t expect_immediate(Assembler* as, const char* text, int32_t low, int32_t high) {
+    int64_t value;
+    if (!parse_number(text, &value)) {
+        fail(as, "expected an immediate, found '%s'", text);
+        return 0;
+    }
+    if (value < low || value > high) {
+        fail(as, "immediate %lld is out of range", (long long)value);
+        return 0;
+    }
+    return (int32_t)value;
+}
+
+static int fits_imm12(int64_t value) {
+    return value >= -2048 && value <= 2047;
+}
+
+// Parses an offset that may be a number or %lo(symbol); returns the fixup
+// kind to apply to the instruction, if any.
+static FixupKind parse_offset(Assembler* as, const char* text, int32_t* value, char* symbol, size_t symbol_size) {
+    *value = 0;
+    if (text[0] == '\0') return FIXUP_NONE;
+    if (strncmp(text, "%lo(", 4) == 0) {
+        size_t length = strlen(text);
+        if (text[length - 1] != ')' || length - 5 >= symbol_size) {
+            fail(as, "malformed '%s'", text);
+            return FIXUP_NONE;
+        }
+        char inner[MAX_LINE];
+        memcpy(inner, text + 4, length - 5);
+        inner[length - 5] = '\0';
+        if (!parse_symbol_reference(inner, symbol, symbol_size, value)) fail(as, "malformed '%s'", text);
+        return FIXUP_ABS_LO;
+    }
+    *value = expect_immediate(as, text, -2048, 2047);
+    return FIXUP_NONE;
+}
+
+// Parses "offset(reg)".
+static FixupKind parse_memory(Assembler* as, const char* text, int* base, int32_t* offset, char* symbol,
+                              size_t symbol_size) {
+    const char* open = strrchr(text, '(');
+    size_t length = strlen(text);
+    if (open == NULL || text[length - 1] != ')') {
+        fail(as, "expected offset(register), found '%s'", text);
+        return FIXUP_NONE;
+    }
+    char before[MAX_LINE];
+    char reg[MAX_LINE];
+    memcpy(before, text, (size_t)(open - text));
+    before[open - text] = '\0';
+    size_t reg_length = length - (size_t)(open - text) - 2;
+    memcpy(reg, open + 1, reg_length);
+    reg[reg_length] = '\0';
+    *base = expect_register(as, reg);
+    return parse_offset(as, before, offset, symbol, symbol_size);
+}
+
+static void emit_load_immediate(Assembler* as, int rd, int64_t value) {
+    int32_t v = (int32_t)value;
+    if (fits_imm12(v)) {
+        emit(as, RV_ADDI, rd, 0, 0, v);
+        return;
+    }
+    int32_t low = (int32_t)((uint32_t)v << 20) >> 20;
+    int32_t high = (int32_t)(((uint32_t)v - (uint32_t)low) >> 12);
+    emit(as, RV_LUI, rd, 0, 0, high);
+    if (low != 0) emit(as, RV_ADDI, rd, rd, 0, low);
+}
+
+static void emit_branch(Assembler* as, RvOpcode op, int rs1, int rs2, const char* target) {
+    char name[MAX_LINE];
+    int32_t addend;
+    int index = emit(as, op, 0, rs1, rs2, 0);
+    if (!parse_symbol_reference(target, name, sizeof(name), &addend)) {
+        fail(as, "expected a label, found '%s'", target);
+        return;
+    }
+    add_fixup(as, index, FIXUP_BRANCH, name, addend);
+}
+
+static void emit_jump(Assembler* as, int rd, const char* target) {
+    char name[MAX_LINE];
+    int32_t addend;
+    int index = emit(as, RV_JAL, rd, 0, 0, 0);
+    if (!parse_symbol_reference(target, name, sizeof(name), &addend)) {
+        fail(as, "expected a label, found '%s'", target);
+        return;
+    }
+    add_fixup(as, index, FIXUP_BRANCH, name, addend);
+}
+
+static void emit_address(Assembler* as, int rd, const char* target) {
+    char name[MAX_LINE];
+    int32_t addend;
+    if (!parse_symbol_reference(target, name, sizeof(name), &addend)) {
+        fail(as, "expected a symbol, found '%s'", target);
+        return;
+    }
+    int high = emit(as, RV_AUIPC, rd, 0, 0, 0);
+    int low = emit(as, RV_ADDI, rd, rd, 0, 0);
+    add_fixup(as, high, FIXUP_PCREL_HI, name, addend);
+    add_fixup(as, low, FIXUP_PCREL_LO, name, addend);
+}
+
+// --- Instructions ---------------------------------------------------------
+
+typedef enum {
+    FORMAT_R,           // rd, rs1, rs2
+    FORMAT_I,           // rd, rs1, imm
+    FORMAT_SHIFT,       // rd, rs1, shamt
+    FORMAT_LOAD,        // rd, off(rs1)
+    FORMAT_STORE,       // rs2, off(rs1)
+    FORMAT_BRANCH,      // rs1, rs2, label
+    FORMAT_U,           // rd, imm20
+    FORMAT_NONE,
+} Format;
+
+static Format opcode_format(RvOpcode op) {
+    switch (rv_opcode_class(op)) {
+        case RV_CLASS_LOAD: return FORMAT_LOAD;
+        case RV_CLASS_STORE: return FORMAT_STORE;
+        case RV_CLASS_BRANCH: return FORMAT_BRANCH;
+        case RV_CLASS_SYSTEM: return FORMAT_NONE;
+        case RV_CLASS_MUL:
+        case RV_CLASS_DIV: return FORMAT_R;
+        default: break;
+    }
+    switch (op) {
+        case RV_LUI: case RV_AUIPC: return FORMAT_U;
+        case RV_SLLI: case RV_SRLI: case RV_SRAI: return FORMAT_SHIFT;
+        case RV_ADDI: case RV_SLTI: case RV_SLTIU: case RV_XORI: case RV_ORI: case RV_ANDI: return FORMAT_I;
+        default: return FORMAT_R;
+    }
+}
+
+static int lookup_opcode(const char* mnemonic) {
+    for (int i = 0; i < RV_OP_COUNT; i++) {
+        if (strcmp(mnemonic, opcode_names[i]) == 0) return i;
+    }
+    return -1;
+}
+
+static int expect_operands(Assembler* as, const char* mnemonic, int count, int expected) {
+    if (count != expected) {
+        fail(as, "'%s' takes %d operands, found %d", mnemonic, expected, count);
+        return 0;
+    }
+    return 1;
+}
+
+static void base_instruction(Assembler* as, RvOpcode op, char** ops, int count) {
+    const char* mnemonic = opcode_names[op];
+    char symbol[MAX_LINE];
+    int32_t imm;
+    switch (opcode_format(op)) {
+        case FORMAT_R:
+            if (!expect_operands(as, mnemonic, count, 3)) return;
+            emit(as, op, expect_register(as, ops[0]), expect_register(as, ops[1]), expect_register(as, ops[2]), 0);
+            return;
+        case FORMAT_I: {
+            if (!expect_operands(as, mnemonic, count, 3)) return;
+            int rd = expect_register(as, ops[0]);
+            int rs1 = expect_register(as, ops[1]);
+            FixupKind kind = parse_offset(as, ops[2], &imm, symbol, sizeof(symbol));
+            int index = emit(as, op, rd, rs1, 0, imm);
+            if (kind != FIXUP_NONE) add_fixup(as, index, kind, symbol, imm);
+            return;
+        }
+        case FORMAT_SHIFT:
+            if (!expect_operands(as, mnemonic, count, 3)) return;
+            emit(as, op, expect_register(as, ops[0]), expect_register(as, ops[1]), 0,
+                 expect_immediate(as, ops[2], 0, 31));
+            return;
+        case FORMAT_LOAD:
+        case FORMAT_STORE: {
+            if (!expect_operands(as, mnemonic, count, 2)) return;
+            int value = expect_register(as, ops[0]);
+            int base;
+            FixupKind kind = parse_memory(as, ops[1], &base, &imm, symbol, sizeof(symbol));
+            int index = opcode_format(op) == FORMAT_LOAD ? emit(as, op, value, base, 0, imm)
+                                                          : emit(as, op, 0, base, value, imm);
+            if (kind != FIXUP_NONE) add_fixup(as, index, kind, symbol, imm);
+            return;
+        }
+        case FORMAT_BRANCH:
+            if (!expect_operands(as, mnemonic, count, 3)) return;
+            emit_branch(as, op, expect_register(as, ops[0]), expect_register(as, ops[1]), ops[2]);
+            return;
+        case FORMAT_U: {
+            if (!expect_operands(as, mnemonic, count, 2)) return;
+            int rd = expect_register(as, ops[0]);
+            if (strncmp(ops[1], "%hi(", 4) == 0 && ops[1][strlen(ops[1]) - 1] == ')') {
+                char inner[MAX_LINE];
+                size_t length = strlen(ops[1]) - 5;
+                memcpy(inner, ops[1] + 4, length);
+                inner[length] = '\0';
+                if (!parse_symbol_reference(inner, symbol, sizeof(symbol), &imm)) {
+                    fail(as, "malformed '%s'", ops[1]);
+                    return;
+                }
+                add_fixup(as, emit(as, op, rd, 0, 0, 0), FIXUP_ABS_HI, symbol, imm);
+                return;
+            }
+            emit(as, op, rd, 0, 0, expect_immediate(as, ops[1], 0, 0xFFFFF));
+            return;
+        }
+        case FORMAT_NONE:
+            if (!expect_operands(as, mnemonic, count, 0)) return;
+            emit(as, op, 0, 0, 0, 0);
+            return;
+    }
+}
+
+// jal and jalr accept both their full and their one-operand forms.
+static int jump_instruction(Assembler* as, const char* mnemonic, char** ops, int count) {
+    if (strcmp(mnemonic, "jal") == 0) {
+        if (count == 1) {
+            emit_jump(as, 1, ops[0]);
+        } else if (expect_operands(as, mnemonic, count, 2)) {
+            emit_jump(as, expect_register(as, ops[0]), ops[1]);
+        }
+        return 1;
+    }
+    if (strcmp(mnemonic, "jalr") == 0) {
+        if (count == 1) {
+            emit(as, RV_JALR, 1, expect_register(as, ops[0]), 0, 0);
+        } else if (count == 2) {
+            int32_t offset;
+            int base;
+            char symbol[MAX_LINE];
+            parse_memory(as, ops[1], &base, &offset, symbol, sizeof(symbol));
+            emit(as, RV_JALR, expect_register(as, ops[0]), base, 0, offset);
+        } else if (expect_operands(as, mnemonic, count, 3)) {
+            emit(as, RV_JALR, expect_register(as, ops[0]), expect_register(as, ops[1]), 0,
+                 expect_immediate(as, ops[2], -2048, 2047));
+        }
+        return 1;
+    }
+    return 0;
+}
+
+typedef struct {
+    const char* name;
+    RvOpcode op;
+    int swap;           // operands are reversed (bgt a, b == blt b, a)
+} BranchAlias;
+
+static const BranchAlias branch_aliases[] = {
+    { "bgt", RV_BLT, 1 }, { "ble", RV_BGE, 1 }, { "bgtu", RV_BLTU, 1 }, { "bleu", RV_BGEU, 1 },
+};
+
+typedef struct {
+    const char* name;
+    RvOpcode op;
+    int zero_first;     // compares zero against the register (bgtz x == blt zero, x)
+} ZeroBranch;
+
+static const ZeroBranch zero_branches[] = {
+    { "beqz", RV_BEQ, 0 }, { "bnez", RV_BNE, 0 }, { "bltz", RV_BLT, 0 },
+    { "bgez", RV_BGE, 0 }, { "bgtz", RV_BLT, 1 }, { "blez", RV_BGE, 1 },
+};
+
+static int pseudo_instruction(Assembler* as, const char* mnemonic, char** ops, int count) {
+    for (size_t i = 0; i < sizeof(zero_branches) / sizeof(zero_branches[0]); i++) {
+        if (strcmp(mnemonic, zero_branches[i].name) != 0) continue;
+        if (!expect_operands(as, mnemonic, count, 2)) return 1;
+        int reg = expect_register(as, ops[0]);
+        if (zero_branches[i].zero_first) {
+            emit_branch(as, zero_branches[i].op, 0, reg, ops[1]);
+        } else {
+            emit_branch(as, zero_branches[i].op, reg, 0, ops[1]);
+        }
+        return 1;
+    }
+    for (size_t i = 0; i < sizeof(branch_aliases) / sizeof(branch_aliases[0]); i++) {
+        if (strcmp(mnemonic, branch_aliases[i].name) != 0) continue;
+        if (!expect_operands(as, mnemonic, count, 3)) return 1;
+        emit_branch(as, branch_aliases[i].op, expect_register(as, ops[1]), expect_register(as, ops[0]), ops[2]);
+        return 1;
+    }
+    if (strcmp(mnemonic, "nop") == 0) {
+        if (expect_operands(as, mnemonic, count, 0)) emit(as, RV_ADDI, 0, 0, 0, 0);
+    } else if (strcmp(mnemonic, "li") == 0) {
+        int64_t value;
+        if (!expect_operands(as, mnemonic, count, 2)) return 1;
+        int rd = expect_register(as, ops[0]);
+        if (!parse_number(ops[1], &value) || value < INT32_MIN || value > UINT32_MAX) {
+            fail(as, "expected a 32-bit immediate, found '%s'", ops[1]);
+            return 1;
+        }
+        emit_load_immediate(as, rd, value);
+    } else if (strcmp(mnemonic, "la") == 0 || strcmp(mnemonic, "lla") == 0) {
+        if (expect_operands(as, mnemonic, count, 2)) emit_address(as, expect_register(as, ops[0]), ops[1]);
+    } else if (strcmp(mnemonic, "mv") == 0) {
+        if (expect_operands(as, mnemonic, count, 2)) {
+            emit(as, RV_ADDI, expect_register(as, ops[0]), expect_register(as, ops[1]), 0, 0);
+        }
+    } else if (strcmp(mnemonic, "not") == 0) {
+        if (expect_operands(as, mnemonic, count, 2)) {
+            emit(as, RV_XORI, expect_register(as, ops[0]), expect_register(as, ops[1]), 0, -1);
+        }
+    } else if (strcmp(mnemonic, "neg") == 0) {
+        if (expect_operands(as, mnemonic, count, 2)) {
+            emit(as, RV_SUB, expect_register(as, ops[0]), 0, expect_register(as, ops[1]), 0);
+        }
+    } else if (strcmp(mnemonic, "seqz") == 0) {
+        if (expect_operands(as, mnemonic, count, 2)) {
+            emit(as, RV_SLTIU, expect_register(as, ops[0]), expect_register(as, ops[1]), 0, 1);
+        }
+    } else if (strcmp(mnemonic, "snez") == 0) {
+        if (expect_operands(as, mnemonic, count, 2)) {
+            emit(as, RV_SLTU, expect_register(as, ops[0]), 0, expect_register(as, ops[1]), 0);
+        }
+    } else if (strcmp(mnemonic, "sltz") == 0) {
+        if (expect_operands(as, mnemonic, count, 2)) {
+            emit(as, RV_SLT, expect_register(as, ops[0]), expect_register(as, ops[1]), 0, 0);
+        }
+    } else if (strcmp(mnemonic, "sgtz") == 0) {
+        if (expect_operands(as, mnemonic, count, 2)) {
+            emit(as, RV_SLT, expect_register(as, ops[0]), 0, expect_register(as, ops[1]), 0);
+        }
+    } else if (strcmp(mnemonic, "j") == 0) {
+        if (expect_operands(as, mnemonic, count, 1)) emit_jump(as, 0, ops[0]);
+    } else if (strcmp(mnemonic, "jr") == 0) {
+        if (expect_operands(as, mnemonic, count, 1)) emit(as, RV_JALR, 0, expect_register(as, ops[0]), 0, 0);
+    } else if (strcmp(mnemonic, "ret") == 0) {
+        if (expect_operands(as, mnemonic, count, 0)) emit(as, RV_JALR, 0, 1, 0, 0);
+    } else if (strcmp(mnemonic, "call") == 0) {
+        if (expect_operands(as, mnemonic, count, 1)) emit_jump(as, 1, ops[0]);
+    } else if (strcmp(mnemonic, "tail") == 0) {
+        if (expect_operands(as, mnemonic, count, 1)) emit_jump(as, 0, ops[0]);
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+// --- Directives -----------------------------------------------------------
+
+static void align_data(Assembler* as, uint32_t alignment) {
+    if (alignment == 0) return;
+    uint32_t padding = (alignment - as->program->data_size % alignment) % alignment;
+    if (padding) emit_data(as, NULL, padding);
+}
+
+static void emit_string(Assembler* as, const char* text, int terminate) {
+    size_t length = strlen(text);
+    if (length < 2 || text[0] != '"' || text[length - 1] != '"') {
+        fail(as, "expected a string, found '%s'", text);
+        return;
+    }
+    for (size_t i = 1; i + 1 < length; i++) {
+        unsigned char c = (unsigned char)text[i];
+        if (c == '\\' && i + 2 < length) {
+            c = (unsigned char)text[++i];
+            switch (c) {
+                case 'n': c = '\n'; break;
+                case 't': c = '\t'; break;
+                case 'r': c = '\r'; break;
+                case '0': c = '\0'; break;
+                default: break;
+            }
+        }
+        emit_data(as, &c, 1);
+    }
+    if (terminate) emit_data(as, "", 1);
+}
+
+static void emit_values(Assembler* as, char** ops, int count, uint32_t size) {
+    if (as->section == SECTION_TEXT) {
+        fail(as, "data directives are only supported outside .text");
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        int64_t value;
+        char name[MAX_LINE];
+        int32_t addend;
+        if (parse_number(ops[i], &value)) {
+            uint32_t word = (uint32_t)value;
+            uint8_t bytes[4] = { (uint8_t)word, (uint8_t)(word >> 8), (uint8_t)(word >> 16), (uint8_t)(word >> 24) };
+            emit_data(as, bytes, size);
+        } else if (size == 4 && parse_symbol_reference(ops[i], name, sizeof(name), &addend)) {
+            as->data_fixups = grow(as->data_fixups, &as->data_fixup_capacity, as->data_fixup_count + 1,
+                                   sizeof(DataFixup));
+            as->data_fixups[as->data_fixup_count++] = (DataFixup){ (int)as->program->data_size, copy_string(name) };
+            uint8_t bytes[4] = { (uint8_t)addend, (uint8_t)(addend >> 8), (uint8_t)(addend >> 16),
+                                 (uint8_t)(addend >> 24) };
+            emit_data(as, bytes, 4);
+        } else {
+            fail(as, "expected a value, found '%s'", ops[i]);
+        }
+    }
+}
+
+static void directive(Assembler* as, const char* name, char** ops, int count) {
+    if (strcmp(name, ".text") == 0) {
+        as->section = SECTION_TEXT;
+    } else if (strcmp(name, ".data") == 0 || strcmp(name, ".bss") == 0 || strcmp(name, ".rodata") == 0) {
+        as->section = SECTION_DATA;
+    } else if (strcmp(name, ".section") == 0) {
+        as->section = count > 0 && strncmp(ops[0], ".text", 5) == 0 ? SECTION_TEXT : SECTION_DATA;
+    } else if (strcmp(name, ".globl") == 0 || strcmp(name, ".global") == 0) {
+        for (int i = 0; i < count; i++) label_entry(as, ops[i])->global = 1;
+    } else if (strcmp(name, ".word") == 0 || strcmp(name, ".4byte") == 0 || strcmp(name, ".long") == 0) {
+        emit_values(as, ops, count, 4);
+    } else if (strcmp(name, ".half") == 0 || strcmp(name, ".2byte") == 0 || strcmp(name, ".short") == 0) {
+        emit_values(as, ops, count, 2);
+    } else if (strcmp(name, ".byte") == 0) {
+        emit_values(as, ops, count, 1);
+    } else if (strcmp(name, ".zero") == 0 || strcmp(name, ".space") == 0 || strcmp(name, ".skip") == 0) {
+        if (as->section == SECTION_TEXT) {
+            fail(as, "data directives are only supported outside .text");
+        } else if (count >= 1) {
+            emit_data(as, NULL, (uint32_t)expect_immediate(as, ops[0], 0, 1 << 26));
+        }
+    } else if (strcmp(name, ".string") == 0 || strcmp(name, ".asciz") == 0 || strcmp(name, ".ascii") == 0) {
+        if (as->section == SECTION_TEXT) {
+            fail(as, "data directives are only supported outside .text");
+            return;
+        }
+        for (int i = 0; i < count; i++) emit_string(as, ops[i], strcmp(name, ".ascii") != 0);
+    } else if (strcmp(name, ".align") == 0 || strcmp(name, ".p2align") == 0) {
+        // Instructions are always word aligned; only data needs padding.
+        if (as->section == SECTION_DATA && count >= 1) align_data(as, 1u << expect_immediate(as, ops[0], 0, 12));
+    } else if (strcmp(name, ".balign") == 0) {
+        if (as->section == SECTION_DATA && count >= 1) align_data(as, (uint32_t)expect_immediate(as, ops[0], 1, 4096));
+    }
+    // Anything else (.type, .size, .file, .option, .attribute, ...) does not
+    // affect execution and is accepted silently.
+}
+
+// --- Lines ----------------------------------------------------------------
+
+// Splits the operand list on commas outside quotes and parentheses, and
+// trims each operand in place.
+static int split_operands(char* text, char** ops) {
+    int count = 0;
+    int depth = 0;
+    int quoted = 0;
+    char* start = text;
+    for (char* p = text;; p++) {
+        if (*p == '"' && (p == text || p[-1] != '\\')) quoted = !quoted;
+        if (!quoted && *p == '(') depth++;
+        if (!quoted && *p == ')') depth--;
+        if (*p == '\0' || (*p == ',' && !quoted && depth == 0)) {
+            int end = *p == '\0';
+            *p = '\0';
+            while (isspace((unsigned char)*start)) start++;
+            char* tail = start + strlen(start);
+            while (tail > start && isspace((unsigned char)tail[-1])) *--tail = '\0';
+            if (*start || count > 0 || !end) {
+                if (count == MAX_OPERANDS) return -1;
+                ops[count++] = start;
+            }
+            if (end) break;
+            start = p + 1;
+        }
+    }
+    return count;
+}
+
+static void strip_comment(char* line) {
+    int quoted = 0;
+    for (char* p = line; *p; p++) {
+        if (*p == '"' && (p == line || p[-1] != '\\')) quoted = !quoted;
+        if (!quoted && (*p == '#' || (*p == '/' && p[1] == '/'))) {
+            *p = '\0';
+            return;
+        }
+    }
+}
+
+static void assemble_line(Assembler* as, char* line) {
+    strip_comment(line);
+    char* p = line;
+    for (;;) {
+        while (isspace((unsigned char)*p)) p++;
+        char* word = p;
+        while (*p && (isalnum((unsigned char)*p) || *p == '_' || *p == '.' || *p == '$')) p++;
+        if (*p == ':' && p > word) {
+            *p++ = '\0';
+            define_label(as, word);
+            continue;
+        }
+        p = word;
+        break;
+    }
+    if (*p == '\0') return;
+
+    char* mnemonic = p;
+    while (*p && !isspace((unsigned char)*p)) p++;
+    if (*p) *p++ = '\0';
+    char* ops[MAX_OPERANDS];
+    int count = split_operands(p, ops);
+    if (count < 0) {
+        fail(as, "too many operands");
+        return;
+    }
+    for (char* c = mnemonic; *c; c++) *c = (char)tolower((unsigned char)*c);
+
+    if (mnemonic[0] == '.') {
+        directive(as, mnemonic, ops, count);
+        return;
+    }
+    if (as->section != SECTION_TEXT) {
+        fail(as, "instruction '%s' outside .text", mnemonic);
+        return;
+    }
+    if (jump_instruction(as, mnemonic, ops, count) || pseudo_instruction(as, mnemonic, ops, count)) return;
+    int op = lookup_opcode(mnemonic);
+    if (op < 0) {
+        fail(as, "unknown instruction '%s'", mnemonic);
+        return;
+    }
+    base_instruction(as, (RvOpcode)op, ops, count);
+}
+
+static uint32_t label_address(const RvProgram* program, const Label* label) {
+    return label->section == SECTION_TEXT ? program->text_base + label->offset * 4
+                                          : program->data_base + label->offset;
+}
+
+static RvOpcode inverted_branch(RvOpcode op) {
+    switch (op) {
+        case RV_BEQ: return RV_BNE;
+        case RV_BNE: return RV_BEQ;
+        case RV_BLT: return RV_BGE;
+        case RV_BGE: return RV_BLT;
+        case RV_BLTU: return RV_BGEU;
+        default: return RV_BLTU;
+    }
+}
+
+// Conditional branches reach +-4 KiB. As GNU as does, a branch to a text
+// label further away becomes the inverted branch over a jal to the label.
+// Each expansion moves the code behind it, which can push other branches
+// out of range, so the layout is redone until it stops changing.
+static void relax_branches(Assembler* as) {
+    RvProgram* program = as->program;
+    for (;;) {
+        int count = program->text_count;
+        // moved[i]: expansions before instruction i, once summed.
+        int* moved = calloc((size_t)count + 1, sizeof(int));
+        if (moved == NULL) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(1);
+        }
+        int expanded = 0;
+        for (int i = 0; i < as->fixup_count; i++) {
+            Fixup* fixup = &as->fixups[i];
+            if (fixup->kind != FIXUP_BRANCH || rv_opcode_class(program->text[fixup->index].op) != RV_CLASS_BRANCH) {
+                continue;
+            }
+            Label* label = find_label(as, fixup->symbol);
+            if (label == NULL || !label->defined || label->section != SECTION_TEXT) continue;
+            int64_t relative = ((int64_t)label->offset - fixup->index) * 4 + fixup->addend;
+            if (relative >= -(1 << 12) && relative < (1 << 12)) continue;
+            moved[fixup->index + 1]++;
+            expanded++;
+        }
+        if (expanded == 0) {
+            free(moved);
+            return;
+        }
+        for (int i = 1; i <= count; i++) moved[i] += moved[i - 1];
+
+        RvInsn* text = malloc((size_t)(count + expanded) * sizeof(RvInsn));
+        if (text == NULL) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(1);
+        }
+        for (int i = 0; i < count; i++) {
+            RvInsn* insn = &text[i + moved[i]];
+            *insn = program->text[i];
+            if (moved[i + 1] == moved[i]) continue;
+            insn->op = inverted_branch(insn->op);
+            insn->imm = 8;
+            insn[1] = (RvInsn){ RV_JAL, 0, 0, 0, 0, insn->line };
+        }
+        for (int i = 0; i < as->fixup_count; i++) {
+            Fixup* fixup = &as->fixups[i];
+            int index = fixup->index;
+            // An expanded branch's target is now the jal's.
+            fixup->index = index + moved[index] + (moved[index + 1] != moved[index]);
+        }
+        for (int i = 0; i < as->label_count; i++) {
+            Label* label = &as->labels[i];
+            if (label->defined && label->section == SECTION_TEXT) label->offset += (uint32_t)moved[label->offset];
+        }
+        free(program->text);
+        free(moved);
+        program->text = text;
+        program->text_count = count + expanded;
+        as->text_capacity = count + expanded;
+    }
+}
+
+static void resolve(Assembler* as) {
+    RvProgram* program = as->program;
+    relax_branches(as);
+    program->text_base = RV_TEXT_BASE;
+    uint32_t text_end = program->text_base + (uint32_t)program->text_count * 4;
+    program->data_base = (text_end + 0xFFFu) & ~0xFFFu;
+
+    for (int i = 0; i < as->fixup_count && !as->failed; i++) {
+        Fixup* fixup = &as->fixups[i];
+        RvInsn* insn = &program->text[fixup->index];
+        Label* label = find_label(as, fixup->symbol);
+        as->line = insn->line;
+        if (label == NULL || !label->defined) {
+            fail(as, "undefined symbol '%s'", fixup->symbol);
+            break;
+        }
+        uint32_t target = label_address(program, label) + (uint32_t)fixup->addend;
+        uint32_t pc = program->text_base + (uint32_t)fixup->index * 4;
+        int32_t relative = (int32_t)(target - pc);
+        switch (fixup->kind) {
+            case FIXUP_BRANCH: {
+                int32_t limit = insn->op == RV_JAL ? 1 << 20 : 1 << 12;
+                if (relative < -limit || relative >= limit) fail(as, "branch to '%s' is out of range", fixup->symbol);
+                insn->imm = relative;
+                break;
+            }
+            case FIXUP_PCREL_HI:
+                insn->imm = (int32_t)(((uint32_t)relative + 0x800u) >> 12);
+                break;
+            case FIXUP_PCREL_LO: {
+                // The pair's offset is relative to the auipc just before.
+                int32_t pair = relative + 4;
+                insn->imm = (int32_t)((uint32_t)pair << 20) >> 20;
+                break;
+            }
+            case FIXUP_ABS_HI:
+                insn->imm = (int32_t)((target + 0x800u) >> 12);
+                break;
+            case FIXUP_ABS_LO:
+                insn->imm = (int32_t)(target << 20) >> 20;
+                break;
+            case FIXUP_NONE:
+                break;
+        }
+    }
+    for (int i = 0; i < as->data_fixup_count && !as->failed; i++) {
+        DataFixup* fixup = &as->data_fixups[i];
+        Label* label = find_label(as, fixup->symbol);
+        if (label == NULL || !label->defined) {
+            fail(as, "undefined symbol '%s'", fixup->symbol);
+            break;
+        }
+        uint8_t* bytes = program->data + fixup->offset;
+        uint32_t value = (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16
+                         | (uint32_t)bytes[3] << 24;
+        value += label_address(program, label);
+        for (int b = 0; b < 4; b++) bytes[b] = (uint8_t)(value >> (8 * b));
+    }
+
+    program->symbols = calloc((size_t)as->label_count + 1, sizeof(RvSymbol));
+    if (program->symbols == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    for (int i = 0; i < as->label_count; i++) {
+        Label* label = &as->labels[i];
+        if (!label->defined) continue;
+        RvSymbol* symbol = &program->symbols[program->symbol_count++];
+        symbol->name = copy_string(label->name);
+        symbol->address = label_address(program, label);
+        symbol->in_text = label->section == SECTION_TEXT;
+        symbol->global = label->global;
+    }
+}
+
+int rv_assemble(const char* source, size_t len, RvProgram* program) {
+    memset(program, 0, sizeof(*program));
+    Assembler as;
+    memset(&as, 0, sizeof(as));
+    as.program = program;
+    as.section = SECTION_TEXT;
+
+    char line[MAX_LINE];
+    size_t start = 0;
+    while (start < len && !as.failed) {
+        size_t end = start;
+        while (end < len && source[end] != '\n') end++;
+        as.line++;
+        size_t length = end - start;
+        if (length >= sizeof(line)) {
+            fail(&as, "line is too long");
+            break;
+        }
+        memcpy(line, source + start, length);
+        line[length] = '\0';
+        assemble_line(&as, line);
+        start = end + 1;
+    }
+    if (!as.failed) resolve(&as);
+
+    for (int i = 0; i < as.label_count; i++) free(as.labels[i].name);
+    for (int i = 0; i < as.fixup_count; i++) free(as.fixups[i].symbol);
+    for (int i = 0; i < as.data_fixup_count; i++) free(as.data_fixups[i].symbol);
+    free(as.labels);
+    free(as.fixups);
+    free(as.data_fixups);
+    if (as.failed) {
+        char error[sizeof(program->error)];
+        memcpy(error, program->error, sizeof(error));
+        rv_program_free(program);
+        memcpy(program->error, error, sizeof(error));
+        return -1;
+    }
+    return 0;
+}
+
+void rv_program_free(RvProgram* program) {
+    for (int i = 0; i < program->symbol_count; i++) free(program->symbols[i].name);
+    free(program->symbols);
+    free(program->text);
+    free(program->data);
+    memset(program, 0, sizeof(*program));
+}
+
+const RvSymbol* rv_find_symbol(const RvProgram* program, const char* name) {
+    for (int i = 0; i < program->symbol_count; i++) {
+        if (strcmp(program->symbols[i].name, name) == 0) return &program->symbols[i];
+    }
+    return NULL;
+}
+
+const RvSymbol* rv_function_at(const RvProgram* program, int index) {
+    uint32_t address = program->text_base + (uint32_t)index * 4;
+    const RvSymbol* best = NULL;
+    for (int i = 0; i < program->symbol_count; i++) {
+        const RvSymbol* symbol = &program->symbols[i];
+        if (!symbol->in_text || symbol->name[0] == '.' || symbol->address > address) continue;
+        if (best == NULL || symbol->address > best->address) best = symbol;
+    }
+    return best;
+}
+
+static const char* target_name(const RvProgram* program, uint32_t address, char* fallback, size_t size) {
+    for (int i = 0; i < program->symbol_count; i++) {
+        if (program->symbols[i].in_text && program->symbols[i].address == address) return program->symbols[i].name;
+    }
+    snprintf(fallback, size, "0x%x", address);
+    return fallback;
+}
+
+void rv_format_insn(const RvProgram* program, int index, char* buffer, size_t size) {
+    const RvInsn* insn = &program->text[index];
+    const char* op = opcode_names[insn->op];
+    const char* rd = register_names[insn->rd];
+    const char* rs1 = register_names[insn->rs1];
+    const char* rs2 = register_names[insn->rs2];
+    char fallback[16];
+    uint32_t pc = program->text_base + (uint32_t)index * 4;
+    const char* target = target_name(program, pc + (uint32_t)insn->imm, fallback, sizeof(fallback));
+
+    switch (insn->op) {
+        case RV_ADDI:
+            if (insn->rs1 == 0) {
+                snprintf(buffer, size, "li %s, %d", rd, insn->imm);
+            } else if (insn->imm == 0) {
+                snprintf(buffer, size, "mv %s, %s", rd, rs1);
+            } else {
+                snprintf(buffer, size, "addi %s, %s, %d", rd, rs1, insn->imm);
+            }
+            return;
+        case RV_SLTIU:
+            if (insn->imm == 1) {
+                snprintf(buffer, size, "seqz %s, %s", rd, rs1);
+                return;
+            }
+            break;
+        case RV_SLTU:
+            if (insn->rs1 == 0) {
+                snprintf(buffer, size, "snez %s, %s", rd, rs2);
+                return;
+            }
+            break;
+        case RV_SUB:
+            if (insn->rs1 == 0) {
+                snprintf(buffer, size, "neg %s, %s", rd, rs2);
+                return;
+            }
+            break;
+        case RV_JAL:
+            if (insn->rd == 0) {
+                snprintf(buffer, size, "j %s", target);
+            } else if (insn->rd == 1) {
+                snprintf(buffer, size, "call %s", target);
+            } else {
+                snprintf(buffer, size, "jal %s, %s", rd, target);
+            }
+            return;
+        case RV_JALR:
+            if (insn->rd == 0 && insn->rs1 == 1 && insn->imm == 0) {
+                snprintf(buffer, size, "ret");
+            } else {
+                snprintf(buffer, size, "jalr %s, %d(%s)", rd, insn->imm, rs1);
+            }
+            return;
+        case RV_LUI:
+        case RV_AUIPC:
+            snprintf(buffer, size, "%s %s, 0x%x", op, rd, (uint32_t)insn->imm & 0xFFFFF);
+            return;
+        case RV_ECALL:
+        case RV_EBREAK:
+            snprintf(buffer, size, "%s", op);
+            return;
+        default:
+            break;
+    }
+    switch (rv_opcode_class(insn->op)) {
+        case RV_CLASS_LOAD:
+            snprintf(buffer, size, "%s %s, %d(%s)", op, rd, insn->imm, rs1);
+            return;
+        case RV_CLASS_STORE:
+            snprintf(buffer, size, "%s %s, %d(%s)", op, rs2, insn->imm, rs1);
+            return;
+        case RV_CLASS_BRANCH:
+            if (insn->rs2 == 0 && (insn->op == RV_BEQ || insn->op == RV_BNE)) {
+                snprintf(buffer, size, "%sz %s, %s", op, rs1, target);
+            } else {
+                snprintf(buffer, size, "%s %s, %s, %s", op, rs1, rs2, target);
+            }
+            return;
+        default:
+            break;
+    }
+    if (insn->op >= RV_ADDI && insn->op <= RV_SRAI) {
+        snprintf(buffer, size, "%s %s, %s, %d", op, rd, rs1, insn->imm);
+    } else {
+        snprintf(buffer, size, "%s %s, %s, %s", op, rd, rs1, rs2);
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Assembler for the RV32IM assembly the compiler emits (and the usual GNU as
+// pseudo-instructions and data directives around it). Instructions are kept
+// decoded rather than encoded; pseudo-instructions are expanded into the
+// base instructions a real assembler would produce, so instruction counts
+// and addresses match a linked binary ("call" is assumed to be relaxed to a
+// single jal, and a conditional branch beyond +-4 KiB becomes the inverted
+// branch over a jal).
+
+typedef enum {
+    RV_LUI, RV_AUIPC, RV_JAL, RV_JALR,
+    RV_BEQ, RV_BNE, RV_BLT, RV_BGE, RV_BLTU, RV_BGEU,
+    RV_LB, RV_LH, RV_LW, RV_LBU, RV_LHU, RV_SB, RV_SH, RV_SW,
+    RV_ADDI, RV_SLTI, RV_SLTIU, RV_XORI, RV_ORI, RV_ANDI, RV_SLLI, RV_SRLI, RV_SRAI,
+    RV_ADD, RV_SUB, RV_SLL, RV_SLT, RV_SLTU, RV_XOR, RV_SRL, RV_SRA, RV_OR, RV_AND,
+    RV_MUL, RV_MULH, RV_MULHSU, RV_MULHU, RV_DIV, RV_DIVU, RV_REM, RV_REMU,
+    RV_ECALL, RV_EBREAK,
+    RV_OP_COUNT
+} RvOpcode;
+
+typedef enum {
+    RV_CLASS_ALU,
+    RV_CLASS_MUL,
+    RV_CLASS_DIV,
+    RV_CLASS_LOAD,
+    RV_CLASS_STORE,
+    RV_CLASS_BRANCH,    // conditional branches
+    RV_CLASS_JUMP,      // jal, jalr
+    RV_CLASS_SYSTEM,
+    RV_CLASS_COUNT
+} RvClass;
+
+typedef struct {
+    RvOpcode op;
+    uint8_t rd;
+    uint8_t rs1;
+    uint8_t rs2;
+    int32_t imm;        // branches and jal: byte offset from this instruction
+    int line;           // source line, for diagnostics
+} RvInsn;
+
+typedef struct {
+    char* name;
+    uint32_t address;
+    int in_text;
+    int global;
+} RvSymbol;
+
+typedef struct {
+    RvInsn* text;
+    int text_count;
+    uint32_t text_base;
+    uint8_t* data;
+    uint32_t data_size;
+    uint32_t data_base;
+    RvSymbol* symbols;
+    int symbol_count;
+    char error[256];
+} RvProgram;
+
+#define RV_TEXT_BASE 0x00010000u
+
+// Returns 0 on success; on failure -1 with a message in program->error.
+int rv_assemble(const char* source, size_t len, RvProgram* program);
+void rv_program_free(RvProgram* program);
+
+const RvSymbol* rv_find_symbol(const RvProgram* program, const char* name);
+// Innermost function (non-local text label) containing the instruction.
+const RvSymbol* rv_function_at(const RvProgram* program, int index);
+
+const char* rv_opcode_name(RvOpcode op);
+const char* rv_register_name(int reg);
+RvClass rv_opcode_class(RvOpcode op);
+// Source registers read by the instruction; returns how many (0-2).
+int rv_source_registers(const RvInsn* insn, int sources[2]);
+// Whether the instruction writes insn->rd.
+int rv_writes_rd(const RvInsn* insn);
+
+// Formats text instruction `index` the way the compiler writes it (pseudo
+// forms such as li, mv, j, call, ret, beqz), with branch targets as labels.
+void rv_format_insn(const RvProgram* program, int index, char* buffer, size_t size);
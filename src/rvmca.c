@@ -0,0 +1,376 @@
+#include "rvmca.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Core models. inorder1 uses the same latencies and penalties as the
+// simulator's defaults (rvsim.c), so the two can be compared directly.
+static const RvCoreModel models[] = {
+    {
+        "inorder1", "single-issue in-order, the simulator's default pipeline",
+        1,
+        { [RV_UNIT_ALU] = 1, [RV_UNIT_MUL] = 1, [RV_UNIT_DIV] = 1, [RV_UNIT_LSU] = 1, [RV_UNIT_BRU] = 1 },
+        { [RV_CLASS_ALU] = 1, [RV_CLASS_MUL] = 3, [RV_CLASS_DIV] = 20, [RV_CLASS_LOAD] = 2,
+          [RV_CLASS_STORE] = 1, [RV_CLASS_BRANCH] = 1, [RV_CLASS_JUMP] = 1, [RV_CLASS_SYSTEM] = 1 },
+        { [RV_CLASS_ALU] = 1, [RV_CLASS_MUL] = 1, [RV_CLASS_DIV] = 1, [RV_CLASS_LOAD] = 1,
+          [RV_CLASS_STORE] = 1, [RV_CLASS_BRANCH] = 1, [RV_CLASS_JUMP] = 1, [RV_CLASS_SYSTEM] = 1 },
+    },
+    {
+        "inorder2", "dual-issue in-order with two ALUs and an unpipelined divider",
+        2,
+        { [RV_UNIT_ALU] = 2, [RV_UNIT_MUL] = 1, [RV_UNIT_DIV] = 1, [RV_UNIT_LSU] = 1, [RV_UNIT_BRU] = 1 },
+        { [RV_CLASS_ALU] = 1, [RV_CLASS_MUL] = 3, [RV_CLASS_DIV] = 20, [RV_CLASS_LOAD] = 3,
+          [RV_CLASS_STORE] = 1, [RV_CLASS_BRANCH] = 1, [RV_CLASS_JUMP] = 1, [RV_CLASS_SYSTEM] = 1 },
+        { [RV_CLASS_ALU] = 1, [RV_CLASS_MUL] = 1, [RV_CLASS_DIV] = 20, [RV_CLASS_LOAD] = 1,
+          [RV_CLASS_STORE] = 1, [RV_CLASS_BRANCH] = 1, [RV_CLASS_JUMP] = 1, [RV_CLASS_SYSTEM] = 1 },
+    },
+};
+#define MODEL_COUNT (int)(sizeof(models) / sizeof(models[0]))
+
+// Front-end bubbles, as in the simulator: taken branches and jalr redirect
+// fetch late, jal early.
+#define TAKEN_PENALTY 2
+#define JUMP_PENALTY 1
+
+static const char* unit_names[RV_UNIT_COUNT] = { "alu", "mul", "div", "lsu", "bru" };
+
+const RvCoreModel* rv_core_model(const char* name) {
+    if (name == NULL) return &models[0];
+    for (int i = 0; i < MODEL_COUNT; i++) {
+        if (strcmp(models[i].name, name) == 0) return &models[i];
+    }
+    return NULL;
+}
+
+void rv_core_model_list(FILE* out) {
+    for (int i = 0; i < MODEL_COUNT; i++) fprintf(out, "  %-10s %s\n", models[i].name, models[i].description);
+}
+
+static RvUnit unit_of(RvClass class) {
+    switch (class) {
+        case RV_CLASS_MUL: return RV_UNIT_MUL;
+        case RV_CLASS_DIV: return RV_UNIT_DIV;
+        case RV_CLASS_LOAD:
+        case RV_CLASS_STORE: return RV_UNIT_LSU;
+        case RV_CLASS_BRANCH:
+        case RV_CLASS_JUMP: return RV_UNIT_BRU;
+        default: return RV_UNIT_ALU;
+    }
+}
+
+// --- Regions --------------------------------------------------------------
+
+typedef struct {
+    int first;              // text indices, inclusive
+    int last;
+    int loop;
+    const RvSymbol* function;
+    const char* header;     // loop header label
+} Region;
+
+static const char* label_at(const RvProgram* program, int index) {
+    uint32_t address = program->text_base + (uint32_t)index * 4;
+    for (int i = 0; i < program->symbol_count; i++) {
+        if (program->symbols[i].in_text && program->symbols[i].address == address) return program->symbols[i].name;
+    }
+    return "?";
+}
+
+// --- Scheduling -----------------------------------------------------------
+
+#define MAX_UNIT_INSTANCES 4
+#define STORE_SLOTS 64
+
+typedef struct {
+    double dep_wait;        // per iteration, cycles waiting for operands
+    double res_wait;        // per iteration, cycles waiting for a unit or an issue slot
+    int critical;
+} InsnStats;
+
+typedef struct {
+    uint64_t completion;            // cycle the last result is available
+    uint64_t first_issue[2];        // issue of the region's first instruction, first and last iteration
+    uint64_t last_completion[2];    // completion after the first and the last iteration
+} Schedule;
+
+// Stores to fixed frame addresses (s0 or sp plus a constant), so that a
+// reload of a spilled variable waits for the store. Computed addresses
+// are assumed not to alias, as llvm-mca does by default.
+typedef struct {
+    int base;
+    int32_t offset;
+    uint64_t ready;
+    int producer;
+} StoreSlot;
+
+typedef struct {
+    StoreSlot slots[STORE_SLOTS];
+    int count;
+    int next;
+} StoreTable;
+
+static StoreSlot* find_store(StoreTable* table, int base, int32_t offset) {
+    for (int i = 0; i < table->count; i++) {
+        if (table->slots[i].base == base && table->slots[i].offset == offset) return &table->slots[i];
+    }
+    return NULL;
+}
+
+static void record_store(StoreTable* table, int base, int32_t offset, uint64_t ready, int producer) {
+    StoreSlot* slot = find_store(table, base, offset);
+    if (slot == NULL) {
+        if (table->count < STORE_SLOTS) {
+            slot = &table->slots[table->count++];
+        } else {
+            slot = &table->slots[table->next];
+            table->next = (table->next + 1) % STORE_SLOTS;
+        }
+    }
+    *slot = (StoreSlot){ base, offset, ready, producer };
+}
+
+static int frame_base(int reg) {
+    return reg == 2 || reg == 8;
+}
+
+// Schedules `iterations` copies of the region. With `unbounded` only data
+// dependencies count (unlimited units, no issue order), which gives the
+// critical path and the loop-carried recurrence. For the first iteration,
+// critical_from receives the producer each instruction waited for last and
+// finish its completion cycle. stats, critical_from and finish may be NULL.
+static void schedule(const RvProgram* program, const Region* region, const RvCoreModel* model, int iterations,
+                     int unbounded, InsnStats* stats, int* critical_from, uint64_t* finish, Schedule* out) {
+    int count = region->last - region->first + 1;
+    uint64_t ready[32] = {0};
+    int producer[32];
+    uint64_t unit_free[RV_UNIT_COUNT][MAX_UNIT_INSTANCES] = {{0}};
+    StoreTable stores = { .count = 0, .next = 0 };
+    for (int r = 0; r < 32; r++) producer[r] = -1;
+    memset(out, 0, sizeof(*out));
+
+    uint64_t last_issue = 0;
+    int issued_in_cycle = 0;
+    uint64_t redirect = 0;          // earliest issue after a taken control transfer
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        for (int i = 0; i < count; i++) {
+            const RvInsn* insn = &program->text[region->first + i];
+            RvClass class = rv_opcode_class(insn->op);
+
+            uint64_t base = 0;
+            if (!unbounded) {
+                base = issued_in_cycle < model->issue_width ? last_issue : last_issue + 1;
+                if (base < redirect) base = redirect;
+            }
+            uint64_t operands = base;
+            int from = -1;
+            int sources[2];
+            int source_count = rv_source_registers(insn, sources);
+            for (int s = 0; s < source_count; s++) {
+                if (sources[s] != 0 && ready[sources[s]] > operands) {
+                    operands = ready[sources[s]];
+                    from = producer[sources[s]];
+                }
+            }
+            StoreSlot* store = NULL;
+            if (class == RV_CLASS_LOAD && frame_base(insn->rs1)) store = find_store(&stores, insn->rs1, insn->imm);
+            if (store && store->ready > operands) {
+                operands = store->ready;
+                from = store->producer;
+            }
+
+            uint64_t issue = operands;
+            if (!unbounded) {
+                RvUnit unit = unit_of(class);
+                int instances = model->units[unit] < MAX_UNIT_INSTANCES ? model->units[unit] : MAX_UNIT_INSTANCES;
+                int best = 0;
+                for (int k = 1; k < instances; k++) {
+                    if (unit_free[unit][k] < unit_free[unit][best]) best = k;
+                }
+                if (unit_free[unit][best] > issue) issue = unit_free[unit][best];
+                unit_free[unit][best] = issue + (uint64_t)model->occupancy[class];
+                if (issue == last_issue && iteration + i > 0) {
+                    issued_in_cycle++;
+                } else {
+                    last_issue = issue;
+                    issued_in_cycle = 1;
+                }
+            }
+            if (stats) {
+                stats[i].dep_wait += (double)(operands - base);
+                stats[i].res_wait += (double)(issue - operands);
+            }
+            if (critical_from && iteration == 0) critical_from[i] = from;
+
+            uint64_t done = issue + (uint64_t)model->latency[class];
+            if (finish && iteration == 0) finish[i] = done;
+            if (rv_writes_rd(insn)) {
+                ready[insn->rd] = done;
+                producer[insn->rd] = i;
+            }
+            if (class == RV_CLASS_STORE && frame_base(insn->rs1)) {
+                // The store's data reaches a later load through forwarding.
+                record_store(&stores, insn->rs1, insn->imm, issue + 1, i);
+            }
+            if (done > out->completion) out->completion = done;
+            if (i == 0) out->first_issue[iteration == 0 ? 0 : 1] = issue;
+
+            // The closing branch of a loop is taken; other conditional
+            // branches are assumed to fall through.
+            if (!unbounded) {
+                if (insn->op == RV_JAL) {
+                    redirect = issue + 1 + JUMP_PENALTY;
+                } else if (insn->op == RV_JALR || (region->loop && i == count - 1)) {
+                    redirect = issue + 1 + TAKEN_PENALTY;
+                }
+            }
+        }
+        if (iteration == 0) out->last_completion[0] = out->completion;
+        out->last_completion[1] = out->completion;
+    }
+}
+
+// --- Report ---------------------------------------------------------------
+
+static void report_region(const RvProgram* program, const Region* region, const RvMcaOptions* options, FILE* out) {
+    const RvCoreModel* model = options->model;
+    int count = region->last - region->first + 1;
+    int iterations = region->loop ? options->iterations : 1;
+    InsnStats* stats = calloc((size_t)count, sizeof(InsnStats));
+    int* critical_from = calloc((size_t)count, sizeof(int));
+    uint64_t* finish = calloc((size_t)count, sizeof(uint64_t));
+    if (stats == NULL || critical_from == NULL || finish == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+
+    Schedule timed;
+    Schedule once;
+    Schedule recurrence;
+    schedule(program, region, model, iterations, 0, stats, NULL, NULL, &timed);
+    schedule(program, region, model, 1, 1, NULL, critical_from, finish, &once);
+    schedule(program, region, model, iterations, 1, NULL, NULL, NULL, &recurrence);
+
+    // Walk the critical path back from the instruction that finishes last.
+    int tail = 0;
+    for (int i = 1; i < count; i++) {
+        if (finish[i] > finish[tail]) tail = i;
+    }
+    for (int i = tail; i >= 0; i = critical_from[i]) stats[i].critical = 1;
+
+    double instructions = (double)count;
+    double cycles_per_iteration = iterations > 1
+        ? (double)(timed.first_issue[1] - timed.first_issue[0]) / (double)(iterations - 1)
+        : (double)timed.completion;
+    double dependency_bound = iterations > 1
+        ? (double)(recurrence.last_completion[1] - recurrence.last_completion[0]) / (double)(iterations - 1)
+        : (double)once.completion;
+
+    double pressure[RV_UNIT_COUNT] = {0};
+    for (int i = 0; i < count; i++) {
+        RvClass class = rv_opcode_class(program->text[region->first + i].op);
+        pressure[unit_of(class)] += (double)model->occupancy[class];
+    }
+    double resource_bound = instructions / model->issue_width;
+    const char* bottleneck = "issue width";
+    for (int u = 0; u < RV_UNIT_COUNT; u++) {
+        pressure[u] /= model->units[u];
+        if (pressure[u] > resource_bound) {
+            resource_bound = pressure[u];
+            bottleneck = unit_names[u];
+        }
+    }
+
+    if (region->loop) {
+        fprintf(out, "\nLoop %s in %s: %d instructions, lines %d-%d\n", region->header,
+                region->function ? region->function->name : "?", count, program->text[region->first].line,
+                program->text[region->last].line);
+    } else {
+        fprintf(out, "\nFunction %s: %d instructions, lines %d-%d\n", region->function->name, count,
+                program->text[region->first].line, program->text[region->last].line);
+    }
+    fprintf(out, "Iterations:          %d\n", iterations);
+    fprintf(out, "Total cycles:        %llu\n", (unsigned long long)timed.completion);
+    if (region->loop) fprintf(out, "Cycles/iteration:    %.2f\n", cycles_per_iteration);
+    fprintf(out, "IPC:                 %.2f\n", cycles_per_iteration > 0 ? instructions / cycles_per_iteration : 0.0);
+    fprintf(out, "Critical path:       %llu cycles\n", (unsigned long long)once.completion);
+    fprintf(out, "Bounds:              %s %.2f, dependencies %.2f\n", bottleneck, resource_bound, dependency_bound);
+    // When neither bound explains the schedule, in-order issue is the
+    // limit: name whichever kind of stall costs the most.
+    const char* limit;
+    double bound = resource_bound > dependency_bound ? resource_bound : dependency_bound;
+    if (cycles_per_iteration <= bound * 1.05) {
+        limit = dependency_bound >= resource_bound ? "data dependencies" : "resources";
+    } else {
+        double dep_stalls = 0.0, res_stalls = 0.0;
+        for (int i = 0; i < count; i++) {
+            dep_stalls += stats[i].dep_wait / iterations;
+            res_stalls += stats[i].res_wait / iterations;
+        }
+        double redirects = cycles_per_iteration - instructions / model->issue_width - dep_stalls - res_stalls;
+        limit = "in-order issue, mostly branch and jump redirects";
+        if (dep_stalls >= res_stalls && dep_stalls >= redirects) {
+            limit = "in-order issue, mostly waiting for operands";
+        } else if (res_stalls >= redirects) {
+            limit = "in-order issue, mostly waiting for busy units";
+        }
+    }
+    fprintf(out, "Limited by:          %s\n", limit);
+
+    fprintf(out, "Resource pressure per iteration:");
+    for (int u = 0; u < RV_UNIT_COUNT; u++) fprintf(out, " %s %.2f", unit_names[u], pressure[u]);
+    fputc('\n', out);
+
+    fprintf(out, "%6s %-4s %3s %6s %6s %2s  %s\n", "line", "unit", "lat", "dep", "res", "cp", "instruction");
+    for (int i = 0; i < count; i++) {
+        int index = region->first + i;
+        const RvInsn* insn = &program->text[index];
+        RvClass class = rv_opcode_class(insn->op);
+        char text[96];
+        rv_format_insn(program, index, text, sizeof(text));
+        if (i > 0 || region->loop) {
+            uint32_t address = program->text_base + (uint32_t)index * 4;
+            for (int s = 0; s < program->symbol_count; s++) {
+                const RvSymbol* symbol = &program->symbols[s];
+                if (symbol->in_text && symbol->address == address) fprintf(out, "%s:\n", symbol->name);
+            }
+        }
+        fprintf(out, "%6d %-4s %3d %6.2f %6.2f %2s  %s\n", insn->line, unit_names[unit_of(class)],
+                model->latency[class], stats[i].dep_wait / iterations, stats[i].res_wait / iterations,
+                stats[i].critical ? "*" : "", text);
+    }
+    free(stats);
+    free(critical_from);
+    free(finish);
+}
+
+void rv_mca_report(const RvProgram* program, const RvMcaOptions* options, FILE* out) {
+    fprintf(out, "Model %s: %s; issue width %d\n", options->model->name, options->model->description,
+            options->model->issue_width);
+    fprintf(out, "Columns: dep and res are cycles per iteration spent waiting for operands and for a unit or\n"
+                 "issue slot; cp marks the critical dependency path of one iteration.\n");
+
+    for (int i = 0; i < program->symbol_count; i++) {
+        const RvSymbol* function = &program->symbols[i];
+        if (!function->in_text || function->name[0] == '.') continue;
+        if (options->function && strcmp(options->function, function->name) != 0) continue;
+        int first = (int)((function->address - program->text_base) / 4);
+        int last = first;
+        while (last + 1 < program->text_count && rv_function_at(program, last + 1) == function) last++;
+        if (first >= program->text_count) continue;
+
+        Region region = { first, last, 0, function, NULL };
+        report_region(program, &region, options, out);
+
+        // Loops: backward branches and jumps within the function.
+        for (int b = first; b <= last; b++) {
+            const RvInsn* insn = &program->text[b];
+            RvClass class = rv_opcode_class(insn->op);
+            int backward = insn->imm <= 0 && (class == RV_CLASS_BRANCH || (insn->op == RV_JAL && insn->rd == 0));
+            if (!backward) continue;
+            int target = b + insn->imm / 4;
+            if (target < first) continue;
+            Region loop = { target, b, 1, function, label_at(program, target) };
+            report_region(program, &loop, options, out);
+        }
+    }
+}
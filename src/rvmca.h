@@ -0,0 +1,42 @@
+#pragma once
+
+#include "rvasm.h"
+#include <stdio.h>
+
+// Static throughput analysis of assembled RV32IM code, in the manner of
+// llvm-mca: every function, and every loop body found from a backward
+// branch, is scheduled as straight-line code on a core model, and the
+// report gives cycles per iteration, resource pressure, the critical
+// dependency path and an annotated listing. Nothing is executed, so
+// branches inside a region are assumed not taken and calls cost only the
+// jump.
+
+typedef enum {
+    RV_UNIT_ALU,
+    RV_UNIT_MUL,
+    RV_UNIT_DIV,
+    RV_UNIT_LSU,
+    RV_UNIT_BRU,
+    RV_UNIT_COUNT
+} RvUnit;
+
+typedef struct {
+    const char* name;
+    const char* description;
+    int issue_width;                    // instructions issued per cycle, in order
+    int units[RV_UNIT_COUNT];           // instances of each functional unit
+    int latency[RV_CLASS_COUNT];        // cycles until the result can be used
+    int occupancy[RV_CLASS_COUNT];      // cycles the unit stays busy (1 when pipelined)
+} RvCoreModel;
+
+typedef struct {
+    const RvCoreModel* model;
+    int iterations;                     // loop bodies are unrolled this many times
+    const char* function;               // only this function, or NULL for all
+} RvMcaOptions;
+
+// The model with that name, or NULL; NULL name gives the default model.
+const RvCoreModel* rv_core_model(const char* name);
+void rv_core_model_list(FILE* out);
+
+void rv_mca_report(const RvProgram* program, const RvMcaOptions* options, FILE* out);
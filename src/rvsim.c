@@ -0,0 +1,529 @@
+#include "rvsim.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Returning to this address ends the simulation.
+#define HALT_ADDRESS 0u
+// Addresses below the text base are never mapped, which catches null
+// pointers and wild offsets from a zeroed register.
+#define LOW_LIMIT RV_TEXT_BASE
+
+void rv_sim_default_config(RvSimConfig* config) {
+    config->icache = (RvCacheConfig){ 16 * 1024, 32, 2 };
+    config->dcache = (RvCacheConfig){ 16 * 1024, 32, 4 };
+    config->miss_penalty = 20;
+    config->load_use = 1;
+    config->branch_penalty = 2;
+    config->jump_penalty = 1;
+    config->mul_latency = 3;
+    config->div_latency = 20;
+    config->memory_size = 16u * 1024 * 1024;
+    config->max_instructions = 1000000000ull;
+}
+
+static int parse_size(const char* text, char** end, uint32_t* value) {
+    unsigned long number = strtoul(text, end, 10);
+    if (*end == text) return -1;
+    if (**end == 'k' || **end == 'K') {
+        number *= 1024;
+        (*end)++;
+    }
+    *value = (uint32_t)number;
+    return 0;
+}
+
+static int is_power_of_two(uint32_t value) {
+    return value && (value & (value - 1)) == 0;
+}
+
+int rv_parse_cache_config(const char* text, RvCacheConfig* cache) {
+    char* end;
+    RvCacheConfig parsed;
+    if (parse_size(text, &end, &parsed.size) != 0) return -1;
+    if (parsed.size == 0 && *end == '\0') {
+        *cache = (RvCacheConfig){ 0, 0, 0 };
+        return 0;
+    }
+    if (*end != ':' || parse_size(end + 1, &end, &parsed.line) != 0) return -1;
+    if (*end != ':' || parse_size(end + 1, &end, &parsed.ways) != 0 || *end != '\0') return -1;
+    if (!is_power_of_two(parsed.size) || !is_power_of_two(parsed.line) || !is_power_of_two(parsed.ways)) return -1;
+    if (parsed.line < 4 || parsed.size < parsed.line * parsed.ways) return -1;
+    *cache = parsed;
+    return 0;
+}
+
+// --- Caches ---------------------------------------------------------------
+
+typedef struct {
+    RvCacheConfig config;
+    uint32_t sets;
+    uint32_t* tags;
+    uint64_t* last_use;     // LRU timestamps; 0 marks an invalid way
+    uint64_t clock;
+    RvCacheStats* stats;
+} Cache;
+
+static void cache_init(Cache* cache, const RvCacheConfig* config, RvCacheStats* stats) {
+    memset(cache, 0, sizeof(*cache));
+    cache->config = *config;
+    cache->stats = stats;
+    if (config->size == 0) return;
+    cache->sets = config->size / (config->line * config->ways);
+    size_t entries = (size_t)cache->sets * config->ways;
+    cache->tags = calloc(entries, sizeof(uint32_t));
+    cache->last_use = calloc(entries, sizeof(uint64_t));
+    if (cache->tags == NULL || cache->last_use == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+}
+
+static void cache_free(Cache* cache) {
+    free(cache->tags);
+    free(cache->last_use);
+}
+
+// Returns 1 on a miss.
+static int cache_access(Cache* cache, uint32_t address) {
+    cache->stats->accesses++;
+    if (cache->sets == 0) return 0;
+    uint32_t block = address / cache->config.line;
+    uint32_t set = block % cache->sets;
+    uint32_t tag = block / cache->sets;
+    uint32_t* tags = cache->tags + (size_t)set * cache->config.ways;
+    uint64_t* last_use = cache->last_use + (size_t)set * cache->config.ways;
+    uint32_t victim = 0;
+    cache->clock++;
+    for (uint32_t way = 0; way < cache->config.ways; way++) {
+        if (last_use[way] != 0 && tags[way] == tag) {
+            last_use[way] = cache->clock;
+            return 0;
+        }
+        if (last_use[way] < last_use[victim]) victim = way;
+    }
+    tags[victim] = tag;
+    last_use[victim] = cache->clock;
+    cache->stats->misses++;
+    return 1;
+}
+
+// --- Machine --------------------------------------------------------------
+
+typedef enum { STALL_NONE, STALL_LOAD, STALL_MULDIV } StallCause;
+
+typedef struct {
+    const RvProgram* program;
+    const RvSimConfig* config;
+    RvSimResult* result;
+    uint32_t regs[32];
+    uint8_t* memory;
+    uint32_t text_end;
+    uint32_t data_end;
+    uint64_t ready[32];             // cycle at which each register's value is available
+    StallCause producer[32];
+    Cache icache;
+    Cache dcache;
+    int halted;
+} Machine;
+
+static void fault(Machine* m, uint32_t pc, const char* format, ...) {
+    RvSimResult* result = m->result;
+    result->status = RV_SIM_FAULT;
+    m->halted = 1;
+    int used = snprintf(result->error, sizeof(result->error), "pc 0x%08x: ", pc);
+    va_list args;
+    va_start(args, format);
+    vsnprintf(result->error + used, sizeof(result->error) - (size_t)used, format, args);
+    va_end(args);
+}
+
+// Text is not writable; data, heap and stack share the rest of the space.
+static int check_access(Machine* m, uint32_t pc, uint32_t address, uint32_t size, int store) {
+    if (address < LOW_LIMIT || address > m->config->memory_size - size) {
+        fault(m, pc, "%s of %u bytes at unmapped address 0x%08x", store ? "store" : "load", size, address);
+        return 0;
+    }
+    if (store && address < m->text_end) {
+        fault(m, pc, "store to text at 0x%08x", address);
+        return 0;
+    }
+    return 1;
+}
+
+static uint32_t load(Machine* m, uint32_t address, uint32_t size) {
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < size; i++) value |= (uint32_t)m->memory[address + i] << (8 * i);
+    return value;
+}
+
+static void store(Machine* m, uint32_t address, uint32_t size, uint32_t value) {
+    for (uint32_t i = 0; i < size; i++) m->memory[address + i] = (uint8_t)(value >> (8 * i));
+}
+
+static uint32_t divide(RvOpcode op, uint32_t a, uint32_t b) {
+    int32_t sa = (int32_t)a;
+    int32_t sb = (int32_t)b;
+    switch (op) {
+        case RV_DIV:
+            if (b == 0) return UINT32_MAX;
+            if (sa == INT32_MIN && sb == -1) return a;
+            return (uint32_t)(sa / sb);
+        case RV_DIVU:
+            return b == 0 ? UINT32_MAX : a / b;
+        case RV_REM:
+            if (b == 0) return a;
+            if (sa == INT32_MIN && sb == -1) return 0;
+            return (uint32_t)(sa % sb);
+        default:
+            return b == 0 ? a : a % b;
+    }
+}
+
+static uint32_t alu(const RvInsn* insn, uint32_t a, uint32_t b) {
+    switch (insn->op) {
+        case RV_ADD: case RV_ADDI: return a + b;
+        case RV_SUB: return a - b;
+        case RV_SLL: case RV_SLLI: return a << (b & 31);
+        case RV_SLT: case RV_SLTI: return (int32_t)a < (int32_t)b;
+        case RV_SLTU: case RV_SLTIU: return a < b;
+        case RV_XOR: case RV_XORI: return a ^ b;
+        case RV_SRL: case RV_SRLI: return a >> (b & 31);
+        case RV_SRA: case RV_SRAI: return (uint32_t)((int32_t)a >> (b & 31));
+        case RV_OR: case RV_ORI: return a | b;
+        case RV_AND: case RV_ANDI: return a & b;
+        case RV_MUL: return a * b;
+        case RV_MULH: return (uint32_t)(((int64_t)(int32_t)a * (int64_t)(int32_t)b) >> 32);
+        case RV_MULHSU: return (uint32_t)(((int64_t)(int32_t)a * (int64_t)(uint64_t)b) >> 32);
+        case RV_MULHU: return (uint32_t)(((uint64_t)a * (uint64_t)b) >> 32);
+        case RV_DIV: case RV_DIVU: case RV_REM: case RV_REMU: return divide(insn->op, a, b);
+        default: return 0;
+    }
+}
+
+static int branch_taken(RvOpcode op, uint32_t a, uint32_t b) {
+    switch (op) {
+        case RV_BEQ: return a == b;
+        case RV_BNE: return a != b;
+        case RV_BLT: return (int32_t)a < (int32_t)b;
+        case RV_BGE: return (int32_t)a >= (int32_t)b;
+        case RV_BLTU: return a < b;
+        default: return a >= b;
+    }
+}
+
+static const uint32_t access_size[] = {
+    [RV_LB] = 1, [RV_LH] = 2, [RV_LW] = 4, [RV_LBU] = 1, [RV_LHU] = 2, [RV_SB] = 1, [RV_SH] = 2, [RV_SW] = 4,
+};
+
+// Linux-style system calls: exit (93) and write (64) to stdout/stderr.
+static int system_call(Machine* m, uint32_t pc) {
+    uint32_t number = m->regs[17];
+    if (number == 93) {
+        m->result->status = RV_SIM_EXITED;
+        m->result->exit_code = (int32_t)m->regs[10];
+        m->halted = 1;
+        return 0;
+    }
+    if (number == 64) {
+        uint32_t fd = m->regs[10];
+        uint32_t address = m->regs[11];
+        uint32_t length = m->regs[12];
+        if ((fd != 1 && fd != 2) || !check_access(m, pc, address, length ? length : 1, 0)) {
+            if (!m->halted) fault(m, pc, "write to unsupported descriptor %u", fd);
+            return 0;
+        }
+        fwrite(m->memory + address, 1, length, fd == 1 ? stdout : stderr);
+        m->regs[10] = length;
+        return 1;
+    }
+    fault(m, pc, "unsupported system call %u", number);
+    return 0;
+}
+
+static void run(Machine* m, uint32_t pc) {
+    const RvProgram* program = m->program;
+    const RvSimConfig* config = m->config;
+    RvSimResult* result = m->result;
+    uint64_t cycle = 0;
+    uint32_t stack_top = m->regs[2];
+
+    for (;;) {
+        if (pc == HALT_ADDRESS) {
+            result->status = RV_SIM_EXITED;
+            result->exit_code = (int32_t)m->regs[10];
+            break;
+        }
+        if (pc < program->text_base || pc >= m->text_end || pc % 4 != 0) {
+            fault(m, pc, "jump outside the program text");
+            break;
+        }
+        if (result->instructions >= config->max_instructions) {
+            result->status = RV_SIM_LIMIT;
+            snprintf(result->error, sizeof(result->error), "stopped after %llu instructions",
+                     (unsigned long long)result->instructions);
+            break;
+        }
+        int index = (int)((pc - program->text_base) / 4);
+        const RvInsn* insn = &program->text[index];
+        uint64_t start = cycle;
+
+        if (cache_access(&m->icache, pc)) {
+            cycle += (uint64_t)config->miss_penalty;
+            result->icache_stalls += (uint64_t)config->miss_penalty;
+        }
+
+        // Operands stall the in-order pipeline until their producer is done.
+        int sources[2];
+        int source_count = rv_source_registers(insn, sources);
+        for (int i = 0; i < source_count; i++) {
+            int reg = sources[i];
+            if (reg == 0 || m->ready[reg] <= cycle) continue;
+            uint64_t wait = m->ready[reg] - cycle;
+            if (m->producer[reg] == STALL_LOAD) {
+                result->load_use_stalls += wait;
+            } else {
+                result->muldiv_stalls += wait;
+            }
+            cycle = m->ready[reg];
+        }
+        cycle++;
+
+        uint32_t a = m->regs[insn->rs1];
+        uint32_t b = m->regs[insn->rs2];
+        uint32_t next = pc + 4;
+        uint32_t value = 0;
+        uint64_t ready = cycle;
+        StallCause cause = STALL_NONE;
+        RvClass class = rv_opcode_class(insn->op);
+        result->by_class[class]++;
+
+        switch (class) {
+            case RV_CLASS_ALU:
+                if (insn->op == RV_LUI) {
+                    value = (uint32_t)insn->imm << 12;
+                } else if (insn->op == RV_AUIPC) {
+                    value = pc + ((uint32_t)insn->imm << 12);
+                } else {
+                    int immediate = insn->op >= RV_ADDI && insn->op <= RV_SRAI;
+                    value = alu(insn, a, immediate ? (uint32_t)insn->imm : b);
+                }
+                break;
+            case RV_CLASS_MUL:
+            case RV_CLASS_DIV:
+                value = alu(insn, a, b);
+                ready = cycle - 1 + (uint64_t)(class == RV_CLASS_MUL ? config->mul_latency : config->div_latency);
+                cause = STALL_MULDIV;
+                break;
+            case RV_CLASS_LOAD:
+            case RV_CLASS_STORE: {
+                uint32_t address = a + (uint32_t)insn->imm;
+                uint32_t size = access_size[insn->op];
+                if (!check_access(m, pc, address, size, class == RV_CLASS_STORE)) break;
+                if (cache_access(&m->dcache, address)) {
+                    cycle += (uint64_t)config->miss_penalty;
+                    result->dcache_stalls += (uint64_t)config->miss_penalty;
+                }
+                if (class == RV_CLASS_STORE) {
+                    store(m, address, size, b);
+                    break;
+                }
+                value = load(m, address, size);
+                if (insn->op == RV_LB) value = (uint32_t)(int32_t)(int8_t)value;
+                if (insn->op == RV_LH) value = (uint32_t)(int32_t)(int16_t)value;
+                ready = cycle + (uint64_t)config->load_use;
+                cause = STALL_LOAD;
+                break;
+            }
+            case RV_CLASS_BRANCH:
+                if (branch_taken(insn->op, a, b)) {
+                    next = pc + (uint32_t)insn->imm;
+                    result->taken_branches++;
+                    cycle += (uint64_t)config->branch_penalty;
+                    result->control_stalls += (uint64_t)config->branch_penalty;
+                }
+                break;
+            case RV_CLASS_JUMP: {
+                value = pc + 4;
+                int penalty = insn->op == RV_JAL ? config->jump_penalty : config->branch_penalty;
+                next = insn->op == RV_JAL ? pc + (uint32_t)insn->imm : (a + (uint32_t)insn->imm) & ~1u;
+                cycle += (uint64_t)penalty;
+                result->control_stalls += (uint64_t)penalty;
+                break;
+            }
+            case RV_CLASS_SYSTEM:
+                if (insn->op == RV_EBREAK) {
+                    fault(m, pc, "ebreak");
+                } else {
+                    system_call(m, pc);
+                }
+                break;
+            case RV_CLASS_COUNT:
+                break;
+        }
+        result->instructions++;
+        result->executed[index]++;
+        result->cycles_at[index] += cycle - start;
+        if (m->halted) break;
+
+        if (rv_writes_rd(insn)) {
+            m->regs[insn->rd] = value;
+            m->ready[insn->rd] = ready;
+            m->producer[insn->rd] = cause;
+        }
+        if (m->regs[2] < stack_top && stack_top - m->regs[2] > result->max_stack) {
+            result->max_stack = stack_top - m->regs[2];
+        }
+        pc = next;
+    }
+    result->cycles = cycle;
+}
+
+int rv_simulate(const RvProgram* program, const char* entry, const RvSimConfig* config, RvSimResult* result) {
+    memset(result, 0, sizeof(*result));
+    result->executed = calloc((size_t)program->text_count + 1, sizeof(uint64_t));
+    result->cycles_at = calloc((size_t)program->text_count + 1, sizeof(uint64_t));
+    if (result->executed == NULL || result->cycles_at == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+
+    const RvSymbol* symbol = rv_find_symbol(program, entry);
+    if (symbol == NULL || !symbol->in_text) {
+        result->status = RV_SIM_FAULT;
+        snprintf(result->error, sizeof(result->error), "entry point '%s' is not defined", entry);
+        return -1;
+    }
+    uint32_t data_end = program->data_base + program->data_size;
+    if (config->memory_size < data_end + 4096 || config->memory_size % 16 != 0) {
+        result->status = RV_SIM_FAULT;
+        snprintf(result->error, sizeof(result->error), "memory size %u does not fit the program",
+                 config->memory_size);
+        return -1;
+    }
+
+    Machine m;
+    memset(&m, 0, sizeof(m));
+    m.program = program;
+    m.config = config;
+    m.result = result;
+    m.text_end = program->text_base + (uint32_t)program->text_count * 4;
+    m.data_end = data_end;
+    m.memory = calloc(config->memory_size, 1);
+    if (m.memory == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    if (program->data_size) memcpy(m.memory + program->data_base, program->data, program->data_size);
+    cache_init(&m.icache, &config->icache, &result->icache);
+    cache_init(&m.dcache, &config->dcache, &result->dcache);
+    m.regs[1] = HALT_ADDRESS;
+    m.regs[2] = config->memory_size;
+    m.regs[3] = program->data_base + 0x800;
+
+    run(&m, symbol->address);
+
+    cache_free(&m.icache);
+    cache_free(&m.dcache);
+    free(m.memory);
+    return result->status == RV_SIM_EXITED ? 0 : -1;
+}
+
+void rv_sim_result_free(RvSimResult* result) {
+    free(result->executed);
+    free(result->cycles_at);
+    result->executed = NULL;
+    result->cycles_at = NULL;
+}
+
+// --- Report ---------------------------------------------------------------
+
+typedef struct {
+    const RvSymbol* function;
+    uint64_t instructions;
+    uint64_t cycles;
+} FunctionTotals;
+
+static int by_cycles(const void* a, const void* b) {
+    const FunctionTotals* x = a;
+    const FunctionTotals* y = b;
+    if (x->cycles != y->cycles) return x->cycles > y->cycles ? -1 : 1;
+    return strcmp(x->function->name, y->function->name);
+}
+
+static double ratio(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * (double)part / (double)whole : 0.0;
+}
+
+static void print_cache(FILE* out, const char* name, const RvCacheConfig* config, const RvCacheStats* stats) {
+    if (config->size == 0) {
+        fprintf(out, "%-8s disabled\n", name);
+        return;
+    }
+    fprintf(out, "%-8s %6uK %3uB lines %2u-way  %12llu accesses %10llu misses (%.2f%%)\n", name,
+            config->size / 1024, config->line, config->ways, (unsigned long long)stats->accesses,
+            (unsigned long long)stats->misses, ratio(stats->misses, stats->accesses));
+}
+
+void rv_sim_report(const RvProgram* program, const RvSimConfig* config, const RvSimResult* result, FILE* out) {
+    static const char* class_names[RV_CLASS_COUNT] = {
+        "alu", "mul", "div", "load", "store", "branch", "jump", "system",
+    };
+    uint64_t instructions = result->instructions;
+    fprintf(out, "Dynamic instructions %16llu\n", (unsigned long long)instructions);
+    fprintf(out, "Cycles               %16llu   CPI %.3f\n", (unsigned long long)result->cycles,
+            instructions ? (double)result->cycles / (double)instructions : 0.0);
+    fprintf(out, "Stack used           %16u bytes\n\n", result->max_stack);
+
+    fprintf(out, "%-8s %14s %8s\n", "class", "count", "share");
+    for (int i = 0; i < RV_CLASS_COUNT; i++) {
+        if (result->by_class[i] == 0) continue;
+        fprintf(out, "%-8s %14llu %7.2f%%\n", class_names[i], (unsigned long long)result->by_class[i],
+                ratio(result->by_class[i], instructions));
+    }
+    fprintf(out, "taken branches %8llu of %llu\n\n", (unsigned long long)result->taken_branches,
+            (unsigned long long)result->by_class[RV_CLASS_BRANCH]);
+
+    fprintf(out, "%-14s %14s %8s\n", "stall", "cycles", "share");
+    const struct {
+        const char* name;
+        uint64_t cycles;
+    } stalls[] = {
+        { "load-use", result->load_use_stalls }, { "mul/div", result->muldiv_stalls },
+        { "control", result->control_stalls },   { "i-cache", result->icache_stalls },
+        { "d-cache", result->dcache_stalls },
+    };
+    for (size_t i = 0; i < sizeof(stalls) / sizeof(stalls[0]); i++) {
+        fprintf(out, "%-14s %14llu %7.2f%%\n", stalls[i].name, (unsigned long long)stalls[i].cycles,
+                ratio(stalls[i].cycles, result->cycles));
+    }
+    fputc('\n', out);
+    print_cache(out, "L1I", &config->icache, &result->icache);
+    print_cache(out, "L1D", &config->dcache, &result->dcache);
+
+    // Per-function totals, attributed by the label each instruction follows.
+    FunctionTotals* totals = calloc((size_t)program->symbol_count + 1, sizeof(FunctionTotals));
+    if (totals == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    int count = 0;
+    for (int i = 0; i < program->text_count; i++) {
+        if (result->executed[i] == 0) continue;
+        const RvSymbol* function = rv_function_at(program, i);
+        if (function == NULL) continue;
+        int slot = 0;
+        while (slot < count && totals[slot].function != function) slot++;
+        if (slot == count) totals[count++].function = function;
+        totals[slot].instructions += result->executed[i];
+        totals[slot].cycles += result->cycles_at[i];
+    }
+    qsort(totals, (size_t)count, sizeof(FunctionTotals), by_cycles);
+    fprintf(out, "\n%-24s %14s %14s %8s\n", "function", "instructions", "cycles", "cycles%");
+    for (int i = 0; i < count; i++) {
+        fprintf(out, "%-24s %14llu %14llu %7.2f%%\n", totals[i].function->name,
+                (unsigned long long)totals[i].instructions, (unsigned long long)totals[i].cycles,
+                ratio(totals[i].cycles, result->cycles));
+    }
+    free(totals);
+}
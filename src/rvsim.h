@@ -0,0 +1,73 @@
+#pragma once
+
+#include "rvasm.h"
+#include <stdint.h>
+#include <stdio.h>
+
+// RV32IM instruction-set simulator for programs assembled by rvasm. It runs
+// one entry function to completion and estimates the cycles of a
+// single-issue in-order pipeline with blocking L1 instruction and data
+// caches. The model is deliberately simple; it is meant to compare two
+// builds of the same program, not to predict a particular core.
+
+typedef struct {
+    uint32_t size;          // bytes; 0 disables the cache (every access hits)
+    uint32_t line;          // bytes per line
+    uint32_t ways;
+} RvCacheConfig;
+
+typedef struct {
+    RvCacheConfig icache;
+    RvCacheConfig dcache;
+    int miss_penalty;       // cycles added by an L1 miss
+    int load_use;           // stall when the next instruction uses a load result
+    int branch_penalty;     // taken conditional branches and jalr
+    int jump_penalty;       // jal, whose target is known at decode
+    int mul_latency;
+    int div_latency;
+    uint32_t memory_size;   // bytes of address space, stack at the top
+    uint64_t max_instructions;
+} RvSimConfig;
+
+typedef enum {
+    RV_SIM_EXITED,          // entry function returned, or exit system call
+    RV_SIM_FAULT,           // bad access, bad jump, unknown system call
+    RV_SIM_LIMIT,           // max_instructions reached
+} RvSimStatus;
+
+typedef struct {
+    uint64_t accesses;
+    uint64_t misses;
+} RvCacheStats;
+
+typedef struct {
+    RvSimStatus status;
+    int32_t exit_code;
+    char error[256];
+    uint64_t instructions;
+    uint64_t cycles;
+    uint64_t by_class[RV_CLASS_COUNT];
+    uint64_t taken_branches;
+    uint64_t load_use_stalls;       // cycles
+    uint64_t muldiv_stalls;         // cycles
+    uint64_t control_stalls;        // cycles
+    uint64_t icache_stalls;         // cycles
+    uint64_t dcache_stalls;         // cycles
+    RvCacheStats icache;
+    RvCacheStats dcache;
+    uint32_t max_stack;             // deepest stack use, bytes
+    // Per text instruction, indexed like RvProgram.text.
+    uint64_t* executed;
+    uint64_t* cycles_at;
+} RvSimResult;
+
+void rv_sim_default_config(RvSimConfig* config);
+// Parses "size:line:ways" (sizes may end in k); returns 0 on success.
+int rv_parse_cache_config(const char* text, RvCacheConfig* cache);
+
+// Runs `entry` with ra pointing at a halt address. Returns 0 when the
+// program exited normally; otherwise result->error says why it stopped.
+int rv_simulate(const RvProgram* program, const char* entry, const RvSimConfig* config, RvSimResult* result);
+void rv_sim_result_free(RvSimResult* result);
+
+void rv_sim_report(const RvProgram* program, const RvSimConfig* config, const RvSimResult* result, FILE* out);
@@ -0,0 +1,134 @@
+#include "symtab.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void* grow(void* data, int* capacity, int needed, size_t size) {
+    if (needed <= *capacity) return data;
+    int grown = *capacity ? *capacity : 16;
+    while (grown < needed) grown *= 2;
+    data = realloc(data, (size_t)grown * size);
+    if (data == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    *capacity = grown;
+    return data;
+}
+
+// FNV-1a.
+static uint32_t hash_name(const char* name, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void symtab_init(SymbolTable* table) {
+    memset(table, 0, sizeof(*table));
+}
+
+void symtab_free(SymbolTable* table) {
+    free(table->names);
+    free(table->slots);
+    free(table->pool);
+    free(table->symbols);
+    free(table->scope_start);
+    memset(table, 0, sizeof(*table));
+}
+
+static int find_slot(const SymbolTable* table, const char* name, size_t length, uint32_t hash) {
+    uint32_t mask = (uint32_t)table->slot_capacity - 1;
+    for (uint32_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        int32_t entry = table->slots[slot];
+        if (entry == 0) return (int)slot;
+        const SymbolName* candidate = &table->names[entry - 1];
+        if (candidate->hash == hash && (size_t)candidate->length == length &&
+            memcmp(table->pool + candidate->text, name, length) == 0) {
+            return (int)slot;
+        }
+    }
+}
+
+static void rehash(SymbolTable* table) {
+    int capacity = table->slot_capacity ? table->slot_capacity * 2 : 64;
+    free(table->slots);
+    table->slots = calloc((size_t)capacity, sizeof(int32_t));
+    if (table->slots == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    table->slot_capacity = capacity;
+    uint32_t mask = (uint32_t)capacity - 1;
+    for (int id = 0; id < table->name_count; id++) {
+        uint32_t slot = table->names[id].hash & mask;
+        while (table->slots[slot] != 0) slot = (slot + 1) & mask;
+        table->slots[slot] = id + 1;
+    }
+}
+
+int symtab_find_name(const SymbolTable* table, const char* name, size_t length) {
+    if (table->slot_capacity == 0) return -1;
+    int slot = find_slot(table, name, length, hash_name(name, length));
+    return table->slots[slot] - 1;
+}
+
+int symtab_intern(SymbolTable* table, const char* name, size_t length) {
+    // At most half full, so probe sequences stay short.
+    if ((table->name_count + 1) * 2 > table->slot_capacity) rehash(table);
+    uint32_t hash = hash_name(name, length);
+    int slot = find_slot(table, name, length, hash);
+    if (table->slots[slot] != 0) return table->slots[slot] - 1;
+
+    if (table->pool_size + length + 1 > table->pool_capacity) {
+        size_t capacity = table->pool_capacity ? table->pool_capacity : 256;
+        while (capacity < table->pool_size + length + 1) capacity *= 2;
+        table->pool = realloc(table->pool, capacity);
+        if (table->pool == NULL) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(1);
+        }
+        table->pool_capacity = capacity;
+    }
+    memcpy(table->pool + table->pool_size, name, length);
+    table->pool[table->pool_size + length] = '\0';
+
+    table->names = grow(table->names, &table->name_capacity, table->name_count + 1, sizeof(SymbolName));
+    int id = table->name_count++;
+    table->names[id] = (SymbolName){ hash, (int32_t)table->pool_size, (int32_t)length, -1 };
+    table->pool_size += length + 1;
+    table->slots[slot] = id + 1;
+    return id;
+}
+
+void symtab_push_scope(SymbolTable* table) {
+    table->scope_start = grow(table->scope_start, &table->scope_capacity, table->depth + 1, sizeof(int));
+    table->scope_start[table->depth++] = table->symbol_count;
+}
+
+void symtab_pop_scope(SymbolTable* table) {
+    if (table->depth == 0) return;
+    int start = table->scope_start[--table->depth];
+    while (table->symbol_count > start) {
+        const Symbol* symbol = &table->symbols[--table->symbol_count];
+        table->names[symbol->name].binding = symbol->shadowed;
+    }
+}
+
+Symbol* symtab_bind(SymbolTable* table, int name, SymbolKind kind, int value) {
+    if (table->depth == 0) symtab_push_scope(table);
+    int current = table->names[name].binding;
+    if (current >= table->scope_start[table->depth - 1]) return &table->symbols[current];
+
+    table->symbols = grow(table->symbols, &table->symbol_capacity, table->symbol_count + 1, sizeof(Symbol));
+    int index = table->symbol_count++;
+    table->symbols[index] = (Symbol){ name, table->depth, kind, value, current };
+    table->names[name].binding = index;
+    return &table->symbols[index];
+}
+
+Symbol* symtab_lookup_text(const SymbolTable* table, const char* name, size_t length) {
+    return symtab_lookup(table, symtab_find_name(table, name, length));
+}
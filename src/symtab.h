@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Scoped symbol table over interned names.
+//
+// Every name is interned once into an open-addressing hash table and is
+// from then on an integer id; two spellings of a name get the same id, so
+// comparing names is comparing ids. The entry of a name also holds its
+// innermost binding, which makes lookup a single probe of the name table
+// (or an array access for an id already in hand), whatever the depth of
+// nesting. Bindings form a stack: binding a name pushes a Symbol that
+// remembers the binding it shadows, and popping a scope unwinds the stack
+// to the scope's start, putting the shadowed bindings back.
+//
+// Symbol pointers are valid until the next binding in the table.
+
+typedef enum {
+    SYMBOL_PARAM,               // bound to an incoming argument
+    SYMBOL_LOCAL,
+    SYMBOL_ARRAY
+} SymbolKind;
+
+typedef struct {
+    int name;                   // interned id
+    int scope;                  // depth of the scope it is bound in, 1 for the outermost
+    SymbolKind kind;
+    int value;                  // client data: a frame offset, a variable number
+    int shadowed;               // binding of the same name in an enclosing scope, or -1
+} Symbol;
+
+typedef struct {
+    uint32_t hash;
+    int32_t text;               // offset in the string pool
+    int32_t length;
+    int32_t binding;            // innermost Symbol, or -1
+} SymbolName;
+
+typedef struct {
+    SymbolName* names;          // by id
+    int name_count, name_capacity;
+    int32_t* slots;             // open addressing over names: id + 1, 0 is empty
+    int slot_capacity;          // power of two
+    char* pool;                 // NUL-terminated name texts
+    size_t pool_size, pool_capacity;
+    Symbol* symbols;            // binding stack
+    int symbol_count, symbol_capacity;
+    int* scope_start;           // per open scope, its first binding
+    int depth, scope_capacity;
+} SymbolTable;
+
+void symtab_init(SymbolTable* table);
+void symtab_free(SymbolTable* table);
+
+// Id of a name, interning it on first use.
+int symtab_intern(SymbolTable* table, const char* name, size_t length);
+// Id of a name if it was ever interned, else -1; does not intern.
+int symtab_find_name(const SymbolTable* table, const char* name, size_t length);
+static inline const char* symtab_name(const SymbolTable* table, int name) {
+    return table->pool + table->names[name].text;
+}
+
+void symtab_push_scope(SymbolTable* table);
+void symtab_pop_scope(SymbolTable* table);
+// Binds a name in the innermost scope. A name already bound in that scope
+// keeps its binding, which is returned.
+Symbol* symtab_bind(SymbolTable* table, int name, SymbolKind kind, int value);
+// Innermost binding of a name, or NULL.
+static inline Symbol* symtab_lookup(const SymbolTable* table, int name) {
+    int binding = name >= 0 ? table->names[name].binding : -1;
+    return binding >= 0 ? &table->symbols[binding] : NULL;
+}
+// Lookup by spelling.
+Symbol* symtab_lookup_text(const SymbolTable* table, const char* name, size_t length);
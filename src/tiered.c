@@ -0,0 +1,188 @@
+#define _POSIX_C_SOURCE 200809L
+#include "tiered.h"
+#include "ir.h"
+#include "peephole.h"
+#include "riscv.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+typedef struct {
+    char* name;
+    char* text;
+    size_t len;
+    IrFunction* ir;             // lowered up front for the IR tier, else NULL
+} FunctionListing;
+
+struct TieredCompile {
+    char* output_path;
+    char* baseline;
+    size_t baseline_len;
+    FunctionListing* functions;
+    int function_count;
+    OptBudget budget;
+    OptLevel level;
+    int use_ir;
+    TierCallback callback;
+    void* user;
+    int tier;
+    int threaded;
+    pthread_t thread;
+};
+
+const char* compile_tier_name(CompileTier tier) {
+    return tier == TIER_OPTIMIZED ? "optimized" : "baseline";
+}
+
+// Runs the IR pipeline over a lowered function and returns its code, or
+// NULL if the budget ran out first.
+static char* optimize_ir(TieredCompile* compile, FunctionListing* function) {
+    if (!run_passes(function->ir, compile->level, &compile->budget)) return NULL;
+    char* text = NULL;
+    size_t len = 0;
+    FILE* output = open_memstream(&text, &len);
+    if (!output) return NULL;
+    ir_emit_function(function->ir, output);
+    fclose(output);
+    return text;
+}
+
+// Readers of output_path see either the old or the new artifact, never a
+// partially written one.
+static int replace_file(const char* path, const char* data, size_t len) {
+    size_t tmp_len = strlen(path) + 32;
+    char* tmp_path = malloc(tmp_len);
+    if (tmp_path == NULL) return -1;
+    snprintf(tmp_path, tmp_len, "%s.tmp.%ld", path, (long)getpid());
+
+    int result = -1;
+    FILE* file = fopen(tmp_path, "w");
+    if (file) {
+        int written = fwrite(data, 1, len, file) == len;
+        if (fclose(file) == 0 && written && rename(tmp_path, path) == 0) result = 0;
+    }
+    if (result != 0) remove(tmp_path);
+    free(tmp_path);
+    return result;
+}
+
+static void* optimizing_tier(void* arg) {
+    TieredCompile* compile = arg;
+    char* optimized = NULL;
+    size_t len = 0;
+    FILE* output = open_memstream(&optimized, &len);
+    if (!output) return NULL;
+
+    // A function that runs out of budget keeps its baseline code.
+    for (int i = 0; i < compile->function_count; i++) {
+        FunctionListing* function = &compile->functions[i];
+        char* text = NULL;
+        if (opt_budget_begin_function(&compile->budget, function->name)) {
+            text = compile->use_ir ? optimize_ir(compile, function)
+                                   : peephole_optimize(function->text, function->len, NULL, NULL, &compile->budget);
+        }
+        opt_budget_end_function(&compile->budget, text != NULL);
+        fputs(text ? text : function->text, output);
+        free(text);
+    }
+    fclose(output);
+
+    if (replace_file(compile->output_path, optimized, len) == 0) {
+        __atomic_store_n(&compile->tier, TIER_OPTIMIZED, __ATOMIC_RELEASE);
+        if (compile->callback) compile->callback(TIER_OPTIMIZED, compile->output_path, compile->user);
+    } else {
+        fprintf(stderr, "Warning: Cannot replace %s with optimized code\n", compile->output_path);
+    }
+    free(optimized);
+    return NULL;
+}
+
+static void free_compile(TieredCompile* compile) {
+    for (int i = 0; i < compile->function_count; i++) {
+        free(compile->functions[i].name);
+        free(compile->functions[i].text);
+        ir_function_free(compile->functions[i].ir);
+    }
+    free(compile->functions);
+    opt_budget_free(&compile->budget);
+    free(compile->baseline);
+    free(compile->output_path);
+    free(compile);
+}
+
+TieredCompile* tiered_compile_start(ASTNode* program, const char* output_path, const OptLimits* limits,
+                                    OptLevel level, int use_ir, TierCallback callback, void* user) {
+    TieredCompile* compile = calloc(1, sizeof(TieredCompile));
+    if (compile == NULL) return NULL;
+    compile->output_path = strdup(output_path);
+    compile->callback = callback;
+    compile->user = user;
+    compile->tier = TIER_BASELINE;
+    compile->level = level;
+    compile->use_ir = use_ir || level != OPT_O0;
+
+    // Keep each function's baseline code separately so the optimizing tier
+    // can fall back one function at a time.
+    int capacity = 0;
+    for (ASTNode* node = program; node; node = node->next) capacity++;
+    compile->functions = calloc(capacity ? (size_t)capacity : 1, sizeof(FunctionListing));
+    FILE* output = open_memstream(&compile->baseline, &compile->baseline_len);
+    if (compile->functions == NULL || !output) {
+        if (output) fclose(output);
+        free_compile(compile);
+        return NULL;
+    }
+    for (ASTNode* node = program; node; node = node->next) {
+        FunctionListing* function = &compile->functions[compile->function_count++];
+        function->name = strdup(node->value ? node->value : "?");
+        FILE* piece = open_memstream(&function->text, &function->len);
+        if (!piece) {
+            fclose(output);
+            free_compile(compile);
+            return NULL;
+        }
+        generate_function(node, piece);
+        fclose(piece);
+        fputs(function->text, output);
+        if (compile->use_ir) function->ir = ir_lower_function(node);
+    }
+    fclose(output);
+
+    if (replace_file(output_path, compile->baseline, compile->baseline_len) != 0) {
+        free_compile(compile);
+        return NULL;
+    }
+    if (callback) callback(TIER_BASELINE, output_path, user);
+
+    // The optimizing tier only reads the baseline listing and the IR, so the
+    // caller is free to release the AST right away.
+    opt_budget_init(&compile->budget, limits);
+    compile->threaded = pthread_create(&compile->thread, NULL, optimizing_tier, compile) == 0;
+    if (!compile->threaded) optimizing_tier(compile);
+    return compile;
+}
+
+CompileTier tiered_compile_tier(TieredCompile* compile) {
+    return (CompileTier)__atomic_load_n(&compile->tier, __ATOMIC_ACQUIRE);
+}
+
+CompileTier tiered_compile_wait(TieredCompile* compile) {
+    if (compile->threaded) {
+        pthread_join(compile->thread, NULL);
+        compile->threaded = 0;
+    }
+    return tiered_compile_tier(compile);
+}
+
+const OptBudget* tiered_compile_budget(TieredCompile* compile) {
+    tiered_compile_wait(compile);
+    return &compile->budget;
+}
+
+CompileTier tiered_compile_finish(TieredCompile* compile) {
+    CompileTier tier = tiered_compile_wait(compile);
+    free_compile(compile);
+    return tier;
+}
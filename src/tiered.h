@@ -0,0 +1,44 @@
+#pragma once
+
+#include "compiler.h"
+#include "budget.h"
+#include "passes.h"
+#include <stddef.h>
+
+// Tiered compilation. The baseline tier is the direct AST-to-assembly code
+// generator and is written before tiered_compile_start() returns. The
+// optimizing tier then runs on a background thread and atomically replaces
+// the artifact (write to a temporary file, then rename) when it finishes.
+// At -O1 and up, or with use_ir, the optimizing tier is the IR pipeline of
+// that level; otherwise it is the peephole optimizer over the baseline
+// listing. Optimization is bounded by OptLimits; a function that exceeds
+// them is written with its baseline code.
+typedef enum {
+    TIER_BASELINE,
+    TIER_OPTIMIZED
+} CompileTier;
+
+// Called once per tier after that tier's output is in place. The optimized
+// tier's callback runs on the background thread.
+typedef void (*TierCallback)(CompileTier tier, const char* output_path, void* user);
+
+typedef struct TieredCompile TieredCompile;
+
+const char* compile_tier_name(CompileTier tier);
+
+// Returns NULL if even the baseline tier could not be written. limits may be
+// NULL for an unbounded optimizing tier. Functions are lowered to IR before
+// this returns, so the caller may release the AST right away. The IR
+// pipeline shares the code generator's label counter, optimization remarks
+// and pass statistics, so the caller must not generate code until
+// tiered_compile_wait().
+TieredCompile* tiered_compile_start(ASTNode* program, const char* output_path, const OptLimits* limits,
+                                    OptLevel level, int use_ir, TierCallback callback, void* user);
+// Tier of the artifact currently on disk; never blocks.
+CompileTier tiered_compile_tier(TieredCompile* compile);
+// Waits for the optimizing tier and returns the final tier.
+CompileTier tiered_compile_wait(TieredCompile* compile);
+// Per-function fuel use of the optimizing tier; waits for it first.
+const OptBudget* tiered_compile_budget(TieredCompile* compile);
+// Waits for the optimizing tier, releases the handle and returns the final tier.
+CompileTier tiered_compile_finish(TieredCompile* compile);
@@ -0,0 +1,40 @@
+#!/bin/sh
+# Checks that batch compilation gives every file the assembly it gets when
+# compiled on its own, whatever was compiled before it in the batch, at
+# each optimization level and with each I/O backend.
+# Usage: tools/batch_check.sh [sources...] (default: test.c and tools/kernels)
+set -e
+
+COMPILER=${COMPILER:-./compiler}
+COMPILER=$(cd "$(dirname "$COMPILER")" && pwd)/$(basename "$COMPILER")
+WORKDIR=$(mktemp -d)
+trap 'rm -rf "$WORKDIR"' EXIT
+
+[ $# -gt 0 ] || set -- test.c tools/kernels/*.c
+i=0
+for source in "$@"; do
+    cp "$source" "$WORKDIR/unit$i.c"
+    i=$((i + 1))
+done
+
+failed=0
+for level in -O0 -O1 -O2 -Os; do
+    mkdir "$WORKDIR/single"
+    for source in "$WORKDIR"/unit*.c; do
+        (cd "$WORKDIR" && "$COMPILER" $level "$source" > /dev/null && mv output.s "single/$(basename "$source" .c).s")
+    done
+    for mode in stdio threads io_uring; do
+        "$COMPILER" $level --batch --batch-io=$mode "$WORKDIR"/unit*.c > /dev/null
+        for expected in "$WORKDIR"/single/*.s; do
+            name=$(basename "$expected")
+            if ! cmp -s "$expected" "$WORKDIR/$name"; then
+                echo "$level --batch-io=$mode: $name differs from the single-file compile"
+                failed=1
+            fi
+        done
+        rm -f "$WORKDIR"/unit*.s
+    done
+    rm -rf "$WORKDIR/single"
+done
+[ "$failed" = 0 ] && echo "OK"
+exit "$failed"
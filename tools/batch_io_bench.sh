@@ -0,0 +1,22 @@
+#!/bin/sh
+# Compares the batch I/O backends on many small files.
+# Usage: tools/batch_io_bench.sh [files] [source]
+set -e
+
+FILES=${1:-2000}
+SOURCE=${2:-test.c}
+COMPILER=${COMPILER:-./compiler}
+WORKDIR=$(mktemp -d)
+trap 'rm -rf "$WORKDIR"' EXIT
+
+i=0
+while [ "$i" -lt "$FILES" ]; do
+    cp "$SOURCE" "$WORKDIR/unit$i.c"
+    i=$((i + 1))
+done
+
+for mode in stdio threads io_uring; do
+    # Warm the page cache and the allocator before the measured run.
+    "$COMPILER" --batch --batch-io=$mode "$WORKDIR"/*.c > /dev/null
+    "$COMPILER" --batch --batch-io=$mode "$WORKDIR"/*.c
+done
@@ -0,0 +1,106 @@
+#!/bin/sh
+# Compiler throughput on generated workloads (tools/gen_workload.c); run by
+# "make bench". The compiler is compared with the tree at BASE built in a
+# scratch directory, so both numbers come from the same machine at the same
+# time. BASE is a git revision, by default where the current branch forked
+# from its upstream, so every local commit is measured; without an upstream
+# it must be given. BASE_COMPILER names an already built baseline compiler
+# instead. Each shape is compiled REPEAT
+# times by each compiler, alternating, and their fastest runs are compared.
+# The run fails if the current compiler is slower by more than THRESHOLD
+# percent, or by more than twice the run-to-run spread measured here (the
+# median run over the fastest one) when that is larger.
+set -e
+
+COMPILER=${COMPILER:-./compiler}
+GEN=${GEN:-build/gen_workload}
+REPEAT=${REPEAT:-5}
+THRESHOLD=${THRESHOLD:-10}
+
+if [ -z "$BASE_COMPILER" ] && [ -z "$BASE" ]; then
+    upstream=$(git rev-parse --abbrev-ref --symbolic-full-name '@{upstream}' 2> /dev/null) || upstream=
+    if [ -z "$upstream" ] || ! BASE=$(git merge-base HEAD "$upstream"); then
+        echo "No base revision: the branch has no upstream; set BASE=<revision> or BASE_COMPILER" >&2
+        exit 1
+    fi
+    echo "Comparing with $BASE, the merge base with $upstream"
+fi
+WORKDIR=$(mktemp -d)
+trap 'rm -rf "$WORKDIR"' EXIT
+
+if [ -z "$BASE_COMPILER" ]; then
+    mkdir "$WORKDIR/base"
+    git archive "$BASE" | tar -x -C "$WORKDIR/base"
+    # Keep make from regenerating the checked-in parser and lexer.
+    touch "$WORKDIR"/base/pre_generated/*
+    make -s -C "$WORKDIR/base" compiler > "$WORKDIR/base.log" 2>&1 || {
+        cat "$WORKDIR/base.log" >&2
+        echo "Cannot build $BASE" >&2
+        exit 1
+    }
+    BASE_COMPILER="$WORKDIR/base/compiler"
+fi
+case $COMPILER in /*) ;; *) COMPILER="$PWD/$COMPILER" ;; esac
+case $BASE_COMPILER in /*) ;; *) BASE_COMPILER="$PWD/$BASE_COMPILER" ;; esac
+
+# name, functions, then the remaining generator options.
+SHAPES="wide 300 --statements=20 --depth=3
+deep 100 --statements=30 --depth=6
+loops 200 --statements=15 --loops=4
+arrays 200 --statements=20 --arrays=60
+calls 300 --statements=20 --calls=50"
+
+now_ns() {
+    date +%s%N
+}
+
+# Appends the time of one compile of $2 by $1, in nanoseconds, to $3.
+time_compile() {
+    start=$(now_ns)
+    (cd "$WORKDIR" && "$1" "$2" > /dev/null)
+    end=$(now_ns)
+    echo $((end - start)) >> "$3"
+}
+
+# Fastest and median of the times in $1.
+summary() {
+    sort -n "$1" | awk '{ t[NR] = $1 } END { print t[1], t[int((NR + 1) / 2)] }'
+}
+
+RESULTS="$WORKDIR/results"
+: > "$RESULTS"
+echo "$SHAPES" | while read -r name functions options; do
+    source="$WORKDIR/$name.c"
+    # shellcheck disable=SC2086
+    "$GEN" --seed=42 --functions="$functions" $options > "$source"
+    : > "$WORKDIR/base.times"
+    : > "$WORKDIR/current.times"
+    i=0
+    while [ "$i" -lt "$REPEAT" ]; do
+        time_compile "$BASE_COMPILER" "$source" "$WORKDIR/base.times"
+        time_compile "$COMPILER" "$source" "$WORKDIR/current.times"
+        i=$((i + 1))
+    done
+    # main is generated in addition to the requested functions.
+    echo "$name $(wc -c < "$source") $((functions + 1)) $(summary "$WORKDIR/base.times") \
+$(summary "$WORKDIR/current.times")" >> "$RESULTS"
+done
+
+awk -v threshold="$THRESHOLD" '
+    {
+        name = $1; bytes = $2; functions = $3
+        base = $4; base_median = $5; current = $6; current_median = $7
+        spread = 100 * (base_median - base) / base
+        if (100 * (current_median - current) / current > spread) spread = 100 * (current_median - current) / current
+        limit = 2 * spread > threshold ? 2 * spread : threshold
+        change = 100 * (base - current) / current
+        printf "%-8s %9.2f MB/s %9.0f functions/s  (%+.1f%% vs base, spread %.1f%%)", name,
+               bytes * 1e3 / current, functions * 1e9 / current, change, spread
+        if (change < -limit) { printf "  REGRESSION"; failed = 1 }
+        printf "\n"
+    }
+    END { exit failed }
+' "$RESULTS" || {
+    echo "Throughput fell below the base revision by more than the threshold or the measured spread" >&2
+    exit 1
+}
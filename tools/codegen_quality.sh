@@ -0,0 +1,93 @@
+#!/bin/sh
+# Generated-code quality check over the kernels in tools/kernels; run by
+# "make quality". For every function it records static instructions, stack
+# frame size, loads, stores and branches (conditional branches and jumps)
+# and compares them with tools/kernels/quality_baseline.txt. It fails if any
+# metric grew, and prints a diff against the baseline assembly of each
+# kernel whose metrics changed. QUALITY_UPDATE=1 records a new baseline.
+set -e
+
+COMPILER=${COMPILER:-./compiler}
+KERNELS=${KERNELS:-tools/kernels}
+BASELINE=$KERNELS/quality_baseline.txt
+BASELINE_ASM=$KERNELS/baseline
+COMPILER=$(cd "$(dirname "$COMPILER")" && pwd)/$(basename "$COMPILER")
+WORKDIR=$(mktemp -d)
+trap 'rm -rf "$WORKDIR"' EXIT
+
+metrics() {
+    awk -v kernel="$1" '
+        /^[A-Za-z_][A-Za-z0-9_]*:$/ { fn = substr($0, 1, length($0) - 1); order[++n] = fn; prologue = 1; next }
+        /^    [a-z]/ && fn != "" {
+            op = $1
+            insns[fn]++
+            # The frame is every stack adjustment of the prologue, which
+            # ends at the first instruction that is not frame setup.
+            if (prologue && op == "addi" && $2 == "sp," && $3 == "sp," && $4 ~ /^-/) frame[fn] -= $4
+            else if (!(op == "sw" && $3 ~ /\(sp\)$/) && !(op == "addi" && $2 == "s0,")) prologue = 0
+            if (op ~ /^(lw|lh|lhu|lb|lbu)$/) loads[fn]++
+            if (op ~ /^(sw|sh|sb)$/) stores[fn]++
+            if (op ~ /^(j|beqz|bnez|blez|bgez|bltz|bgtz|beq|bne|blt|bge|bgt|ble|bltu|bgeu|bgtu|bleu)$/) branches[fn]++
+        }
+        END {
+            for (i = 1; i <= n; i++) {
+                fn = order[i]
+                printf "%s %s %d %d %d %d %d\n", kernel, fn, insns[fn], frame[fn], loads[fn], stores[fn], branches[fn]
+            }
+        }' "$2"
+}
+
+: > "$WORKDIR/metrics.txt"
+for source in "$KERNELS"/*.c; do
+    kernel=$(basename "$source" .c)
+    (cd "$WORKDIR" && "$COMPILER" "$OLDPWD/$source" > /dev/null && mv output.s "$kernel.s")
+    metrics "$kernel" "$WORKDIR/$kernel.s" >> "$WORKDIR/metrics.txt"
+done
+
+if [ "${QUALITY_UPDATE:-0}" = 1 ]; then
+    mkdir -p "$BASELINE_ASM"
+    { echo "# kernel function instructions frame loads stores branches"; cat "$WORKDIR/metrics.txt"; } > "$BASELINE"
+    for source in "$KERNELS"/*.c; do
+        kernel=$(basename "$source" .c)
+        cp "$WORKDIR/$kernel.s" "$BASELINE_ASM/$kernel.s"
+    done
+    echo "Baseline written to $BASELINE and $BASELINE_ASM/"
+    exit 0
+fi
+
+# Prints one line per function whose metrics changed and, in
+# $WORKDIR/changed, the kernels to diff; exits 1 if anything got worse.
+status=0
+awk -v changed="$WORKDIR/changed" '
+    BEGIN { split("instructions frame loads stores branches", names, " ") }
+    FILENAME == ARGV[1] { if ($1 !~ /^#/) { key = $1 " " $2; for (i = 3; i <= 7; i++) base[key, i] = $i; known[key] = 1 }; next }
+    !(($1 " " $2) in known) { printf "%-28s new function\n", $1 " " $2; print $1 > changed; next }
+    {
+        key = $1 " " $2
+        seen[key] = 1
+        line = ""
+        for (i = 3; i <= 7; i++) {
+            if ($i != base[key, i]) {
+                line = line sprintf("  %s %d -> %d", names[i - 2], base[key, i], $i)
+                if ($i > base[key, i]) { line = line " (worse)"; worse = 1 }
+            }
+        }
+        if (line != "") { printf "%-28s%s\n", key, line; print $1 > changed }
+    }
+    END {
+        for (key in known) if (!(key in seen)) { printf "%-28s removed\n", key; split(key, part, " "); print part[1] > changed }
+        exit worse
+    }
+' "$BASELINE" "$WORKDIR/metrics.txt" || status=1
+
+if [ -s "$WORKDIR/changed" ]; then
+    sort -u "$WORKDIR/changed" | while read -r kernel; do
+        diff -u --label "$BASELINE_ASM/$kernel.s" --label "$kernel.s" "$BASELINE_ASM/$kernel.s" "$WORKDIR/$kernel.s" || true
+    done
+else
+    echo "Code quality unchanged on $(wc -l < "$WORKDIR/metrics.txt") functions"
+fi
+if [ "$status" != 0 ]; then
+    echo "Generated code got worse than $BASELINE" >&2
+fi
+exit $status
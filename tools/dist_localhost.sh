@@ -0,0 +1,89 @@
+#!/bin/sh
+# Exercises distributed compilation with several workers on localhost:
+# all workers up (at -O0 and -O2), one worker killed while it has requests in flight, one
+# worker down, and no workers at all. Each run must produce the same
+# assembly as a local batch compile.
+# Usage: tools/dist_localhost.sh [files] [source] [first_port]
+set -e
+
+FILES=${1:-200}
+SOURCE=${2:-test.c}
+PORT=${3:-7301}
+COMPILER=${COMPILER:-./compiler}
+GEN_WORKLOAD=${GEN_WORKLOAD:-build/gen_workload}
+WORKDIR=$(mktemp -d)
+PIDS=""
+trap 'kill $PIDS 2>/dev/null || true; rm -rf "$WORKDIR"' EXIT
+
+if [ ! -x "$GEN_WORKLOAD" ]; then
+    echo "$GEN_WORKLOAD not found; run 'make $GEN_WORKLOAD' first" >&2
+    exit 1
+fi
+
+i=0
+while [ "$i" -lt "$FILES" ]; do
+    cp "$SOURCE" "$WORKDIR/unit$i.c"
+    i=$((i + 1))
+done
+"$COMPILER" --batch --batch-io=stdio "$WORKDIR"/*.c > /dev/null
+mkdir "$WORKDIR/expected"
+mv "$WORKDIR"/*.s "$WORKDIR/expected/"
+"$COMPILER" -O2 --batch --batch-io=stdio "$WORKDIR"/*.c > /dev/null
+mkdir "$WORKDIR/expected-O2"
+mv "$WORKDIR"/*.s "$WORKDIR/expected-O2/"
+
+# Generated programs that take long enough to compile that a worker can be
+# killed before the batch is over.
+mkdir "$WORKDIR/slow" "$WORKDIR/slow/expected"
+i=0
+while [ "$i" -lt 60 ]; do
+    "$GEN_WORKLOAD" --seed=$i --functions=10 > "$WORKDIR/slow/unit$i.c"
+    i=$((i + 1))
+done
+"$COMPILER" --batch --batch-io=stdio "$WORKDIR"/slow/*.c > /dev/null
+mv "$WORKDIR"/slow/*.s "$WORKDIR/slow/expected/"
+
+WORKERS=""
+for p in $PORT $((PORT + 1)) $((PORT + 2)); do
+    "$COMPILER" --worker=127.0.0.1:$p > /dev/null &
+    PIDS="$PIDS $!"
+    WORKERS="$WORKERS${WORKERS:+,}127.0.0.1:$p"
+done
+sleep 0.5
+
+# check <title> [level]: the level travels with each request.
+check() {
+    echo "== $1"
+    "$COMPILER" ${2:-} --workers="$WORKERS" "$WORKDIR"/*.c
+    for f in "$WORKDIR"/expected${2:-}/*.s; do
+        cmp -s "$f" "$WORKDIR/$(basename "$f")" || { echo "mismatch: $(basename "$f")"; exit 1; }
+    done
+    rm -f "$WORKDIR"/*.s
+}
+
+# Kills the first worker, and the process serving its connection, once the
+# batch has produced its first output: the requests it still owed must be
+# resent to the others.
+killed_mid_batch() {
+    echo "== worker killed mid-batch"
+    "$COMPILER" --workers="$WORKERS" "$WORKDIR"/slow/*.c > "$WORKDIR/log" 2>&1 &
+    coordinator=$!
+    until ls "$WORKDIR"/slow/*.s > /dev/null 2>&1; do sleep 0.01; done
+    victim=$(echo $PIDS | cut -d' ' -f1)
+    pkill -KILL -P "$victim" || true
+    kill "$victim"
+    wait "$coordinator" || { cat "$WORKDIR/log"; echo "distributed compile failed"; exit 1; }
+    cat "$WORKDIR/log"
+    grep -q "Lost worker" "$WORKDIR/log" || { echo "the worker was not lost mid-batch"; exit 1; }
+    for f in "$WORKDIR"/slow/expected/*.s; do
+        cmp -s "$f" "$WORKDIR/slow/$(basename "$f")" || { echo "mismatch: slow/$(basename "$f")"; exit 1; }
+    done
+}
+
+check "three workers"
+check "three workers at -O2" -O2
+killed_mid_batch
+check "one worker down"
+kill $PIDS 2>/dev/null || true
+check "no workers (local fallback)"
+echo "OK"
@@ -0,0 +1,221 @@
+// Deterministic generator of Small C programs for benchmarking.
+// Usage: gen_workload [options] > program.c
+//   --seed=<n>         random seed (default 1); equal seeds give equal output
+//   --functions=<n>    number of functions besides main (default 100)
+//   --statements=<n>   statements per function body (default 20)
+//   --depth=<n>        maximum expression depth (default 4)
+//   --loops=<n>        maximum loop nesting (default 2)
+//   --arrays=<pct>     chance that an operand or store uses an array (default 20)
+//   --calls=<pct>      chance that an operand is a call (default 10)
+// Programs only call functions defined before them, so there is no
+// recursion, and they stay inside what the parser and generator accept.
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARRAY_SIZE 16
+#define MAX_PARAMS 3
+// Each enclosing if/while holds a register in the generator, so nesting is
+// capped to keep deep expressions inside the register file.
+#define MAX_NESTING 5
+
+typedef struct {
+    uint64_t seed;
+    int functions;
+    int statements;
+    int depth;
+    int loops;
+    int arrays;
+    int calls;
+} Shape;
+
+static uint64_t rng_state;
+static int* param_counts;
+static int current_function;
+static int in_call;
+
+// xorshift64*, so the output does not depend on the C library's rand().
+static uint64_t next_random(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+static int below(int n) {
+    return n > 0 ? (int)(next_random() % (uint64_t)n) : 0;
+}
+
+static int chance(int percent) {
+    return below(100) < percent;
+}
+
+static void indent(int level) {
+    for (int i = 0; i < level; i++) fputs("    ", stdout);
+}
+
+static const char* scalars[] = { "a", "b", "c", "d", "e", "x", "y", "z" };
+#define SCALAR_COUNT (int)(sizeof(scalars) / sizeof(scalars[0]))
+
+static void expression(const Shape* shape, int depth);
+
+static void operand(const Shape* shape) {
+    // Arguments are simple expressions without further calls, which keeps
+    // the output size proportional to --calls instead of exponential in it.
+    if (current_function > 0 && !in_call && chance(shape->calls)) {
+        int callee = below(current_function);
+        printf("f%d(", callee);
+        in_call = 1;
+        for (int i = 0; i < param_counts[callee]; i++) {
+            if (i) fputs(", ", stdout);
+            expression(shape, 1);
+        }
+        in_call = 0;
+        putchar(')');
+    } else if (chance(shape->arrays)) {
+        printf("arr[%s %% %d]", scalars[below(SCALAR_COUNT)], ARRAY_SIZE);
+    } else if (chance(40)) {
+        printf("%d", below(1000));
+    } else {
+        fputs(scalars[below(SCALAR_COUNT)], stdout);
+    }
+}
+
+static void expression(const Shape* shape, int depth) {
+    static const char* ops[] = { "+", "-", "*", "/", "%", "<", ">", "==", "!=", "<=", ">=", "&&", "||" };
+    if (depth <= 0 || chance(25)) {
+        operand(shape);
+        return;
+    }
+    // Arithmetic dominates, as it does in real code.
+    int op = chance(70) ? below(3) : below((int)(sizeof(ops) / sizeof(ops[0])));
+    putchar('(');
+    expression(shape, depth - 1);
+    printf(" %s ", ops[op]);
+    expression(shape, depth - 1);
+    putchar(')');
+}
+
+static void block(const Shape* shape, int count, int level, int loop_depth);
+
+static void statement(const Shape* shape, int level, int loop_depth) {
+    int kind = below(10);
+    indent(level);
+    if (kind < 4) {
+        printf("%s = ", scalars[below(SCALAR_COUNT)]);
+        expression(shape, shape->depth);
+        puts(";");
+    } else if (kind == 4) {
+        printf("%s %s ", scalars[below(SCALAR_COUNT)], chance(50) ? "+=" : "-=");
+        expression(shape, shape->depth / 2);
+        puts(";");
+    } else if (kind == 5 && chance(shape->arrays * 2)) {
+        printf("arr[%s %% %d] = ", scalars[below(SCALAR_COUNT)], ARRAY_SIZE);
+        expression(shape, shape->depth);
+        puts(";");
+    } else if (kind <= 6 && level <= MAX_NESTING) {
+        fputs("if (", stdout);
+        expression(shape, shape->depth / 2 + 1);
+        puts(") {");
+        block(shape, 1 + below(3), level + 1, loop_depth);
+        indent(level);
+        if (chance(50)) {
+            puts("} else {");
+            block(shape, 1 + below(3), level + 1, loop_depth);
+            indent(level);
+        }
+        puts("}");
+    } else if (kind > 6 && loop_depth < shape->loops && level <= MAX_NESTING) {
+        // Counters are bounded so generated programs also terminate when run.
+        const char* counter = loop_depth % 2 ? "j" : "i";
+        if (chance(50)) {
+            printf("for (%s = 0; %s < %d; %s = %s + 1) {\n", counter, counter, 2 + below(30), counter, counter);
+            block(shape, 1 + below(4), level + 1, loop_depth + 1);
+        } else {
+            printf("%s = 0;\n", counter);
+            indent(level);
+            printf("while (%s < %d) {\n", counter, 2 + below(30));
+            block(shape, 1 + below(4), level + 1, loop_depth + 1);
+            indent(level + 1);
+            printf("%s = %s + 1;\n", counter, counter);
+        }
+        indent(level);
+        puts("}");
+    } else {
+        fputs("z = ", stdout);
+        expression(shape, shape->depth);
+        puts(";");
+    }
+}
+
+static void block(const Shape* shape, int count, int level, int loop_depth) {
+    for (int i = 0; i < count; i++) statement(shape, level, loop_depth);
+}
+
+static void function(const Shape* shape, int index) {
+    static const char* params[MAX_PARAMS] = { "a", "b", "c" };
+    current_function = index;
+    printf("int f%d(", index);
+    for (int i = 0; i < param_counts[index]; i++) printf("%sint %s", i ? ", " : "", params[i]);
+    puts(") {");
+    for (int i = param_counts[index]; i < SCALAR_COUNT; i++) printf("    int %s = %d;\n", scalars[i], below(100));
+    puts("    int i;\n    int j;");
+    printf("    int arr[%d];\n", ARRAY_SIZE);
+    block(shape, shape->statements, 1, 0);
+    fputs("    return ", stdout);
+    expression(shape, shape->depth);
+    puts(";\n}\n");
+}
+
+static int parse_option(const char* arg, const char* name, int* value) {
+    size_t length = strlen(name);
+    if (strncmp(arg, name, length) != 0 || arg[length] != '=') return 0;
+    *value = atoi(arg + length + 1);
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    Shape shape = { 1, 100, 20, 4, 2, 20, 10 };
+    for (int i = 1; i < argc; i++) {
+        int seed;
+        if (parse_option(argv[i], "--seed", &seed)) {
+            shape.seed = (uint64_t)seed;
+        } else if (!parse_option(argv[i], "--functions", &shape.functions)
+                   && !parse_option(argv[i], "--statements", &shape.statements)
+                   && !parse_option(argv[i], "--depth", &shape.depth)
+                   && !parse_option(argv[i], "--loops", &shape.loops)
+                   && !parse_option(argv[i], "--arrays", &shape.arrays)
+                   && !parse_option(argv[i], "--calls", &shape.calls)) {
+            fprintf(stderr, "Usage: %s [--seed=n] [--functions=n] [--statements=n] [--depth=n]\n"
+                            "          [--loops=n] [--arrays=pct] [--calls=pct]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (shape.functions < 0 || shape.statements < 0 || shape.depth < 0 || shape.loops < 0) {
+        fprintf(stderr, "Error: Shape parameters must not be negative\n");
+        return 1;
+    }
+
+    // The seed is mixed so that small seeds do not start in a weak state.
+    rng_state = shape.seed * 0x9E3779B97F4A7C15ULL + 0x632BE59BD9B4E019ULL;
+    param_counts = malloc((size_t)(shape.functions + 1) * sizeof(int));
+    if (param_counts == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return 1;
+    }
+    for (int i = 0; i < shape.functions; i++) param_counts[i] = below(MAX_PARAMS + 1);
+
+    for (int i = 0; i < shape.functions; i++) function(&shape, i);
+
+    puts("int main() {");
+    puts("    int s = 0;");
+    for (int i = 0; i < shape.functions; i += 1 + shape.functions / 16) {
+        printf("    s = s + f%d(", i);
+        for (int j = 0; j < param_counts[i]; j++) printf("%s%d", j ? ", " : "", j + 1);
+        puts(");");
+    }
+    puts("    return s;\n}");
+    free(param_counts);
+    return 0;
+}
@@ -0,0 +1,113 @@
+    .text
+    .globl main
+main:
+    addi sp, sp, -96
+    sw ra, 92(sp)
+    sw s0, 88(sp)
+    addi s0, sp, 96
+    li a0, 0
+    sw a0, -12(s0)
+.L1:
+    lw t0, -12(s0)
+    li t1, 16
+    slt t0, t0, t1
+    beqz t0, .L2
+    lw t0, -12(s0)
+    lw a0, -12(s0)
+    li t1, 7
+    mul a0, a0, t1
+    li t1, 3
+    add a0, a0, t1
+    li t1, 16
+    rem a0, a0, t1
+    slli t0, t0, 2
+    add t0, t0, s0
+    sw a0, -84(t0)
+    lw a0, -12(s0)
+    li t0, 1
+    add a0, a0, t0
+    sw a0, -12(s0)
+    j .L1
+.L2:
+    li a0, 0
+    sw a0, -12(s0)
+.L3:
+    lw t0, -12(s0)
+    li t1, 15
+    slt t0, t0, t1
+    beqz t0, .L4
+    li a0, 0
+    sw a0, -16(s0)
+.L5:
+    lw t0, -16(s0)
+    li t1, 15
+    lw t2, -12(s0)
+    sub t1, t1, t2
+    slt t0, t0, t1
+    beqz t0, .L6
+    lw t0, -16(s0)
+    slli t0, t0, 2
+    add t0, t0, s0
+    lw t0, -84(t0)
+    lw t1, -16(s0)
+    li t2, 1
+    add t1, t1, t2
+    slli t1, t1, 2
+    add t1, t1, s0
+    lw t1, -84(t1)
+    slt t0, t1, t0
+    beqz t0, .L7
+    lw a0, -16(s0)
+    slli a0, a0, 2
+    add a0, a0, s0
+    lw a0, -84(a0)
+    sw a0, -20(s0)
+    lw t0, -16(s0)
+    lw a0, -16(s0)
+    li t1, 1
+    add a0, a0, t1
+    slli a0, a0, 2
+    add a0, a0, s0
+    lw a0, -84(a0)
+    slli t0, t0, 2
+    add t0, t0, s0
+    sw a0, -84(t0)
+    lw t0, -16(s0)
+    li t1, 1
+    add t0, t0, t1
+    lw a0, -20(s0)
+    slli t0, t0, 2
+    add t0, t0, s0
+    sw a0, -84(t0)
+    j .L8
+.L7:
+.L8:
+    lw a0, -16(s0)
+    li t0, 1
+    add a0, a0, t0
+    sw a0, -16(s0)
+    j .L5
+.L6:
+    lw a0, -12(s0)
+    li t0, 1
+    add a0, a0, t0
+    sw a0, -12(s0)
+    j .L3
+.L4:
+    li a0, 0
+    slli a0, a0, 2
+    add a0, a0, s0
+    lw a0, -84(a0)
+    li t0, 15
+    slli t0, t0, 2
+    add t0, t0, s0
+    lw t0, -84(t0)
+    li t1, 100
+    mul t0, t0, t1
+    add a0, a0, t0
+.L0:
+    addi sp, s0, -16
+    lw ra, 12(sp)
+    lw s0, 8(sp)
+    addi sp, sp, 16
+    ret
@@ -0,0 +1,90 @@
+    .text
+    .globl steps
+steps:
+    addi sp, sp, -32
+    sw ra, 28(sp)
+    sw s0, 24(sp)
+    addi s0, sp, 32
+    sw a0, -12(s0)
+    li a0, 0
+    sw a0, -16(s0)
+.L1:
+    lw t0, -12(s0)
+    li t1, 1
+    xor t0, t0, t1
+    snez t0, t0
+    beqz t0, .L2
+    lw t0, -12(s0)
+    li t1, 2
+    rem t0, t0, t1
+    li t1, 0
+    xor t0, t0, t1
+    seqz t0, t0
+    beqz t0, .L3
+    lw a0, -12(s0)
+    li t0, 2
+    div a0, a0, t0
+    sw a0, -12(s0)
+    j .L4
+.L3:
+    li a0, 3
+    lw t0, -12(s0)
+    mul a0, a0, t0
+    li t0, 1
+    add a0, a0, t0
+    sw a0, -12(s0)
+.L4:
+    lw a0, -16(s0)
+    li t0, 1
+    add a0, a0, t0
+    sw a0, -16(s0)
+    j .L1
+.L2:
+    lw a0, -16(s0)
+.L0:
+    addi sp, s0, -16
+    lw ra, 12(sp)
+    lw s0, 8(sp)
+    addi sp, sp, 16
+    ret
+    .text
+    .globl main
+main:
+    addi sp, sp, -32
+    sw ra, 28(sp)
+    sw s0, 24(sp)
+    addi s0, sp, 32
+    li a0, 0
+    sw a0, -12(s0)
+    li a0, 1
+    sw a0, -16(s0)
+.L6:
+    lw t0, -16(s0)
+    li t1, 30
+    slt t0, t0, t1
+    beqz t0, .L7
+    lw a0, -16(s0)
+    call steps
+    mv t0, a0
+    lw t1, -12(s0)
+    slt t0, t1, t0
+    beqz t0, .L8
+    lw a0, -16(s0)
+    call steps
+    sw a0, -12(s0)
+    j .L9
+.L8:
+.L9:
+    lw a0, -16(s0)
+    li t0, 1
+    add a0, a0, t0
+    sw a0, -16(s0)
+    j .L6
+.L7:
+    lw a0, -12(s0)
+.L5:
+    addi sp, s0, -16
+    lw ra, 12(sp)
+    lw s0, 8(sp)
+    addi sp, sp, 16
+    ret
@@ -0,0 +1,90 @@
+    .text
+    .globl fact
+fact:
+    addi sp, sp, -32
+    sw ra, 28(sp)
+    sw s0, 24(sp)
+    addi s0, sp, 32
+    sw a0, -12(s0)
+    lw t0, -12(s0)
+    li t1, 1
+    slt t0, t1, t0
+    xori t0, t0, 1
+    beqz t0, .L1
+    li a0, 1
+    j .L0
+    j .L2
+.L1:
+.L2:
+    lw t0, -12(s0)
+    lw a0, -12(s0)
+    li t2, 1
+    sub a0, a0, t2
+    addi sp, sp, -16
+    sw t0, 0(sp)
+    call fact
+    lw t0, 0(sp)
+    addi sp, sp, 16
+    mv t1, a0
+    mul a0, t0, t1
+.L0:
+    addi sp, s0, -16
+    lw ra, 12(sp)
+    lw s0, 8(sp)
+    addi sp, sp, 16
+    ret
+    .text
+    .globl loopfact
+loopfact:
+    addi sp, sp, -32
+    sw ra, 28(sp)
+    sw s0, 24(sp)
+    addi s0, sp, 32
+    sw a0, -12(s0)
+    li a0, 1
+    sw a0, -16(s0)
+.L4:
+    lw t0, -12(s0)
+    li t1, 1
+    slt t0, t1, t0
+    beqz t0, .L5
+    lw a0, -16(s0)
+    lw t0, -12(s0)
+    mul a0, a0, t0
+    sw a0, -16(s0)
+    lw a0, -12(s0)
+    li t0, 1
+    sub a0, a0, t0
+    sw a0, -12(s0)
+    j .L4
+.L5:
+    lw a0, -16(s0)
+.L3:
+    addi sp, s0, -16
+    lw ra, 12(sp)
+    lw s0, 8(sp)
+    addi sp, sp, 16
+    ret
+    .text
+    .globl main
+main:
+    addi sp, sp, -16
+    sw ra, 12(sp)
+    sw s0, 8(sp)
+    addi s0, sp, 16
+    li a0, 10
+    call fact
+    mv t0, a0
+    li a0, 10
+    addi sp, sp, -16
+    sw t0, 0(sp)
+    call loopfact
+    lw t0, 0(sp)
+    addi sp, sp, 16
+    mv t1, a0
+    sub a0, t0, t1
+.L6:
+    lw ra, 12(sp)
+    lw s0, 8(sp)
+    addi sp, sp, 16
+    ret
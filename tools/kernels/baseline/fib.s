@@ -0,0 +1,52 @@
+    .text
+    .globl fib
+fib:
+    addi sp, sp, -32
+    sw ra, 28(sp)
+    sw s0, 24(sp)
+    addi s0, sp, 32
+    sw a0, -12(s0)
+    lw t0, -12(s0)
+    li t1, 2
+    slt t0, t0, t1
+    beqz t0, .L1
+    lw a0, -12(s0)
+    j .L0
+    j .L2
+.L1:
+.L2:
+    lw a0, -12(s0)
+    li t1, 1
+    sub a0, a0, t1
+    call fib
+    mv t0, a0
+    lw a0, -12(s0)
+    li t2, 2
+    sub a0, a0, t2
+    addi sp, sp, -16
+    sw t0, 0(sp)
+    call fib
+    lw t0, 0(sp)
+    addi sp, sp, 16
+    mv t1, a0
+    add a0, t0, t1
+.L0:
+    addi sp, s0, -16
+    lw ra, 12(sp)
+    lw s0, 8(sp)
+    addi sp, sp, 16
+    ret
+    .text
+    .globl main
+main:
+    addi sp, sp, -16
+    sw ra, 12(sp)
+    sw s0, 8(sp)
+    addi s0, sp, 16
+    li a0, 15
+    call fib
+.L3:
+    lw ra, 12(sp)
+    lw s0, 8(sp)
+    addi sp, sp, 16
+    ret
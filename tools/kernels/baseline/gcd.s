@@ -0,0 +1,74 @@
+    .text
+    .globl gcd
+gcd:
+    addi sp, sp, -32
+    sw ra, 28(sp)
+    sw s0, 24(sp)
+    addi s0, sp, 32
+    sw a0, -12(s0)
+    sw a1, -16(s0)
+.L1:
+    lw t0, -16(s0)
+    li t1, 0
+    xor t0, t0, t1
+    snez t0, t0
+    beqz t0, .L2
+    lw a0, -12(s0)
+    lw t0, -16(s0)
+    rem a0, a0, t0
+    sw a0, -20(s0)
+    lw a0, -16(s0)
+    sw a0, -12(s0)
+    lw a0, -20(s0)
+    sw a0, -16(s0)
+    j .L1
+.L2:
+    lw a0, -12(s0)
+.L0:
+    addi sp, s0, -16
+    lw ra, 12(sp)
+    lw s0, 8(sp)
+    addi sp, sp, 16
+    ret
+    .text
+    .globl main
+main:
+    addi sp, sp, -32
+    sw ra, 28(sp)
+    sw s0, 24(sp)
+    addi s0, sp, 32
+    li a0, 0
+    sw a0, -12(s0)
+    li a0, 1
+    sw a0, -16(s0)
+.L4:
+    lw t0, -16(s0)
+    li t1, 50
+    slt t0, t0, t1
+    beqz t0, .L5
+    lw t0, -12(s0)
+    lw a0, -16(s0)
+    li t2, 7
+    mul a0, a0, t2
+    li a1, 84
+    addi sp, sp, -16
+    sw t0, 0(sp)
+    call gcd
+    lw t0, 0(sp)
+    addi sp, sp, 16
+    mv t1, a0
+    add a0, t0, t1
+    sw a0, -12(s0)
+    lw a0, -16(s0)
+    li t0, 1
+    add a0, a0, t0
+    sw a0, -16(s0)
+    j .L4
+.L5:
+    lw a0, -12(s0)
+.L3:
+    addi sp, s0, -16
+    lw ra, 12(sp)
+    lw s0, 8(sp)
+    addi sp, sp, 16
+    ret
@@ -0,0 +1,1644 @@
+    .text
+    .globl mix
+mix:
+    addi sp, sp, -32
+    sw ra, 28(sp)
+    sw s0, 24(sp)
+    addi s0, sp, 32
+    sw a0, -20(s0)
+    li a0, 1
+    sw a0, -12(s0)
+    li a0, 0
+    sw a0, -16(s0)
+.L1:
+    lw t0, -16(s0)
+    lw t1, -20(s0)
+    slt t0, t0, t1
+    beqz t0, .L2
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 11
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 12
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 13
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 14
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 15
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 16
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 9
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 17
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 18
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 19
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 20
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 21
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 22
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 23
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 9
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 11
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 12
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 13
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 14
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 15
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 16
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 17
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 9
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 18
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 19
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 20
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 21
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 22
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 23
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 11
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 9
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 12
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 13
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 14
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 15
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 16
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 17
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 18
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 9
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 19
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 20
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 21
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 22
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 23
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 11
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 12
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 9
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 13
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 14
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 15
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 16
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 17
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 18
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 19
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 9
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 20
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 21
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 22
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 23
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 11
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 12
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 13
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 9
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 14
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 15
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 16
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 17
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 18
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 19
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 20
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 9
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 21
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 22
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 23
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 11
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 12
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 13
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 14
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 9
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 15
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 16
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 17
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 18
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 19
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 20
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 21
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 9
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 22
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 23
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 11
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 12
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 13
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 14
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 15
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 9
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 16
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 17
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 18
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 19
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 20
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 21
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 22
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 9
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 23
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 11
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 12
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 13
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 14
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 15
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 16
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 9
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 17
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 18
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 19
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 20
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 21
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 22
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 23
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 9
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 11
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 12
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 13
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 14
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 15
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 16
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 17
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 9
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 18
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 19
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 20
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 21
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 22
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 23
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 11
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 9
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 12
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 13
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 14
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 15
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 16
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 17
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 18
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 9
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 19
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 20
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 21
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 22
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 23
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 11
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 12
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 9
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 13
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 14
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 15
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 16
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 17
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 18
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 19
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 9
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 20
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 21
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 22
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 23
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 11
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 12
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 13
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 9
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 14
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 15
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 16
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 17
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 18
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 19
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 20
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 9
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 21
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 3
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 22
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 4
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 23
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 5
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 11
+    add a0, a0, t0
+    li t0, 1009
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 6
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 12
+    add a0, a0, t0
+    li t0, 997
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 7
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 13
+    add a0, a0, t0
+    li t0, 991
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -12(s0)
+    li t0, 8
+    mul a0, a0, t0
+    lw t0, -16(s0)
+    add a0, a0, t0
+    li t0, 14
+    add a0, a0, t0
+    li t0, 983
+    rem a0, a0, t0
+    sw a0, -12(s0)
+    lw a0, -16(s0)
+    li t0, 1
+    add a0, a0, t0
+    sw a0, -16(s0)
+    j .L1
+.L2:
+    lw a0, -12(s0)
+.L0:
+    addi sp, s0, -16
+    lw ra, 12(sp)
+    lw s0, 8(sp)
+    addi sp, sp, 16
+    ret
+    .text
+    .globl main
+main:
+    addi sp, sp, -16
+    sw ra, 12(sp)
+    sw s0, 8(sp)
+    addi s0, sp, 16
+    li a0, 40
+    call mix
+.L3:
+    lw ra, 12(sp)
+    lw s0, 8(sp)
+    addi sp, sp, 16
+    ret
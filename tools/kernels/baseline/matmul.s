@@ -0,0 +1,119 @@
+    .text
+    .globl main
+main:
+    addi sp, sp, -224
+    sw ra, 220(sp)
+    sw s0, 216(sp)
+    addi s0, sp, 224
+    li a0, 0
+    sw a0, -12(s0)
+.L1:
+    lw t0, -12(s0)
+    li t1, 16
+    slt t0, t0, t1
+    beqz t0, .L2
+    lw t0, -12(s0)
+    lw a0, -12(s0)
+    li t1, 1
+    add a0, a0, t1
+    slli t0, t0, 2
+    add t0, t0, s0
+    sw a0, -88(t0)
+    lw t0, -12(s0)
+    li a0, 16
+    lw t1, -12(s0)
+    sub a0, a0, t1
+    slli t0, t0, 2
+    add t0, t0, s0
+    sw a0, -152(t0)
+    lw a0, -12(s0)
+    li t0, 1
+    add a0, a0, t0
+    sw a0, -12(s0)
+    j .L1
+.L2:
+    li a0, 0
+    sw a0, -12(s0)
+.L3:
+    lw t0, -12(s0)
+    li t1, 4
+    slt t0, t0, t1
+    beqz t0, .L4
+    li a0, 0
+    sw a0, -16(s0)
+.L5:
+    lw t0, -16(s0)
+    li t1, 4
+    slt t0, t0, t1
+    beqz t0, .L6
+    li a0, 0
+    sw a0, -24(s0)
+    li a0, 0
+    sw a0, -20(s0)
+.L7:
+    lw t0, -20(s0)
+    li t1, 4
+    slt t0, t0, t1
+    beqz t0, .L8
+    lw a0, -24(s0)
+    lw t0, -12(s0)
+    li t1, 4
+    mul t0, t0, t1
+    lw t1, -20(s0)
+    add t0, t0, t1
+    slli t0, t0, 2
+    add t0, t0, s0
+    lw t0, -88(t0)
+    lw t1, -20(s0)
+    li t2, 4
+    mul t1, t1, t2
+    lw t2, -16(s0)
+    add t1, t1, t2
+    slli t1, t1, 2
+    add t1, t1, s0
+    lw t1, -152(t1)
+    mul t0, t0, t1
+    add a0, a0, t0
+    sw a0, -24(s0)
+    lw a0, -20(s0)
+    li t0, 1
+    add a0, a0, t0
+    sw a0, -20(s0)
+    j .L7
+.L8:
+    lw t0, -12(s0)
+    li t1, 4
+    mul t0, t0, t1
+    lw t1, -16(s0)
+    add t0, t0, t1
+    lw a0, -24(s0)
+    slli t0, t0, 2
+    add t0, t0, s0
+    sw a0, -216(t0)
+    lw a0, -16(s0)
+    li t0, 1
+    add a0, a0, t0
+    sw a0, -16(s0)
+    j .L5
+.L6:
+    lw a0, -12(s0)
+    li t0, 1
+    add a0, a0, t0
+    sw a0, -12(s0)
+    j .L3
+.L4:
+    li a0, 0
+    slli a0, a0, 2
+    add a0, a0, s0
+    lw a0, -216(a0)
+    li t0, 15
+    slli t0, t0, 2
+    add t0, t0, s0
+    lw t0, -216(t0)
+    add a0, a0, t0
+.L0:
+    addi sp, s0, -16
+    lw ra, 12(sp)
+    lw s0, 8(sp)
+    addi sp, sp, 16
+    ret
@@ -0,0 +1,58 @@
+    .text
+    .globl main
+main:
+    addi sp, sp, -160
+    sw ra, 156(sp)
+    sw s0, 152(sp)
+    addi s0, sp, 160
+    li a0, 0
+    sw a0, -12(s0)
+.L1:
+    lw t0, -12(s0)
+    li t1, 32
+    slt t0, t0, t1
+    beqz t0, .L2
+    lw t0, -12(s0)
+    lw a0, -12(s0)
+    li t1, 3
+    mul a0, a0, t1
+    li t1, 1
+    add a0, a0, t1
+    slli t0, t0, 2
+    add t0, t0, s0
+    sw a0, -144(t0)
+    lw a0, -12(s0)
+    li t0, 1
+    add a0, a0, t0
+    sw a0, -12(s0)
+    j .L1
+.L2:
+    li a0, 0
+    sw a0, -16(s0)
+    li a0, 0
+    sw a0, -12(s0)
+.L3:
+    lw t0, -12(s0)
+    li t1, 32
+    slt t0, t0, t1
+    beqz t0, .L4
+    lw a0, -16(s0)
+    lw t0, -12(s0)
+    slli t0, t0, 2
+    add t0, t0, s0
+    lw t0, -144(t0)
+    add a0, a0, t0
+    sw a0, -16(s0)
+    lw a0, -12(s0)
+    li t0, 1
+    add a0, a0, t0
+    sw a0, -12(s0)
+    j .L3
+.L4:
+    lw a0, -16(s0)
+.L0:
+    addi sp, s0, -16
+    lw ra, 12(sp)
+    lw s0, 8(sp)
+    addi sp, sp, 16
+    ret
@@ -0,0 +1,20 @@
+// Nested loops with compares and swaps on an array.
+int main() {
+    int v[16];
+    int i;
+    int j;
+    int t;
+    for (i = 0; i < 16; i = i + 1) {
+        v[i] = (i * 7 + 3) % 16;
+    }
+    for (i = 0; i < 15; i = i + 1) {
+        for (j = 0; j < 15 - i; j = j + 1) {
+            if (v[j] > v[j + 1]) {
+                t = v[j];
+                v[j] = v[j + 1];
+                v[j + 1] = t;
+            }
+        }
+    }
+    return v[0] + v[15] * 100;
+}
@@ -0,0 +1,26 @@
+// Branchy integer code: Collatz sequence lengths.
+int steps(int n) {
+    int c;
+    c = 0;
+    while (n != 1) {
+        if (n % 2 == 0) {
+            n = n / 2;
+        } else {
+            n = 3 * n + 1;
+        }
+        c = c + 1;
+    }
+    return c;
+}
+
+int main() {
+    int m;
+    int i;
+    m = 0;
+    for (i = 1; i < 30; i = i + 1) {
+        if (steps(i) > m) {
+            m = steps(i);
+        }
+    }
+    return m;
+}
@@ -0,0 +1,23 @@
+// Division-heavy loop with a branch on every digit.
+int digitsum(int n) {
+    int s;
+    s = 0;
+    while (n > 0) {
+        if (n % 10 > 4) {
+            s = s + 1;
+        }
+        s = s + n % 10;
+        n = n / 10;
+    }
+    return s;
+}
+
+int main() {
+    int t;
+    int i;
+    t = 0;
+    for (i = 0; i < 200; i = i + 7) {
+        t = t + digitsum(i * 13);
+    }
+    return t;
+}
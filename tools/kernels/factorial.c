@@ -0,0 +1,21 @@
+// Linear recursion next to the equivalent loop.
+int fact(int n) {
+    if (n <= 1) {
+        return 1;
+    }
+    return n * fact(n - 1);
+}
+
+int loopfact(int n) {
+    int r;
+    r = 1;
+    while (n > 1) {
+        r = r * n;
+        n = n - 1;
+    }
+    return r;
+}
+
+int main() {
+    return fact(10) - loopfact(10);
+}
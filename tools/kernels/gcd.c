@@ -0,0 +1,20 @@
+// Euclid's algorithm: a data-dependent loop around remainder.
+int gcd(int a, int b) {
+    int t;
+    while (b != 0) {
+        t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+int main() {
+    int s;
+    int k;
+    s = 0;
+    for (k = 1; k < 50; k = k + 1) {
+        s = s + gcd(k * 7, 84);
+    }
+    return s;
+}
@@ -0,0 +1,176 @@
+// A loop whose body is larger than the +-4 KiB a conditional branch can
+// reach, so the assembler has to relax the branches around it.
+int mix(int n) {
+    int s;
+    int i;
+    s = 1;
+    i = 0;
+    while (i < n) {
+        s = (s * 3 + i + 11) % 1009;
+        s = (s * 4 + i + 12) % 997;
+        s = (s * 5 + i + 13) % 991;
+        s = (s * 6 + i + 14) % 983;
+        s = (s * 7 + i + 15) % 1009;
+        s = (s * 8 + i + 16) % 997;
+        s = (s * 9 + i + 17) % 991;
+        s = (s * 3 + i + 18) % 983;
+        s = (s * 4 + i + 19) % 1009;
+        s = (s * 5 + i + 20) % 997;
+        s = (s * 6 + i + 21) % 991;
+        s = (s * 7 + i + 22) % 983;
+        s = (s * 8 + i + 23) % 1009;
+        s = (s * 9 + i + 11) % 997;
+        s = (s * 3 + i + 12) % 991;
+        s = (s * 4 + i + 13) % 983;
+        s = (s * 5 + i + 14) % 1009;
+        s = (s * 6 + i + 15) % 997;
+        s = (s * 7 + i + 16) % 991;
+        s = (s * 8 + i + 17) % 983;
+        s = (s * 9 + i + 18) % 1009;
+        s = (s * 3 + i + 19) % 997;
+        s = (s * 4 + i + 20) % 991;
+        s = (s * 5 + i + 21) % 983;
+        s = (s * 6 + i + 22) % 1009;
+        s = (s * 7 + i + 23) % 997;
+        s = (s * 8 + i + 11) % 991;
+        s = (s * 9 + i + 12) % 983;
+        s = (s * 3 + i + 13) % 1009;
+        s = (s * 4 + i + 14) % 997;
+        s = (s * 5 + i + 15) % 991;
+        s = (s * 6 + i + 16) % 983;
+        s = (s * 7 + i + 17) % 1009;
+        s = (s * 8 + i + 18) % 997;
+        s = (s * 9 + i + 19) % 991;
+        s = (s * 3 + i + 20) % 983;
+        s = (s * 4 + i + 21) % 1009;
+        s = (s * 5 + i + 22) % 997;
+        s = (s * 6 + i + 23) % 991;
+        s = (s * 7 + i + 11) % 983;
+        s = (s * 8 + i + 12) % 1009;
+        s = (s * 9 + i + 13) % 997;
+        s = (s * 3 + i + 14) % 991;
+        s = (s * 4 + i + 15) % 983;
+        s = (s * 5 + i + 16) % 1009;
+        s = (s * 6 + i + 17) % 997;
+        s = (s * 7 + i + 18) % 991;
+        s = (s * 8 + i + 19) % 983;
+        s = (s * 9 + i + 20) % 1009;
+        s = (s * 3 + i + 21) % 997;
+        s = (s * 4 + i + 22) % 991;
+        s = (s * 5 + i + 23) % 983;
+        s = (s * 6 + i + 11) % 1009;
+        s = (s * 7 + i + 12) % 997;
+        s = (s * 8 + i + 13) % 991;
+        s = (s * 9 + i + 14) % 983;
+        s = (s * 3 + i + 15) % 1009;
+        s = (s * 4 + i + 16) % 997;
+        s = (s * 5 + i + 17) % 991;
+        s = (s * 6 + i + 18) % 983;
+        s = (s * 7 + i + 19) % 1009;
+        s = (s * 8 + i + 20) % 997;
+        s = (s * 9 + i + 21) % 991;
+        s = (s * 3 + i + 22) % 983;
+        s = (s * 4 + i + 23) % 1009;
+        s = (s * 5 + i + 11) % 997;
+        s = (s * 6 + i + 12) % 991;
+        s = (s * 7 + i + 13) % 983;
+        s = (s * 8 + i + 14) % 1009;
+        s = (s * 9 + i + 15) % 997;
+        s = (s * 3 + i + 16) % 991;
+        s = (s * 4 + i + 17) % 983;
+        s = (s * 5 + i + 18) % 1009;
+        s = (s * 6 + i + 19) % 997;
+        s = (s * 7 + i + 20) % 991;
+        s = (s * 8 + i + 21) % 983;
+        s = (s * 9 + i + 22) % 1009;
+        s = (s * 3 + i + 23) % 997;
+        s = (s * 4 + i + 11) % 991;
+        s = (s * 5 + i + 12) % 983;
+        s = (s * 6 + i + 13) % 1009;
+        s = (s * 7 + i + 14) % 997;
+        s = (s * 8 + i + 15) % 991;
+        s = (s * 9 + i + 16) % 983;
+        s = (s * 3 + i + 17) % 1009;
+        s = (s * 4 + i + 18) % 997;
+        s = (s * 5 + i + 19) % 991;
+        s = (s * 6 + i + 20) % 983;
+        s = (s * 7 + i + 21) % 1009;
+        s = (s * 8 + i + 22) % 997;
+        s = (s * 9 + i + 23) % 991;
+        s = (s * 3 + i + 11) % 983;
+        s = (s * 4 + i + 12) % 1009;
+        s = (s * 5 + i + 13) % 997;
+        s = (s * 6 + i + 14) % 991;
+        s = (s * 7 + i + 15) % 983;
+        s = (s * 8 + i + 16) % 1009;
+        s = (s * 9 + i + 17) % 997;
+        s = (s * 3 + i + 18) % 991;
+        s = (s * 4 + i + 19) % 983;
+        s = (s * 5 + i + 20) % 1009;
+        s = (s * 6 + i + 21) % 997;
+        s = (s * 7 + i + 22) % 991;
+        s = (s * 8 + i + 23) % 983;
+        s = (s * 9 + i + 11) % 1009;
+        s = (s * 3 + i + 12) % 997;
+        s = (s * 4 + i + 13) % 991;
+        s = (s * 5 + i + 14) % 983;
+        s = (s * 6 + i + 15) % 1009;
+        s = (s * 7 + i + 16) % 997;
+        s = (s * 8 + i + 17) % 991;
+        s = (s * 9 + i + 18) % 983;
+        s = (s * 3 + i + 19) % 1009;
+        s = (s * 4 + i + 20) % 997;
+        s = (s * 5 + i + 21) % 991;
+        s = (s * 6 + i + 22) % 983;
+        s = (s * 7 + i + 23) % 1009;
+        s = (s * 8 + i + 11) % 997;
+        s = (s * 9 + i + 12) % 991;
+        s = (s * 3 + i + 13) % 983;
+        s = (s * 4 + i + 14) % 1009;
+        s = (s * 5 + i + 15) % 997;
+        s = (s * 6 + i + 16) % 991;
+        s = (s * 7 + i + 17) % 983;
+        s = (s * 8 + i + 18) % 1009;
+        s = (s * 9 + i + 19) % 997;
+        s = (s * 3 + i + 20) % 991;
+        s = (s * 4 + i + 21) % 983;
+        s = (s * 5 + i + 22) % 1009;
+        s = (s * 6 + i + 23) % 997;
+        s = (s * 7 + i + 11) % 991;
+        s = (s * 8 + i + 12) % 983;
+        s = (s * 9 + i + 13) % 1009;
+        s = (s * 3 + i + 14) % 997;
+        s = (s * 4 + i + 15) % 991;
+        s = (s * 5 + i + 16) % 983;
+        s = (s * 6 + i + 17) % 1009;
+        s = (s * 7 + i + 18) % 997;
+        s = (s * 8 + i + 19) % 991;
+        s = (s * 9 + i + 20) % 983;
+        s = (s * 3 + i + 21) % 1009;
+        s = (s * 4 + i + 22) % 997;
+        s = (s * 5 + i + 23) % 991;
+        s = (s * 6 + i + 11) % 983;
+        s = (s * 7 + i + 12) % 1009;
+        s = (s * 8 + i + 13) % 997;
+        s = (s * 9 + i + 14) % 991;
+        s = (s * 3 + i + 15) % 983;
+        s = (s * 4 + i + 16) % 1009;
+        s = (s * 5 + i + 17) % 997;
+        s = (s * 6 + i + 18) % 991;
+        s = (s * 7 + i + 19) % 983;
+        s = (s * 8 + i + 20) % 1009;
+        s = (s * 9 + i + 21) % 997;
+        s = (s * 3 + i + 22) % 991;
+        s = (s * 4 + i + 23) % 983;
+        s = (s * 5 + i + 11) % 1009;
+        s = (s * 6 + i + 12) % 997;
+        s = (s * 7 + i + 13) % 991;
+        s = (s * 8 + i + 14) % 983;
+        i = i + 1;
+    }
+    return s;
+}
+
+int main() {
+    return mix(40);
+}
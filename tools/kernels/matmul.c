@@ -0,0 +1,24 @@
+// 4x4 integer matrix product on flattened arrays: a triply nested loop.
+int main() {
+    int a[16];
+    int b[16];
+    int c[16];
+    int i;
+    int j;
+    int k;
+    int s;
+    for (i = 0; i < 16; i = i + 1) {
+        a[i] = i + 1;
+        b[i] = 16 - i;
+    }
+    for (i = 0; i < 4; i = i + 1) {
+        for (j = 0; j < 4; j = j + 1) {
+            s = 0;
+            for (k = 0; k < 4; k = k + 1) {
+                s = s + a[i * 4 + k] * b[k * 4 + j];
+            }
+            c[i * 4 + j] = s;
+        }
+    }
+    return c[0] + c[15];
+}
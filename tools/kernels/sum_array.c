@@ -0,0 +1,14 @@
+// Fills an array and sums it: a counted loop with indexed loads and stores.
+int main() {
+    int data[32];
+    int i;
+    int total;
+    for (i = 0; i < 32; i = i + 1) {
+        data[i] = i * 3 + 1;
+    }
+    total = 0;
+    for (i = 0; i < 32; i = i + 1) {
+        total = total + data[i];
+    }
+    return total;
+}
@@ -0,0 +1,368 @@
+// Micro-benchmarks of the compiler's stages on a fixed in-memory program:
+//   lex         yylex() over the whole source                  tokens/s
+//   parse       yyparse() including AST construction           nodes/s
+//   expression  generate_expression() on every expression      instructions/s
+//   statement   generate_statement() on every function body    instructions/s
+//   liveness    IR liveness of one function of --blocks blocks block visits/s
+//   reaching    reaching stores on the same function           block visits/s
+//   available   available expressions on the same function     block visits/s
+// Each benchmark runs --warmup untimed repetitions and then --reps timed
+// ones, and reports the median and 99th percentile repetition.
+// Usage: microbench [--reps=n] [--warmup=n] [--functions=n] [--blocks=n] [benchmark...]
+#define _POSIX_C_SOURCE 200809L
+#include "compiler.h"
+#include "dataflow.h"
+#include "ir.h"
+#include "riscv.h"
+#include "parser.tab.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct yy_buffer_state* YY_BUFFER_STATE;
+YY_BUFFER_STATE yy_scan_bytes(const char* bytes, int len);
+void yy_delete_buffer(YY_BUFFER_STATE buffer);
+
+// One function of the input; %d is replaced by the function index so that
+// every function has its own name and calls the previous one.
+static const char* function_template =
+    "int f%d(int a, int b) {\n"
+    "    int c = a * 3 + b;\n"
+    "    int d = (a - b) * (c + 7) / 2;\n"
+    "    int i;\n"
+    "    int arr[16];\n"
+    "    for (i = 0; i < 16; i = i + 1) {\n"
+    "        arr[i] = i * c + d %% 5;\n"
+    "    }\n"
+    "    if (a < b && c != 0) {\n"
+    "        d = d + arr[a %% 16] - arr[b %% 16];\n"
+    "    } else {\n"
+    "        d = d - (a + b) * (c - 1);\n"
+    "    }\n"
+    "    while (c > 0) {\n"
+    "        c = c - 1;\n"
+    "        d += c * 2;\n"
+    "    }\n"
+    "    return f%d(d, c) + (a == b || !d);\n"
+    "}\n\n";
+
+// One step of the large function for the dataflow benchmarks: six blocks,
+// with values live across the loop and stores to known and computed array
+// elements. %d is the step number.
+static const char* step_template =
+    "    if (x < y + %d) {\n"
+    "        x = x + i * 3;\n"
+    "        a[i %% 8] = x;\n"
+    "    } else {\n"
+    "        y = y - x;\n"
+    "        a[%d] = y;\n"
+    "    }\n"
+    "    while (x > y) {\n"
+    "        x = x - 3;\n"
+    "        t = t + a[x %% 8] + x * y;\n"
+    "    }\n"
+    "    i = i + 1;\n";
+
+typedef struct {
+    const char* name;
+    const char* unit;
+    // Runs the benchmark once and returns the number of units processed.
+    long (*run)(void);
+} Benchmark;
+
+static char* source;
+static size_t source_len;
+static ASTNode* program;
+
+static void build_source(int functions) {
+    FILE* output = open_memstream(&source, &source_len);
+    if (!output) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    for (int i = 0; i < functions; i++) fprintf(output, function_template, i, i > 0 ? i - 1 : 0);
+    fclose(output);
+}
+
+static long count_nodes(ASTNode* node) {
+    long count = 0;
+    for (; node; node = node->next) count += 1 + count_nodes(node->left) + count_nodes(node->right);
+    return count;
+}
+
+static ASTNode* parse_text(const char* text, size_t len) {
+    root = NULL;
+    yylineno = 1;
+    YY_BUFFER_STATE buffer = yy_scan_bytes(text, (int)len);
+    int parsed = yyparse() == 0;
+    yy_delete_buffer(buffer);
+    if (!parsed) {
+        fprintf(stderr, "Error: Benchmark input does not parse\n");
+        exit(1);
+    }
+    return root;
+}
+
+static ASTNode* parse_source(void) {
+    return parse_text(source, source_len);
+}
+
+// Listing written by the code generator benchmarks.
+static FILE* sink;
+static char* sink_buffer;
+static size_t sink_size;
+
+static void open_sink(void) {
+    sink = open_memstream(&sink_buffer, &sink_size);
+    if (!sink) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+}
+
+// Closes the listing and counts its instructions: the indented lines, not
+// labels or the directives of the prologue.
+static long close_sink(void) {
+    fclose(sink);
+    long count = 0;
+    for (size_t i = 0; i + 4 < sink_size; i++) {
+        if ((i == 0 || sink_buffer[i - 1] == '\n') && strncmp(sink_buffer + i, "    ", 4) == 0
+            && sink_buffer[i + 4] != '.') {
+            count++;
+        }
+    }
+    free(sink_buffer);
+    return count;
+}
+
+static long run_lex(void) {
+    long tokens = 0;
+    yylineno = 1;
+    YY_BUFFER_STATE buffer = yy_scan_bytes(source, (int)source_len);
+    int token;
+    while ((token = yylex()) != 0) {
+        if (token == IDENTIFIER || token == STRING_LITERAL || token == CHAR_LITERAL) free(yylval.str);
+        tokens++;
+    }
+    yy_delete_buffer(buffer);
+    return tokens;
+}
+
+static long run_parse(void) {
+    ASTNode* tree = parse_source();
+    long nodes = count_nodes(tree);
+    free_ast(tree);
+    root = NULL;
+    return nodes;
+}
+
+static void expressions_in(ASTNode* node) {
+    for (; node; node = node->next) {
+        switch (node->type) {
+            case NODE_ASSIGNMENT:
+            case NODE_DECLARATION:
+            case NODE_RETURN:
+                if (node->right) generate_expression(node->right, sink, A0);
+                if (node->left && node->type == NODE_RETURN) generate_expression(node->left, sink, A0);
+                break;
+            case NODE_IF:
+            case NODE_WHILE:
+                generate_expression(node->left, sink, A0);
+                expressions_in(node->right);
+                break;
+            case NODE_ELSE:
+                expressions_in(node->right);
+                break;
+            case NODE_FOR: {
+                // The condition, iteration and body are chained on ->right.
+                ASTNode* condition = node->right;
+                if (node->left) generate_expression(node->left, sink, A0);
+                if (condition) generate_expression(condition, sink, A0);
+                if (condition && condition->next) {
+                    generate_expression(condition->next, sink, A0);
+                    expressions_in(condition->next->next);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+static long run_expression(void) {
+    open_sink();
+    reset_codegen_state();
+    for (ASTNode* function = program; function; function = function->next) expressions_in(function->right);
+    return close_sink();
+}
+
+static long run_statement(void) {
+    open_sink();
+    reset_codegen_state();
+    for (ASTNode* function = program; function; function = function->next) {
+        generate_statement(function->right, sink);
+    }
+    return close_sink();
+}
+
+static IrFunction* large_function;
+
+static void build_large_function(int blocks) {
+    char* text;
+    size_t len;
+    FILE* output = open_memstream(&text, &len);
+    if (!output) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    fprintf(output, "int large(int p, int q) {\n    int x = p;\n    int y = q;\n    int t = 0;\n    int i = 0;\n"
+                    "    int a[8];\n");
+    for (int step = 0; step < blocks / 6 + 1; step++) fprintf(output, step_template, step % 16, step % 8);
+    fprintf(output, "    return t;\n}\n");
+    fclose(output);
+    ASTNode* tree = parse_text(text, len);
+    large_function = ir_lower_function(tree);
+    free_ast(tree);
+    root = NULL;
+    free(text);
+}
+
+static long run_liveness(void) {
+    IrLiveness liveness;
+    ir_liveness(&liveness, large_function, NULL, NULL);
+    long visits = liveness.flow.visits;
+    ir_liveness_free(&liveness);
+    return visits;
+}
+
+static long run_reaching(void) {
+    IrReaching reaching;
+    ir_reaching_definitions(&reaching, large_function);
+    long visits = reaching.flow.visits;
+    ir_reaching_free(&reaching);
+    return visits;
+}
+
+static long run_available(void) {
+    IrAvailable available;
+    ir_available_expressions(&available, large_function);
+    long visits = available.flow.visits;
+    ir_available_free(&available);
+    return visits;
+}
+
+static const Benchmark benchmarks[] = {
+    { "lex", "tokens", run_lex },
+    { "parse", "nodes", run_parse },
+    { "expression", "instructions", run_expression },
+    { "statement", "instructions", run_statement },
+    { "liveness", "visits", run_liveness },
+    { "reaching", "visits", run_reaching },
+    { "available", "visits", run_available },
+};
+// Benchmarks from this one on use the large IR function.
+#define FIRST_DATAFLOW_BENCHMARK 4
+#define BENCHMARK_COUNT (int)(sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+static double seconds_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+static int by_value(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+// Nearest-rank percentile of a sorted array.
+static double percentile(const double* sorted, int count, double p) {
+    int rank = (int)(p / 100.0 * count + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+static void run_benchmark(const Benchmark* benchmark, int warmup, int reps) {
+    double* times = malloc((size_t)reps * sizeof(double));
+    if (times == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    long units = 0;
+    for (int i = 0; i < warmup; i++) benchmark->run();
+    for (int i = 0; i < reps; i++) {
+        double start = seconds_now();
+        units = benchmark->run();
+        times[i] = seconds_now() - start;
+    }
+    qsort(times, (size_t)reps, sizeof(double), by_value);
+    double median = percentile(times, reps, 50);
+    double p99 = percentile(times, reps, 99);
+    printf("%-12s %10ld %-12s %10.3f ms %10.3f ms %12.0f %s/s\n", benchmark->name, units, benchmark->unit,
+           median * 1e3, p99 * 1e3, median > 0 ? (double)units / median : 0.0, benchmark->unit);
+    free(times);
+}
+
+static int parse_count(const char* arg, const char* name, int* value) {
+    size_t length = strlen(name);
+    if (strncmp(arg, name, length) != 0 || arg[length] != '=') return 0;
+    *value = atoi(arg + length + 1);
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    int reps = 30;
+    int warmup = 3;
+    int functions = 500;
+    int blocks = 12000;
+    int selected[BENCHMARK_COUNT] = {0};
+    int any_selected = 0;
+    for (int i = 1; i < argc; i++) {
+        if (parse_count(argv[i], "--reps", &reps) || parse_count(argv[i], "--warmup", &warmup)
+            || parse_count(argv[i], "--functions", &functions) || parse_count(argv[i], "--blocks", &blocks)) {
+            continue;
+        }
+        int found = 0;
+        for (int b = 0; b < BENCHMARK_COUNT; b++) {
+            if (strcmp(argv[i], benchmarks[b].name) == 0) selected[b] = found = any_selected = 1;
+        }
+        if (!found) {
+            fprintf(stderr,
+                    "Usage: %s [--reps=n] [--warmup=n] [--functions=n] [--blocks=n] "
+                    "[lex|parse|expression|statement|liveness|reaching|available]...\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (reps < 1 || functions < 1 || blocks < 1 || warmup < 0) {
+        fprintf(stderr, "Error: --reps, --functions and --blocks must be positive\n");
+        return 1;
+    }
+
+    build_source(functions);
+    program = parse_source();
+
+    int dataflow = 0;
+    for (int b = FIRST_DATAFLOW_BENCHMARK; b < BENCHMARK_COUNT; b++) dataflow |= !any_selected || selected[b];
+    if (dataflow) build_large_function(blocks);
+
+    printf("Input: %d functions, %zu bytes; %d warm-up and %d timed repetitions\n", functions, source_len, warmup,
+           reps);
+    if (dataflow) {
+        printf("Dataflow input: one function of %d blocks and %d instructions\n", large_function->block_count,
+               large_function->insn_count);
+    }
+    printf("%-12s %10s %-12s %13s %13s %16s\n", "benchmark", "units", "", "median", "p99", "rate");
+    for (int b = 0; b < BENCHMARK_COUNT; b++) {
+        if (!any_selected || selected[b]) run_benchmark(&benchmarks[b], warmup, reps);
+    }
+
+    if (large_function) ir_function_free(large_function);
+    free_ast(program);
+    free(source);
+    return 0;
+}
@@ -0,0 +1,786 @@
+// Performance fuzzer: looks for Small C inputs whose compile time or peak
+// memory grows superlinearly with their size.
+//
+// A candidate is a pattern, prefix + open*k + core + close*k + suffix, built
+// from the grammar for one context (a list of functions, statements,
+// arguments or parameters, a chain of operators, or nested blocks and
+// expressions). Each candidate is compiled in a child process for doubling
+// k until the input is --max-bytes long or a compile takes --max-time
+// seconds, and the growth exponent of CPU time and peak RSS over input size
+// is fitted on the largest sizes. Candidates are mutated by regenerating one
+// of their parts from the grammar, preferring the steepest ones seen so far.
+// Patterns above --threshold are minimized token by token and written to the
+// corpus directory; --replay re-measures a corpus and fails if any entry is
+// still superlinear. Inputs are compiled at -O0 unless another level is
+// given, which puts the IR pipeline (SSA construction, dataflow, loop,
+// dependence and range analyses) under test.
+//
+// Usage: perf_fuzz [-O0|-O1|-O2|-Os] [--seed=n] [--iterations=n] [--corpus=dir]
+//                  [--threshold=x] [--max-bytes=n] [--max-time=s]
+//        perf_fuzz [-O0|-O1|-O2|-Os] --replay=dir [--threshold=x]
+#define _GNU_SOURCE
+#include "compiler.h"
+#include "driver.h"
+#include <dirent.h>
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define POOL_SIZE 8
+#define MAX_POINTS 32
+#define FIT_POINTS 4
+#define RUNS_PER_SIZE 3
+#define MIN_FIT_SECONDS 0.002
+#define MIN_FIT_RSS_KB 1024
+#define CHILD_TIMEOUT_S 20
+
+typedef enum {
+    CTX_FUNCTIONS,
+    CTX_STATEMENTS,
+    CTX_NESTED_STATEMENTS,
+    CTX_ELSE_CHAIN,
+    CTX_OPERATOR_CHAIN,
+    CTX_NESTED_EXPRESSION,
+    CTX_ARGUMENTS,
+    CTX_PARAMETERS,
+    CTX_COUNT
+} Context;
+
+enum { PART_PREFIX, PART_OPEN, PART_CORE, PART_CLOSE, PART_SUFFIX, PART_COUNT };
+
+typedef struct {
+    Context context;
+    char* parts[PART_COUNT];
+} Pattern;
+
+typedef struct {
+    double time_slope;
+    double memory_slope;
+    int points;
+    size_t largest_bytes;
+    double largest_seconds;
+    const char* stopped;    // why scaling stopped early, or NULL
+} Measurement;
+
+typedef struct {
+    Pattern pattern;
+    double score;
+} PoolEntry;
+
+static const char* context_names[CTX_COUNT] = {
+    "functions", "statements", "nested-statements", "else-chain",
+    "operator-chain", "nested-expression", "arguments", "parameters"
+};
+static const char* part_names[PART_COUNT] = { "prefix", "open", "core", "close", "suffix" };
+
+static uint64_t rng_state;
+static size_t max_bytes = 256 * 1024;
+static double max_time = 0.5;
+static double threshold = 1.3;
+static long base_rss_kb;
+
+// --- Random grammar productions -------------------------------------------
+
+static uint64_t next_random(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+static int below(int n) {
+    return n > 0 ? (int)(next_random() % (uint64_t)n) : 0;
+}
+
+static void out_of_memory(void) {
+    fprintf(stderr, "Memory allocation failed\n");
+    exit(1);
+}
+
+typedef struct {
+    char* data;
+    size_t len;
+    size_t cap;
+} Text;
+
+static void text_append(Text* text, const char* s) {
+    size_t n = strlen(s);
+    if (text->len + n + 1 > text->cap) {
+        text->cap = (text->len + n + 1) * 2;
+        text->data = realloc(text->data, text->cap);
+        if (text->data == NULL) out_of_memory();
+    }
+    memcpy(text->data + text->len, s, n + 1);
+    text->len += n;
+}
+
+static char* text_take(Text* text) {
+    if (text->data == NULL) text_append(text, "");
+    char* data = text->data;
+    memset(text, 0, sizeof(*text));
+    return data;
+}
+
+static void gen_expression(Text* text, int depth) {
+    static const char* names[] = { "x", "y", "n", "i" };
+    static const char* ops[] = { "+", "-", "*", "/", "%", "<", ">", "==", "!=", "<=", ">=", "&&", "||" };
+    char buffer[32];
+    int choice = depth <= 0 ? below(4) : below(9);
+    switch (choice) {
+        case 0:
+        case 1:
+            text_append(text, names[below(4)]);
+            break;
+        case 2:
+            snprintf(buffer, sizeof(buffer), "%d", below(100));
+            text_append(text, buffer);
+            break;
+        case 3:
+            text_append(text, below(2) ? "arr [ i ]" : "f ( x )");
+            break;
+        case 4:
+            text_append(text, below(2) ? "- " : "! ");
+            gen_expression(text, depth - 1);
+            break;
+        case 5:
+            text_append(text, "( ");
+            gen_expression(text, depth - 1);
+            text_append(text, " )");
+            break;
+        case 6:
+            text_append(text, "f ( ");
+            gen_expression(text, depth - 1);
+            text_append(text, " , ");
+            gen_expression(text, depth - 1);
+            text_append(text, " )");
+            break;
+        default:
+            gen_expression(text, depth - 1);
+            text_append(text, " ");
+            text_append(text, ops[below(13)]);
+            text_append(text, " ");
+            gen_expression(text, depth - 1);
+            break;
+    }
+}
+
+static void gen_statement(Text* text, int depth) {
+    int choice = depth <= 0 ? below(4) : below(10);
+    switch (choice) {
+        case 0:
+        case 1:
+            text_append(text, below(2) ? "x = " : "y += ");
+            gen_expression(text, 2);
+            text_append(text, " ;\n");
+            break;
+        case 2:
+            text_append(text, "int v = ");
+            gen_expression(text, 1);
+            text_append(text, " ;\n");
+            break;
+        case 3:
+            text_append(text, "f ( ");
+            gen_expression(text, 1);
+            text_append(text, " ) ;\n");
+            break;
+        case 4:
+        case 5:
+            text_append(text, "if ( ");
+            gen_expression(text, 1);
+            text_append(text, " ) ");
+            gen_statement(text, depth - 1);
+            if (choice == 5) {
+                text_append(text, "else ");
+                gen_statement(text, depth - 1);
+            }
+            break;
+        case 6:
+            text_append(text, "while ( ");
+            gen_expression(text, 1);
+            text_append(text, " ) ");
+            gen_statement(text, depth - 1);
+            break;
+        case 7:
+            text_append(text, "for ( i = 0 ; i < ");
+            gen_expression(text, 1);
+            text_append(text, " ; i = i + 1 ) ");
+            gen_statement(text, depth - 1);
+            break;
+        case 8:
+            text_append(text, "{\n");
+            gen_statement(text, depth - 1);
+            gen_statement(text, depth - 1);
+            text_append(text, "}\n");
+            break;
+        default:
+            text_append(text, "return ");
+            gen_expression(text, 1);
+            text_append(text, " ;\n");
+            break;
+    }
+}
+
+static char* expression_part(int depth) {
+    Text text = {0};
+    gen_expression(&text, depth);
+    return text_take(&text);
+}
+
+static char* statement_part(int depth) {
+    Text text = {0};
+    gen_statement(&text, depth);
+    return text_take(&text);
+}
+
+static char* function_part(void) {
+    Text text = {0};
+    text_append(&text, below(2) ? "int g ( int x ) {\n" : "void h ( ) {\n");
+    int statements = 1 + below(3);
+    for (int i = 0; i < statements; i++) gen_statement(&text, 2);
+    text_append(&text, "}\n");
+    return text_take(&text);
+}
+
+// Opening halves of the nesting constructs, with the matching close.
+static void nesting_part(Context context, char** open, char** close) {
+    Text text = {0};
+    if (context == CTX_NESTED_STATEMENTS) {
+        static const char* heads[] = { "if ( ", "while ( ", "for ( i = 0 ; i < " };
+        int kind = below(4);
+        if (below(2)) gen_statement(&text, 0);
+        if (kind == 3) {
+            text_append(&text, "{\n");
+        } else {
+            text_append(&text, heads[kind]);
+            gen_expression(&text, 1);
+            text_append(&text, kind == 2 ? " ; i = i + 1 ) {\n" : " ) {\n");
+        }
+        *open = text_take(&text);
+        if (below(2)) gen_statement(&text, 0);
+        text_append(&text, "}\n");
+        *close = text_take(&text);
+    } else {
+        static const char* opens[] = { "( ", "- ", "! ", "f ( ", "arr [ ", NULL };
+        static const char* closes[] = { " )", "", "", " )", " ]", " )" };
+        int kind = below(6);
+        if (opens[kind]) {
+            text_append(&text, opens[kind]);
+        } else {
+            // "( e op ... )": left operand, then the nested right operand.
+            static const char* ops[] = { "+", "*", "<", "&&", "-" };
+            text_append(&text, "( ");
+            gen_expression(&text, 1);
+            text_append(&text, " ");
+            text_append(&text, ops[below(5)]);
+            text_append(&text, " ");
+        }
+        *open = text_take(&text);
+        text_append(&text, closes[kind]);
+        *close = text_take(&text);
+    }
+}
+
+static const char* main_prefix = "int main ( ) {\nint x ;\nint y ;\nint n ;\nint i ;\nint arr [ 8 ] ;\n";
+
+// Regenerates one varying part of the pattern, or all of them for part < 0.
+static void regenerate(Pattern* pattern, int part) {
+    Context context = pattern->context;
+    char* fresh[PART_COUNT] = {0};
+    switch (context) {
+        case CTX_FUNCTIONS:
+            fresh[PART_OPEN] = function_part();
+            break;
+        case CTX_STATEMENTS:
+            fresh[PART_OPEN] = statement_part(2);
+            break;
+        case CTX_NESTED_STATEMENTS:
+        case CTX_NESTED_EXPRESSION:
+            nesting_part(context, &fresh[PART_OPEN], &fresh[PART_CLOSE]);
+            fresh[PART_CORE] = context == CTX_NESTED_STATEMENTS ? statement_part(1) : expression_part(1);
+            break;
+        case CTX_ELSE_CHAIN: {
+            Text text = {0};
+            text_append(&text, "if ( ");
+            gen_expression(&text, 1);
+            text_append(&text, " ) ");
+            gen_statement(&text, 1);
+            text_append(&text, "else ");
+            fresh[PART_OPEN] = text_take(&text);
+            fresh[PART_CORE] = statement_part(1);
+            break;
+        }
+        case CTX_OPERATOR_CHAIN: {
+            static const char* ops[] = { "+", "-", "*", "/", "<", "==", "&&", "||" };
+            Text text = {0};
+            gen_expression(&text, below(2));
+            text_append(&text, " ");
+            text_append(&text, ops[below(8)]);
+            text_append(&text, " ");
+            fresh[PART_OPEN] = text_take(&text);
+            fresh[PART_CORE] = expression_part(1);
+            break;
+        }
+        case CTX_ARGUMENTS: {
+            Text text = {0};
+            gen_expression(&text, 1);
+            text_append(&text, " , ");
+            fresh[PART_OPEN] = text_take(&text);
+            fresh[PART_CORE] = expression_part(1);
+            break;
+        }
+        case CTX_PARAMETERS:
+            fresh[PART_OPEN] = strdup(below(2) ? "int p , " : "char c , ");
+            fresh[PART_CORE] = strdup("int q");
+            break;
+        default:
+            break;
+    }
+    // The surroundings only depend on the context.
+    static const char* prefixes[CTX_COUNT] = { "", NULL, NULL, NULL, NULL, NULL, NULL, "int f ( " };
+    static const char* suffixes[CTX_COUNT] = {
+        "", "return 0 ;\n}\n", "return 0 ;\n}\n", "return 0 ;\n}\n", " ;\nreturn 0 ;\n}\n",
+        " ;\nreturn 0 ;\n}\n", " ) ;\nreturn 0 ;\n}\n", " ) {\nreturn q ;\n}\n"
+    };
+    Text prefix = {0};
+    text_append(&prefix, prefixes[context] ? prefixes[context] : main_prefix);
+    if (context == CTX_OPERATOR_CHAIN || context == CTX_NESTED_EXPRESSION) text_append(&prefix, "x = ");
+    if (context == CTX_ARGUMENTS) text_append(&prefix, "f ( ");
+    fresh[PART_PREFIX] = text_take(&prefix);
+    fresh[PART_SUFFIX] = strdup(suffixes[context]);
+
+    int nesting = context == CTX_NESTED_STATEMENTS || context == CTX_NESTED_EXPRESSION;
+    for (int i = 0; i < PART_COUNT; i++) {
+        if (fresh[i] == NULL) fresh[i] = strdup("");
+        if (fresh[i] == NULL) out_of_memory();
+        // Nesting constructs change their open and close halves together.
+        int paired = nesting && (i == PART_OPEN || i == PART_CLOSE) && (part == PART_OPEN || part == PART_CLOSE);
+        if (part < 0 || i == part || paired || pattern->parts[i] == NULL || i == PART_PREFIX || i == PART_SUFFIX) {
+            free(pattern->parts[i]);
+            pattern->parts[i] = fresh[i];
+        } else {
+            free(fresh[i]);
+        }
+    }
+}
+
+static void pattern_free(Pattern* pattern) {
+    for (int i = 0; i < PART_COUNT; i++) {
+        free(pattern->parts[i]);
+        pattern->parts[i] = NULL;
+    }
+}
+
+static void pattern_copy(Pattern* to, const Pattern* from) {
+    to->context = from->context;
+    for (int i = 0; i < PART_COUNT; i++) {
+        to->parts[i] = strdup(from->parts[i]);
+        if (to->parts[i] == NULL) out_of_memory();
+    }
+}
+
+static char* pattern_instance(const Pattern* pattern, long k, size_t* len) {
+    Text text = {0};
+    text_append(&text, pattern->parts[PART_PREFIX]);
+    for (long i = 0; i < k; i++) text_append(&text, pattern->parts[PART_OPEN]);
+    text_append(&text, pattern->parts[PART_CORE]);
+    for (long i = 0; i < k; i++) text_append(&text, pattern->parts[PART_CLOSE]);
+    text_append(&text, pattern->parts[PART_SUFFIX]);
+    *len = text.len;
+    return text_take(&text);
+}
+
+// --- Measurement -----------------------------------------------------------
+
+typedef struct {
+    int status;         // 0 compiled, 1 rejected by the compiler, 2 crashed or timed out
+    double seconds;     // user + system CPU time of the child
+    long rss_kb;
+} RunResult;
+
+static RunResult compile_in_child(const char* source, size_t len) {
+    RunResult result = { 2, 0, 0 };
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        exit(1);
+    }
+    if (pid == 0) {
+        alarm(CHILD_TIMEOUT_S);
+        // Diagnostics of rejected inputs are expected; keep them quiet.
+        if (!freopen("/dev/null", "w", stderr)) _exit(3);
+        char* assembly = NULL;
+        size_t assembly_len = 0;
+        _exit(compile_buffer(source, len, &assembly, &assembly_len) == 0 ? 0 : 1);
+    }
+    int status;
+    struct rusage usage;
+    while (wait4(pid, &status, 0, &usage) < 0) {
+        if (errno != EINTR) return result;
+    }
+    result.seconds = (double)usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+                   + (double)usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+    result.rss_kb = usage.ru_maxrss;
+    if (WIFEXITED(status) && WEXITSTATUS(status) <= 1) result.status = WEXITSTATUS(status);
+    return result;
+}
+
+// Least-squares slope of log(y) over log(x) for the last FIT_POINTS points
+// with y >= min_y.
+static double fit_slope(const double* x, const double* y, int count, double min_y) {
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    int used = 0;
+    for (int i = count - 1; i >= 0 && used < FIT_POINTS; i--) {
+        if (y[i] < min_y) break;
+        double lx = log(x[i]), ly = log(y[i]);
+        sx += lx;
+        sy += ly;
+        sxx += lx * lx;
+        sxy += lx * ly;
+        used++;
+    }
+    if (used < 3) return 0;
+    double denominator = used * sxx - sx * sx;
+    return denominator > 0 ? (used * sxy - sx * sy) / denominator : 0;
+}
+
+static Measurement measure(const Pattern* pattern) {
+    Measurement m = { 0, 0, 0, 0, 0, NULL };
+    double bytes[MAX_POINTS], seconds[MAX_POINTS], rss[MAX_POINTS];
+    int count = 0;
+    for (long k = 1; count < MAX_POINTS; k *= 2) {
+        size_t len;
+        char* source = pattern_instance(pattern, k, &len);
+        if (len > max_bytes && count > 0) {
+            free(source);
+            break;
+        }
+        RunResult best = { 2, 0, 0 };
+        for (int run = 0; run < RUNS_PER_SIZE; run++) {
+            RunResult result = compile_in_child(source, len);
+            if (result.status != 0) {
+                best = result;
+                break;
+            }
+            if (best.status != 0 || result.seconds < best.seconds) best = result;
+            // Slow sizes are not repeated; their noise is relatively small.
+            if (result.seconds > max_time / 4) break;
+        }
+        free(source);
+        if (best.status != 0) {
+            m.stopped = best.status == 1 ? "rejected" : "crashed or timed out";
+            break;
+        }
+        bytes[count] = (double)len;
+        seconds[count] = best.seconds;
+        rss[count] = (double)(best.rss_kb - base_rss_kb);
+        m.largest_bytes = len;
+        m.largest_seconds = best.seconds;
+        count++;
+        if (best.seconds > max_time) break;
+    }
+    m.points = count;
+    m.time_slope = fit_slope(bytes, seconds, count, MIN_FIT_SECONDS);
+    m.memory_slope = fit_slope(bytes, rss, count, MIN_FIT_RSS_KB);
+    return m;
+}
+
+static int superlinear(const Measurement* m) {
+    return m->time_slope > threshold || m->memory_slope > threshold;
+}
+
+static void print_measurement(const char* label, const Pattern* pattern, const Measurement* m) {
+    printf("%-10s %-18s time^%.2f memory^%.2f  %zu bytes in %.3f s%s%s\n", label, context_names[pattern->context],
+           m->time_slope, m->memory_slope, m->largest_bytes, m->largest_seconds, m->stopped ? ", stopped: " : "",
+           m->stopped ? m->stopped : "");
+}
+
+// --- Minimization and the corpus ------------------------------------------
+
+static int still_superlinear(const Pattern* pattern) {
+    size_t len;
+    char* source = pattern_instance(pattern, 2, &len);
+    RunResult result = compile_in_child(source, len);
+    free(source);
+    if (result.status != 0) return 0;
+    Measurement m = measure(pattern);
+    return superlinear(&m);
+}
+
+// Removes tokens (space separated) from the repeated parts while the
+// pattern stays valid and superlinear: chunks of halving size, one pass each.
+static void minimize(Pattern* pattern, int budget) {
+    for (int part = PART_OPEN; part <= PART_CLOSE && budget > 0; part++) {
+        for (size_t chunk = strlen(pattern->parts[part]) / 2; chunk >= 1 && budget > 0; chunk /= 2) {
+            size_t start = 0;
+            while (budget > 0) {
+                char* text = pattern->parts[part];
+                size_t len = strlen(text);
+                while (start < len && text[start] == ' ') start++;
+                if (start >= len) break;
+                size_t end = start;
+                for (size_t tokens = 0; end < len && tokens < chunk; tokens++) {
+                    while (end < len && text[end] != ' ' && text[end] != '\n') end++;
+                    while (end < len && (text[end] == ' ' || text[end] == '\n')) end++;
+                }
+                char* candidate = malloc(len + 1);
+                if (candidate == NULL) out_of_memory();
+                memcpy(candidate, text, start);
+                strcpy(candidate + start, text + end);
+                pattern->parts[part] = candidate;
+                budget--;
+                if (still_superlinear(pattern)) {
+                    free(text);
+                } else {
+                    pattern->parts[part] = text;
+                    free(candidate);
+                    start = end;
+                }
+            }
+            if (chunk == 1) break;
+        }
+    }
+}
+
+static void write_escaped(FILE* output, const char* s) {
+    for (; *s; s++) {
+        if (*s == '\n') {
+            fputs("\\n", output);
+        } else if (*s == '\\') {
+            fputs("\\\\", output);
+        } else {
+            fputc(*s, output);
+        }
+    }
+}
+
+static uint64_t pattern_hash(const Pattern* pattern) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (int i = 0; i < PART_COUNT; i++) {
+        for (const char* s = pattern->parts[i]; *s; s++) hash = (hash ^ (unsigned char)*s) * 1099511628211ULL;
+        hash = (hash ^ 0xff) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static void save_reproducer(const char* corpus, const Pattern* pattern, const Measurement* m) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s-%08llx.pattern", corpus, context_names[pattern->context],
+             (unsigned long long)(pattern_hash(pattern) & 0xffffffffULL));
+    if (access(path, F_OK) == 0) return;
+    mkdir(corpus, 0755);
+    FILE* output = fopen(path, "w");
+    if (!output) {
+        fprintf(stderr, "Error: Cannot create %s\n", path);
+        return;
+    }
+    fprintf(output, "# time^%.2f memory^%.2f when found; input = prefix + open*k + core + close*k + suffix\n",
+            m->time_slope, m->memory_slope);
+    fprintf(output, "context %s\n", context_names[pattern->context]);
+    for (int i = 0; i < PART_COUNT; i++) {
+        fprintf(output, "%s ", part_names[i]);
+        write_escaped(output, pattern->parts[i]);
+        fputc('\n', output);
+    }
+    fclose(output);
+    printf("saved      %s\n", path);
+}
+
+static int load_pattern(const char* path, Pattern* pattern) {
+    FILE* input = fopen(path, "r");
+    if (!input) return -1;
+    memset(pattern, 0, sizeof(*pattern));
+    pattern->context = CTX_COUNT;
+    char* line = NULL;
+    size_t capacity = 0;
+    ssize_t len;
+    while ((len = getline(&line, &capacity, input)) >= 0) {
+        if (len > 0 && line[len - 1] == '\n') line[--len] = '\0';
+        if (line[0] == '#' || line[0] == '\0') continue;
+        char* value = strchr(line, ' ');
+        value = value ? value + 1 : line + len;
+        if (strncmp(line, "context ", 8) == 0) {
+            for (int c = 0; c < CTX_COUNT; c++) {
+                if (strcmp(value, context_names[c]) == 0) pattern->context = (Context)c;
+            }
+            continue;
+        }
+        for (int i = 0; i < PART_COUNT; i++) {
+            size_t name_len = strlen(part_names[i]);
+            if (strncmp(line, part_names[i], name_len) != 0 || (line[name_len] != ' ' && line[name_len] != '\0')) {
+                continue;
+            }
+            char* unescaped = malloc(strlen(value) + 1);
+            if (unescaped == NULL) out_of_memory();
+            char* to = unescaped;
+            for (const char* from = value; *from; from++) {
+                if (*from == '\\' && from[1]) {
+                    from++;
+                    *to++ = *from == 'n' ? '\n' : *from;
+                } else {
+                    *to++ = *from;
+                }
+            }
+            *to = '\0';
+            free(pattern->parts[i]);
+            pattern->parts[i] = unescaped;
+        }
+    }
+    free(line);
+    fclose(input);
+    for (int i = 0; i < PART_COUNT; i++) {
+        if (pattern->parts[i] == NULL) pattern->parts[i] = strdup("");
+    }
+    return pattern->context == CTX_COUNT ? -1 : 0;
+}
+
+static int by_name(const struct dirent** a, const struct dirent** b) {
+    return strcmp((*a)->d_name, (*b)->d_name);
+}
+
+static int replay(const char* corpus) {
+    struct dirent** entries;
+    int count = scandir(corpus, &entries, NULL, by_name);
+    if (count < 0) {
+        fprintf(stderr, "Error: Cannot read corpus %s\n", corpus);
+        return 1;
+    }
+    int failures = 0, replayed = 0;
+    for (int i = 0; i < count; i++) {
+        const char* name = entries[i]->d_name;
+        size_t len = strlen(name);
+        if (len > 8 && strcmp(name + len - 8, ".pattern") == 0) {
+            char path[4096];
+            snprintf(path, sizeof(path), "%s/%s", corpus, name);
+            Pattern pattern;
+            if (load_pattern(path, &pattern) != 0) {
+                fprintf(stderr, "Error: Malformed pattern %s\n", path);
+                failures++;
+            } else {
+                Measurement m = measure(&pattern);
+                int bad = superlinear(&m);
+                print_measurement(bad ? "FAIL" : "ok", &pattern, &m);
+                failures += bad;
+                replayed++;
+            }
+            pattern_free(&pattern);
+        }
+        free(entries[i]);
+    }
+    free(entries);
+    printf("%d of %d corpus entries superlinear (threshold %.2f)\n", failures, replayed, threshold);
+    return failures ? 1 : 0;
+}
+
+// --- Driver ------------------------------------------------------------------
+
+static int parse_number(const char* arg, const char* name, double* value) {
+    size_t length = strlen(name);
+    if (strncmp(arg, name, length) != 0 || arg[length] != '=') return 0;
+    *value = atof(arg + length + 1);
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    double seed = 1, iterations = 20, bytes = (double)max_bytes;
+    const char* corpus = "tools/perf_corpus";
+    const char* replay_dir = NULL;
+    OptLevel level = OPT_O0;
+    for (int i = 1; i < argc; i++) {
+        if (parse_opt_level(argv[i], &level) == 0) {
+            // Applies to every compile below.
+        } else if (strncmp(argv[i], "--corpus=", 9) == 0) {
+            corpus = argv[i] + 9;
+        } else if (strncmp(argv[i], "--replay=", 9) == 0) {
+            replay_dir = argv[i] + 9;
+        } else if (!parse_number(argv[i], "--seed", &seed) && !parse_number(argv[i], "--iterations", &iterations)
+                   && !parse_number(argv[i], "--threshold", &threshold)
+                   && !parse_number(argv[i], "--max-bytes", &bytes)
+                   && !parse_number(argv[i], "--max-time", &max_time)) {
+            fprintf(stderr, "Usage: %s [-O0|-O1|-O2|-Os] [--seed=n] [--iterations=n] [--corpus=dir]\n"
+                            "          [--threshold=x] [--max-bytes=n] [--max-time=s]\n"
+                            "       %s [-O0|-O1|-O2|-Os] --replay=dir [--threshold=x]\n", argv[0], argv[0]);
+            return 1;
+        }
+    }
+    max_bytes = (size_t)bytes;
+    compile_buffer_set_options(level, 0, NULL);
+
+    // Peak RSS of compiling an empty program; memory growth is measured on top.
+    const char* empty = "int main ( ) {\nreturn 0 ;\n}\n";
+    base_rss_kb = compile_in_child(empty, strlen(empty)).rss_kb;
+
+    if (replay_dir) return replay(replay_dir);
+
+    rng_state = (uint64_t)seed * 0x9E3779B97F4A7C15ULL + 0x632BE59BD9B4E019ULL;
+    PoolEntry pool[POOL_SIZE];
+    int pool_count = 0;
+    int found = 0;
+    // One reproducer per context and run, so a single cause does not flood
+    // the corpus with variants.
+    int saved[CTX_COUNT] = {0};
+    for (int iteration = 0; iteration < (int)iterations; iteration++) {
+        Pattern candidate = {0};
+        if (pool_count == 0 || below(10) < 3) {
+            candidate.context = (Context)below(CTX_COUNT);
+            regenerate(&candidate, -1);
+        } else {
+            pattern_copy(&candidate, &pool[below(pool_count)].pattern);
+            static const int parts[] = { PART_OPEN, PART_CORE, PART_CLOSE };
+            regenerate(&candidate, parts[below(3)]);
+        }
+        Measurement m = measure(&candidate);
+        if (m.points == 0) {
+            pattern_free(&candidate);
+            continue;
+        }
+        print_measurement(superlinear(&m) ? "FOUND" : "tried", &candidate, &m);
+
+        if (superlinear(&m)) found++;
+        if (superlinear(&m) && !saved[candidate.context]) {
+            saved[candidate.context] = 1;
+            Pattern reduced;
+            pattern_copy(&reduced, &candidate);
+            minimize(&reduced, 24);
+            Measurement reduced_m = measure(&reduced);
+            if (superlinear(&reduced_m)) {
+                print_measurement("minimized", &reduced, &reduced_m);
+                save_reproducer(corpus, &reduced, &reduced_m);
+            } else {
+                save_reproducer(corpus, &candidate, &m);
+            }
+            pattern_free(&reduced);
+        }
+
+        // Keep the steepest candidates as parents for later mutations.
+        double score = m.time_slope > m.memory_slope ? m.time_slope : m.memory_slope;
+        int slot = pool_count < POOL_SIZE ? pool_count++ : -1;
+        if (slot < 0) {
+            int worst = 0;
+            for (int i = 1; i < POOL_SIZE; i++) {
+                if (pool[i].score < pool[worst].score) worst = i;
+            }
+            if (pool[worst].score < score) {
+                pattern_free(&pool[worst].pattern);
+                slot = worst;
+            }
+        }
+        if (slot >= 0) {
+            pool[slot].pattern = candidate;
+            pool[slot].score = score;
+        } else {
+            pattern_free(&candidate);
+        }
+    }
+    for (int i = 0; i < pool_count; i++) pattern_free(&pool[i].pattern);
+    printf("%d superlinear candidates found in %d iterations\n", found, (int)iterations);
+    return 0;
+}
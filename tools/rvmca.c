@@ -0,0 +1,91 @@
+// Static throughput analysis of RV32IM assembly, llvm-mca style: estimates
+// cycles per iteration, resource pressure and the critical path of every
+// function and loop body, and prints an annotated listing.
+// Usage: rvmca [--model=name] [--iterations=n] [--function=name] program.s
+//        rvmca --list-models
+// The compiler runs the same analysis on its own output with -fmca-report.
+#include "rvasm.h"
+#include "rvmca.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static char* read_file(const char* path, size_t* len) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) return NULL;
+    size_t capacity = 4096;
+    size_t used = 0;
+    char* text = malloc(capacity);
+    size_t got;
+    while (text && (got = fread(text + used, 1, capacity - used, file)) > 0) {
+        used += got;
+        if (used == capacity) {
+            capacity *= 2;
+            text = realloc(text, capacity);
+        }
+    }
+    fclose(file);
+    if (text == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    *len = used;
+    return text;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "Usage: %s [--model=name] [--iterations=n] [--function=name] program.s\n", program);
+    fprintf(stderr, "       %s --list-models\n", program);
+}
+
+int main(int argc, char** argv) {
+    RvMcaOptions options = { rv_core_model(NULL), 100, NULL };
+    const char* path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--model=", 8) == 0) {
+            options.model = rv_core_model(argv[i] + 8);
+            if (options.model == NULL) {
+                fprintf(stderr, "Error: Unknown model '%s'; models:\n", argv[i] + 8);
+                rv_core_model_list(stderr);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--iterations=", 13) == 0) {
+            options.iterations = atoi(argv[i] + 13);
+        } else if (strncmp(argv[i], "--function=", 11) == 0) {
+            options.function = argv[i] + 11;
+        } else if (strcmp(argv[i], "--list-models") == 0) {
+            rv_core_model_list(stdout);
+            return 0;
+        } else if (argv[i][0] != '-' && path == NULL) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (path == NULL) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (options.iterations < 2) {
+        fprintf(stderr, "Error: --iterations must be at least 2\n");
+        return 1;
+    }
+
+    size_t len;
+    char* source = read_file(path, &len);
+    if (source == NULL) {
+        fprintf(stderr, "Error: Cannot open file '%s'\n", path);
+        return 1;
+    }
+    RvProgram program;
+    int status = rv_assemble(source, len, &program);
+    free(source);
+    if (status != 0) {
+        fprintf(stderr, "Error: %s:%s\n", path, program.error);
+        return 1;
+    }
+    rv_mca_report(&program, &options, stdout);
+    rv_program_free(&program);
+    return 0;
+}
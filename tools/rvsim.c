@@ -0,0 +1,157 @@
+// Runs the compiler's RV32IM output on the built-in simulator and reports the
+// dynamic instruction count, an in-order pipeline cycle estimate and L1
+// cache behaviour.
+// Usage: rvsim [options] program.s
+//   --entry=<name>          function to run (default main)
+//   --icache=<size:line:ways>, --dcache=<size:line:ways>
+//                           L1 geometry, e.g. 16k:32:2; 0 disables the cache
+//   --miss-penalty=<n>      cycles per L1 miss (default 20)
+//   --load-use=<n>          load-to-use stall (default 1)
+//   --branch-penalty=<n>    taken branch and jalr penalty (default 2)
+//   --jump-penalty=<n>      jal penalty (default 1)
+//   --mul-latency=<n>, --div-latency=<n>   (default 3 and 20)
+//   --memory=<bytes>        address space size (default 16M)
+//   --max-insns=<n>         stop after n instructions (default 1e9)
+//   --quiet                 print only the result line
+// The exit status is 0 when the program ran to completion, whatever it
+// returned; the returned value is printed.
+#include "rvasm.h"
+#include "rvsim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static char* read_file(const char* path, size_t* len) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) return NULL;
+    size_t capacity = 4096;
+    size_t used = 0;
+    char* text = malloc(capacity);
+    if (text == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    size_t got;
+    while ((got = fread(text + used, 1, capacity - used, file)) > 0) {
+        used += got;
+        if (used == capacity) {
+            capacity *= 2;
+            text = realloc(text, capacity);
+            if (text == NULL) {
+                fprintf(stderr, "Memory allocation failed\n");
+                exit(1);
+            }
+        }
+    }
+    fclose(file);
+    *len = used;
+    return text;
+}
+
+static const char* option_value(const char* arg, const char* name) {
+    size_t length = strlen(name);
+    if (strncmp(arg, name, length) != 0 || arg[length] != '=') return NULL;
+    return arg + length + 1;
+}
+
+static int parse_int_option(const char* arg, const char* name, int* value) {
+    const char* text = option_value(arg, name);
+    if (text == NULL) return 0;
+    *value = atoi(text);
+    return 1;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s [--entry=name] [--icache=size:line:ways] [--dcache=size:line:ways]\n"
+            "          [--miss-penalty=n] [--load-use=n] [--branch-penalty=n] [--jump-penalty=n]\n"
+            "          [--mul-latency=n] [--div-latency=n] [--memory=bytes] [--max-insns=n]\n"
+            "          [--quiet] program.s\n",
+            program);
+}
+
+int main(int argc, char** argv) {
+    RvSimConfig config;
+    rv_sim_default_config(&config);
+    const char* entry = "main";
+    const char* path = NULL;
+    int quiet = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value;
+        if ((value = option_value(arg, "--entry")) != NULL) {
+            entry = value;
+        } else if ((value = option_value(arg, "--icache")) != NULL) {
+            if (rv_parse_cache_config(value, &config.icache) != 0) {
+                fprintf(stderr, "Error: Invalid cache geometry '%s'\n", value);
+                return 1;
+            }
+        } else if ((value = option_value(arg, "--dcache")) != NULL) {
+            if (rv_parse_cache_config(value, &config.dcache) != 0) {
+                fprintf(stderr, "Error: Invalid cache geometry '%s'\n", value);
+                return 1;
+            }
+        } else if ((value = option_value(arg, "--memory")) != NULL) {
+            char* end;
+            unsigned long bytes = strtoul(value, &end, 10);
+            if (*end == 'k' || *end == 'K') bytes *= 1024;
+            if (*end == 'm' || *end == 'M') bytes *= 1024 * 1024;
+            config.memory_size = (uint32_t)bytes;
+        } else if ((value = option_value(arg, "--max-insns")) != NULL) {
+            config.max_instructions = strtoull(value, NULL, 10);
+        } else if (parse_int_option(arg, "--miss-penalty", &config.miss_penalty)
+                   || parse_int_option(arg, "--load-use", &config.load_use)
+                   || parse_int_option(arg, "--branch-penalty", &config.branch_penalty)
+                   || parse_int_option(arg, "--jump-penalty", &config.jump_penalty)
+                   || parse_int_option(arg, "--mul-latency", &config.mul_latency)
+                   || parse_int_option(arg, "--div-latency", &config.div_latency)) {
+            continue;
+        } else if (strcmp(arg, "--quiet") == 0) {
+            quiet = 1;
+        } else if (arg[0] != '-' && path == NULL) {
+            path = arg;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (path == NULL) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (config.miss_penalty < 0 || config.load_use < 0 || config.branch_penalty < 0 || config.jump_penalty < 0
+        || config.mul_latency < 1 || config.div_latency < 1) {
+        fprintf(stderr, "Error: Penalties must not be negative and latencies must be positive\n");
+        return 1;
+    }
+
+    size_t len;
+    char* source = read_file(path, &len);
+    if (source == NULL) {
+        fprintf(stderr, "Error: Cannot open file '%s'\n", path);
+        return 1;
+    }
+    RvProgram program;
+    if (rv_assemble(source, len, &program) != 0) {
+        fprintf(stderr, "Error: %s:%s\n", path, program.error);
+        free(source);
+        return 1;
+    }
+    free(source);
+
+    RvSimResult result;
+    int status = rv_simulate(&program, entry, &config, &result);
+    if (status == 0) {
+        printf("%s returned %d\n", entry, result.exit_code);
+    } else {
+        fprintf(stderr, "Error: %s\n", result.error);
+    }
+    if (!quiet) {
+        putchar('\n');
+        rv_sim_report(&program, &config, &result, stdout);
+    }
+    rv_sim_result_free(&result);
+    rv_program_free(&program);
+    return status == 0 ? 0 : 1;
+}
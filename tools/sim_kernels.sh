@@ -0,0 +1,67 @@
+#!/bin/sh
+# Runs the kernels in tools/kernels on the built-in RV32IM simulator; run by
+# "make sim". Every kernel must return the value recorded in
+# tools/kernels/sim_baseline.txt, and its dynamic instruction count and
+# estimated cycles are compared with the recorded ones. The simulator is
+# deterministic, so any growth fails. SIM_UPDATE=1 records new counts (the
+# expected results of kernels already in the baseline are kept; check the
+# result of a new kernel against a native build before recording it).
+# Extra simulator options can be passed in RVSIM_ARGS.
+set -e
+
+COMPILER=${COMPILER:-./compiler}
+RVSIM=${RVSIM:-build/rvsim}
+KERNELS=${KERNELS:-tools/kernels}
+BASELINE=$KERNELS/sim_baseline.txt
+COMPILER=$(cd "$(dirname "$COMPILER")" && pwd)/$(basename "$COMPILER")
+WORKDIR=$(mktemp -d)
+trap 'rm -rf "$WORKDIR"' EXIT
+
+: > "$WORKDIR/results.txt"
+for source in "$KERNELS"/*.c; do
+    kernel=$(basename "$source" .c)
+    (cd "$WORKDIR" && "$COMPILER" "$OLDPWD/$source" > /dev/null && mv output.s "$kernel.s")
+    # shellcheck disable=SC2086
+    if ! "$RVSIM" $RVSIM_ARGS "$WORKDIR/$kernel.s" > "$WORKDIR/$kernel.out" 2>&1; then
+        echo "$kernel: $(head -n 1 "$WORKDIR/$kernel.out")" >&2
+        exit 1
+    fi
+    awk -v kernel="$kernel" '
+        /^main returned / { result = $3 }
+        /^Dynamic instructions/ { instructions = $3 }
+        /^Cycles/ { cycles = $2 }
+        END { print kernel, result, instructions, cycles }' "$WORKDIR/$kernel.out" >> "$WORKDIR/results.txt"
+done
+
+if [ "${SIM_UPDATE:-0}" = 1 ]; then
+    [ -f "$BASELINE" ] || : > "$BASELINE"
+    awk '
+        FILENAME == ARGV[1] { if ($1 !~ /^#/) expected[$1] = $2; next }
+        FNR == 1 { print "# kernel result instructions cycles" }
+        { if ($1 in expected) $2 = expected[$1]; print }
+    ' "$BASELINE" "$WORKDIR/results.txt" > "$WORKDIR/baseline.txt"
+    mv "$WORKDIR/baseline.txt" "$BASELINE"
+    echo "Baseline written to $BASELINE"
+    exit 0
+fi
+
+[ -f "$BASELINE" ] || BASELINE=/dev/null
+awk '
+    FILENAME == ARGV[1] { if ($1 !~ /^#/) { known[$1] = 1; result[$1] = $2; insns[$1] = $3; cycles[$1] = $4 }; next }
+    FNR == 1 { printf "%-14s %10s %12s %8s %12s %8s\n", "kernel", "result", "instructions", "change", "cycles", "change" }
+    {
+        if (!($1 in known)) {
+            printf "%-14s %10s %12d %8s %12d %8s  new kernel\n", $1, $2, $3, "", $4, ""
+            next
+        }
+        note = ""
+        if ($2 != result[$1]) { note = "  wrong result, expected " result[$1]; failed = 1 }
+        else if ($3 > insns[$1] || $4 > cycles[$1]) { note = "  worse"; failed = 1 }
+        printf "%-14s %10s %12d %+7.1f%% %12d %+7.1f%%%s\n", $1, $2, $3, 100 * ($3 - insns[$1]) / insns[$1],
+               $4, 100 * ($4 - cycles[$1]) / cycles[$1], note
+    }
+    END { exit failed }
+' "$BASELINE" "$WORKDIR/results.txt" || {
+    echo "Kernels regressed against $BASELINE" >&2
+    exit 1
+}